@@ -156,6 +156,9 @@ void AssignmentClient::setUpStatusToMonitor() {
     // send a stats packet every 1 seconds
     connect(&_statsTimerACM, &QTimer::timeout, this, &AssignmentClient::sendStatusPacketToACM);
     _statsTimerACM.start(1000);
+
+    // let the monitor know right away that this child is up, it measures how long children take to start
+    sendStatusPacketToACM();
 }
 
 void AssignmentClient::sendStatusPacketToACM() {
@@ -168,10 +171,14 @@ void AssignmentClient::sendStatusPacketToACM() {
         assignmentType = _currentAssignment->getType();
     }
 
-    auto statusPacket = NLPacket::create(PacketType::AssignmentClientStatus, sizeof(assignmentType) + NUM_BYTES_RFC4122_UUID);
+    qint64 pid = QCoreApplication::applicationPid();
+
+    auto statusPacket = NLPacket::create(PacketType::AssignmentClientStatus,
+                                         sizeof(assignmentType) + NUM_BYTES_RFC4122_UUID + sizeof(pid));
 
     statusPacket->write(_childAssignmentUUID.toRfc4122());
     statusPacket->writePrimitive(assignmentType);
+    statusPacket->writePrimitive(pid);
     
     nodeList->sendPacket(std::move(statusPacket), _assignmentClientMonitorSocket);
 }
@@ -23,6 +23,7 @@
 #include <SharedUtil.h>
 #include <ShutdownEventListener.h>
 #include <shared/ScriptInitializerMixin.h>
+#include <udt/NetworkConditioner.h>
 
 #include "Assignment.h"
 #include "AssignmentClient.h"
@@ -102,6 +103,11 @@ AssignmentClientApp::AssignmentClientApp(int argc, char* argv[]) :
     const QCommandLineOption parentPIDOption(PARENT_PID_OPTION, "PID of the parent process", "parent-pid");
     parser.addOption(parentPIDOption);
 
+    const QCommandLineOption networkConditionsOption(ASSIGNMENT_NETWORK_CONDITIONS_OPTION,
+        "emulated loss, reordering, jitter and bandwidth caps, e.g. loss=1,delay=20,jitter=5,bandwidth=2000",
+        "conditions");
+    parser.addOption(networkConditionsOption);
+
     if (!parser.parse(QCoreApplication::arguments())) {
         std::cout << parser.errorText().toStdString() << std::endl; // Avoid Qt log spam
         parser.showHelp();
@@ -238,6 +244,12 @@ AssignmentClientApp::AssignmentClientApp(int argc, char* argv[]) :
         }
     }
 
+    if (parser.isSet(networkConditionsOption)) {
+        // passed through the environment so that every socket, including the ones of forked children, picks it up
+        qputenv(udt::NetworkConditioner::ENVIRONMENT_VARIABLE.toLocal8Bit(),
+                parser.value(networkConditionsOption).toLocal8Bit());
+    }
+
     QThread::currentThread()->setObjectName("main thread");
 
     LogHandler::getInstance().moveToThread(thread());
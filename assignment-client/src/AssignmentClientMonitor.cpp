@@ -19,6 +19,7 @@
 
 #include <AddressManager.h>
 #include <LogHandler.h>
+#include <NumericalConstants.h>
 #include <udt/PacketHeaders.h>
 
 #include "AssignmentClientApp.h"
@@ -234,6 +235,8 @@ void AssignmentClientMonitor::spawnChildClient() {
         assignmentClient->setStandardErrorFile(stderrPathTemp);
     }
 
+    quint64 spawnTime = usecTimestampNow();
+
     // make sure that the output from the child process appears in our output
     assignmentClient->setProcessChannelMode(QProcess::ForwardedChannels);
     assignmentClient->start(QCoreApplication::applicationFilePath(), _childArguments);
@@ -280,7 +283,7 @@ void AssignmentClientMonitor::spawnChildClient() {
 
         qDebug() << "Spawned a child client with PID" << assignmentClient->processId();
 
-        _childProcesses.insert(assignmentClient->processId(), { assignmentClient, stdoutPath, stderrPath });
+        _childProcesses.insert(assignmentClient->processId(), { assignmentClient, stdoutPath, stderrPath, spawnTime });
     }
 }
 
@@ -370,11 +373,60 @@ void AssignmentClientMonitor::handleChildStatusPacket(QSharedPointer<ReceivedMes
 
         childData->setChildType(Assignment::Type(assignmentType));
 
+        // children tell their PID along, the first status they send marks the end of their startup
+        qint64 pid = 0;
+        if (message->getBytesLeftToRead() >= (qint64)sizeof(pid)) {
+            message->readPrimitive(&pid);
+        }
+
+        auto it = _childProcesses.find(pid);
+        if (it != _childProcesses.end() && it->startupTime == 0) {
+            it->startupTime = std::max((quint64)1, usecTimestampNow() - it->spawnTime);
+            qDebug() << "Child process" << pid << "started up in" << (it->startupTime / USECS_PER_MSEC) << "msecs";
+
+            ++_numStartedChildren;
+            _totalStartupTime += it->startupTime;
+            _maxStartupTime = std::max(_maxStartupTime, it->startupTime);
+        }
+
         // note when this child talked
         matchingNode->setLastHeardMicrostamp(usecTimestampNow());
     }
 }
 
+// Adds what the memory of a child costs: its resident set, and its proportional share of it (the pages it shares with
+// other processes divided among them).
+static void addMemoryUsage(QJsonObject& server, qint64 pid) {
+#ifdef Q_OS_LINUX
+    QFile smaps(QString("/proc/%1/smaps_rollup").arg(pid));
+    if (!smaps.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    qint64 sharedKB = 0;
+
+    for (auto& line : smaps.readAll().split('\n')) {
+        auto fields = line.simplified().split(' ');
+        if (fields.size() < 2) {
+            continue;
+        }
+
+        auto field = fields[0];
+        qint64 kilobytes = fields[1].toLongLong();
+
+        if (field == "Rss:") {
+            server["rss_kb"] = kilobytes;
+        } else if (field == "Pss:") {
+            server["pss_kb"] = kilobytes;
+        } else if (field == "Shared_Clean:" || field == "Shared_Dirty:") {
+            sharedKB += kilobytes;
+        }
+    }
+
+    server["shared_kb"] = sharedKB;
+#endif
+}
+
 bool AssignmentClientMonitor::handleHTTPRequest(HTTPConnection* connection, const QUrl& url, bool skipSubHandler) {
     if (url.path() == "/status") {
         QByteArray response;
@@ -388,11 +440,26 @@ bool AssignmentClientMonitor::handleHTTPRequest(HTTPConnection* connection, cons
             server["logStdout"] = ac.logStdoutPath;
             server["logStderr"] = ac.logStderrPath;
 
+            if (ac.startupTime > 0) {
+                server["startup_msecs"] = (double)ac.startupTime / USECS_PER_MSEC;
+            }
+
+            addMemoryUsage(server, ac.process->processId());
+
             servers[QString::number(ac.process->processId())] = server;
         }
 
         status["servers"] = servers;
 
+        // the startup time of every child since the monitor started
+        QJsonObject startup;
+        startup["children"] = _numStartedChildren;
+        if (_numStartedChildren > 0) {
+            startup["mean_msecs"] = (double)_totalStartupTime / _numStartedChildren / USECS_PER_MSEC;
+            startup["max_msecs"] = (double)_maxStartupTime / USECS_PER_MSEC;
+        }
+        status["startup"] = startup;
+
         QJsonDocument document { status };
 
         connection->respond(HTTPConnection::StatusCode200, document.toJson());
@@ -30,6 +30,8 @@ struct ACProcess {
     QProcess* process; // looks like a dangling pointer, but is parented by the AssignmentClientMonitor 
     QString logStdoutPath;
     QString logStderrPath;
+    quint64 spawnTime { 0 }; // usecs
+    quint64 startupTime { 0 }; // usecs between the spawn and the first status of the child, 0 until then
 };
 
 class AssignmentClientMonitor : public QObject, public HTTPRequestHandler {
@@ -80,6 +82,11 @@ private:
     QSet<quint16> _childListenPorts;
 
     bool _wantsChildFileLogging { false };
+
+    // how long children take to start up, since the monitor started
+    int _numStartedChildren { 0 };
+    quint64 _totalStartupTime { 0 }; // usecs
+    quint64 _maxStartupTime { 0 }; // usecs
 };
 
 #endif // hifi_AssignmentClientMonitor_h
@@ -34,6 +34,7 @@
 #include <SharedUtil.h>
 #include <PathUtils.h>
 #include <image/TextureProcessing.h>
+#include <udt/BBRCC.h>
 
 #include "AssetServerLogging.h"
 #include "BakeAssetTask.h"
@@ -392,6 +393,14 @@ void AssetServer::completeSetup() {
                     " (" << maxBandwidth << "bits/s)";
     }
 
+    static const QString CONGESTION_CONTROL_OPTION = "congestion_control";
+    static const QString BBR_CONGESTION_CONTROL = "bbr";
+    if (assetServerObject[CONGESTION_CONTROL_OPTION].toString() == BBR_CONGESTION_CONTROL) {
+        nodeList->setCongestionControlFactory(std::unique_ptr<udt::CongestionControlVirtualFactory>(
+            new udt::CongestionControlFactory<udt::BBRCC>()));
+        qCInfo(asset_server) << "Using BBR congestion control for asset transfers";
+    }
+
     // get the path to the asset folder from the domain server settings
     static const QString ASSETS_PATH_OPTION = "assets_path";
     auto assetsJSONValue = assetServerObject[ASSETS_PATH_OPTION];
@@ -88,7 +88,7 @@ void SendAssetTask::run() {
                     file.seek(byteRange.fromInclusive);
                     replyPacketList->writePrimitive(AssetUtils::AssetServerError::NoError);
                     replyPacketList->writePrimitive(size);
-                    replyPacketList->write(file.read(size));
+                    replyPacketList->writeExternal(file.read(size));
                 } else {
                     // this range is negative, at least the first part of the read will be back into the end of the file
 
@@ -99,7 +99,7 @@ void SendAssetTask::run() {
                     replyPacketList->writePrimitive(size);
 
                     // first write everything from the negative range to the end of the file
-                    replyPacketList->write(file.read(size));
+                    replyPacketList->writeExternal(file.read(size));
                 }
 
                 qCDebug(networking) << "Sending asset: " << hexHash;
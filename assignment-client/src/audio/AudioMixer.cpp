@@ -86,7 +86,7 @@ AudioMixer::AudioMixer(ReceivedMessage& message) :
     auto& packetReceiver = nodeList->getPacketReceiver();
 
     // packets whose consequences are limited to their own node can be parallelized
-    packetReceiver.registerListenerForTypes({
+    for (auto type : {
             PacketType::MicrophoneAudioNoEcho,
             PacketType::MicrophoneAudioWithEcho,
             PacketType::InjectAudio,
@@ -100,8 +100,9 @@ AudioMixer::AudioMixer(ReceivedMessage& message) :
             PacketType::PerAvatarGainSet,
             PacketType::InjectorGainSet,
             PacketType::AudioSoloRequest,
-            PacketType::StopInjector },
-            this, "queueAudioPacket");
+            PacketType::StopInjector }) {
+        packetReceiver.registerHandler(type, this, &AudioMixer::queueAudioPacket);
+    }
 
     // packets whose consequences are global should be processed on the main thread
     packetReceiver.registerListener(PacketType::MuteEnvironment, this, "handleMuteEnvironmentPacket");
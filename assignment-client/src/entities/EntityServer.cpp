@@ -49,6 +49,9 @@ EntityServer::EntityServer(ReceivedMessage& message) :
     DependencyManager::set<ModelFormatRegistry>(); // ModelFormatRegistry must be defined before ModelCache. See the ModelCache ctor
     DependencyManager::set<ModelCache>();
 
+    // every viewer is sent the same entities, encode them once
+    EntityItem::setEncodeCacheEnabled(true);
+
     auto& packetReceiver = DependencyManager::get<NodeList>()->getPacketReceiver();
     packetReceiver.registerListenerForTypes({ PacketType::EntityAdd,
         PacketType::EntityClone,
@@ -81,6 +84,13 @@ void EntityServer::aboutToFinish() {
     DependencyManager::destroy<AssignmentDynamicFactory>();
 
     OctreeServer::aboutToFinish();
+
+    // after the send threads that use it, waits for a capture in progress
+    _sceneSnapshots.reset();
+}
+
+EntitySceneSnapshotPointer EntityServer::getSceneSnapshot() {
+    return _sceneSnapshots ? _sceneSnapshots->get() : EntitySceneSnapshotPointer();
 }
 
 void EntityServer::handleEntityPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
@@ -108,6 +118,8 @@ OctreePointer EntityServer::createTree() {
     DependencyManager::set<AssignmentParentFinder>(tree);
     DependencyManager::set<EntityEditFilters>(std::static_pointer_cast<EntityTree>(tree));
 
+    _sceneSnapshots.reset(new EntitySceneSnapshotCache(tree));
+
     return tree;
 }
 
@@ -370,6 +382,12 @@ void EntityServer::entityFilterAdded(EntityItemID id, bool success) {
 void EntityServer::nodeAdded(SharedNodePointer node) {
     EntityTreePointer tree = std::static_pointer_cast<EntityTree>(_tree);
     tree->knowAvatarID(node->getUUID());
+
+    // so that the scene is ready to be sent by the time the new viewer sends its first query
+    if (node->getType() == NodeType::Agent && _sceneSnapshots) {
+        _sceneSnapshots->refresh();
+    }
+
     OctreeServer::nodeAdded(node);
 }
 
@@ -414,6 +432,24 @@ QString EntityServer::serverSubclassStats() {
     statsString += QString().sprintf("       EntityItem size... %ld bytes\r\n", sizeof(EntityItem));
     statsString += "\r\n\r\n";
 
+    statsString += "<b>Entity Server Encode Cache Statistics</b>\r\n";
+    statsString += QString("           Encoded entities copied: %1\r\n")
+        .arg(locale.toString((qulonglong)EntityItem::getEncodeCacheHits()));
+    statsString += QString("                  Entities encoded: %1\r\n")
+        .arg(locale.toString((qulonglong)EntityItem::getEncodeCacheMisses()));
+    statsString += QString("                      Bytes copied: %1\r\n")
+        .arg(locale.toString((qulonglong)EntityItem::getEncodeCacheBytesCopied()));
+    statsString += "\r\n\r\n";
+
+    statsString += "<b>Entity Server Initial Scene Statistics</b>\r\n";
+    statsString += QString("                Scenes sent in bulk: %1\r\n")
+        .arg(locale.toString((qulonglong)EntityTreeSendThread::_totalBulkScenes));
+    statsString += QString("              Entities sent in bulk: %1\r\n")
+        .arg(locale.toString((qulonglong)EntityTreeSendThread::_totalBulkSceneEntities));
+    statsString += QString("                 Bytes sent in bulk: %1\r\n")
+        .arg(locale.toString((qulonglong)EntityTreeSendThread::_totalBulkSceneBytes));
+    statsString += "\r\n\r\n";
+
     statsString += "<b>Entity Server Sending to Viewer Statistics</b>\r\n";
     statsString += "----- Viewer Node ID -----------------    ----- Entity ID ----------------------    "
                    "---------- Last Sent To ----------    ---------- Last Edited -----------\r\n";
@@ -17,6 +17,7 @@
 #include <memory>
 
 #include <EntityItem.h>
+#include <EntitySceneSnapshotCache.h>
 #include <EntityTree.h>
 #include <SimpleEntitySimulation.h>
 
@@ -59,6 +60,9 @@ public:
 
     virtual void aboutToFinish() override;
 
+    // The scene sent in bulk to the new viewers, nullptr while there is no recent one. Never waits for a capture.
+    EntitySceneSnapshotPointer getSceneSnapshot();
+
 public slots:
     virtual void nodeAdded(SharedNodePointer node) override;
     virtual void nodeKilled(SharedNodePointer node) override;
@@ -86,6 +90,8 @@ private:
     int _MAXIMUM_DYNAMIC_DOMAIN_VERIFICATION_TIMER_MS = DEFAULT_MAXIMUM_DYNAMIC_DOMAIN_VERIFICATION_TIMER_MS;  // 1h
     QTimer _dynamicDomainVerificationTimer;
     void startDynamicDomainVerification();
+
+    std::unique_ptr<EntitySceneSnapshotCache> _sceneSnapshots;
 };
 
 #endif  // hifi_EntityServer_h
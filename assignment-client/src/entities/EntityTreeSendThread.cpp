@@ -11,21 +11,64 @@
 
 #include "EntityTreeSendThread.h"
 
+#include <limits>
+
 #include <EntityNodeData.h>
 #include <EntityTypes.h>
+#include <NumericalConstants.h>
 #include <OctreeUtils.h>
 
 #include "EntityServer.h"
 
+AtomicUIntStat EntityTreeSendThread::_totalBulkScenes { 0 };
+AtomicUIntStat EntityTreeSendThread::_totalBulkSceneEntities { 0 };
+AtomicUIntStat EntityTreeSendThread::_totalBulkSceneBytes { 0 };
+
 EntityTreeSendThread::EntityTreeSendThread(OctreeServer* myServer, const SharedNodePointer& node) :
     OctreeSendThread(myServer, node)
 {
-    connect(std::static_pointer_cast<EntityTree>(myServer->getOctree()).get(), &EntityTree::editingEntityPointer, this, &EntityTreeSendThread::editingEntityPointer, Qt::QueuedConnection);
-    connect(std::static_pointer_cast<EntityTree>(myServer->getOctree()).get(), &EntityTree::deletingEntityPointer, this, &EntityTreeSendThread::deletingEntityPointer, Qt::QueuedConnection);
+    auto entityTree = std::static_pointer_cast<EntityTree>(myServer->getOctree());
+    auto pendingChanges = _pendingChanges;
+
+    connect(entityTree.get(), &EntityTree::editingEntityPointer, this, [pendingChanges](const EntityItemPointer& entity) {
+        std::lock_guard<std::mutex> lock(pendingChanges->mutex);
+        pendingChanges->editedEntities.push_back(entity);
+    }, Qt::DirectConnection);
+    connect(entityTree.get(), &EntityTree::deletingEntityPointer, this, [pendingChanges](EntityItem* entity) {
+        std::lock_guard<std::mutex> lock(pendingChanges->mutex);
+        pendingChanges->deletedEntities.push_back(entity);
+    }, Qt::DirectConnection);
 
     // connect to connection ID change on EntityNodeData so we can clear state for this receiver
     auto nodeData = static_cast<EntityNodeData*>(node->getLinkedData());
-    connect(nodeData, &EntityNodeData::incomingConnectionIDChanged, this, &EntityTreeSendThread::resetState);
+    connect(nodeData, &EntityNodeData::incomingConnectionIDChanged, this, [pendingChanges] {
+        std::lock_guard<std::mutex> lock(pendingChanges->mutex);
+        pendingChanges->reset = true;
+    }, Qt::DirectConnection);
+}
+
+void EntityTreeSendThread::processPendingChanges() {
+    bool reset;
+    std::vector<EntityItem*> deletedEntities;
+    std::vector<EntityItemPointer> editedEntities;
+    {
+        std::lock_guard<std::mutex> lock(_pendingChanges->mutex);
+        reset = _pendingChanges->reset;
+        _pendingChanges->reset = false;
+        deletedEntities.swap(_pendingChanges->deletedEntities);
+        editedEntities.swap(_pendingChanges->editedEntities);
+    }
+
+    // the deletions go first so that an entity edited before it was deleted isn't queued to be sent
+    if (reset) {
+        resetState();
+    }
+    for (auto entity : deletedEntities) {
+        deletingEntityPointer(entity);
+    }
+    for (const auto& entity : editedEntities) {
+        editingEntityPointer(entity);
+    }
 }
 
 void EntityTreeSendThread::resetState() {
@@ -110,8 +153,12 @@ bool EntityTreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, O
 
         int32_t lodLevelOffset = nodeData->getBoundaryLevelAdjust() + (viewFrustumChanged ? LOW_RES_MOVING_ADJUST : NO_BOUNDARY_ADJUST);
         newView.lodScaleFactor = powf(2.0f, lodLevelOffset);
-        
-        startNewTraversal(newView, root, isFullScene);
+
+        // a new viewer is sent the scene in view at once, and then what changed since it was captured
+        bool isFirstTraversal = _traversal.finished() && _traversal.getStartOfCompletedTraversal() == 0;
+        if (!isFirstTraversal || isFullScene || !sendInitialScene(node, nodeData, newView)) {
+            startNewTraversal(newView, root, isFullScene);
+        }
 
         // When the viewFrustum changed the sort order may be incorrect, so we re-sort
         // and also use the opportunity to cull anything no longer in view
@@ -176,6 +223,138 @@ bool EntityTreeSendThread::traverseTreeAndSendContents(SharedNodePointer node, O
     return sendComplete;
 }
 
+bool EntityTreeSendThread::sendInitialScene(const SharedNodePointer& node, OctreeQueryNode* nodeData,
+                                            const DiffTraversal::View& view) {
+    // the filtered queries are sent the entities that match along with their family, which takes the traversal
+    auto entityNodeData = static_cast<EntityNodeData*>(nodeData);
+    if (!entityNodeData->getJSONFilter()->isEmpty()) {
+        return false;
+    }
+
+    auto snapshot = static_cast<EntityServer*>(_myServer)->getSceneSnapshot();
+    if (!snapshot) {
+        return false;
+    }
+
+    // The message reads like an EntityData packet, with sections that hold entities of the root element, as the packets
+    // of the traversals do. Only their header and the entities in view are picked here, with the tree lock held: the
+    // sections are compressed once it is released, see sendDeferredMessage().
+    {
+        const char zeroByte = 0;
+        uint8_t childrenExistBits = 0;
+        auto root = _myServer->getOctree()->getRoot();
+        for (int32_t i = 0; i < NUMBER_OF_CHILDREN; ++i) {
+            if (root->getChildAtIndex(i)) {
+                childrenExistBits += (1 << i);
+            }
+        }
+
+        _initialSceneSectionHeader.clear();
+        _initialSceneSectionHeader.append(zeroByte); // octalcode
+        _initialSceneSectionHeader.append(zeroByte); // colors
+        _initialSceneSectionHeader.append((char)childrenExistBits); // childrenInTreeMask
+        _initialSceneSectionHeader.append(zeroByte); // childrenInBufferMask
+    }
+    _initialSceneEntities.clear();
+
+    _knownState.clear();
+
+    bool canGetAndSetPrivateUserData = node->getCanGetAndSetPrivateUserData();
+    uint64_t sendTime = usecTimestampNow();
+
+    for (const auto& entry : snapshot->getEntries()) {
+        auto entity = entry.entity.lock();
+        if (!entity || entity->isDead() || !entity->getElement()) {
+            // deleted since the capture, the deletion can be older than the viewer and never be sent to it
+            continue;
+        }
+
+        float priority = view.computePriority(entity);
+        if (priority == PrioritizedEntity::DO_NOT_SEND) {
+            continue;
+        }
+
+        bool withPrivateUserData = canGetAndSetPrivateUserData && !entry.dataWithPrivateUserData.isEmpty();
+        const QByteArray& data = withPrivateUserData ? entry.dataWithPrivateUserData : entry.data;
+        if (data.isEmpty()) {
+            _sendQueue.emplace(entity, priority);
+            continue;
+        }
+
+        // shares the encoded data of the snapshot
+        _initialSceneEntities.push_back(data);
+
+        // what changed since the capture is sent by the traversals
+        KnownState& state = _knownState[entity.get()];
+        state.sendTime = snapshot->getCaptureTime();
+        state.baseline.baselineSent(entry.propertiesVersion, sendTime, true);
+
+        _myServer->trackSend(entity->getID(), entity->getLastEdited(), _nodeUuid);
+    }
+
+    DiffTraversal::View completedView = view;
+    completedView.startTime = snapshot->getCaptureTime();
+    _traversal.setCompletedView(completedView);
+
+    return true;
+}
+
+void EntityTreeSendThread::sendDeferredMessage(const SharedNodePointer& node, OctreeQueryNode* nodeData) {
+    const int numEntitiesOffset = _initialSceneSectionHeader.size();
+    QByteArray sectionHeader = _initialSceneSectionHeader;
+    sectionHeader.append(QByteArray(sizeof(uint16_t), 0)); // numEntities
+
+    // a section is at most the size of OCTREE_PACKET_INTERNAL_SECTION_SIZE once compressed
+    const int MAX_SECTION_SIZE = 60 * BYTES_PER_KILOBYTE;
+    const uint16_t MAX_SECTION_ENTITIES = std::numeric_limits<uint16_t>::max();
+
+    OCTREE_PACKET_FLAGS flags = 0;
+    setAtBit(flags, PACKET_IS_COLOR_BIT);
+    setAtBit(flags, PACKET_IS_COMPRESSED_BIT);
+
+    auto packetList = NLPacketList::create(PacketType::EntityData, QByteArray(), true, true);
+    packetList->writePrimitive(flags);
+    packetList->writePrimitive(OCTREE_PACKET_SEQUENCE(nodeData->getSequenceNumber()));
+    packetList->writePrimitive(OCTREE_PACKET_SENT_TIME(usecTimestampNow()));
+
+    QByteArray section = sectionHeader;
+    uint16_t numSectionEntities = 0;
+    auto writeSection = [&] {
+        if (numSectionEntities == 0) {
+            return;
+        }
+        memcpy(section.data() + numEntitiesOffset, &numSectionEntities, sizeof(numSectionEntities));
+
+        // the default level, most of the time goes to compress for little gain past it
+        QByteArray compressedSection = qCompress(section);
+        packetList->writePrimitive(OCTREE_PACKET_INTERNAL_SECTION_SIZE(compressedSection.size()));
+        packetList->write(compressedSection);
+
+        section = sectionHeader;
+        numSectionEntities = 0;
+    };
+
+    for (const auto& data : _initialSceneEntities) {
+        if (section.size() + data.size() > MAX_SECTION_SIZE || numSectionEntities == MAX_SECTION_ENTITIES) {
+            writeSection();
+        }
+        section.append(data);
+        ++numSectionEntities;
+    }
+    writeSection();
+
+    _totalBulkScenes++;
+    _totalBulkSceneEntities += (int)_initialSceneEntities.size();
+    _totalBulkSceneBytes += packetList->getDataSize();
+    _totalBytes += packetList->getDataSize();
+    _totalPackets += packetList->getNumPackets();
+
+    _initialSceneEntities.clear();
+
+    nodeData->untrackedPacketSent();
+    DependencyManager::get<NodeList>()->sendPacketList(std::move(packetList), *node);
+}
+
 bool EntityTreeSendThread::addAncestorsToExtraFlaggedEntities(const QUuid& filteredEntityID,
                                                               EntityItem& entityItem, EntityNodeData& nodeData) {
     // check if this entity has a parent that is also an entity
@@ -272,8 +451,8 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
                             const auto& view = _traversal.getCurrentView();
                             priority = view.computePriority(entity);
 
-                        } else if (entity->getLastEdited() > knownTimestamp->second ||
-                                   entity->getLastChangedOnServer() > knownTimestamp->second) {
+                        } else if (entity->getLastEdited() > knownTimestamp->second.sendTime ||
+                                   entity->getLastChangedOnServer() > knownTimestamp->second.sendTime) {
                             // it is known and it changed --> put it on the queue with any priority
                             // TODO: sort these correctly
                             priority = PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
@@ -301,8 +480,8 @@ void EntityTreeSendThread::startNewTraversal(const DiffTraversal::View& view, En
                         const auto& view = _traversal.getCurrentView();
                         priority = view.computePriority(entity);
 
-                    } else if (entity->getLastEdited() > knownTimestamp->second ||
-                               entity->getLastChangedOnServer() > knownTimestamp->second) {
+                    } else if (entity->getLastEdited() > knownTimestamp->second.sendTime ||
+                               entity->getLastChangedOnServer() > knownTimestamp->second.sendTime) {
                         // it is known and it changed --> put it on the queue with any priority
                         // TODO: sort these correctly
                         priority = PrioritizedEntity::WHEN_IN_DOUBT_PRIORITY;
@@ -362,22 +541,42 @@ bool EntityTreeSendThread::traverseTreeAndBuildNextPacketPayload(EncodeBitstream
     nodeData->stats.encodeStarted();
     auto entityNode = _node.toStrongRef();
     auto entityNodeData = static_cast<EntityNodeData*>(entityNode->getLinkedData());
+    auto jsonFilter = entityNodeData->getJSONFilter();
     while(!_sendQueue.empty()) {
         PrioritizedEntity queuedItem = _sendQueue.top();
         EntityItemPointer entity = queuedItem.getEntity();
         if (entity) {
             const QUuid& entityID = entity->getID();
-            // Only send entities that match the jsonFilters, but keep track of everything we've tried to send so we don't try to send it again;
+            // Only send entities that match the JSON filter, but keep track of everything we've tried to send so we don't try to send it again;
             // also send if we previously matched since this represents change to a matched item.
-            bool entityMatchesFilters = entity->matchesJSONFilters(jsonFilters);
+            bool entityMatchesFilters = entity->matchesJSONFilters(*jsonFilter);
             bool entityPreviouslyMatchedFilter = entityNodeData->sentFilteredEntity(entityID);
+            auto knownState = _knownState.find(entity.get());
+            bool isNewBaseline = false;
+            quint64 propertiesVersion = 0;
 
             if (entityMatchesFilters || entityNodeData->isEntityFlaggedAsExtra(entityID) || entityPreviouslyMatchedFilter) {
-                if (!jsonFilters.isEmpty() && entityMatchesFilters) {
+                if (!jsonFilter->isEmpty() && entityMatchesFilters) {
                     // Record explicitly filtered-in entity so that extra entities can be flagged.
                     entityNodeData->insertSentFilteredEntity(entityID);
                 }
-                OctreeElement::AppendState appendEntityState = entity->appendEntityData(&_packetData, params, _extraEncodeData, entityNode->getCanGetAndSetPrivateUserData());
+
+                quint64 knownPropertiesVersion = 0;
+                if (knownState != _knownState.end()) {
+                    knownPropertiesVersion = knownState->second.baseline.getDeltaVersion(*entity, sendTime,
+                        nodeData->getSendsNacks(), isNewBaseline);
+                } else {
+                    isNewBaseline = nodeData->getSendsNacks();
+                }
+
+                // a continued entity could have been changed since its first part was encoded, don't make it a baseline
+                if (_extraEncodeData->entities.contains(entityID)) {
+                    isNewBaseline = false;
+                }
+                propertiesVersion = entity->getPropertiesVersion();
+
+                OctreeElement::AppendState appendEntityState = entity->appendEntityData(&_packetData, params, _extraEncodeData,
+                    entityNode->getCanGetAndSetPrivateUserData(), knownPropertiesVersion);
 
                 if (appendEntityState != OctreeElement::COMPLETED) {
                     if (appendEntityState == OctreeElement::PARTIAL) {
@@ -395,7 +594,11 @@ bool EntityTreeSendThread::traverseTreeAndBuildNextPacketPayload(EncodeBitstream
             if (queuedItem.shouldForceRemove()) {
                 _knownState.erase(entity.get());
             } else {
-                _knownState[entity.get()] = sendTime;
+                KnownState& state = _knownState[entity.get()];
+                state.sendTime = sendTime;
+                if (isNewBaseline) {
+                    state.baseline.baselineSent(propertiesVersion, sendTime, false);
+                }
             }
         }
         _sendQueue.pop();
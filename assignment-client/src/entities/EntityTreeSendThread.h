@@ -12,11 +12,15 @@
 #ifndef hifi_EntityTreeSendThread_h
 #define hifi_EntityTreeSendThread_h
 
+#include <memory>
+#include <mutex>
 #include <unordered_set>
+#include <vector>
 
 #include "../octree/OctreeSendThread.h"
 
 #include <DiffTraversal.h>
+#include <EntityDeltaBaseline.h>
 #include <EntityPriorityQueue.h>
 #include <shared/ConicalViewFrustum.h>
 
@@ -30,19 +34,32 @@ class EntityTreeSendThread : public OctreeSendThread {
 public:
     EntityTreeSendThread(OctreeServer* myServer, const SharedNodePointer& node);
 
+    static AtomicUIntStat _totalBulkScenes;
+    static AtomicUIntStat _totalBulkSceneEntities;
+    static AtomicUIntStat _totalBulkSceneBytes;
+
 protected:
     bool traverseTreeAndSendContents(SharedNodePointer node, OctreeQueryNode* nodeData,
             bool viewFrustumChanged, bool isFullScene) override;
 
-private slots:
-    void resetState(); // clears our known state forcing entities to appear unsent
+    void processPendingChanges() override;
 
 private:
+    void resetState(); // clears our known state forcing entities to appear unsent
+
     // the following two methods return booleans to indicate if any extra flagged entities were new additions to set
     bool addAncestorsToExtraFlaggedEntities(const QUuid& filteredEntityID, EntityItem& entityItem, EntityNodeData& nodeData);
     bool addDescendantsToExtraFlaggedEntities(const QUuid& filteredEntityID, EntityItem& entityItem, EntityNodeData& nodeData);
 
     void startNewTraversal(const DiffTraversal::View& viewFrustum, EntityTreeElementPointer root, bool forceFirstPass = false);
+
+    // Sends the entities of the scene snapshot in view in one reliable message, in place of a first traversal. Returns
+    // false if the scene is to be sent by the traversal instead, as it is when there is no recent snapshot: this is
+    // called with the tree lock held, it doesn't wait for one to be captured. The message is only put together and sent
+    // by sendDeferredMessage(), once the lock is released.
+    bool sendInitialScene(const SharedNodePointer& node, OctreeQueryNode* nodeData, const DiffTraversal::View& view);
+    bool hasDeferredMessage() const override { return !_initialSceneEntities.empty(); }
+    void sendDeferredMessage(const SharedNodePointer& node, OctreeQueryNode* nodeData) override;
     bool traverseTreeAndBuildNextPacketPayload(EncodeBitstreamParams& params, const QJsonObject& jsonFilters) override;
 
     void preDistributionProcessing() override;
@@ -51,14 +68,35 @@ private:
 
     DiffTraversal _traversal;
     EntityPriorityQueue _sendQueue;
-    std::unordered_map<EntityItem*, uint64_t> _knownState;
+
+    // the initial scene picked by sendInitialScene(), the data of its entities is shared with the snapshot
+    QByteArray _initialSceneSectionHeader;
+    std::vector<QByteArray> _initialSceneEntities;
+
+    // What the receiver knows of an entity. The changes are counted from the baseline rather than from the last send,
+    // so that a lost or ignored update is covered by the next one.
+    struct KnownState {
+        uint64_t sendTime { 0 };
+        EntityDeltaBaseline baseline;
+    };
+    std::unordered_map<EntityItem*, KnownState> _knownState;
 
     // packet construction stuff
     EntityTreeElementExtraEncodeDataPointer _extraEncodeData { new EntityTreeElementExtraEncodeData() };
     int32_t _numEntitiesOffset { 0 };
     uint16_t _numEntities { 0 };
 
-private slots:
+    // The tree and the node data signal their changes from whichever thread makes them, while the passes run on the
+    // workers of the scheduler: the changes wait here for the next pass. Shared with the connections, which can still
+    // fire while this is being destroyed.
+    struct PendingChanges {
+        std::mutex mutex;
+        bool reset { false };
+        std::vector<EntityItem*> deletedEntities;
+        std::vector<EntityItemPointer> editedEntities;
+    };
+    std::shared_ptr<PendingChanges> _pendingChanges { std::make_shared<PendingChanges>() };
+
     void editingEntityPointer(const EntityItemPointer& entity);
     void deletingEntityPointer(EntityItem* entity);
 };
@@ -14,6 +14,9 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QJsonObject>
 #include <QBuffer>
+
+#include <algorithm>
+
 #include <LogHandler.h>
 #include <MessagesClient.h>
 #include <NodeList.h>
@@ -25,51 +28,122 @@ MessagesMixer::MessagesMixer(ReceivedMessage& message) : ThreadedAssignment(mess
 {
     connect(DependencyManager::get<NodeList>().data(), &NodeList::nodeKilled, this, &MessagesMixer::nodeKilled);
     auto& packetReceiver = DependencyManager::get<NodeList>()->getPacketReceiver();
-    packetReceiver.registerListener(PacketType::MessagesData, this, "handleMessages");
-    packetReceiver.registerListener(PacketType::MessagesSubscribe, this, "handleMessagesSubscribe");
-    packetReceiver.registerListener(PacketType::MessagesUnsubscribe, this, "handleMessagesUnsubscribe");
+    packetReceiver.registerHandler(PacketType::MessagesData, this, &MessagesMixer::handleMessages);
+    packetReceiver.registerHandler(PacketType::MessagesSubscribe, this, &MessagesMixer::handleMessagesSubscribe);
+    packetReceiver.registerHandler(PacketType::MessagesUnsubscribe, this, &MessagesMixer::handleMessagesUnsubscribe);
 }
 
 void MessagesMixer::nodeKilled(SharedNodePointer killedNode) {
-    for (auto& channel : _channelSubscribers) {
-        channel.remove(killedNode->getUUID());
+    for (auto& channel : _channels) {
+        auto& subscribers = channel.subscribers;
+        subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), killedNode), subscribers.end());
     }
+
+    _fanOut.forget(killedNode);
 }
 
 void MessagesMixer::handleMessages(QSharedPointer<ReceivedMessage> receivedMessage, SharedNodePointer senderNode) {
-    QString channel, message;
+    QString channelName, message;
     QByteArray data;
     QUuid senderID;
     bool isText;
-    MessagesClient::decodeMessagesPacket(receivedMessage, channel, isText, message, data, senderID);
+    MessagesClient::decodeMessagesPacket(receivedMessage, channelName, isText, message, data, senderID);
 
-    auto nodeList = DependencyManager::get<NodeList>();
+    auto it = _channelIDs.find(channelName);
+    if (it == _channelIDs.end() || _channels[it.value()].subscribers.empty()) {
+        ++_numUnsubscribedMessages;
+        return;
+    }
 
-    nodeList->eachMatchingNode(
-        [&](const SharedNodePointer& node)->bool {
-        return node->getActiveSocket() && _channelSubscribers[channel].contains(node->getUUID());
-    },
-        [&](const SharedNodePointer& node) {
-        auto packetList = isText ? MessagesClient::encodeMessagesPacket(channel, message, senderID) :
-                                   MessagesClient::encodeMessagesDataPacket(channel, data, senderID);
-        nodeList->sendPacketList(std::move(packetList), *node);
-    });
+    auto& channel = _channels[it.value()];
+    ++channel.numMessages;
+    channel.numDeliveries += channel.subscribers.size();
+
+    // serialize the message once, every subscriber is sent the same payload
+    auto payload = MessagesClient::encodeMessagesPayload(channelName, isText, isText ? message.toUtf8() : data, senderID);
+    _fanOut.publish(payload, channel.subscribers);
 }
 
 void MessagesMixer::handleMessagesSubscribe(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
-    QString channel = QString::fromUtf8(message->getMessage());
-    _channelSubscribers[channel] << senderNode->getUUID();
+    QString channelName = QString::fromUtf8(message->getMessage());
+
+    auto it = _channelIDs.find(channelName);
+    if (it == _channelIDs.end()) {
+        it = _channelIDs.insert(channelName, (ChannelID)_channels.size());
+        _channels.push_back({ channelName, {} });
+    }
+
+    auto& subscribers = _channels[it.value()].subscribers;
+    if (std::find(subscribers.begin(), subscribers.end(), senderNode) == subscribers.end()) {
+        subscribers.push_back(senderNode);
+    }
 }
 
 void MessagesMixer::handleMessagesUnsubscribe(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
-    QString channel = QString::fromUtf8(message->getMessage());
-    if (_channelSubscribers.contains(channel)) {
-        _channelSubscribers[channel].remove(senderNode->getUUID());
+    QString channelName = QString::fromUtf8(message->getMessage());
+
+    auto it = _channelIDs.find(channelName);
+    if (it != _channelIDs.end()) {
+        auto& subscribers = _channels[it.value()].subscribers;
+        subscribers.erase(std::remove(subscribers.begin(), subscribers.end(), senderNode), subscribers.end());
+    }
+}
+
+void MessagesMixer::pruneEmptyChannels() {
+    // the IDs of the channels that are left are renumbered, they only ever index _channels
+    std::vector<Channel> channels;
+    _channelIDs.clear();
+
+    for (auto& channel : _channels) {
+        if (!channel.subscribers.empty()) {
+            _channelIDs.insert(channel.name, (ChannelID)channels.size());
+            channels.push_back(std::move(channel));
+        }
     }
+
+    _channels.swap(channels);
 }
 
 void MessagesMixer::sendStatsPacket() {
-    QJsonObject statsObject, messagesMixerObject;
+    QJsonObject statsObject, messagesMixerObject, channelsObject;
+
+    quint64 now = usecTimestampNow();
+    float secondsSinceLastStats = _lastStatsTime ? (float)(now - _lastStatsTime) / USECS_PER_SECOND : 0.0f;
+    _lastStatsTime = now;
+
+    auto perSecond = [&](quint64 count) {
+        return secondsSinceLastStats > 0.0f ? (float)count / secondsSinceLastStats : 0.0f;
+    };
+
+    // add stats for each channel that has been busy since the last stats packet
+    for (auto& channel : _channels) {
+        if (channel.numMessages > 0) {
+            QJsonObject channelStats;
+            channelStats["subscribers"] = (int)channel.subscribers.size();
+            channelStats["messages_per_second"] = perSecond(channel.numMessages);
+            channelStats["deliveries_per_second"] = perSecond(channel.numDeliveries);
+            channelsObject[channel.name] = channelStats;
+        }
+
+        channel.numMessages = 0;
+        channel.numDeliveries = 0;
+    }
+
+    QJsonObject fanOutObject;
+    auto fanOutStats = _fanOut.getStats();
+    fanOutObject["threads"] = _fanOut.numThreads();
+    fanOutObject["channels"] = (int)_channels.size();
+    fanOutObject["unsubscribed_messages_per_second"] = perSecond(_numUnsubscribedMessages);
+    fanOutObject["sent"] = (double)fanOutStats.numSent;
+    fanOutObject["delayed"] = (double)fanOutStats.numDelayed;
+    fanOutObject["dropped"] = (double)fanOutStats.numDropped;
+    fanOutObject["queued"] = (double)fanOutStats.numQueued;
+    _numUnsubscribedMessages = 0;
+
+    pruneEmptyChannels();
+
+    statsObject["channels"] = channelsObject;
+    statsObject["fan_out"] = fanOutObject;
 
     // add stats for each listerner
     DependencyManager::get<NodeList>()->eachNode([&](const SharedNodePointer& node) {
@@ -85,7 +159,66 @@ void MessagesMixer::sendStatsPacket() {
 }
 
 void MessagesMixer::run() {
+    // the fan out runs with its defaults until the domain-server settings are in
+    DomainHandler& domainHandler = DependencyManager::get<NodeList>()->getDomainHandler();
+    connect(&domainHandler, &DomainHandler::settingsReceived, this, &MessagesMixer::domainSettingsRequestComplete);
+
     ThreadedAssignment::commonInit(MESSAGES_MIXER_LOGGING_NAME, NodeType::MessagesMixer);
     auto nodeList = DependencyManager::get<NodeList>();
     nodeList->addSetOfNodeTypesToNodeInterestSet({ NodeType::Agent, NodeType::EntityScriptServer });
 }
+
+void MessagesMixer::domainSettingsRequestComplete() {
+    parseDomainServerSettings(DependencyManager::get<NodeList>()->getDomainHandler().getSettingsObject());
+}
+
+void MessagesMixer::parseDomainServerSettings(const QJsonObject& domainSettings) {
+    const QString MESSAGES_MIXER_SETTINGS_KEY = "messages_mixer";
+    QJsonObject messagesMixerGroupObject = domainSettings[MESSAGES_MIXER_SETTINGS_KEY].toObject();
+
+    const QString AUTO_THREADS = "auto_threads";
+    bool autoThreads = messagesMixerGroupObject[AUTO_THREADS].toBool(true);
+    if (!autoThreads) {
+        bool ok;
+        const QString NUM_THREADS = "num_threads";
+        int numThreads = messagesMixerGroupObject[NUM_THREADS].toString().toInt(&ok);
+        if (!ok) {
+            qWarning() << "Messages mixer: Error reading thread count. Using 1 thread.";
+            numThreads = 1;
+        }
+        _fanOut.setNumThreads(numThreads);
+    }
+    qDebug() << "Messages mixer will use" << _fanOut.numThreads() << "threads to send messages.";
+
+    MessagesFanOut::Settings settings;
+
+    const QString MAX_MESSAGES_PER_SECOND = "max_messages_per_second";
+    const float DEFAULT_MAX_MESSAGES_PER_SECOND = 0.0f; // domain owners opt in to limiting
+    settings.maxMessagesPerSecond = std::max(0.0f, (float)messagesMixerGroupObject[MAX_MESSAGES_PER_SECOND]
+        .toDouble(DEFAULT_MAX_MESSAGES_PER_SECOND));
+
+    const QString MAX_BURST = "max_burst";
+    const int DEFAULT_MAX_BURST = 100;
+    settings.maxBurst = std::max(1, messagesMixerGroupObject[MAX_BURST].toInt(DEFAULT_MAX_BURST));
+
+    const QString MAX_QUEUED_MESSAGES = "max_queued_messages";
+    const int DEFAULT_MAX_QUEUED_MESSAGES = 0;
+    settings.maxQueuedMessages = std::max(0, messagesMixerGroupObject[MAX_QUEUED_MESSAGES]
+        .toInt(DEFAULT_MAX_QUEUED_MESSAGES));
+
+    const QString DROP_POLICY = "drop_policy";
+    const QString DROP_NEWEST = "newest";
+    settings.dropPolicy = messagesMixerGroupObject[DROP_POLICY].toString() == DROP_NEWEST ?
+        MessagesFanOut::DropPolicy::DropNewest : MessagesFanOut::DropPolicy::DropOldest;
+
+    if (settings.maxMessagesPerSecond > 0.0f) {
+        qDebug() << "Messages mixer will send at most" << settings.maxMessagesPerSecond << "messages per second"
+            << "to each subscriber, in bursts of" << settings.maxBurst << "and with up to" << settings.maxQueuedMessages
+            << "held back before the" << (settings.dropPolicy == MessagesFanOut::DropPolicy::DropNewest ? "newest" : "oldest")
+            << "are dropped.";
+    } else {
+        qDebug() << "Messages mixer will not limit the rate of messages sent to each subscriber.";
+    }
+
+    _fanOut.setSettings(settings);
+}
@@ -15,6 +15,11 @@
 #ifndef hifi_MessagesMixer_h
 #define hifi_MessagesMixer_h
 
+#include <vector>
+
+#include <QtCore/QJsonObject>
+
+#include <MessagesFanOut.h>
 #include <ThreadedAssignment.h>
 
 /// Handles assignments of type MessagesMixer - distribution of avatar data to various clients
@@ -32,9 +37,33 @@ private slots:
     void handleMessages(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
     void handleMessagesSubscribe(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
     void handleMessagesUnsubscribe(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
+    void domainSettingsRequestComplete();
 
 private:
-    QHash<QString,QSet<QUuid>> _channelSubscribers;
+    using ChannelID = quint32;
+
+    struct Channel {
+        QString name;
+        std::vector<SharedNodePointer> subscribers;
+
+        // since the last stats packet
+        quint64 numMessages { 0 };
+        quint64 numDeliveries { 0 };
+    };
+
+    void parseDomainServerSettings(const QJsonObject& domainSettings);
+
+    // drops the channels nobody is subscribed to any more, once their stats have been sent
+    void pruneEmptyChannels();
+
+    // channel names are interned when they are first subscribed to, and keep their ID until nobody is subscribed
+    QHash<QString, ChannelID> _channelIDs;
+    std::vector<Channel> _channels;
+
+    MessagesFanOut _fanOut;
+
+    quint64 _numUnsubscribedMessages { 0 }; // since the last stats packet
+    quint64 _lastStatsTime { 0 };
 };
 
 #endif // hifi_MessagesMixer_h
@@ -0,0 +1,147 @@
+//
+//  OctreeEditDecoderPool.cpp
+//  assignment-client/src/octree
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeEditDecoderPool.h"
+
+#include <algorithm>
+
+#include <QtCore/QDebug>
+
+OctreeEditDecoderPool::OctreeEditDecoderPool(int numThreads) {
+    setNumThreads(numThreads);
+}
+
+OctreeEditDecoderPool::~OctreeEditDecoderPool() {
+    stopWorkers();
+}
+
+void OctreeEditDecoderPool::setNumThreads(int numThreads) {
+    // clamp to allowed size
+    {
+        int maxThreads = QThread::idealThreadCount();
+        if (maxThreads == -1) {
+            // idealThreadCount returns -1 if cores cannot be detected
+            static const int MAX_THREADS_IF_UNKNOWN = 4;
+            maxThreads = MAX_THREADS_IF_UNKNOWN;
+        }
+
+        int clampedThreads = std::min(std::max(1, numThreads), maxThreads);
+        if (clampedThreads != numThreads) {
+            qWarning("%s: clamped to %d (was %d)", __FUNCTION__, clampedThreads, numThreads);
+            numThreads = clampedThreads;
+        }
+    }
+
+    if (numThreads == this->numThreads()) {
+        return;
+    }
+
+    qDebug("%s: set %d threads (was %d)", __FUNCTION__, numThreads, this->numThreads());
+
+    stopWorkers();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = false;
+    }
+
+    // the thread running a batch is one of the decoders
+    for (int i = 1; i < numThreads; ++i) {
+        auto worker = new Worker(*this);
+        worker->start();
+        _workers.emplace_back(worker);
+    }
+}
+
+void OctreeEditDecoderPool::run(size_t count, const Job& job) {
+    if (count == 0) {
+        return;
+    }
+
+    if (_workers.empty() || count == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &job;
+        _count = count;
+        _nextIndex = 0;
+        ++_generation;
+    }
+    _hasJob.notify_all();
+
+    work(job, count);
+
+    // the job goes out of scope with the batch, a worker that wakes up late finds none
+    std::unique_lock<std::mutex> lock(_mutex);
+    _jobDone.wait(lock, [&] { return _numWorking == 0; });
+    _job = nullptr;
+}
+
+void OctreeEditDecoderPool::work(const Job& job, size_t count) {
+    size_t index;
+    while ((index = _nextIndex++) < count) {
+        job(index);
+    }
+}
+
+void OctreeEditDecoderPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _hasJob.notify_all();
+
+    for (auto& worker : _workers) {
+        worker->wait();
+    }
+    _workers.clear();
+}
+
+void OctreeEditDecoderPool::Worker::run() {
+    uint64_t generation = 0;
+
+    while (true) {
+        const Job* job;
+        size_t count;
+
+        {
+            std::unique_lock<std::mutex> lock(_pool._mutex);
+            _pool._hasJob.wait(lock, [&] {
+                return _pool._isStopping || _pool._generation != generation;
+            });
+
+            if (_pool._isStopping) {
+                break;
+            }
+
+            generation = _pool._generation;
+            job = _pool._job;
+            count = _pool._count;
+
+            if (!job) {
+                continue;
+            }
+            ++_pool._numWorking;
+        }
+
+        _pool.work(*job, count);
+
+        {
+            std::lock_guard<std::mutex> lock(_pool._mutex);
+            --_pool._numWorking;
+        }
+        _pool._jobDone.notify_one();
+    }
+}
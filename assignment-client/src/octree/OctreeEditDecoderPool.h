@@ -0,0 +1,68 @@
+//
+//  OctreeEditDecoderPool.h
+//  assignment-client/src/octree
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeEditDecoderPool_h
+#define hifi_OctreeEditDecoderPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QThread>
+
+// Decodes the edit messages of a batch on a pool of worker threads, ahead of them being applied to the tree.
+//
+// The thread that runs a batch decodes along with the workers, and returns once every message of the batch is decoded.
+class OctreeEditDecoderPool {
+public:
+    using Job = std::function<void(size_t index)>;
+
+    OctreeEditDecoderPool(int numThreads = QThread::idealThreadCount());
+    ~OctreeEditDecoderPool();
+
+    void setNumThreads(int numThreads);
+    int numThreads() const { return (int)_workers.size() + 1; }
+
+    // Calls the job once for each index from 0 to count - 1, on whichever thread is free. Must be called from a single
+    // thread.
+    void run(size_t count, const Job& job);
+
+private:
+    class Worker : public QThread {
+    public:
+        Worker(OctreeEditDecoderPool& pool) : _pool(pool) {}
+
+        void run() override;
+
+    private:
+        OctreeEditDecoderPool& _pool;
+    };
+
+    void work(const Job& job, size_t count);
+    void stopWorkers();
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _hasJob;
+    std::condition_variable _jobDone;
+    const Job* _job { nullptr }; // guarded by _mutex
+    size_t _count { 0 }; // guarded by _mutex
+    uint64_t _generation { 0 }; // guarded by _mutex, bumped for every batch
+    int _numWorking { 0 }; // guarded by _mutex
+    bool _isStopping { false }; // guarded by _mutex
+
+    std::atomic<size_t> _nextIndex { 0 };
+};
+
+#endif // hifi_OctreeEditDecoderPool_h
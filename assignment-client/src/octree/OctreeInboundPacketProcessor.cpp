@@ -11,9 +11,11 @@
 
 #include "OctreeInboundPacketProcessor.h"
 
+#include <chrono>
 #include <limits>
 
 #include <NumericalConstants.h>
+#include <PortableHighResolutionClock.h>
 #include <udt/PacketHeaders.h>
 #include <PerfStat.h>
 
@@ -31,6 +33,7 @@ OctreeInboundPacketProcessor::OctreeInboundPacketProcessor(OctreeServer* myServe
     _totalLockWaitTime(0),
     _totalElementsInPacket(0),
     _totalPackets(0),
+    _lastEditsWindowAt(usecTimestampNow()),
     _lastNackTime(usecTimestampNow()),
     _shuttingDown(false)
 {
@@ -44,6 +47,11 @@ void OctreeInboundPacketProcessor::resetStats() {
     _totalPackets = 0;
     _lastNackTime = usecTimestampNow();
 
+    {
+        std::lock_guard<std::mutex> lock(_applyLatencyMutex);
+        _applyLatency.reset();
+    }
+
     QWriteLocker locker(&_senderStatsLock);
     _singleSenderStats.clear();
 }
@@ -59,6 +67,8 @@ uint32_t OctreeInboundPacketProcessor::getMaxWait() const {
 }
 
 void OctreeInboundPacketProcessor::preProcess() {
+    updateAppliedEditsPerSecond();
+
     // check if it's time to send a nack. If yes, do so
     quint64 now = usecTimestampNow();
     if (now - _lastNackTime >= TOO_LONG_SINCE_LAST_NACK) {
@@ -171,12 +181,30 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
             }
 
             quint64 startProcess, startLock = usecTimestampNow();
-            int editDataBytesRead;
-            _myServer->getOctree()->withWriteLock([&] {
-                startProcess = usecTimestampNow();
-                editDataBytesRead =
-                    _myServer->getOctree()->processEditPacketData(*message, editData, maxSize, sendingNode);
-            });
+            int editDataBytesRead = 0;
+            auto octree = _myServer->getOctree();
+
+            // most edits leave the structure of the tree alone, don't hold the send threads' traversals up for those
+            auto edit = octree->decodeEditPacketData(*message, editData, maxSize, sendingNode);
+            bool processedInPlace = false;
+            if (edit) {
+                editDataBytesRead = edit->processedBytes;
+                octree->withReadLock([&] {
+                    startProcess = usecTimestampNow();
+                    processedInPlace = octree->processDecodedEditInPlace(*edit, sendingNode);
+                });
+            }
+
+            if (!processedInPlace) {
+                octree->withWriteLock([&] {
+                    startProcess = usecTimestampNow();
+                    if (edit) {
+                        octree->processDecodedEdit(*edit, sendingNode);
+                    } else {
+                        editDataBytesRead = octree->processEditPacketData(*message, editData, maxSize, sendingNode);
+                    }
+                });
+            }
             quint64 endProcess = usecTimestampNow();
 
             if (debugProcessPacket) {
@@ -225,6 +253,169 @@ void OctreeInboundPacketProcessor::processPacket(QSharedPointer<ReceivedMessage>
     }
 }
 
+void OctreeInboundPacketProcessor::updateAppliedEditsPerSecond() {
+    quint64 now = usecTimestampNow();
+    quint64 sinceLastWindow = now - _lastEditsWindowAt;
+
+    if (sinceLastWindow > USECS_PER_SECOND) {
+        float secondsSinceLastWindow = (float)sinceLastWindow / USECS_PER_SECOND;
+        _appliedEditsPerSecond.updateAverage((float)_lastWindowAppliedEdits / secondsSinceLastWindow);
+
+        _lastEditsWindowAt = now;
+        _lastWindowAppliedEdits = 0;
+    }
+}
+
+static quint64 receiveClockNow() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(p_high_resolution_clock::now().time_since_epoch()).count();
+}
+
+void OctreeInboundPacketProcessor::processPackets(std::list<NodeSharedReceivedMessagePair>& packets) {
+    // the debugging output is that of the messages processed one by one
+    if (_shuttingDown || _myServer->wantsVerboseDebug() || _myServer->wantsDebugReceiving()) {
+        ReceivedPacketProcessor::processPackets(packets);
+        return;
+    }
+
+    auto octree = _myServer->getOctree();
+
+    std::vector<DecodedEditMessage> messages(packets.size());
+    auto packetIt = packets.begin();
+    for (auto& decodedMessage : messages) {
+        decodedMessage.message = packetIt->second;
+        decodedMessage.sendingNode = packetIt->first;
+        ++packetIt;
+    }
+
+    // decoding leaves the tree alone, the messages of the batch are decoded all at once
+    _decoderPool.run(messages.size(), [&](size_t index) {
+        decodeEditMessage(messages[index]);
+    });
+
+    // the edits are then applied in the order they came in: with only the read lock for as long as they leave the
+    // structure of the tree alone...
+    auto it = messages.begin();
+    if (it != messages.end() && it->isDecoded) {
+        quint64 startLock = usecTimestampNow();
+        octree->withReadLock([&] {
+            it->lockWaitTime += usecTimestampNow() - startLock;
+
+            for (; it != messages.end() && it->isDecoded; ++it) {
+                while (it->numApplied < it->edits.size()) {
+                    quint64 startProcess = usecTimestampNow();
+                    if (!octree->processDecodedEditInPlace(*it->edits[it->numApplied], it->sendingNode)) {
+                        break;
+                    }
+                    it->processTime += usecTimestampNow() - startProcess;
+                    ++it->numApplied;
+                }
+
+                if (it->numApplied < it->edits.size()) {
+                    break;
+                }
+                it->appliedAt = receiveClockNow();
+            }
+        });
+    }
+
+    // ...and the rest of them with the write lock, in batches that restructure the tree once for all their edits
+    while (it != messages.end()) {
+        if (!it->isDecoded) {
+            // erases and the challenges of ownership take the locks they need, which they can't with the write lock
+            // already held, so they go between two batches, once the moves of the batch before them are done
+            processPacket(it->message, it->sendingNode);
+            ++it;
+            continue;
+        }
+
+        auto firstBatched = it;
+
+        quint64 startLock = usecTimestampNow();
+        octree->withWriteLock([&] {
+            it->lockWaitTime += usecTimestampNow() - startLock;
+
+            octree->beginEditBatch();
+            for (; it != messages.end() && it->isDecoded; ++it) {
+                for (; it->numApplied < it->edits.size(); ++it->numApplied) {
+                    quint64 startProcess = usecTimestampNow();
+                    octree->processDecodedEdit(*it->edits[it->numApplied], it->sendingNode);
+                    it->processTime += usecTimestampNow() - startProcess;
+                }
+            }
+            octree->endEditBatch();
+        });
+
+        quint64 appliedAt = receiveClockNow();
+        for (auto batched = firstBatched; batched != it; ++batched) {
+            batched->appliedAt = appliedAt;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_applyLatencyMutex);
+        for (auto& decodedMessage : messages) {
+            if (decodedMessage.isDecoded && !decodedMessage.edits.empty()) {
+                quint64 receivedAt = decodedMessage.message->getFirstPacketReceiveTime();
+                quint64 latency = decodedMessage.appliedAt > receivedAt ? decodedMessage.appliedAt - receivedAt : 0;
+                _applyLatency.record(latency, decodedMessage.edits.size());
+            }
+        }
+    }
+
+    for (auto& decodedMessage : messages) {
+        if (decodedMessage.isDecoded) {
+            QUuid nodeUUID = decodedMessage.sendingNode ? decodedMessage.sendingNode->getUUID() : DEFAULT_NODE_ID_REF;
+            trackInboundPacket(nodeUUID, decodedMessage.sequence, decodedMessage.transitTime,
+                               (int)decodedMessage.edits.size(), decodedMessage.processTime, decodedMessage.lockWaitTime);
+        }
+    }
+
+    midProcess();
+}
+
+void OctreeInboundPacketProcessor::decodeEditMessage(DecodedEditMessage& decodedMessage) {
+    auto octree = _myServer->getOctree();
+    ReceivedMessage& message = *decodedMessage.message;
+
+    // the challenges of ownership are processed as they come
+    if (!octree->handlesEditPacketType(message.getType())) {
+        return;
+    }
+
+    message.readPrimitive(&decodedMessage.sequence);
+
+    quint64 sentAt;
+    message.readPrimitive(&sentAt);
+
+    quint64 arrivedAt = usecTimestampNow();
+    decodedMessage.transitTime = sentAt > arrivedAt ? 0 : arrivedAt - sentAt;
+
+    while (message.getBytesLeftToRead() > 0) {
+        auto editData = reinterpret_cast<const unsigned char*>(message.getRawMessage() + message.getPosition());
+        int maxSize = message.getBytesLeftToRead();
+
+        auto edit = octree->decodeEditPacketData(message, editData, maxSize, decodedMessage.sendingNode);
+        if (!edit) {
+            // the tree doesn't decode those ahead, the whole message is processed when its turn comes
+            decodedMessage.edits.clear();
+            message.seek(0);
+            return;
+        }
+
+        int editDataBytesRead = edit->processedBytes;
+        decodedMessage.edits.push_back(std::move(edit));
+        if (editDataBytesRead <= 0) {
+            break;
+        }
+
+        // skip to next edit record in the packet
+        message.seek(message.getPosition() + editDataBytesRead);
+    }
+
+    decodedMessage.isDecoded = true;
+}
+
 void OctreeInboundPacketProcessor::trackInboundPacket(const QUuid& nodeUUID, unsigned short int sequence, quint64 transitTime,
             int editsInPacket, quint64 processTime, quint64 lockWaitTime) {
 
@@ -233,6 +424,7 @@ void OctreeInboundPacketProcessor::trackInboundPacket(const QUuid& nodeUUID, uns
     _totalLockWaitTime += lockWaitTime;
     _totalElementsInPacket += editsInPacket;
     _totalPackets++;
+    _lastWindowAppliedEdits += editsInPacket;
 
     QWriteLocker locker(&_senderStatsLock);
 
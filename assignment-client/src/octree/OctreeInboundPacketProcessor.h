@@ -14,8 +14,14 @@
 #ifndef hifi_OctreeInboundPacketProcessor_h
 #define hifi_OctreeInboundPacketProcessor_h
 
+#include <mutex>
+#include <vector>
+
+#include <Octree.h>
 #include <ReceivedPacketProcessor.h>
+#include <shared/HdrHistogram.h>
 
+#include "OctreeEditDecoderPool.h"
 #include "SequenceNumberStats.h"
 
 class OctreeServer;
@@ -70,6 +76,10 @@ public:
     quint64 getAverageLockWaitTimePerElement() const
                 { return _totalElementsInPacket == 0 ? 0 : _totalLockWaitTime / _totalElementsInPacket; }
 
+    float getAppliedEditsPerSecond() const { return _appliedEditsPerSecond.getAverage(); }
+    // from an edit message being received to its edits being applied to the tree, in usecs
+    HdrHistogram getApplyLatency() const { std::lock_guard<std::mutex> lock(_applyLatencyMutex); return _applyLatency; }
+
     void resetStats();
 
     NodeToSenderStatsMap getSingleSenderStats() { QReadLocker locker(&_senderStatsLock); return _singleSenderStats; }
@@ -79,6 +89,7 @@ public:
 protected:
 
     virtual void processPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) override;
+    virtual void processPackets(std::list<NodeSharedReceivedMessagePair>& packets) override;
 
     virtual uint32_t getMaxWait() const override;
     virtual void preProcess() override;
@@ -88,6 +99,23 @@ private:
     int sendNackPackets();
 
 private:
+    // an edit message of a batch, with its edits decoded ahead of being applied
+    struct DecodedEditMessage {
+        QSharedPointer<ReceivedMessage> message;
+        SharedNodePointer sendingNode;
+        bool isDecoded { false }; // otherwise the message is processed by processPacket()
+        unsigned short int sequence { 0 };
+        quint64 transitTime { 0 };
+        std::vector<OctreeDecodedEditPointer> edits;
+        size_t numApplied { 0 };
+        quint64 processTime { 0 };
+        quint64 lockWaitTime { 0 };
+        quint64 appliedAt { 0 }; // on the clock of the receive time of the message
+    };
+
+    void decodeEditMessage(DecodedEditMessage& decodedMessage);
+    void updateAppliedEditsPerSecond();
+
     void trackInboundPacket(const QUuid& nodeUUID, unsigned short int sequence, quint64 transitTime,
             int elementsInPacket, quint64 processTime, quint64 lockWaitTime);
 
@@ -103,6 +131,15 @@ private:
     NodeToSenderStatsMap _singleSenderStats;
     QReadWriteLock _senderStatsLock;
 
+    OctreeEditDecoderPool _decoderPool;
+
+    quint64 _lastEditsWindowAt;
+    int _lastWindowAppliedEdits { 0 };
+    SimpleMovingAverage _appliedEditsPerSecond;
+
+    mutable std::mutex _applyLatencyMutex;
+    HdrHistogram _applyLatency; // guarded by _applyLatencyMutex
+
     std::atomic<uint64_t> _lastNackTime;
     bool _shuttingDown;
 };
@@ -0,0 +1,262 @@
+//
+//  OctreeSendScheduler.cpp
+//  assignment-client/src/octree
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "OctreeSendScheduler.h"
+
+#include <algorithm>
+
+#include <glm/glm.hpp>
+
+#include <QtCore/QDebug>
+
+#include "OctreeSendThread.h"
+#include "OctreeServerConsts.h"
+
+OctreeSendScheduler::OctreeSendScheduler(int numThreads) {
+    if (numThreads == -1) {
+        // idealThreadCount returns -1 if cores cannot be detected
+        static const int MAX_THREADS_IF_UNKNOWN = 4;
+        numThreads = MAX_THREADS_IF_UNKNOWN;
+    }
+    numThreads = std::max(1, numThreads);
+
+    qDebug("%s: set %d threads", __FUNCTION__, numThreads);
+
+    // start with an empty frame, the last worker to get through it waits for clients to start the next
+    _frame = 1;
+    _numBusyWorkers = numThreads;
+    _frameStart = Clock::now();
+
+    for (int i = 0; i < numThreads; ++i) {
+        auto worker = new Worker(*this, i);
+        worker->setObjectName(QString("Octree Send Worker %1").arg(i));
+        _workers.emplace_back(worker);
+    }
+    for (auto& worker : _workers) {
+        worker->start();
+    }
+}
+
+OctreeSendScheduler::~OctreeSendScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _frameStarted.notify_all();
+
+    for (auto& worker : _workers) {
+        worker->wait();
+    }
+    _workers.clear();
+}
+
+void OctreeSendScheduler::add(OctreeSendThread* sendThread) {
+    auto job = std::make_shared<Job>();
+    job->sendThread = sendThread;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(job);
+    }
+
+    // wakes up the last worker of the previous frame, in case it is waiting for a client
+    _frameStarted.notify_all();
+}
+
+void OctreeSendScheduler::remove(OctreeSendThread* sendThread) {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    auto it = std::find_if(_jobs.begin(), _jobs.end(), [&](const JobPointer& job) {
+        return job->sendThread == sendThread;
+    });
+    if (it == _jobs.end()) {
+        return;
+    }
+
+    // the job may still be queued for the current frame, it is skipped from now on
+    auto job = *it;
+    _jobs.erase(it);
+    job->isDone = true;
+
+    _jobStopped.wait(lock, [&] { return !job->isRunning; });
+}
+
+OctreeSendScheduler::Stats OctreeSendScheduler::getStats() const {
+    Stats stats;
+    stats.numFrames = _numFrames;
+    stats.numLateFrames = _numLateFrames;
+    stats.numPasses = _numPasses;
+    stats.numStolenPasses = _numStolenPasses;
+    return stats;
+}
+
+uint64_t OctreeSendScheduler::viewLocalityKey(const ConicalViewFrustums& views) {
+    if (views.empty()) {
+        return 0;
+    }
+
+    // the cells are as large as the distance views can be apart and still be very similar
+    const float CELL_SIZE = 5.0f; // meters
+    const int CELL_OFFSET = 1 << 15;
+    const int MAX_CELL = (1 << 16) - 1;
+
+    const auto& view = views.front();
+    auto cell = [&](float coordinate) {
+        int index = (int)glm::floor(coordinate / CELL_SIZE) + CELL_OFFSET;
+        return (uint64_t)glm::clamp(index, 0, MAX_CELL);
+    };
+
+    // the face of the cube around the view it looks through
+    const glm::vec3& direction = view.getDirection();
+    glm::vec3 magnitude = glm::abs(direction);
+    int axis = (magnitude.x >= magnitude.y && magnitude.x >= magnitude.z) ? 0 : (magnitude.y >= magnitude.z ? 1 : 2);
+    uint64_t face = 2 * axis + (direction[axis] < 0.0f ? 1 : 0);
+
+    const glm::vec3& position = view.getPosition();
+    return (cell(position.x) << 48) | (cell(position.y) << 32) | (cell(position.z) << 16) | face;
+}
+
+void OctreeSendScheduler::startFrame() {
+    _frameStart = Clock::now();
+
+    std::vector<std::pair<uint64_t, JobPointer>> jobs;
+    jobs.reserve(_jobs.size());
+    for (auto& job : _jobs) {
+        if (!job->isDone) {
+            jobs.emplace_back(job->sendThread->getViewLocalityKey(), job);
+        }
+    }
+    std::stable_sort(jobs.begin(), jobs.end(), [](const std::pair<uint64_t, JobPointer>& a,
+                                                  const std::pair<uint64_t, JobPointer>& b) {
+        return a.first < b.first;
+    });
+
+    // every worker gets a run of clients looking from the same place
+    size_t numWorkers = _workers.size();
+    size_t runSize = (jobs.size() + numWorkers - 1) / numWorkers;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        auto& worker = *_workers[i];
+        size_t begin = std::min(i * runSize, jobs.size());
+        size_t end = std::min(begin + runSize, jobs.size());
+
+        std::lock_guard<std::mutex> queueLock(worker.queueMutex);
+        worker.queue.clear();
+        for (size_t j = begin; j < end; ++j) {
+            worker.queue.push_back(jobs[j].second);
+        }
+    }
+
+    _numBusyWorkers = (int)numWorkers;
+    ++_frame;
+    ++_numFrames;
+
+    _frameStarted.notify_all();
+}
+
+void OctreeSendScheduler::finishFrame() {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (--_numBusyWorkers > 0) {
+        return;
+    }
+
+    // the last worker done starts the next frame, on time if the passes of this one allow
+    auto nextFrameStart = _frameStart + std::chrono::microseconds(OCTREE_SEND_INTERVAL_USECS);
+    if (Clock::now() > nextFrameStart) {
+        ++_numLateFrames;
+    } else {
+        _frameStarted.wait_until(lock, nextFrameStart, [&] { return _isStopping; });
+    }
+
+    _frameStarted.wait(lock, [&] { return _isStopping || !_jobs.empty(); });
+
+    if (!_isStopping) {
+        startFrame();
+    }
+}
+
+OctreeSendScheduler::JobPointer OctreeSendScheduler::takeJob(int workerIndex) {
+    {
+        auto& worker = *_workers[workerIndex];
+        std::lock_guard<std::mutex> queueLock(worker.queueMutex);
+        if (!worker.queue.empty()) {
+            auto job = worker.queue.front();
+            worker.queue.pop_front();
+            return job;
+        }
+    }
+
+    // steal from the end of the runs of the others, away from the clients they are sending to next
+    int numWorkers = (int)_workers.size();
+    for (int i = 1; i < numWorkers; ++i) {
+        auto& worker = *_workers[(workerIndex + i) % numWorkers];
+        std::lock_guard<std::mutex> queueLock(worker.queueMutex);
+        if (!worker.queue.empty()) {
+            auto job = worker.queue.back();
+            worker.queue.pop_back();
+            ++_numStolenPasses;
+            return job;
+        }
+    }
+
+    return JobPointer();
+}
+
+void OctreeSendScheduler::runJob(const JobPointer& job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (job->isDone) {
+            return;
+        }
+        job->isRunning = true;
+    }
+
+    bool keepSending = job->sendThread->sendPass();
+    ++_numPasses;
+
+    if (!keepSending) {
+        // the sender can't be destroyed before the job stops running, which is why this happens before that
+        emit job->sendThread->finished();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        job->isRunning = false;
+        if (!keepSending) {
+            job->isDone = true;
+        }
+    }
+    _jobStopped.notify_all();
+}
+
+void OctreeSendScheduler::Worker::run() {
+    uint64_t frame = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_scheduler._mutex);
+            _scheduler._frameStarted.wait(lock, [&] {
+                return _scheduler._isStopping || _scheduler._frame != frame;
+            });
+
+            if (_scheduler._isStopping) {
+                break;
+            }
+
+            frame = _scheduler._frame;
+        }
+
+        while (auto job = _scheduler.takeJob(_index)) {
+            _scheduler.runJob(job);
+        }
+
+        _scheduler.finishFrame();
+    }
+}
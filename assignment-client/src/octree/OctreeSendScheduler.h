@@ -0,0 +1,106 @@
+//
+//  OctreeSendScheduler.h
+//  assignment-client/src/octree
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeSendScheduler_h
+#define hifi_OctreeSendScheduler_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QThread>
+
+#include <shared/ConicalViewFrustum.h>
+
+class OctreeSendThread;
+
+// Runs the send passes of all the clients of an octree server on a fixed pool of worker threads, rather than on a
+// thread per client.
+//
+// The passes run in frames, one every OCTREE_SEND_INTERVAL_USECS. At the start of a frame the clients are sorted by
+// where they look from and split in runs between the workers, so that the clients with similar views are sent to one
+// after the other on the same core, and find the elements their traversals visit still in its cache. A worker done
+// with its own run steals passes from the back of the others'.
+class OctreeSendScheduler {
+public:
+    struct Stats {
+        quint64 numFrames { 0 };
+        quint64 numLateFrames { 0 }; // that started late because the passes of the previous one took too long
+        quint64 numPasses { 0 };
+        quint64 numStolenPasses { 0 };
+    };
+
+    OctreeSendScheduler(int numThreads = QThread::idealThreadCount());
+    ~OctreeSendScheduler();
+
+    int numThreads() const { return (int)_workers.size(); }
+
+    void add(OctreeSendThread* sendThread);
+
+    // Stops running the passes of the sender, and waits for the one in progress if there is one. The sender emits
+    // finished(), from a worker, once its client is gone: it has to be removed then.
+    void remove(OctreeSendThread* sendThread);
+
+    Stats getStats() const;
+
+    // Orders the views so that the ones close to each other, looking the same way, are next to each other.
+    static uint64_t viewLocalityKey(const ConicalViewFrustums& views);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        OctreeSendThread* sendThread { nullptr };
+        bool isRunning { false }; // guarded by _mutex
+        bool isDone { false }; // guarded by _mutex, once removed or once its client is gone
+    };
+    using JobPointer = std::shared_ptr<Job>;
+
+    class Worker : public QThread {
+    public:
+        Worker(OctreeSendScheduler& scheduler, int index) : _scheduler(scheduler), _index(index) {}
+
+        void run() override;
+
+        std::mutex queueMutex;
+        std::deque<JobPointer> queue; // the passes of the current frame, guarded by queueMutex
+
+    private:
+        OctreeSendScheduler& _scheduler;
+        int _index;
+    };
+
+    void startFrame(); // with _mutex held
+    void finishFrame();
+    JobPointer takeJob(int workerIndex);
+    void runJob(const JobPointer& job);
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _frameStarted;
+    std::condition_variable _jobStopped;
+    std::vector<JobPointer> _jobs; // guarded by _mutex
+    uint64_t _frame { 0 }; // guarded by _mutex
+    int _numBusyWorkers { 0 }; // guarded by _mutex
+    Clock::time_point _frameStart; // guarded by _mutex
+    bool _isStopping { false }; // guarded by _mutex
+
+    std::atomic<quint64> _numFrames { 0 };
+    std::atomic<quint64> _numLateFrames { 0 };
+    std::atomic<quint64> _numPasses { 0 };
+    std::atomic<quint64> _numStolenPasses { 0 };
+};
+
+#endif // hifi_OctreeSendScheduler_h
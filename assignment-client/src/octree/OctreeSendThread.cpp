@@ -19,6 +19,7 @@
 #include <udt/PacketHeaders.h>
 #include <PerfStat.h>
 
+#include "OctreeSendScheduler.h"
 #include "OctreeServer.h"
 #include "OctreeServerConsts.h"
 #include "OctreeLogging.h"
@@ -66,14 +67,14 @@ void OctreeSendThread::setIsShuttingDown() {
 }
 
 
-bool OctreeSendThread::process() {
+bool OctreeSendThread::sendPass() {
     if (_isShuttingDown) {
         return false; // exit early if we're shutting down
     }
 
     OctreeServer::didProcess(this);
 
-    quint64  start = usecTimestampNow();
+    processPendingChanges();
 
     // we'd better have a server at this point, or we're in trouble
     assert(_myServer);
@@ -91,14 +92,22 @@ bool OctreeSendThread::process() {
             if (nodeData && nodeData->hasReceivedFirstQuery() && node->getActiveSocket() && !nodeData->isShuttingDown()) {
                 bool viewFrustumChanged = nodeData->updateCurrentViewFrustum();
                 packetDistributor(node, nodeData, viewFrustumChanged);
+
+                _viewLocalityKey = OctreeSendScheduler::viewLocalityKey(nodeData->getCurrentViews());
             }
         } else {
             return false; // exit early if we're shutting down
         }
     }
 
-    if (_isShuttingDown) {
-        return false; // exit early if we're shutting down
+    return !_isShuttingDown;
+}
+
+bool OctreeSendThread::process() {
+    quint64  start = usecTimestampNow();
+
+    if (!sendPass()) {
+        return false;
     }
 
     // Only sleep if we're still running and we got the lock last time we tried, otherwise try to get the lock asap
@@ -367,6 +376,15 @@ int OctreeSendThread::packetDistributor(SharedNodePointer node, OctreeQueryNode*
         traverseTreeAndSendContents(node, nodeData, viewFrustumChanged, isFullScene);
     });
 
+    if (hasDeferredMessage() && !nodeData->isShuttingDown()) {
+        if (nodeData->isPacketWaiting()) {
+            // the packet being filled already has the sequence number the message is about to take
+            _packetsSentThisInterval += handlePacketSend(node, nodeData);
+        }
+        sendDeferredMessage(node, nodeData);
+        nodeData->resetOctreePacket();   // because nodeData's _sequenceNumber has changed
+    }
+
     // Here's where we can/should allow the server to send other data...
     // send the environment packet
     // TODO: should we turn this into a while loop to better handle sending multiple special packets
@@ -38,6 +38,13 @@ public:
 
     QUuid getNodeUuid() const { return _nodeUuid; }
 
+    /// Sends the client what it should get next, without waiting for the next send interval. Returns false once the
+    /// client is gone, or once shutting down.
+    bool sendPass();
+
+    /// Where the client looks from as of its last pass, see OctreeSendScheduler::viewLocalityKey().
+    uint64_t getViewLocalityKey() const { return _viewLocalityKey; }
+
     static AtomicUIntStat _totalBytes;
     static AtomicUIntStat _totalWastedBytes;
     static AtomicUIntStat _totalPackets;
@@ -52,6 +59,9 @@ protected:
     /// Implements generic processing behavior for this thread.
     virtual bool process() override;
 
+    /// Called at the start of every pass, on the thread running it, to catch up with the changes to the tree
+    virtual void processPendingChanges() {}
+
     virtual bool traverseTreeAndSendContents(SharedNodePointer node, OctreeQueryNode* nodeData,
             bool viewFrustumChanged, bool isFullScene);
     virtual bool traverseTreeAndBuildNextPacketPayload(EncodeBitstreamParams& params, const QJsonObject& jsonFilters) = 0;
@@ -68,12 +78,17 @@ private:
     int packetDistributor(SharedNodePointer node, OctreeQueryNode* nodeData, bool viewFrustumChanged);
 
     virtual bool hasSomethingToSend(OctreeQueryNode* nodeData) = 0;
+    /// A message put together with the tree lock held by traverseTreeAndSendContents, but only finished and sent once it
+    /// is released. It is sent reliably, with a sequence number of its own.
+    virtual bool hasDeferredMessage() const { return false; }
+    virtual void sendDeferredMessage(const SharedNodePointer& node, OctreeQueryNode* nodeData) {}
     virtual bool shouldStartNewTraversal(OctreeQueryNode* nodeData, bool viewFrustumChanged) = 0;
 
     int _truePacketsSent { 0 }; // available for debug stats
     int _trueBytesSent { 0 }; // available for debug stats
     int _packetsSentThisInterval { 0 }; // used for bandwidth throttle condition
     bool _isShuttingDown { false };
+    std::atomic<uint64_t> _viewLocalityKey { 0 };
 };
 
 #endif // hifi_OctreeSendThread_h
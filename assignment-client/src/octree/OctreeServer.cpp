@@ -428,6 +428,16 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += QString("          Total Clients Connected: %1 clients\r\n")
             .arg(locale.toString((uint)getCurrentClientCount()).rightJustified(COLUMN_WIDTH, ' '));
 
+        auto schedulerStats = _sendScheduler.getStats();
+        statsString += QString("                     Send Workers: %1 threads\r\n")
+            .arg(locale.toString(_sendScheduler.numThreads()).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("                      Send Frames: %1 frames (%2 late)\r\n")
+            .arg(locale.toString(schedulerStats.numFrames).rightJustified(COLUMN_WIDTH, ' '))
+            .arg(locale.toString(schedulerStats.numLateFrames));
+        statsString += QString("                      Send Passes: %1 passes (%2 stolen)\r\n")
+            .arg(locale.toString(schedulerStats.numPasses).rightJustified(COLUMN_WIDTH, ' '))
+            .arg(locale.toString(schedulerStats.numStolenPasses));
+
         quint64 oneSecondAgo = usecTimestampNow() - USECS_PER_SECOND;
 
         statsString += QString("            process() last second: %1 clients\r\n")
@@ -655,6 +665,8 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         quint64 averageLockWaitTimePerElement = _octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
         quint64 totalElementsProcessed = _octreeInboundPacketProcessor->getTotalElementsProcessed();
         quint64 totalPacketsProcessed = _octreeInboundPacketProcessor->getTotalPacketsProcessed();
+        float appliedEditsPerSecond = _octreeInboundPacketProcessor->getAppliedEditsPerSecond();
+        HdrHistogram applyLatency = _octreeInboundPacketProcessor->getApplyLatency();
 
         quint64 averageDecodeTime = _tree->getAverageDecodeTime();
         quint64 averageLookupTime = _tree->getAverageLookupTime();
@@ -674,6 +686,15 @@ bool OctreeServer::handleHTTPRequest(HTTPConnection* connection, const QUrl& url
         statsString += QString("    Packets Queue Processing OUT: %1 PPS \r\n")
             .arg(locale.toString(processedPPS, 'f', FLOAT_PRECISION).rightJustified(COLUMN_WIDTH, ' '));
 
+        statsString += QString("                   Edits Applied: %1 edits/s\r\n")
+            .arg(locale.toString(appliedEditsPerSecond, 'f', FLOAT_PRECISION).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("          Edit Apply Latency p50: %1 usecs\r\n")
+            .arg(locale.toString((uint)applyLatency.getValueAtPercentile(50.0)).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("          Edit Apply Latency p95: %1 usecs\r\n")
+            .arg(locale.toString((uint)applyLatency.getValueAtPercentile(95.0)).rightJustified(COLUMN_WIDTH, ' '));
+        statsString += QString("          Edit Apply Latency p99: %1 usecs\r\n")
+            .arg(locale.toString((uint)applyLatency.getValueAtPercentile(99.0)).rightJustified(COLUMN_WIDTH, ' '));
+
         statsString += QString("           Total Inbound Packets: %1 packets\r\n")
             .arg(locale.toString((uint)totalPacketsProcessed).rightJustified(COLUMN_WIDTH, ' '));
         statsString += QString("          Total Inbound Elements: %1 elements\r\n")
@@ -876,9 +897,10 @@ void OctreeServer::parsePayload() {
 OctreeServer::UniqueSendThread OctreeServer::createSendThread(const SharedNodePointer& node) {
     auto sendThread = newSendThread(node);
 
-    // we want to be notified when the thread finishes
-    connect(sendThread.get(), &GenericThread::finished, this, &OctreeServer::removeSendThread);
-    sendThread->initialize(true);
+    // we want to be notified when the thread finishes, which the scheduler signals from one of its workers
+    connect(sendThread.get(), &GenericThread::finished, this, &OctreeServer::removeSendThread, Qt::QueuedConnection);
+    sendThread->initialize(false);
+    _sendScheduler.add(sendThread.get());
 
     return sendThread;
 }
@@ -886,6 +908,8 @@ OctreeServer::UniqueSendThread OctreeServer::createSendThread(const SharedNodePo
 void OctreeServer::removeSendThread() {
     // If the object has been deleted since the event was queued, sender() will return nullptr
     if (auto sendThread = qobject_cast<OctreeSendThread*>(sender())) {
+        _sendScheduler.remove(sendThread);
+
         // This deletes the unique_ptr, so sendThread is destructed after that line
         _sendThreads.erase(sendThread->getNodeUuid());
     }
@@ -902,6 +926,7 @@ void OctreeServer::handleOctreeQueryPacket(QSharedPointer<ReceivedMessage> messa
         if (it == _sendThreads.end()) {
             _sendThreads.emplace(senderNode->getUUID(), createSendThread(senderNode));
         } else if (it->second->isShuttingDown()) {
+            _sendScheduler.remove(it->second.get());
             _sendThreads.erase(it); // Remove right away and wait on thread to be
 
             _sendThreads.emplace(senderNode->getUUID(), createSendThread(senderNode));
@@ -1048,6 +1073,12 @@ void OctreeServer::readConfiguration() {
         qDebug() << "persisAbsoluteFilePath=" << _persistAbsoluteFilePath;
 
         _persistAsFileType = "json.gz";
+        QString persistFileType;
+        if (readOptionString(QString("persistFileType"), settingsSectionObject, persistFileType)
+            && persistFileType == "bin") {
+            _persistAsFileType = persistFileType;
+        }
+        qDebug() << "persistFileType=" << _persistAsFileType;
 
         _persistInterval = OctreePersistThread::DEFAULT_PERSIST_INTERVAL;
         int result { -1 };
@@ -1292,11 +1323,11 @@ void OctreeServer::aboutToFinish() {
     for (auto& it : _sendThreads) {
         auto& sendThread = *it.second;
         sendThread.setIsShuttingDown();
+        _sendScheduler.remove(&sendThread);
         sendThread.terminate();
     }
 
-    // Clear will destruct all the unique_ptr to OctreeSendThreads which will call the GenericThread's dtor
-    // which waits on the thread to be done before returning
+    // Clear will destruct all the unique_ptr to OctreeSendThreads, none of which the scheduler runs anymore
     _sendThreads.clear(); // Cleans up all the send threads.
 
     if (_persistManager) {
@@ -1458,12 +1489,18 @@ void OctreeServer::sendStatsPacket() {
         dataArray2["1. packetQueue"] = (double)_octreeInboundPacketProcessor->packetsToProcessCount();
         dataArray2["2. totalPackets"] = (double)_octreeInboundPacketProcessor->getTotalPacketsProcessed();
         dataArray2["3. totalElements"] = (double)_octreeInboundPacketProcessor->getTotalElementsProcessed();
+        dataArray2["4. editsPerSecond"] = (double)_octreeInboundPacketProcessor->getAppliedEditsPerSecond();
 
         timingArray2["1. avgTransitTimePerPacket"] = (double)_octreeInboundPacketProcessor->getAverageTransitTimePerPacket();
         timingArray2["2. avgProcessTimePerPacket"] = (double)_octreeInboundPacketProcessor->getAverageProcessTimePerPacket();
         timingArray2["3. avgLockWaitTimePerPacket"] = (double)_octreeInboundPacketProcessor->getAverageLockWaitTimePerPacket();
         timingArray2["4. avgProcessTimePerElement"] = (double)_octreeInboundPacketProcessor->getAverageProcessTimePerElement();
         timingArray2["5. avgLockWaitTimePerElement"] = (double)_octreeInboundPacketProcessor->getAverageLockWaitTimePerElement();
+
+        HdrHistogram applyLatency = _octreeInboundPacketProcessor->getApplyLatency();
+        timingArray2["6. editApplyLatencyP50"] = (double)applyLatency.getValueAtPercentile(50.0);
+        timingArray2["7. editApplyLatencyP95"] = (double)applyLatency.getValueAtPercentile(95.0);
+        timingArray2["8. editApplyLatencyP99"] = (double)applyLatency.getValueAtPercentile(99.0);
     }
 
     QJsonObject statsObject3;
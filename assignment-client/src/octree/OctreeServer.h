@@ -23,6 +23,7 @@
 #include <ThreadedAssignment.h>
 
 #include "OctreePersistThread.h"
+#include "OctreeSendScheduler.h"
 #include "OctreeSendThread.h"
 #include "OctreeServerConsts.h"
 #include "OctreeInboundPacketProcessor.h"
@@ -202,6 +203,7 @@ protected:
     QString _safeServerName;
     
     SendThreads _sendThreads;
+    OctreeSendScheduler _sendScheduler; // runs the passes of the send threads, stopped before they are destroyed
 
     static int _clientCount;
     static SimpleMovingAverage _averageLoopTime;
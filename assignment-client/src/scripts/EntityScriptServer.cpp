@@ -11,8 +11,11 @@
 
 #include "EntityScriptServer.h"
 
+#include <algorithm>
 #include <mutex>
 
+#include <QtCore/QJsonArray>
+
 #include <AudioConstants.h>
 #include <AudioInjectorManager.h>
 #include <ClientServerUtils.h>
@@ -54,6 +57,11 @@ void messageHandler(QtMsgType type, const QMessageLogContext& context, const QSt
 
 int EntityScriptServer::_entitiesScriptEngineCount = 0;
 
+static const int SHARD_BALANCE_INTERVAL_MSECS = 10 * MSECS_PER_SECOND;
+
+// a shard has to have spent this share of the time running entity scripts for its scripts to be moved to another one
+static const float MIN_SHARD_LOAD_TO_BALANCE = 0.25f;
+
 EntityScriptServer::EntityScriptServer(ReceivedMessage& message) : ThreadedAssignment(message) {
     qInstallMessageHandler(messageHandler);
 
@@ -96,6 +104,11 @@ EntityScriptServer::EntityScriptServer(ReceivedMessage& message) : ThreadedAssig
     timer->setInterval(LOG_INTERVAL);
     connect(timer, &QTimer::timeout, this, &EntityScriptServer::pushLogs);
     timer->start();
+
+    auto balanceTimer = new QTimer(this);
+    balanceTimer->setInterval(SHARD_BALANCE_INTERVAL_MSECS);
+    connect(balanceTimer, &QTimer::timeout, this, &EntityScriptServer::balanceShards);
+    balanceTimer->start();
 }
 
 EntityScriptServer::~EntityScriptServer() {
@@ -125,7 +138,8 @@ void EntityScriptServer::handleEntityScriptGetStatusPacket(QSharedPointer<Receiv
         replyPacketList->writePrimitive(messageID);
 
         EntityScriptDetails details;
-        if (_entitiesScriptEngine->getEntityScriptDetails(entityID, details)) {
+        auto engine = _entityScriptShards->getEngine(entityID);
+        if (engine && engine->getEntityScriptDetails(entityID, details)) {
             replyPacketList->writePrimitive(true);
             replyPacketList->writePrimitive(details.status);
             replyPacketList->writeString(details.errorInfo);
@@ -167,10 +181,52 @@ void EntityScriptServer::handleSettings() {
 
     qDebug() << QString("Received entity script server settings, Max Entity PPS: %1, Entity PPS Per Entity Script: %2")
                 .arg(_maxEntityPPS).arg(_entityPPSPerScript);
+
+    static const QString SCRIPT_ENGINE_SHARDS_OPTION = "script_engine_shards";
+    int numShards = entityScriptServerSettings[SCRIPT_ENGINE_SHARDS_OPTION].toInt(DEFAULT_NUM_SCRIPT_ENGINE_SHARDS);
+    numShards = std::max(1, std::min(numShards, MAX_NUM_SCRIPT_ENGINE_SHARDS));
+    if (numShards != _numShards) {
+        qCDebug(entity_script_server) << "Running entity scripts in" << numShards << "script engines";
+        _numShards = numShards;
+
+        if (_entityViewer.getTree() && !_shuttingDown && _entityScriptShards->getNumShards() > 0) {
+            // the running scripts are loaded again in the engines they are assigned to now
+            QList<EntityItemID> entityIDs = _movingEntityScripts.keys();
+            for (const auto& engine : _entityScriptShards->getEngines()) {
+                entityIDs.append(engine->getListOfEntityScriptIDs());
+            }
+            stopEntitiesScriptEngines();
+            resetEntitiesScriptEngines();
+            for (const auto& entityID : entityIDs) {
+                checkAndCallPreload(entityID);
+            }
+        }
+    }
+
+    static const QString SHARD_BALANCING_OPTION = "entity_script_shard_balancing";
+    _isShardBalancingEnabled = entityScriptServerSettings[SHARD_BALANCING_OPTION].toBool();
+
+    static const QString SOFT_BUDGET_OPTION = "entity_script_soft_budget";
+    static const QString HARD_BUDGET_OPTION = "entity_script_hard_budget";
+    int softBudgetMsecsPerSecond = std::max(0, entityScriptServerSettings[SOFT_BUDGET_OPTION].toInt());
+    int hardBudgetMsecs = std::max(0, entityScriptServerSettings[HARD_BUDGET_OPTION].toInt());
+    if (softBudgetMsecsPerSecond != _softBudgetMsecsPerSecond || hardBudgetMsecs != _hardBudgetMsecs) {
+        qCDebug(entity_script_server) << "Entity script budgets, soft:" << softBudgetMsecsPerSecond << "ms per second, hard:"
+            << hardBudgetMsecs << "ms";
+        _softBudgetMsecsPerSecond = softBudgetMsecsPerSecond;
+        _hardBudgetMsecs = hardBudgetMsecs;
+    }
+    // applied every time, whatever the engines were set to they get the budgets of the domain back
+    for (const auto& engine : _entityScriptShards->getEngines()) {
+        engine->setEntityScriptBudgets(_softBudgetMsecsPerSecond, _hardBudgetMsecs);
+    }
 }
 
 void EntityScriptServer::updateEntityPPS() {
-    int numRunningScripts = _entitiesScriptEngine->getNumRunningEntityScripts();
+    int numRunningScripts = 0;
+    for (const auto& engine : _entityScriptShards->getEngines()) {
+        numRunningScripts += engine->getNumRunningEntityScripts();
+    }
     int pps;
     if (std::numeric_limits<int>::max() / _entityPPSPerScript < numRunningScripts) {
         qWarning() << QString("Integer multiplication would overflow, clamping to maxint: %1 * %2").arg(numRunningScripts).arg(_entityPPSPerScript);
@@ -231,7 +287,7 @@ void EntityScriptServer::pushLogs() {
 
 void EntityScriptServer::handleEntityScriptCallMethodPacket(QSharedPointer<ReceivedMessage> receivedMessage, SharedNodePointer senderNode) {
 
-    if (_entitiesScriptEngine && _entityViewer.getTree() && !_shuttingDown) {
+    if (_entityViewer.getTree() && !_shuttingDown) {
         auto entityID = QUuid::fromRfc4122(receivedMessage->read(NUM_BYTES_RFC4122_UUID));
 
         auto method = receivedMessage->readString();
@@ -245,7 +301,7 @@ void EntityScriptServer::handleEntityScriptCallMethodPacket(QSharedPointer<Recei
             params << paramString;
         }
 
-        _entitiesScriptEngine->callEntityScriptMethod(entityID, method, params, senderNode->getUUID());
+        _entityScriptShards->callEntityScriptMethod(entityID, method, params, senderNode->getUUID());
     }
 }
 
@@ -276,8 +332,13 @@ void EntityScriptServer::run() {
         NodeType::EntityServer, NodeType::MessagesMixer, NodeType::AssetServer
     });
 
-    // Setup Script Engine
-    resetEntitiesScriptEngine();
+    // the shards send their edits from their own threads, the sender sends them from its own
+    _entityEditSender.initialize(true);
+
+    // Setup Script Engines
+    resetEntitiesScriptEngines();
+    DependencyManager::get<EntityScriptingInterface>()->setEntitiesScriptEngine(
+        qSharedPointerCast<EntitiesScriptEngineProvider>(_entityScriptShards));
 
     auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
     entityScriptingInterface->init();
@@ -439,7 +500,7 @@ void EntityScriptServer::selectAudioFormat(const QString& selectedCodecName) {
     }
 }
 
-void EntityScriptServer::resetEntitiesScriptEngine() {
+ScriptEnginePointer EntityScriptServer::createEntitiesScriptEngine(bool updatesEntityViewer) {
     auto engineName = QString("about:Entities %1").arg(++_entitiesScriptEngineCount);
     auto newEngine = scriptEngineFactory(ScriptEngine::ENTITY_SERVER_SCRIPT, NO_SCRIPT, engineName);
 
@@ -456,48 +517,69 @@ void EntityScriptServer::resetEntitiesScriptEngine() {
     connect(newEngine.data(), &ScriptEngine::warningMessage, scriptEngines, &ScriptEngines::onWarningMessage);
     connect(newEngine.data(), &ScriptEngine::infoMessage, scriptEngines, &ScriptEngines::onInfoMessage);
 
-    connect(newEngine.data(), &ScriptEngine::update, this, [this] {
-        _entityViewer.queryOctree();
-        _entityViewer.getTree()->preUpdate();
-        _entityViewer.getTree()->update();
-    });
+    // the entity viewer is updated once a frame, by one of the engines
+    if (updatesEntityViewer) {
+        connect(newEngine.data(), &ScriptEngine::update, this, [this] {
+            _entityViewer.queryOctree();
+            _entityViewer.getTree()->preUpdate();
+            _entityViewer.getTree()->update();
+        });
+    }
+
+    connect(newEngine.data(), &ScriptEngine::entityScriptDetailsUpdated, this, &EntityScriptServer::updateEntityPPS);
+    connect(newEngine.data(), &ScriptEngine::entityScriptDetailsUpdated,
+            this, &EntityScriptServer::preloadMovedEntityScripts);
 
     scriptEngines->runScriptInitializers(newEngine);
     newEngine->runInThread();
-    auto newEngineSP = qSharedPointerCast<EntitiesScriptEngineProvider>(newEngine);
-    DependencyManager::get<EntityScriptingInterface>()->setEntitiesScriptEngine(newEngineSP);
+    newEngine->setEntityScriptBudgets(_softBudgetMsecsPerSecond, _hardBudgetMsecs);
+    return newEngine;
+}
 
-    if (_entitiesScriptEngine) {
-        disconnect(_entitiesScriptEngine.data(), &ScriptEngine::entityScriptDetailsUpdated,
-                   this, &EntityScriptServer::updateEntityPPS);
+void EntityScriptServer::resetEntitiesScriptEngines() {
+    for (const auto& engine : _entityScriptShards->getEngines()) {
+        disconnect(engine.data(), &ScriptEngine::entityScriptDetailsUpdated, this, &EntityScriptServer::updateEntityPPS);
+        disconnect(engine.data(), &ScriptEngine::entityScriptDetailsUpdated,
+                   this, &EntityScriptServer::preloadMovedEntityScripts);
     }
+    _movingEntityScripts.clear();
 
-    _entitiesScriptEngine.swap(newEngine);
-    connect(_entitiesScriptEngine.data(), &ScriptEngine::entityScriptDetailsUpdated,
-            this, &EntityScriptServer::updateEntityPPS);
+    std::vector<ScriptEnginePointer> engines;
+    for (int i = 0; i < _numShards; ++i) {
+        engines.push_back(createEntitiesScriptEngine(i == 0));
+    }
+    _entityScriptShards->setEngines(engines);
+    _shardRunTimes.assign(engines.size(), 0);
 }
 
+void EntityScriptServer::stopEntitiesScriptEngines() {
+    auto engines = _entityScriptShards->getEngines();
 
-void EntityScriptServer::clear() {
-    // unload and stop the engine
-    if (_entitiesScriptEngine) {
-        // do this here (instead of in deleter) to avoid marshalling unload signals back to this thread
-        _entitiesScriptEngine->unloadAllEntityScripts();
-        _entitiesScriptEngine->stop();
-        _entitiesScriptEngine->waitTillDoneRunning();
+    // do this here (instead of in deleter) to avoid marshalling unload signals back to this thread
+    for (const auto& engine : engines) {
+        engine->unloadAllEntityScripts();
+        engine->stop();
     }
+    for (const auto& engine : engines) {
+        engine->waitTillDoneRunning();
+    }
+}
+
+void EntityScriptServer::clear() {
+    // unload and stop the engines
+    stopEntitiesScriptEngines();
 
     _entityViewer.clear();
 
-    // reset the engine
+    // reset the engines
     if (!_shuttingDown) {
-        resetEntitiesScriptEngine();
+        resetEntitiesScriptEngines();
     }
 }
 
 void EntityScriptServer::shutdownScriptEngine() {
-    if (_entitiesScriptEngine) {
-        _entitiesScriptEngine->disconnectNonEssentialSignals(); // disconnect all slots/signals from the script engine, except essential
+    for (const auto& engine : _entityScriptShards->getEngines()) {
+        engine->disconnectNonEssentialSignals(); // disconnect all slots/signals from the script engine, except essential
     }
     _shuttingDown = true;
 
@@ -506,7 +588,7 @@ void EntityScriptServer::shutdownScriptEngine() {
     auto scriptEngines = DependencyManager::get<ScriptEngines>();
     scriptEngines->shutdownScripting();
 
-    _entitiesScriptEngine.clear();
+    _entityScriptShards->setEngines({});
 
     auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
     // our entity tree is going to go away so tell that to the EntityScriptingInterface
@@ -524,9 +606,12 @@ void EntityScriptServer::addingEntity(const EntityItemID& entityID) {
 }
 
 void EntityScriptServer::deletingEntity(const EntityItemID& entityID) {
-    if (_entityViewer.getTree() && !_shuttingDown && _entitiesScriptEngine) {
-        _entitiesScriptEngine->unloadEntityScript(entityID, true);
+    auto engine = _entityScriptShards->getEngine(entityID);
+    if (_entityViewer.getTree() && !_shuttingDown && engine) {
+        engine->unloadEntityScript(entityID, true);
     }
+    _entityScriptShards->forgetEntity(entityID);
+    _movingEntityScripts.remove(entityID);
 }
 
 void EntityScriptServer::entityServerScriptChanging(const EntityItemID& entityID, bool reload) {
@@ -536,25 +621,78 @@ void EntityScriptServer::entityServerScriptChanging(const EntityItemID& entityID
 }
 
 void EntityScriptServer::checkAndCallPreload(const EntityItemID& entityID, bool forceRedownload) {
-    if (_entityViewer.getTree() && !_shuttingDown && _entitiesScriptEngine) {
+    auto engine = _entityScriptShards->getEngine(entityID);
+    // the scripts of an entity that is moving are preloaded once they are unloaded from their old engine
+    if (_entityViewer.getTree() && !_shuttingDown && engine && !_movingEntityScripts.contains(entityID)) {
 
         EntityItemPointer entity = _entityViewer.getTree()->findEntityByEntityItemID(entityID);
         EntityScriptDetails details;
-        bool isRunning = _entitiesScriptEngine->getEntityScriptDetails(entityID, details);
+        bool isRunning = engine->getEntityScriptDetails(entityID, details);
         if (entity && (forceRedownload || !isRunning || details.scriptText != entity->getServerScripts())) {
             if (isRunning) {
-                _entitiesScriptEngine->unloadEntityScript(entityID, true);
+                engine->unloadEntityScript(entityID, true);
             }
 
             QString scriptUrl = entity->getServerScripts();
             if (!scriptUrl.isEmpty()) {
                 scriptUrl = DependencyManager::get<ResourceManager>()->normalizeURL(scriptUrl);
-                _entitiesScriptEngine->loadEntityScript(entityID, scriptUrl, forceRedownload);
+                engine->loadEntityScript(entityID, scriptUrl, forceRedownload);
             }
         }
     }
 }
 
+void EntityScriptServer::moveEntityScript(const EntityItemID& entityID, int shard) {
+    auto engine = _entityScriptShards->getEngine(entityID);
+    if (!engine || !engine->hasEntityScriptDetails(entityID)) {
+        return;
+    }
+
+    // the scripts are unloaded and preloaded again in the other engine, like when they are reloaded, so they lose the
+    // state they kept in memory. The unload has to be done before the other engine preloads them, or both would run,
+    // and it waits for any entity script call running in the old engine.
+    _movingEntityScripts[entityID] = engine;
+    _entityScriptShards->moveEntity(entityID, shard);
+    engine->unloadEntityScript(entityID, true);
+}
+
+void EntityScriptServer::preloadMovedEntityScripts() {
+    for (auto it = _movingEntityScripts.begin(); it != _movingEntityScripts.end();) {
+        if (it.value()->hasEntityScriptDetails(it.key())) {
+            ++it;
+            continue;
+        }
+        auto entityID = it.key();
+        it = _movingEntityScripts.erase(it);
+        checkAndCallPreload(entityID);
+    }
+}
+
+void EntityScriptServer::balanceShards() {
+    auto engines = _entityScriptShards->getEngines();
+    if (_shuttingDown || engines.empty()) {
+        return;
+    }
+
+    std::vector<QHash<EntityItemID, quint64>> runTimes;
+    _shardRunTimes.assign(engines.size(), 0);
+    for (size_t i = 0; i < engines.size(); ++i) {
+        runTimes.push_back(engines[i]->takeEntityScriptRunTimes());
+        for (auto runTime : runTimes.back()) {
+            _shardRunTimes[i] += runTime;
+        }
+    }
+
+    EntityItemID entityID;
+    int shard;
+    quint64 minRunTimeToBalance = (quint64)(MIN_SHARD_LOAD_TO_BALANCE * SHARD_BALANCE_INTERVAL_MSECS * USECS_PER_MSEC);
+    if (_isShardBalancingEnabled && EntityScriptShards::pickEntityToMove(runTimes, minRunTimeToBalance, entityID, shard)) {
+        qCDebug(entity_script_server) << "Moving the scripts of" << entityID << "from shard"
+            << _entityScriptShards->getShard(entityID) << "to shard" << shard;
+        moveEntityScript(entityID, shard);
+    }
+}
+
 void EntityScriptServer::sendStatsPacket() {
     QJsonObject statsObject;
 
@@ -566,11 +704,58 @@ void EntityScriptServer::sendStatsPacket() {
 
     QJsonObject scriptEngineStats;
     int numberRunningScripts = 0;
-    const auto scriptEngine = _entitiesScriptEngine;
-    if (scriptEngine) {
-        numberRunningScripts = scriptEngine->getNumRunningEntityScripts();
+    QJsonArray shardStats;
+    std::vector<std::pair<double, QJsonObject>> entityScriptStats;
+    auto engines = _entityScriptShards->getEngines();
+    for (size_t i = 0; i < engines.size(); ++i) {
+        QVariantMap engineStats = engines[i]->getScriptStats();
+        int shardRunningScripts = engineStats["runningEntityScripts"].toInt();
+        numberRunningScripts += shardRunningScripts;
+
+        QJsonObject shardObject;
+        shardObject["number_running_scripts"] = shardRunningScripts;
+        if (i < _shardRunTimes.size()) {
+            shardObject["script_time_percent"] =
+                100.0 * (double)_shardRunTimes[i] / (double)(SHARD_BALANCE_INTERVAL_MSECS * USECS_PER_MSEC);
+        }
+        shardObject["script_time_msecs"] = engineStats["entityScriptRunTime"].toDouble();
+        shardObject["script_calls"] = engineStats["entityScriptCalls"].toDouble();
+        shardObject["timer_calls"] = engineStats["timerCalls"].toDouble();
+        shardObject["deferred_timer_calls"] = engineStats["deferredTimerCalls"].toDouble();
+        shardObject["suspended_scripts"] = engineStats["suspendedEntityScripts"].toDouble();
+        shardObject["timers"] = engineStats["timers"].toInt();
+        shardStats.append(shardObject);
+
+        auto entityScripts = engineStats["entityScripts"].toMap();
+        for (auto it = entityScripts.constBegin(); it != entityScripts.constEnd(); ++it) {
+            auto entityStats = it.value().toMap();
+            QJsonObject entityObject;
+            entityObject["entity_id"] = it.key();
+            entityObject["shard"] = (int)i;
+            entityObject["script_time_msecs"] = entityStats["runTime"].toDouble();
+            entityObject["max_call_msecs"] = entityStats["maxCallTime"].toDouble();
+            entityObject["calls"] = entityStats["calls"].toDouble();
+            entityObject["timer_calls"] = entityStats["timerCalls"].toDouble();
+            entityObject["deferred_timer_calls"] = entityStats["deferredTimerCalls"].toDouble();
+            entityObject["timers"] = entityStats["timers"].toInt();
+            entityScriptStats.emplace_back(entityStats["runTime"].toDouble(), entityObject);
+        }
     }
     scriptEngineStats["number_running_scripts"] = numberRunningScripts;
+    scriptEngineStats["shards"] = shardStats;
+
+    // only the scripts that ran the longest, the stats of every script would swamp the domain-server
+    static const size_t NUM_BUSIEST_ENTITY_SCRIPTS = 10;
+    size_t numBusiest = std::min(entityScriptStats.size(), NUM_BUSIEST_ENTITY_SCRIPTS);
+    std::partial_sort(entityScriptStats.begin(), entityScriptStats.begin() + numBusiest, entityScriptStats.end(),
+        [](const std::pair<double, QJsonObject>& a, const std::pair<double, QJsonObject>& b) {
+            return a.first > b.first;
+        });
+    QJsonArray busiestScripts;
+    for (size_t i = 0; i < numBusiest; ++i) {
+        busiestScripts.append(entityScriptStats[i].second);
+    }
+    scriptEngineStats["busiest_scripts"] = busiestScripts;
     statsObject["script_engine_stats"] = scriptEngineStats;
     
 
@@ -665,6 +850,8 @@ void EntityScriptServer::aboutToFinish() {
     DependencyManager::destroy<ScriptEngines>();
     DependencyManager::destroy<EntityScriptServerServices>();
 
+    _entityEditSender.terminate();
+
     // cleanup codec & encoder
     if (_codec && _encoder) {
         _codec->releaseEncoder(_encoder);
@@ -19,12 +19,16 @@
 #include <QtCore/QUuid>
 
 #include <EntityEditPacketSender.h>
+#include <EntityScriptShards.h>
 #include <plugins/CodecPlugin.h>
 #include <ScriptEngine.h>
 #include <SimpleEntitySimulation.h>
 #include <ThreadedAssignment.h>
 #include "../entities/EntityTreeHeadlessViewer.h"
 
+static const int DEFAULT_NUM_SCRIPT_ENGINE_SHARDS = 1;
+static const int MAX_NUM_SCRIPT_ENGINE_SHARDS = 16;
+
 class EntityScriptServer : public ThreadedAssignment {
     Q_OBJECT
 
@@ -56,12 +60,16 @@ private slots:
 
     void handleEntityScriptCallMethodPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode);
 
+    void balanceShards();
+    void preloadMovedEntityScripts();
 
 private:
     void negotiateAudioFormat();
     void selectAudioFormat(const QString& selectedCodecName);
 
-    void resetEntitiesScriptEngine();
+    ScriptEnginePointer createEntitiesScriptEngine(bool updatesEntityViewer);
+    void resetEntitiesScriptEngines();
+    void stopEntitiesScriptEngines();
     void clear();
     void shutdownScriptEngine();
 
@@ -69,13 +77,20 @@ private:
     void deletingEntity(const EntityItemID& entityID);
     void entityServerScriptChanging(const EntityItemID& entityID, bool reload);
     void checkAndCallPreload(const EntityItemID& entityID, bool forceRedownload = false);
+    void moveEntityScript(const EntityItemID& entityID, int shard);
 
     void cleanupOldKilledListeners();
 
     bool _shuttingDown { false };
 
     static int _entitiesScriptEngineCount;
-    ScriptEnginePointer _entitiesScriptEngine;
+    QSharedPointer<EntityScriptShards> _entityScriptShards { QSharedPointer<EntityScriptShards>::create() };
+    int _numShards { DEFAULT_NUM_SCRIPT_ENGINE_SHARDS };
+    bool _isShardBalancingEnabled { false }; // moving a script reloads it, so it only happens if the domain asks for it
+    int _softBudgetMsecsPerSecond { 0 };
+    int _hardBudgetMsecs { 0 };
+    std::vector<quint64> _shardRunTimes; // the time each shard spent running entity scripts over the last balance
+    QHash<EntityItemID, ScriptEnginePointer> _movingEntityScripts; // the engine each is being unloaded from
     SimpleEntitySimulationPointer _entitySimulation;
     EntityEditPacketSender _entityEditSender;
     EntityTreeHeadlessViewer _entityViewer;
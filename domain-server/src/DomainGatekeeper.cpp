@@ -313,6 +313,7 @@ void DomainGatekeeper::updateNodePermissions() {
         }
 
         node->setPermissions(userPerms);
+        _server->refreshNodeRevision(node);
 
         if (!userPerms.can(NodePermissions::Permission::canConnectToDomain)) {
             qDebug() << "node" << node->getUUID() << "no longer has permission to connect.";
@@ -161,6 +161,8 @@ bool DomainServer::forwardMetaverseAPIRequest(HTTPConnection* connection,
 
 DomainServer::DomainServer(int argc, char* argv[]) :
     QCoreApplication(argc, argv),
+    // start from the current time so that revisions keep increasing across restarts
+    _nodeTableRevision(usecTimestampNow()),
     _gatekeeper(this),
     _httpManager(QHostAddress::AnyIPv4, DOMAIN_SERVER_HTTP_PORT, QString("%1/resources/web/").arg(QCoreApplication::applicationDirPath()), this)
 {
@@ -683,6 +685,7 @@ bool DomainServer::isPacketVerified(const udt::Packet& packet) {
 void DomainServer::setupNodeListAndAssignments() {
     const QString CUSTOM_LOCAL_PORT_OPTION = "metaverse.local_port";
     static const QString ENABLE_PACKET_AUTHENTICATION = "metaverse.enable_packet_verification";
+    static const QString PACKET_VERIFICATION_METHOD = "metaverse.packet_verification_method";
 
     QVariant localPortValue = _settingsManager.valueOrDefaultValueForKeyPath(CUSTOM_LOCAL_PORT_OPTION);
     int domainServerPort = localPortValue.toInt();
@@ -752,6 +755,11 @@ void DomainServer::setupNodeListAndAssignments() {
     bool isAuthEnabled = _settingsManager.valueOrDefaultValueForKeyPath(ENABLE_PACKET_AUTHENTICATION).toBool();
     nodeList->setAuthenticatePackets(isAuthEnabled);
 
+    static const QString SIPHASH_VERIFICATION_METHOD = "siphash";
+    bool useSipHash = _settingsManager.valueOrDefaultValueForKeyPath(PACKET_VERIFICATION_METHOD).toString()
+        == SIPHASH_VERIFICATION_METHOD;
+    nodeList->setAuthenticationMethod(useSipHash ? HMACAuth::SIPHASH : HMACAuth::MD5);
+
     connect(nodeList.data(), &LimitedNodeList::nodeAdded, this, &DomainServer::nodeAdded);
     connect(nodeList.data(), &LimitedNodeList::nodeKilled, this, &DomainServer::nodeKilled);
     connect(nodeList.data(), &LimitedNodeList::localSockAddrChanged, this,
@@ -1074,6 +1082,7 @@ void DomainServer::processListRequestPacket(QSharedPointer<ReceivedMessage> mess
     // update this node's sockets in case they have changed
     sendingNode->setPublicSocket(nodeRequestData.publicSockAddr);
     sendingNode->setLocalSocket(nodeRequestData.localSockAddr);
+    refreshNodeRevision(sendingNode);
 
     DomainServerNodeData* nodeData = static_cast<DomainServerNodeData*>(sendingNode->getLinkedData());
 
@@ -1090,6 +1099,12 @@ void DomainServer::processListRequestPacket(QSharedPointer<ReceivedMessage> mess
         safeInterestSet.remove(NodeType::Agent);
     }
 
+    // the revision this node acknowledged only covers the node types it was interested in until now
+    quint64 knownNodeTableRevision = nodeRequestData.domainListRevision;
+    if (safeInterestSet != nodeData->getNodeInterestSet()) {
+        knownNodeTableRevision = 0;
+    }
+
     // update the NodeInterestSet in case there have been any changes
     nodeData->setNodeInterestSet(safeInterestSet);
 
@@ -1099,7 +1114,8 @@ void DomainServer::processListRequestPacket(QSharedPointer<ReceivedMessage> mess
     // client-side send time of last connect/domain list request
     nodeData->setLastDomainCheckinTimestamp(nodeRequestData.lastPingTimestamp);
 
-    sendDomainListToNode(sendingNode, message->getFirstPacketReceiveTime(), message->getSenderSockAddr(), false);
+    sendDomainListToNode(sendingNode, message->getFirstPacketReceiveTime(), message->getSenderSockAddr(), false,
+                         knownNodeTableRevision);
 }
 
 bool DomainServer::isInInterestSet(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB) {
@@ -1177,20 +1193,62 @@ void DomainServer::handleConnectedNode(SharedNodePointer newNode, quint64 reques
         newNode->setIsReplicated(true);
     }
 
+    // the other nodes hear about this one in their next domain list delta
+    refreshNodeRevision(newNode);
+
     // send out this node to our other connected nodes
     broadcastNewNode(newNode);
 }
 
-void DomainServer::sendDomainListToNode(const SharedNodePointer& node, quint64 requestPacketReceiveTime, const HifiSockAddr &senderSockAddr, bool newConnection) {
+void DomainServer::sendDomainListToNode(const SharedNodePointer& node, quint64 requestPacketReceiveTime, const HifiSockAddr &senderSockAddr,
+                                        bool newConnection, quint64 knownNodeTableRevision) {
     const int NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES = NUM_BYTES_RFC4122_UUID + NLPacket::NUM_BYTES_LOCALID +
-        NUM_BYTES_RFC4122_UUID + NLPacket::NUM_BYTES_LOCALID + 4;
+        NUM_BYTES_RFC4122_UUID + NLPacket::NUM_BYTES_LOCALID + 4 + sizeof(quint64) + sizeof(quint64) + sizeof(quint32);
+
+    DomainServerNodeData* nodeData = static_cast<DomainServerNodeData*>(node->getLinkedData());
+    auto limitedNodeList = DependencyManager::get<LimitedNodeList>();
+
+    // a node that doesn't hold a revision we can build on gets the full list,
+    // otherwise only the nodes it is interested in that changed since its revision
+    bool isFullList = newConnection || knownNodeTableRevision == 0 || knownNodeTableRevision > _nodeTableRevision
+        || knownNodeTableRevision < _forgottenNodeTableRevision;
+
+    std::vector<SharedNodePointer> changedNodes;
+    std::vector<QUuid> removedNodes;
+
+    // store the nodeInterestSet on this DomainServerNodeData, in case it has changed
+    auto& nodeInterestSet = nodeData->getNodeInterestSet();
+
+    // DTLSServerSession* dtlsSession = _isUsingDTLS ? _dtlsSessions[senderSockAddr] : NULL;
+    if (nodeInterestSet.size() > 0 && nodeData->isAuthenticated()) {
+        // if this authenticated node has any interest types, send back those nodes as well
+        if (isFullList) {
+            limitedNodeList->eachNode([this, node, &changedNodes](const SharedNodePointer& otherNode) {
+                if (otherNode->getUUID() != node->getUUID() && isInInterestSet(node, otherNode)) {
+                    changedNodes.push_back(otherNode);
+                }
+            });
+        } else {
+            for (auto it = _nodeTableChanges.upper_bound(knownNodeTableRevision); it != _nodeTableChanges.end(); ++it) {
+                const auto& change = it->second;
+
+                if (change.nodeUUID == node->getUUID() || !nodeInterestSet.contains(change.nodeType)) {
+                    continue;
+                }
+
+                if (change.isRemoved) {
+                    removedNodes.push_back(change.nodeUUID);
+                } else if (auto otherNode = limitedNodeList->nodeWithUUID(change.nodeUUID)) {
+                    changedNodes.push_back(otherNode);
+                }
+            }
+        }
+    }
 
     // setup the extended header for the domain list packets
     // this data is at the beginning of each of the domain list packets
     QByteArray extendedHeader(NUM_DOMAIN_LIST_EXTENDED_HEADER_BYTES, 0);
     QDataStream extendedHeaderStream(&extendedHeader, QIODevice::WriteOnly);
-    DomainServerNodeData* nodeData = static_cast<DomainServerNodeData*>(node->getLinkedData());
-    auto limitedNodeList = DependencyManager::get<LimitedNodeList>();
 
     extendedHeaderStream << limitedNodeList->getSessionUUID();
     extendedHeaderStream << limitedNodeList->getSessionLocalID();
@@ -1198,39 +1256,49 @@ void DomainServer::sendDomainListToNode(const SharedNodePointer& node, quint64 r
     extendedHeaderStream << node->getLocalID();
     extendedHeaderStream << node->getPermissions();
     extendedHeaderStream << limitedNodeList->getAuthenticatePackets();
+    extendedHeaderStream << (quint8)limitedNodeList->getAuthenticationMethod();
     extendedHeaderStream << nodeData->getLastDomainCheckinTimestamp();
     extendedHeaderStream << quint64(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
     extendedHeaderStream << quint64(duration_cast<microseconds>(p_high_resolution_clock::now().time_since_epoch()).count()) - requestPacketReceiveTime;
     extendedHeaderStream << newConnection;
+
+    // the revision this list builds on (0 for a full list), the revision it brings the node to, and how many entries
+    // the list holds across all of its packets - the node can only move to the new revision once it has seen them all.
+    // An unauthenticated node is sent no other nodes, so it shouldn't hold on to a revision either.
+    extendedHeaderStream << (isFullList ? quint64(0) : knownNodeTableRevision);
+    extendedHeaderStream << (nodeData->isAuthenticated() ? _nodeTableRevision : quint64(0));
+    extendedHeaderStream << quint32(changedNodes.size() + removedNodes.size());
+
     auto domainListPackets = NLPacketList::create(PacketType::DomainList, extendedHeader);
 
-    // always send the node their own UUID back
     QDataStream domainListStream(domainListPackets.get());
 
-    // store the nodeInterestSet on this DomainServerNodeData, in case it has changed
-    auto& nodeInterestSet = nodeData->getNodeInterestSet();
+    for (const auto& otherNode : changedNodes) {
+        // since we're about to add a node to the packet we start a segment
+        domainListPackets->startSegment();
 
-    if (nodeInterestSet.size() > 0) {
+        domainListStream << (quint8)DomainListEntryType::Node;
 
-        // DTLSServerSession* dtlsSession = _isUsingDTLS ? _dtlsSessions[senderSockAddr] : NULL;
-        if (nodeData->isAuthenticated()) {
-            // if this authenticated node has any interest types, send back those nodes as well
-            limitedNodeList->eachNode([this, node, &domainListPackets, &domainListStream](const SharedNodePointer& otherNode) {
-                if (otherNode->getUUID() != node->getUUID() && isInInterestSet(node, otherNode)) {
-                    // since we're about to add a node to the packet we start a segment
-                    domainListPackets->startSegment();
+        // re-use what the node looked like when it last changed, if we have it
+        auto otherNodeData = static_cast<DomainServerNodeData*>(otherNode->getLinkedData());
+        if (!isFullList && otherNodeData && !otherNodeData->getSerializedNode().isEmpty()) {
+            const auto& serializedNode = otherNodeData->getSerializedNode();
+            domainListStream.writeRawData(serializedNode.constData(), serializedNode.size());
+        } else {
+            domainListStream << *otherNode.data();
+        }
 
-                    // don't send avatar nodes to other avatars, that will come from avatar mixer
-                    domainListStream << *otherNode.data();
+        // pack the secret that these two nodes will use to communicate with each other
+        domainListStream << connectionSecretForNodes(node, otherNode);
 
-                    // pack the secret that these two nodes will use to communicate with each other
-                    domainListStream << connectionSecretForNodes(node, otherNode);
+        // we've added the node we wanted so end the segment now
+        domainListPackets->endSegment();
+    }
 
-                    // we've added the node we wanted so end the segment now
-                    domainListPackets->endSegment();
-                }
-            });
-        }
+    for (const auto& removedNodeUUID : removedNodes) {
+        domainListPackets->startSegment();
+        domainListStream << (quint8)DomainListEntryType::RemovedNode << removedNodeUUID;
+        domainListPackets->endSegment();
     }
 
     // send an empty list to the node, in case there were no other nodes
@@ -1240,6 +1308,49 @@ void DomainServer::sendDomainListToNode(const SharedNodePointer& node, quint64 r
     limitedNodeList->sendPacketList(std::move(domainListPackets), *node);
 }
 
+void DomainServer::refreshNodeRevision(const SharedNodePointer& node) {
+    auto nodeData = static_cast<DomainServerNodeData*>(node->getLinkedData());
+    if (!nodeData) {
+        return;
+    }
+
+    QByteArray serializedNode;
+    QDataStream serializedNodeStream(&serializedNode, QIODevice::WriteOnly);
+    serializedNodeStream << *node;
+
+    if (nodeData->getNodeTableRevision() != 0 && serializedNode == nodeData->getSerializedNode()) {
+        // nothing other nodes can see has changed
+        return;
+    }
+
+    // the node's previous change is superseded by this one
+    _nodeTableChanges.erase(nodeData->getNodeTableRevision());
+
+    nodeData->setSerializedNode(serializedNode);
+    nodeData->setNodeTableRevision(++_nodeTableRevision);
+    _nodeTableChanges[_nodeTableRevision] = { node->getUUID(), node->getType(), false };
+}
+
+void DomainServer::addRemovedNodeRevision(const SharedNodePointer& node) {
+    static const size_t MAX_REMOVED_NODE_REVISIONS = 1000;
+
+    auto nodeData = static_cast<DomainServerNodeData*>(node->getLinkedData());
+    if (nodeData) {
+        _nodeTableChanges.erase(nodeData->getNodeTableRevision());
+        nodeData->setNodeTableRevision(0);
+    }
+
+    _nodeTableChanges[++_nodeTableRevision] = { node->getUUID(), node->getType(), true };
+    _removedNodeRevisions.push_back(_nodeTableRevision);
+
+    // forget the oldest removals, nodes that haven't caught up with them by now will need a full list
+    while (_removedNodeRevisions.size() > MAX_REMOVED_NODE_REVISIONS) {
+        _forgottenNodeTableRevision = _removedNodeRevisions.front();
+        _nodeTableChanges.erase(_forgottenNodeTableRevision);
+        _removedNodeRevisions.pop_front();
+    }
+}
+
 QUuid DomainServer::connectionSecretForNodes(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB) {
     DomainServerNodeData* nodeAData = static_cast<DomainServerNodeData*>(nodeA->getLinkedData());
     DomainServerNodeData* nodeBData = static_cast<DomainServerNodeData*>(nodeB->getLinkedData());
@@ -3066,6 +3177,7 @@ void DomainServer::updateReplicatedNodes() {
                     << otherNode->getPermissions().getVerifiedUserName() << otherNode->getUUID();
             }
             otherNode->setIsReplicated(shouldReplicate);
+            refreshNodeRevision(otherNode);
         }
     );
 }
@@ -3130,6 +3242,8 @@ void DomainServer::nodeKilled(SharedNodePointer node) {
         }
     }
 
+    addRemovedNodeRevision(node);
+
     broadcastNodeDisconnect(node);
 }
 
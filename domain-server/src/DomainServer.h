@@ -12,6 +12,9 @@
 #ifndef hifi_DomainServer_h
 #define hifi_DomainServer_h
 
+#include <deque>
+#include <map>
+
 #include <QtCore/QCoreApplication>
 #include <QtCore/QHash>
 #include <QtCore/QJsonObject>
@@ -181,7 +184,10 @@ private:
     void handleKillNode(SharedNodePointer nodeToKill);
     void broadcastNodeDisconnect(const SharedNodePointer& disconnnectedNode);
 
-    void sendDomainListToNode(const SharedNodePointer& node, quint64 requestPacketReceiveTime, const HifiSockAddr& senderSockAddr, bool newConnection);
+    void sendDomainListToNode(const SharedNodePointer& node, quint64 requestPacketReceiveTime, const HifiSockAddr& senderSockAddr,
+                              bool newConnection, quint64 knownNodeTableRevision = 0);
+    void refreshNodeRevision(const SharedNodePointer& node);
+    void addRemovedNodeRevision(const SharedNodePointer& node);
 
     bool isInInterestSet(const SharedNodePointer& nodeA, const SharedNodePointer& nodeB);
 
@@ -233,6 +239,21 @@ private:
 
     std::vector<QString> _replicatedUsernames;
 
+    // Every change to a node that shows up in domain lists is given the next node table revision, so that a domain list
+    // request that acknowledges a revision can be answered with only what changed since. _nodeTableChanges holds the
+    // latest change for each node, and a bounded number of removals - a request acknowledging a revision from before
+    // the oldest removal we forgot gets a full list.
+    struct NodeTableChange {
+        QUuid nodeUUID;
+        NodeType_t nodeType;
+        bool isRemoved;
+    };
+
+    quint64 _nodeTableRevision;
+    quint64 _forgottenNodeTableRevision { 0 };
+    std::map<quint64, NodeTableChange> _nodeTableChanges;
+    std::deque<quint64> _removedNodeRevisions;
+
     DomainGatekeeper _gatekeeper;
 
     HTTPManager _httpManager;
@@ -75,6 +75,12 @@ public:
 
     bool hasCheckedIn() const { return _hasCheckedIn; }
     void setHasCheckedIn(bool hasCheckedIn) { _hasCheckedIn = hasCheckedIn; }
+
+    // the node table revision this node last changed at, and what it looked like in a domain list then
+    quint64 getNodeTableRevision() const { return _nodeTableRevision; }
+    void setNodeTableRevision(quint64 nodeTableRevision) { _nodeTableRevision = nodeTableRevision; }
+    const QByteArray& getSerializedNode() const { return _serializedNode; }
+    void setSerializedNode(const QByteArray& serializedNode) { _serializedNode = serializedNode; }
     
 private:
     QJsonObject overrideValuesIfNeeded(const QJsonObject& newStats);
@@ -102,6 +108,9 @@ private:
     bool _wasAssigned { false };
 
     bool _hasCheckedIn { false };
+
+    quint64 _nodeTableRevision { 0 };
+    QByteArray _serializedNode;
 };
 
 #endif // hifi_DomainServerNodeData_h
@@ -29,6 +29,7 @@ public:
     HifiSockAddr senderSockAddr;
     QList<NodeType_t> interestList;
     QString placeName;
+    quint64 domainListRevision { 0 }; // domain list requests only - the node table revision the node holds
     QString hardwareAddress;
     QUuid machineFingerprint;
     QString SystemInfo;
@@ -13,8 +13,13 @@
 
 #include <openssl/x509.h>
 
+#include <algorithm>
+
+#include <QtCore/QCommandLineParser>
 #include <QtCore/QDataStream>
+#include <QtCore/QFile>
 #include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
 #include <QtCore/QTimer>
 #include <QtNetwork/QNetworkReply>
 #include <QtNetwork/QNetworkRequest>
@@ -22,24 +27,57 @@
 #include <LimitedNodeList.h>
 #include <NetworkAccessManager.h>
 #include <NetworkingConstants.h>
+#include <NumericalConstants.h>
 #include <udt/PacketHeaders.h>
 #include <SharedUtil.h>
+#include <UUID.h>
 
 const int CLEAR_INACTIVE_PEERS_INTERVAL_MSECS = 1 * 1000;
 const int PEER_SILENCE_THRESHOLD_MSECS = 5 * 1000;
+const quint64 VERIFIED_HEARTBEAT_WINDOW_USECS = 60 * USECS_PER_SECOND;
+const size_t MAX_QUEUED_PACKETS_PER_WORKER = 10000;
 
 IceServer::IceServer(int argc, char* argv[]) :
     QCoreApplication(argc, argv),
     _id(QUuid::createUuid()),
-    _serverSocket(0, false),
-    _activePeers()
+    _serverSocket(0, false)
 {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity ICE server");
+    parser.addHelpOption();
+
+    const QCommandLineOption threadsOption("threads", "number of threads processing heartbeats and queries", "count");
+    parser.addOption(threadsOption);
+
+    const QCommandLineOption publicKeysOption("public-keys",
+        "JSON file of domain IDs to objects with a base64 \"public_key\", trusted without asking the metaverse API", "path");
+    parser.addOption(publicKeysOption);
+
+    parser.process(*this);
+
+    if (parser.isSet(publicKeysOption)) {
+        loadPublicKeys(parser.value(publicKeysOption));
+    }
+
+    int numThreads = QThread::idealThreadCount();
+    if (parser.isSet(threadsOption)) {
+        numThreads = parser.value(threadsOption).toInt();
+    }
+    numThreads = std::max(1, numThreads);
+
+    qDebug() << "ice-server is processing packets on" << numThreads << "threads";
+    for (int i = 0; i < numThreads; ++i) {
+        auto worker = new Worker(*this);
+        worker->start();
+        _workers.emplace_back(worker);
+    }
+
     // start the ice-server socket
     qDebug() << "ice-server socket is listening on" << ICE_SERVER_DEFAULT_PORT;
     _serverSocket.bind(QHostAddress::AnyIPv4, ICE_SERVER_DEFAULT_PORT);
 
-    // set processPacket as the verified packet callback for the udt::Socket
-    _serverSocket.setPacketHandler([this](std::unique_ptr<udt::Packet> packet) { processPacket(std::move(packet));  });
+    // set queuePacket as the verified packet callback for the udt::Socket
+    _serverSocket.setPacketHandler([this](std::unique_ptr<udt::Packet> packet) { queuePacket(std::move(packet)); });
     
     // set packetVersionMatch as the verify packet operator for the udt::Socket
     using std::placeholders::_1;
@@ -55,6 +93,13 @@ IceServer::IceServer(int argc, char* argv[]) :
     connect(&networkAccessManager, &QNetworkAccessManager::finished, this, &IceServer::publicKeyReplyFinished);
 }
 
+IceServer::~IceServer() {
+    // the workers send with the socket, they have to be gone before it is
+    for (auto& worker : _workers) {
+        worker->stop();
+    }
+}
+
 bool IceServer::packetVersionMatch(const udt::Packet& packet) {
     PacketType headerType = NLPacket::typeInHeader(packet);
     PacketVersion headerVersion = NLPacket::versionInHeader(packet);
@@ -66,65 +111,138 @@ bool IceServer::packetVersionMatch(const udt::Packet& packet) {
     }
 }
 
-void IceServer::processPacket(std::unique_ptr<udt::Packet> packet) {
-
+void IceServer::queuePacket(std::unique_ptr<udt::Packet> packet) {
     auto nlPacket = NLPacket::fromBase(std::move(packet));
-    
-    // make sure that this packet at least looks like something we can read
-    if (nlPacket->getPayloadSize() >= NLPacket::localHeaderSize(PacketType::ICEServerHeartbeat)) {
-        
-        if (nlPacket->getType() == PacketType::ICEServerHeartbeat) {
-            SharedNetworkPeer peer = addOrUpdateHeartbeatingPeer(*nlPacket);
-            if (peer) {
-                // so that we can send packets to the heartbeating peer when we need, we need to activate a socket now
-                peer->activateMatchingOrNewSymmetricSocket(nlPacket->getSenderSockAddr());
-
-                // we have an active and verified heartbeating peer
-                // send them an ACK packet so they know that they are being heard and ready for ICE
-                static auto ackPacket = NLPacket::create(PacketType::ICEServerHeartbeatACK);
-                _serverSocket.writePacket(*ackPacket, nlPacket->getSenderSockAddr());
-            } else {
-                // we couldn't verify this peer - respond back to them so they know they may need to perform keypair re-generation
-                static auto deniedPacket = NLPacket::create(PacketType::ICEServerHeartbeatDenied);
-                _serverSocket.writePacket(*deniedPacket, nlPacket->getSenderSockAddr());
-            }
-        } else if (nlPacket->getType() == PacketType::ICEServerQuery) {
-            QDataStream heartbeatStream(nlPacket.get());
-            
-            // this is a node hoping to connect to a heartbeating peer - do we have the heartbeating peer?
-            QUuid senderUUID;
-            heartbeatStream >> senderUUID;
-            
-            // pull the public and private sock addrs for this peer
-            HifiSockAddr publicSocket, localSocket;
-            heartbeatStream >> publicSocket >> localSocket;
-            
-            // check if this node also included a UUID that they would like to connect to
-            QUuid connectRequestID;
-            heartbeatStream >> connectRequestID;
-            
-            SharedNetworkPeer matchingPeer = _activePeers.value(connectRequestID);
-            
-            if (matchingPeer) {
-                
-                qDebug() << "Sending information for peer" << connectRequestID << "to peer" << senderUUID;
-                
-                // we have the peer they want to connect to - send them pack the information for that peer
-                sendPeerInformationPacket(*matchingPeer, &nlPacket->getSenderSockAddr());
-                
-                // we also need to send them to the active peer they are hoping to connect to
-                // create a dummy peer object we can pass to sendPeerInformationPacket
-                
-                NetworkPeer dummyPeer(senderUUID, publicSocket, localSocket);
-                sendPeerInformationPacket(dummyPeer, matchingPeer->getActiveSocket());
-            } else {
-                qDebug() << "Peer" << senderUUID << "asked for" << connectRequestID << "but no matching peer found";
+
+    // both heartbeats and queries start with the ID of their sender, keeping all the packets of a sender
+    // on the same worker keeps them in order
+    size_t workerIndex = 0;
+    if (nlPacket->getPayloadSize() >= NUM_BYTES_RFC4122_UUID) {
+        workerIndex = qHash(QByteArray::fromRawData(nlPacket->getPayload(), NUM_BYTES_RFC4122_UUID)) % _workers.size();
+    }
+
+    if (!_workers[workerIndex]->push(std::move(nlPacket))) {
+        ++_numDroppedPackets;
+    }
+}
+
+bool IceServer::Worker::push(std::unique_ptr<NLPacket> packet) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_packets.size() >= MAX_QUEUED_PACKETS_PER_WORKER) {
+            return false;
+        }
+        _packets.push_back(std::move(packet));
+    }
+    _condition.notify_one();
+    return true;
+}
+
+void IceServer::Worker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _condition.notify_one();
+    wait();
+}
+
+void IceServer::Worker::run() {
+    while (true) {
+        std::deque<std::unique_ptr<NLPacket>> packets;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this] {
+                return !_packets.empty() || _isStopping;
+            });
+
+            if (_isStopping) {
+                break;
             }
+
+            // take everything that arrived since the last batch
+            packets.swap(_packets);
+        }
+
+        for (auto& packet : packets) {
+            _server.processPacket(*packet);
+        }
+    }
+}
+
+void IceServer::processPacket(NLPacket& packet) {
+    // make sure that this packet at least looks like something we can read
+    if (packet.getPayloadSize() >= NLPacket::localHeaderSize(PacketType::ICEServerHeartbeat)) {
+        if (packet.getType() == PacketType::ICEServerHeartbeat) {
+            processHeartbeat(packet);
+        } else if (packet.getType() == PacketType::ICEServerQuery) {
+            processQuery(packet);
         }
     }
 }
 
-SharedNetworkPeer IceServer::addOrUpdateHeartbeatingPeer(NLPacket& packet) {
+void IceServer::processHeartbeat(NLPacket& packet) {
+    // the reply packets are re-used, but the socket writes a sequence number in them so each worker needs its own
+    if (addOrUpdateHeartbeatingPeer(packet)) {
+        // we have an active and verified heartbeating peer
+        // send them an ACK packet so they know that they are being heard and ready for ICE
+        static thread_local auto ackPacket = NLPacket::create(PacketType::ICEServerHeartbeatACK);
+        _serverSocket.writePacket(*ackPacket, packet.getSenderSockAddr());
+    } else {
+        // we couldn't verify this peer - respond back to them so they know they may need to perform keypair re-generation
+        static thread_local auto deniedPacket = NLPacket::create(PacketType::ICEServerHeartbeatDenied);
+        _serverSocket.writePacket(*deniedPacket, packet.getSenderSockAddr());
+    }
+}
+
+void IceServer::processQuery(NLPacket& packet) {
+    QDataStream heartbeatStream(&packet);
+    
+    // this is a node hoping to connect to a heartbeating peer - do we have the heartbeating peer?
+    QUuid senderUUID;
+    heartbeatStream >> senderUUID;
+    
+    // pull the public and private sock addrs for this peer
+    HifiSockAddr publicSocket, localSocket;
+    heartbeatStream >> publicSocket >> localSocket;
+    
+    // check if this node also included a UUID that they would like to connect to
+    QUuid connectRequestID;
+    heartbeatStream >> connectRequestID;
+
+    // copy what we need out of the matching peer, a heartbeat could be updating it on another worker
+    QByteArray matchingPeerData;
+    HifiSockAddr matchingPeerSocket;
+    {
+        auto& shard = shardForPeer(connectRequestID);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        SharedNetworkPeer matchingPeer = shard.peers.value(connectRequestID);
+        if (matchingPeer && matchingPeer->getActiveSocket()) {
+            matchingPeerData = matchingPeer->toByteArray();
+            matchingPeerSocket = *matchingPeer->getActiveSocket();
+        }
+    }
+    
+    if (!matchingPeerData.isEmpty()) {
+        
+        qDebug() << "Sending information for peer" << connectRequestID << "to peer" << senderUUID;
+        
+        // we have the peer they want to connect to - send them pack the information for that peer
+        sendPeerInformationPacket(matchingPeerData, packet.getSenderSockAddr());
+        
+        // we also need to send them to the active peer they are hoping to connect to
+        // create a dummy peer object we can pass to sendPeerInformationPacket
+        
+        NetworkPeer dummyPeer(senderUUID, publicSocket, localSocket);
+        sendPeerInformationPacket(dummyPeer.toByteArray(), matchingPeerSocket);
+    } else {
+        qDebug() << "Peer" << senderUUID << "asked for" << connectRequestID << "but no matching peer found";
+    }
+}
+
+bool IceServer::addOrUpdateHeartbeatingPeer(NLPacket& packet) {
 
     // pull the UUID, public and private sock addrs for this peer
     QUuid senderUUID;
@@ -137,92 +255,170 @@ SharedNetworkPeer IceServer::addOrUpdateHeartbeatingPeer(NLPacket& packet) {
     auto signedPlaintext = QByteArray::fromRawData(packet.getPayload(), heartbeatStream.device()->pos());
     heartbeatStream >> signature;
 
+    auto& shard = shardForPeer(senderUUID);
+
     // make sure this is a verified heartbeat before performing any more processing
-    if (isVerifiedHeartbeat(senderUUID, signedPlaintext, signature)) {
-        // make sure we have this sender in our peer hash
-        SharedNetworkPeer matchingPeer = _activePeers.value(senderUUID);
+    if (!isVerifiedHeartbeat(shard, senderUUID, signedPlaintext, signature)) {
+        return false;
+    }
 
-        if (!matchingPeer) {
-            // if we don't have this sender we need to create them now
-            matchingPeer = QSharedPointer<NetworkPeer>::create(senderUUID, publicSocket, localSocket);
-            _activePeers.insert(senderUUID, matchingPeer);
+    std::lock_guard<std::mutex> lock(shard.mutex);
 
-            qDebug() << "Added a new network peer" << *matchingPeer;
-        } else {
-            // we already had the peer so just potentially update their sockets
-            matchingPeer->setPublicSocket(publicSocket);
-            matchingPeer->setLocalSocket(localSocket);
-        }
+    // make sure we have this sender in our peer hash
+    SharedNetworkPeer matchingPeer = shard.peers.value(senderUUID);
 
-        // update our last heard microstamp for this network peer to now
-        matchingPeer->setLastHeardMicrostamp(usecTimestampNow());
-        
-        return matchingPeer;
+    if (!matchingPeer) {
+        // if we don't have this sender we need to create them now
+        matchingPeer = QSharedPointer<NetworkPeer>::create(senderUUID, publicSocket, localSocket);
+        shard.peers.insert(senderUUID, matchingPeer);
+
+        qDebug() << "Added a new network peer" << *matchingPeer;
     } else {
-        // not verified, return the empty peer object
-        return SharedNetworkPeer();
+        // we already had the peer so just potentially update their sockets
+        matchingPeer->setPublicSocket(publicSocket);
+        matchingPeer->setLocalSocket(localSocket);
     }
+
+    // so that we can send packets to the heartbeating peer when we need, we need to activate a socket now
+    matchingPeer->activateMatchingOrNewSymmetricSocket(packet.getSenderSockAddr());
+
+    // update our last heard microstamp for this network peer to now
+    matchingPeer->setLastHeardMicrostamp(usecTimestampNow());
+
+    return true;
 }
 
-bool IceServer::isVerifiedHeartbeat(const QUuid& domainID, const QByteArray& plaintext, const QByteArray& signature) {
-    // make sure we're not already waiting for a public key for this domain-server
-    if (!_pendingPublicKeyRequests.contains(domainID)) {
-        // check if we have a public key for this domain ID - if we do not then fire off the request for it
+bool IceServer::isVerifiedHeartbeat(PeerShard& shard, const QUuid& domainID,
+                                    const QByteArray& plaintext, const QByteArray& signature) {
+    RSASharedPtr rsaPublicKey;
+    {
+        std::lock_guard<std::mutex> lock(_publicKeysMutex);
+
+        // make sure we're not already waiting for a public key for this domain-server
+        if (_pendingPublicKeyRequests.contains(domainID)) {
+            return false;
+        }
+
         auto it = _domainPublicKeys.find(domainID);
         if (it != _domainPublicKeys.end()) {
+            rsaPublicKey = it->second;
+        }
+    }
 
-            // attempt to verify the signature for this heartbeat
-            const auto rsaPublicKey = it->second.get();
-
-            if (rsaPublicKey) {
-                auto hashedPlaintext = QCryptographicHash::hash(plaintext, QCryptographicHash::Sha256);
-                int verificationResult = RSA_verify(NID_sha256,
-                                                    reinterpret_cast<const unsigned char*>(hashedPlaintext.constData()),
-                                                    hashedPlaintext.size(),
-                                                    reinterpret_cast<const unsigned char*>(signature.constData()),
-                                                    signature.size(),
-                                                    rsaPublicKey);
-
-                if (verificationResult == 1) {
-                    // this is the only success case - we return true here to indicate that the heartbeat is verified
-                    return true;
-                } else {
-                    qDebug() << "Failed to verify heartbeat for" << domainID << "- re-requesting public key from API.";
-                }
+    // check if we have a public key for this domain ID - if we do not then fire off the request for it
+    if (!rsaPublicKey) {
+        requestDomainPublicKey(domainID);
+        return false;
+    }
 
-            } else {
-                // we can't let this user in since we couldn't convert their public key to an RSA key we could use
-                qWarning() << "Public key for" << domainID << "is not a usable RSA* public key.";
-                qWarning() << "Re-requesting public key from API";
-            }
+    auto now = usecTimestampNow();
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // skip the RSA verification if we already verified this exact heartbeat with this key not long ago
+        auto it = shard.verifiedHeartbeats.find(domainID);
+        if (it != shard.verifiedHeartbeats.end() && it->publicKey == rsaPublicKey
+            && now - it->verifiedAt < VERIFIED_HEARTBEAT_WINDOW_USECS
+            && it->plaintext == plaintext && it->signature == signature) {
+            return true;
         }
+    }
 
-        // we could not verify this heartbeat (missing public key, could not load public key, bad actor)
-        // ask the metaverse API for the right public key and return false to indicate that this is not verified
-        requestDomainPublicKey(domainID);
+    // attempt to verify the signature for this heartbeat
+    auto hashedPlaintext = QCryptographicHash::hash(plaintext, QCryptographicHash::Sha256);
+    int verificationResult = RSA_verify(NID_sha256,
+                                        reinterpret_cast<const unsigned char*>(hashedPlaintext.constData()),
+                                        hashedPlaintext.size(),
+                                        reinterpret_cast<const unsigned char*>(signature.constData()),
+                                        signature.size(),
+                                        rsaPublicKey.get());
+
+    if (verificationResult == 1) {
+        // this is the only success case - we return true here to indicate that the heartbeat is verified
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto& verifiedHeartbeat = shard.verifiedHeartbeats[domainID];
+        verifiedHeartbeat.publicKey = rsaPublicKey;
+        verifiedHeartbeat.plaintext = QByteArray(plaintext.constData(), plaintext.size()); // deep copy, it's packet data
+        verifiedHeartbeat.signature = signature;
+        verifiedHeartbeat.verifiedAt = now;
+
+        return true;
     }
 
+    qDebug() << "Failed to verify heartbeat for" << domainID << "- re-requesting public key from API.";
+
+    // we could not verify this heartbeat (could not load public key, bad actor)
+    // ask the metaverse API for the right public key and return false to indicate that this is not verified
+    requestDomainPublicKey(domainID);
+
     return false;
 }
 
 void IceServer::requestDomainPublicKey(const QUuid& domainID) {
-    // send a request to the metaverse API for the public key for this domain
-    auto& networkAccessManager = NetworkAccessManager::getInstance();
+    {
+        std::lock_guard<std::mutex> lock(_publicKeysMutex);
+
+        // keys from the command line aren't replaced, and there is only one request for a domain at a time
+        if (_preloadedPublicKeys.contains(domainID) || _pendingPublicKeyRequests.contains(domainID)) {
+            return;
+        }
+
+        // add this to the set of pending public key requests
+        _pendingPublicKeyRequests.insert(domainID);
+    }
 
-    QUrl publicKeyURL { NetworkingConstants::METAVERSE_SERVER_URL() };
-    QString publicKeyPath = QString("/api/v1/domains/%1/public_key").arg(uuidStringWithoutCurlyBraces(domainID));
-    publicKeyURL.setPath(publicKeyPath);
+    // the replies are handled by the network access manager of the main thread, so that's where the request is made
+    QMetaObject::invokeMethod(this, [domainID] {
+        // send a request to the metaverse API for the public key for this domain
+        auto& networkAccessManager = NetworkAccessManager::getInstance();
 
-    QNetworkRequest publicKeyRequest { publicKeyURL };
-    publicKeyRequest.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
-    publicKeyRequest.setAttribute(QNetworkRequest::User, domainID);
+        QUrl publicKeyURL { NetworkingConstants::METAVERSE_SERVER_URL() };
+        QString publicKeyPath = QString("/api/v1/domains/%1/public_key").arg(uuidStringWithoutCurlyBraces(domainID));
+        publicKeyURL.setPath(publicKeyPath);
 
-    qDebug() << "Requesting public key for domain with ID" << domainID;
+        QNetworkRequest publicKeyRequest { publicKeyURL };
+        publicKeyRequest.setAttribute(QNetworkRequest::FollowRedirectsAttribute, true);
+        publicKeyRequest.setAttribute(QNetworkRequest::User, domainID);
 
-    // add this to the set of pending public key requests
-    _pendingPublicKeyRequests.insert(domainID);
+        qDebug() << "Requesting public key for domain with ID" << domainID;
 
-    networkAccessManager.get(publicKeyRequest);
+        networkAccessManager.get(publicKeyRequest);
+    });
+}
+
+void IceServer::loadPublicKeys(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open public keys file" << path;
+        return;
+    }
+
+    static const QString PUBLIC_KEY_KEY = "public_key";
+
+    auto keysObject = QJsonDocument::fromJson(file.readAll()).object();
+
+    std::lock_guard<std::mutex> lock(_publicKeysMutex);
+
+    for (auto it = keysObject.begin(); it != keysObject.end(); ++it) {
+        QUuid domainID(it.key());
+        auto publicKey = QByteArray::fromBase64(it.value().toObject()[PUBLIC_KEY_KEY].toString().toUtf8());
+        const unsigned char* publicKeyData = reinterpret_cast<const unsigned char*>(publicKey.constData());
+
+        RSA* rsaPublicKey = d2i_RSA_PUBKEY(NULL, &publicKeyData, publicKey.size());
+
+        if (domainID.isNull() || !rsaPublicKey) {
+            qWarning() << "Skipping unusable public key for" << it.key() << "in" << path;
+            RSA_free(rsaPublicKey);
+            continue;
+        }
+
+        _domainPublicKeys[domainID] = RSASharedPtr(rsaPublicKey, RSA_free);
+        _preloadedPublicKeys.insert(domainID);
+    }
+
+    qDebug() << "Loaded" << _preloadedPublicKeys.size() << "public keys from" << path;
 }
 
 void IceServer::publicKeyReplyFinished(QNetworkReply* reply) {
@@ -254,7 +450,8 @@ void IceServer::publicKeyReplyFinished(QNetworkReply* reply) {
                 RSA* rsaPublicKey = d2i_RSA_PUBKEY(NULL, &publicKeyData, apiPublicKey.size());
 
                 if (rsaPublicKey) {
-                    _domainPublicKeys[domainID] = { rsaPublicKey, RSA_free };
+                    std::lock_guard<std::mutex> lock(_publicKeysMutex);
+                    _domainPublicKeys[domainID] = RSASharedPtr(rsaPublicKey, RSA_free);
                 } else {
                     qWarning() << "Could not convert in-memory public key for" << domainID << "to usable RSA public key.";
                     qWarning() << "Public key will be re-requested on next heartbeat.";
@@ -275,38 +472,63 @@ void IceServer::publicKeyReplyFinished(QNetworkReply* reply) {
     }
 
     // remove this domain ID from the list of pending public key requests
-    _pendingPublicKeyRequests.remove(domainID);
+    {
+        std::lock_guard<std::mutex> lock(_publicKeysMutex);
+        _pendingPublicKeyRequests.remove(domainID);
+    }
 
     reply->deleteLater();
 }
 
-void IceServer::sendPeerInformationPacket(const NetworkPeer& peer, const HifiSockAddr* destinationSockAddr) {
+void IceServer::sendPeerInformationPacket(const QByteArray& peerData, const HifiSockAddr& destinationSockAddr) {
     auto peerPacket = NLPacket::create(PacketType::ICEServerPeerInformation);
 
-    // get the byte array for this peer
-    peerPacket->write(peer.toByteArray());
+    // write the byte array for this peer
+    peerPacket->write(peerData);
     
     // write the current packet
-    _serverSocket.writePacket(*peerPacket, *destinationSockAddr);
+    _serverSocket.writePacket(*peerPacket, destinationSockAddr);
 }
 
 void IceServer::clearInactivePeers() {
-    NetworkPeerHash::iterator peerItem = _activePeers.begin();
+    std::vector<QUuid> inactivePeerIDs;
 
-    while (peerItem != _activePeers.end()) {
-        SharedNetworkPeer peer = peerItem.value();
+    for (auto& shard : _peerShards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
 
-        if ((usecTimestampNow() - peer->getLastHeardMicrostamp()) > (PEER_SILENCE_THRESHOLD_MSECS * 1000)) {
-            qDebug() << "Removing peer from memory for inactivity -" << *peer;
+        auto peerItem = shard.peers.begin();
 
-            // if we had a public key for this domain, remove it now
-            _domainPublicKeys.erase(peer->getUUID());
+        while (peerItem != shard.peers.end()) {
+            SharedNetworkPeer peer = peerItem.value();
 
-            // remove the peer object
-            peerItem = _activePeers.erase(peerItem);
-        } else {
-            // we didn't kill this peer, push the iterator forwards
-            ++peerItem;
+            if ((usecTimestampNow() - peer->getLastHeardMicrostamp()) > (PEER_SILENCE_THRESHOLD_MSECS * 1000)) {
+                qDebug() << "Removing peer from memory for inactivity -" << *peer;
+
+                inactivePeerIDs.push_back(peer->getUUID());
+                shard.verifiedHeartbeats.remove(peer->getUUID());
+
+                // remove the peer object
+                peerItem = shard.peers.erase(peerItem);
+            } else {
+                // we didn't kill this peer, push the iterator forwards
+                ++peerItem;
+            }
         }
     }
+
+    if (!inactivePeerIDs.empty()) {
+        std::lock_guard<std::mutex> lock(_publicKeysMutex);
+
+        // if we had a public key for this domain, remove it now
+        for (auto& peerID : inactivePeerIDs) {
+            if (!_preloadedPublicKeys.contains(peerID)) {
+                _domainPublicKeys.erase(peerID);
+            }
+        }
+    }
+
+    int numDroppedPackets = _numDroppedPackets.exchange(0);
+    if (numDroppedPackets > 0) {
+        qWarning() << "Dropped" << numDroppedPackets << "packets that arrived faster than they could be processed";
+    }
 }
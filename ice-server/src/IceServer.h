@@ -12,8 +12,18 @@
 #ifndef hifi_IceServer_h
 #define hifi_IceServer_h
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <QtCore/QCoreApplication>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QThread>
 #include <QUdpSocket>
 
 #include <openssl/rsa.h>
@@ -32,30 +42,78 @@ class IceServer : public QCoreApplication {
     Q_OBJECT
 public:
     IceServer(int argc, char* argv[]);
+    ~IceServer();
 private slots:
     void clearInactivePeers();
     void publicKeyReplyFinished(QNetworkReply* reply);
 private:
+    using RSASharedPtr = std::shared_ptr<RSA>;
+
+    // A domain signs the same plaintext in every heartbeat until its sockets change, so a signature that was
+    // verified with the domain's current public key is trusted again without RSA until the window it was verified in
+    // is over.
+    struct VerifiedHeartbeat {
+        RSASharedPtr publicKey;
+        QByteArray plaintext;
+        QByteArray signature;
+        quint64 verifiedAt { 0 };
+    };
+
+    // The peers are spread over shards by ID, so that the workers rarely wait on each other.
+    struct PeerShard {
+        std::mutex mutex;
+        QHash<QUuid, SharedNetworkPeer> peers;
+        QHash<QUuid, VerifiedHeartbeat> verifiedHeartbeats;
+    };
+
+    // Processes the packets the socket thread hands it, a whole batch at a time.
+    class Worker : public QThread {
+    public:
+        Worker(IceServer& server) : _server(server) {}
+
+        bool push(std::unique_ptr<NLPacket> packet); // false if the backlog is full and the packet was dropped
+        void stop();
+
+        void run() override;
+
+    private:
+        IceServer& _server;
+
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::deque<std::unique_ptr<NLPacket>> _packets; // guarded by _mutex
+        bool _isStopping { false }; // guarded by _mutex
+    };
+
     bool packetVersionMatch(const udt::Packet& packet);
-    void processPacket(std::unique_ptr<udt::Packet> packet);
-    
-    SharedNetworkPeer addOrUpdateHeartbeatingPeer(NLPacket& incomingPacket);
-    void sendPeerInformationPacket(const NetworkPeer& peer, const HifiSockAddr* destinationSockAddr);
+    void queuePacket(std::unique_ptr<udt::Packet> packet);
+    void processPacket(NLPacket& packet);
+    void processHeartbeat(NLPacket& packet);
+    void processQuery(NLPacket& packet);
 
-    bool isVerifiedHeartbeat(const QUuid& domainID, const QByteArray& plaintext, const QByteArray& signature);
+    bool addOrUpdateHeartbeatingPeer(NLPacket& incomingPacket);
+    void sendPeerInformationPacket(const QByteArray& peerData, const HifiSockAddr& destinationSockAddr);
+
+    bool isVerifiedHeartbeat(PeerShard& shard, const QUuid& domainID,
+                             const QByteArray& plaintext, const QByteArray& signature);
     void requestDomainPublicKey(const QUuid& domainID);
+    void loadPublicKeys(const QString& path);
+
+    PeerShard& shardForPeer(const QUuid& peerID) { return _peerShards[qHash(peerID) % NUM_PEER_SHARDS]; }
 
     QUuid _id;
     udt::Socket _serverSocket;
 
-    using NetworkPeerHash = QHash<QUuid, SharedNetworkPeer>;
-    NetworkPeerHash _activePeers;
+    static const int NUM_PEER_SHARDS = 64;
+    std::array<PeerShard, NUM_PEER_SHARDS> _peerShards;
 
-    using RSAUniquePtr = std::unique_ptr<RSA, std::function<void(RSA*)>>;
-    using DomainPublicKeyHash = std::unordered_map<QUuid, RSAUniquePtr>;
-    DomainPublicKeyHash _domainPublicKeys;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::atomic<int> _numDroppedPackets { 0 };
 
-    QSet<QUuid> _pendingPublicKeyRequests;
+    std::mutex _publicKeysMutex;
+    std::unordered_map<QUuid, RSASharedPtr> _domainPublicKeys; // guarded by _publicKeysMutex
+    QSet<QUuid> _pendingPublicKeyRequests; // guarded by _publicKeysMutex
+    QSet<QUuid> _preloadedPublicKeys; // given on the command line, they are kept while their domain is inactive
 };
 
 #endif // hifi_IceServer_h
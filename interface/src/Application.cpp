@@ -6918,6 +6918,7 @@ void Application::queryOctree(NodeType_t serverType, PacketType packetType) {
         _octreeQuery.setBoundaryLevelAdjust(lodManager->getBoundaryLevelAdjust());
     }
     _octreeQuery.setReportInitialCompletion(isModifiedQuery);
+    _octreeQuery.setSendsNacks(true); // see sendNackPackets
 
 
     auto nodeList = DependencyManager::get<NodeList>();
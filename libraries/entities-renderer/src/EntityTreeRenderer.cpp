@@ -163,6 +163,12 @@ void EntityTreeRenderer::resetEntitiesScriptEngine() {
                                                 QString("about:Entities %1").arg(++_entitiesScriptEngineCount));
     DependencyManager::get<ScriptEngines>()->runScriptInitializers(_entitiesScriptEngine);
     _entitiesScriptEngine->runInThread();
+
+    // the entity script budgets are off unless they are set
+    static Setting::Handle<int> softBudgetMsecsPerSecond { "entityScriptSoftBudgetMsecsPerSecond", 0 };
+    static Setting::Handle<int> hardBudgetMsecs { "entityScriptHardBudgetMsecs", 0 };
+    _entitiesScriptEngine->setEntityScriptBudgets(softBudgetMsecsPerSecond.get(), hardBudgetMsecs.get());
+
     auto entitiesScriptEngineProvider = qSharedPointerCast<EntitiesScriptEngineProvider>(_entitiesScriptEngine);
     auto entityScriptingInterface = DependencyManager::get<EntityScriptingInterface>();
     entityScriptingInterface->setEntitiesScriptEngine(entitiesScriptEngineProvider);
@@ -73,6 +73,10 @@ public:
 
     void reset() { _path.clear(); _completedView.startTime = 0; } // resets our state to force a new "First" traversal
 
+    // Ends the current traversal as if the view was traversed at its startTime, for a scene sent by other means. The
+    // next traversal finds what changed since then.
+    void setCompletedView(const View& view) { _path.clear(); _currentView = view; _completedView = view; }
+
 private:
     void getNextVisibleElement(VisibleElement& next);
 
@@ -0,0 +1,49 @@
+//
+//  EntityDeltaBaseline.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityDeltaBaseline.h"
+
+#include <NumericalConstants.h>
+
+#include "EntityItem.h"
+
+const uint64_t EntityDeltaBaseline::SETTLE_PERIOD = 2 * USECS_PER_SECOND;
+const uint64_t EntityDeltaBaseline::REFRESH_PERIOD = 10 * USECS_PER_SECOND;
+
+quint64 EntityDeltaBaseline::getDeltaVersion(const EntityItem& entity, uint64_t now, bool viewerSendsNacks,
+                                             bool& isNewBaseline) const {
+    // a baseline sent unreliably is only worth sending to a viewer that would ask for it again if it were lost
+    bool canSendBaseline = viewerSendsNacks;
+
+    bool hasBaseline = _version != 0 && (_isReliable || viewerSendsNacks);
+    if (hasBaseline && !_isReliable && now > _sendTime + REFRESH_PERIOD) {
+        hasBaseline = false;
+    }
+
+    EntityPropertyFlags changedProperties;
+    if (!hasBaseline || !entity.getPropertiesChangedSince(_version, changedProperties)) {
+        isNewBaseline = canSendBaseline;
+        return 0;
+    }
+
+    // the viewer may not have the baseline yet, the changes made meanwhile are sent whole without replacing it
+    isNewBaseline = false;
+    if (now < _sendTime + SETTLE_PERIOD) {
+        return 0;
+    }
+
+    return _version;
+}
+
+void EntityDeltaBaseline::baselineSent(quint64 propertiesVersion, uint64_t sendTime, bool isReliable) {
+    _version = propertiesVersion;
+    _sendTime = sendTime;
+    _isReliable = isReliable;
+}
@@ -0,0 +1,53 @@
+//
+//  EntityDeltaBaseline.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityDeltaBaseline_h
+#define hifi_EntityDeltaBaseline_h
+
+#include <stdint.h>
+
+#include <QtCore/QtGlobal>
+
+class EntityItem;
+
+// What a viewer of an entity-server is known to have of an entity: the version of the properties it was last sent all
+// of. Once the viewer has it, it is only sent the properties changed since that version.
+//
+// Nothing confirms that the viewer received an entity packet, so a baseline is only relied on if either
+//  - it was sent reliably (the initial scene), or
+//  - the viewer NACKs the packets it misses, and then only for REFRESH_PERIOD: NACKs are best effort, and a lost
+//    baseline would leave the viewer with default values for the properties that didn't change since. The entity is
+//    sent whole again once the period is over, which is the new baseline.
+// Viewers that don't NACK (agents, the entity script server) are sent everything unreliable entity packets carry.
+class EntityDeltaBaseline {
+public:
+    // time for the packets that carried a baseline to be NACKed and resent, or for a reliable message to arrive ahead
+    // of the unreliable packets sent after it
+    static const uint64_t SETTLE_PERIOD;
+
+    // how long a baseline that was sent unreliably is relied on
+    static const uint64_t REFRESH_PERIOD;
+
+    // The version of the properties the viewer can be sent the changes since, 0 to send all of them.
+    // isNewBaseline is set if all of them are to be sent so that they become the new baseline.
+    quint64 getDeltaVersion(const EntityItem& entity, uint64_t now, bool viewerSendsNacks, bool& isNewBaseline) const;
+
+    // the properties at this version were sent whole to be the new baseline
+    void baselineSent(quint64 propertiesVersion, uint64_t sendTime, bool isReliable);
+
+    quint64 getVersion() const { return _version; }
+
+private:
+    quint64 _version { 0 }; // 0 until all of the properties were sent
+    uint64_t _sendTime { 0 };
+    bool _isReliable { false };
+};
+
+#endif // hifi_EntityDeltaBaseline_h
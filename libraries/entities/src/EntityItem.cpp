@@ -48,6 +48,10 @@ int entityItemPointernMetaTypeId = qRegisterMetaType<EntityItemPointer>();
 
 int EntityItem::_maxActionsDataSize = 800;
 quint64 EntityItem::_rememberDeletedActionTime = 20 * USECS_PER_SECOND;
+bool EntityItem::_encodeCacheEnabled = false;
+std::atomic<quint64> EntityItem::_encodeCacheHits { 0 };
+std::atomic<quint64> EntityItem::_encodeCacheMisses { 0 };
+std::atomic<quint64> EntityItem::_encodeCacheBytesCopied { 0 };
 QString EntityItem::_marketplacePublicKey;
 
 std::function<glm::quat(const glm::vec3&, const glm::quat&, BillboardMode, const glm::vec3&)> EntityItem::_getBillboardRotationOperator = [](const glm::vec3&, const glm::quat& rotation, BillboardMode, const glm::vec3&) { return rotation; };
@@ -156,7 +160,8 @@ EntityPropertyFlags EntityItem::getEntityProperties(EncodeBitstreamParams& param
 
 OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packetData, EncodeBitstreamParams& params,
                                             EntityTreeElementExtraEncodeDataPointer entityTreeElementExtraEncodeData,
-                                            const bool destinationNodeCanGetAndSetPrivateUserData) const {
+                                            const bool destinationNodeCanGetAndSetPrivateUserData,
+                                            quint64 knownPropertiesVersion) const {
 
     // ALL this fits...
     //    object ID [16 bytes]
@@ -194,12 +199,51 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
     requestedProperties -= PROP_OWNING_AVATAR_ID;
     requestedProperties -= PROP_VISIBLE_IN_SECONDARY_CAMERA;
 
+    // a destination that already knows this entity only needs what changed since the version it has
+    EntityPropertyFlags changedProperties;
+    if (knownPropertiesVersion > 0 && getPropertiesChangedSince(knownPropertiesVersion, changedProperties)) {
+        // motion is extrapolated from the position, rotation and derivatives together, keep them consistent
+        static const EntityPropertyFlags MOTION_PROPERTIES = EntityPropertyFlags(PROP_PARENT_ID) + PROP_PARENT_JOINT_INDEX +
+            PROP_POSITION + PROP_ROTATION + PROP_QUERY_AA_CUBE + PROP_VELOCITY + PROP_ANGULAR_VELOCITY + PROP_ACCELERATION;
+        if (!(changedProperties & MOTION_PROPERTIES).isEmpty()) {
+            changedProperties += MOTION_PROPERTIES;
+        }
+
+        // the entity-server is authoritative for the simulation owner, which also changes without edits
+        changedProperties += PROP_SIMULATION_OWNER;
+
+        requestedProperties &= changedProperties;
+    }
+
     // If we are being called for a subsequent pass at appendEntityData() that failed to completely encode this item,
     // then our entityTreeElementExtraEncodeData should include data about which properties we need to append.
-    if (entityTreeElementExtraEncodeData && entityTreeElementExtraEncodeData->entities.contains(getEntityItemID())) {
+    bool isContinuation = entityTreeElementExtraEncodeData &&
+        entityTreeElementExtraEncodeData->entities.contains(getEntityItemID());
+    if (isContinuation) {
         requestedProperties = entityTreeElementExtraEncodeData->entities.value(getEntityItemID());
     }
 
+    // the rest of an entity split over packets is never cached, it depends on where the packet was full
+    bool useEncodeCache = _encodeCacheEnabled && !isContinuation;
+    EncodeCacheStamp encodeCacheStamp;
+    if (useEncodeCache) {
+        encodeCacheStamp = getEncodeCacheStamp();
+        QByteArray encodedData = findEncodedData(encodeCacheStamp, requestedProperties,
+                                                 destinationNodeCanGetAndSetPrivateUserData);
+
+        if (!encodedData.isEmpty()) {
+            // if it doesn't fit whole anymore, encode it again to send what fits
+            if (packetData->appendRawData(encodedData)) {
+                _encodeCacheHits++;
+                _encodeCacheBytesCopied += encodedData.size();
+                params.trackSend(getID(), getLastEdited());
+                return appendState;
+            }
+        } else {
+            _encodeCacheMisses++;
+        }
+    }
+
     QString privateUserData = "";
     if (destinationNodeCanGetAndSetPrivateUserData) {
         privateUserData = getPrivateUserData();
@@ -207,6 +251,7 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
 
     EntityPropertyFlags propertiesDidntFit = requestedProperties;
 
+    int entityOffset = packetData->getUncompressedByteOffset();
     LevelDetails entityLevel = packetData->startLevel();
 
     quint64 lastEdited = getLastEdited();
@@ -379,6 +424,13 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
         }
 
         packetData->endLevel(entityLevel);
+
+        // keep it for the next destination, unless it was changed while being encoded
+        if (useEncodeCache && appendState == OctreeElement::COMPLETED && getEncodeCacheStamp() == encodeCacheStamp) {
+            int encodedSize = packetData->getUncompressedByteOffset() - entityOffset;
+            QByteArray encodedData((const char*)packetData->getUncompressedData(entityOffset), encodedSize);
+            storeEncodedData(encodeCacheStamp, requestedProperties, destinationNodeCanGetAndSetPrivateUserData, encodedData);
+        }
     } else {
         packetData->discardLevel(entityLevel);
         appendState = OctreeElement::NONE; // if we got here, then we didn't include the item
@@ -1552,7 +1604,8 @@ bool EntityItem::setProperties(const EntityItemProperties& properties) {
     SET_ENTITY_PROPERTY_FROM_PROPERTIES(certificateType, setCertificateType);
     SET_ENTITY_PROPERTY_FROM_PROPERTIES(staticCertificateVersion, setStaticCertificateVersion);
 
-    if (updateQueryAACube()) {
+    bool queryAACubeChanged = updateQueryAACube();
+    if (queryAACubeChanged) {
         somethingChanged = true;
     }
 
@@ -1561,6 +1614,12 @@ bool EntityItem::setProperties(const EntityItemProperties& properties) {
 
     // Finally notify if change detected
     if (somethingChanged) {
+        EntityPropertyFlags changedProperties = properties.getChangedProperties();
+        if (queryAACubeChanged) {
+            changedProperties += PROP_QUERY_AA_CUBE;
+        }
+        markPropertiesChanged(changedProperties);
+
         uint64_t now = usecTimestampNow();
         #ifdef WANT_DEBUG
             int elapsed = now - getLastEdited();
@@ -2655,33 +2714,19 @@ void EntityItem::globalizeProperties(EntityItemProperties& properties, const QSt
 }
 
 
-bool EntityItem::matchesJSONFilters(const QJsonObject& jsonFilters) const {
-
-    // The intention for the query JSON filter and this method is to be flexible to handle a variety of filters for
-    // ALL entity properties. Some work will need to be done to the property system so that it can be more flexible
-    // (to grab the value and default value of a property given the string representation of that property, for example)
-
-    // currently the only property filter we handle in EntityItem is '+' for serverScripts
-    // which means that we only handle a filtered query asking for entities where the serverScripts property is non-default
-
-    static const QString SERVER_SCRIPTS_PROPERTY = "serverScripts";
-    static const QString ENTITY_TYPE_PROPERTY = "type";
-
-    foreach(const auto& property, jsonFilters.keys()) {
-        if (property == SERVER_SCRIPTS_PROPERTY && jsonFilters[property] == EntityQueryFilterSymbol::NonDefault) {
+bool EntityItem::matchesJSONFilters(const EntityJSONFilter& jsonFilter) const {
+    switch (jsonFilter.getTest()) {
+        case EntityJSONFilter::Test::NonDefaultServerScripts:
             // check if this entity has a non-default value for serverScripts
-            if (_serverScripts != ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS) {
-                return true;
-            } else {
-                return false;
-            }
-        } else if (property == ENTITY_TYPE_PROPERTY) {
-            return (jsonFilters[property] == EntityTypes::getEntityTypeName(getType()) );
-        }
+            return _serverScripts != ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS;
+        case EntityJSONFilter::Test::Type:
+            return getType() == jsonFilter.getType();
+        case EntityJSONFilter::Test::Nothing:
+            return false;
+        case EntityJSONFilter::Test::None:
+        default:
+            return true;
     }
-
-    // the json filter syntax did not match what we expected, return a match
-    return true;
 }
 
 quint64 EntityItem::getLastSimulated() const {
@@ -2718,6 +2763,109 @@ void EntityItem::setLastEdited(quint64 lastEdited) {
 void EntityItem::markAsChangedOnServer() {
     withWriteLock([&] {
         _changedOnServer = usecTimestampNow();
+
+        _allPropertiesChangedVersion = ++_propertiesVersion;
+        _propertyVersions.clear();
+    });
+    journalChangeOnServer();
+}
+
+void EntityItem::markAsChangedOnServer(const EntityPropertyFlags& changedProperties) {
+    withWriteLock([&] {
+        _changedOnServer = usecTimestampNow();
+    });
+    markPropertiesChanged(changedProperties);
+    journalChangeOnServer();
+}
+
+void EntityItem::journalChangeOnServer() {
+    // the changes the server makes on its own, like those of the simulation, are persisted as the edits are
+    if (auto tree = getTree()) {
+        tree->journalEntityChange(getEntityItemID(), getThisPointer());
+    }
+}
+
+void EntityItem::markPropertiesChanged(const EntityPropertyFlags& changedProperties) {
+    if (changedProperties.isEmpty()) {
+        return;
+    }
+
+    withWriteLock([&] {
+        quint64 version = ++_propertiesVersion;
+        for (int property = changedProperties.firstFlag(); property <= changedProperties.lastFlag(); ++property) {
+            if (changedProperties.getHasProperty((EntityPropertyList)property)) {
+                _propertyVersions[property] = version;
+            }
+        }
+    });
+}
+
+EntityItem::EncodeCacheStamp EntityItem::getEncodeCacheStamp() const {
+    EncodeCacheStamp stamp;
+    withReadLock([&] {
+        stamp.propertiesVersion = _propertiesVersion;
+        stamp.lastEdited = _lastEdited;
+        stamp.lastUpdated = _lastUpdated;
+        stamp.lastSimulated = _lastSimulated;
+    });
+    return stamp;
+}
+
+QByteArray EntityItem::findEncodedData(const EncodeCacheStamp& stamp, const EntityPropertyFlags& requestedProperties,
+                                       bool withPrivateUserData) const {
+    std::lock_guard<std::mutex> lock(_encodeCacheMutex);
+
+    if (_encodeCacheStamp == stamp) {
+        for (auto& encoded : _encodeCache) {
+            if (encoded.withPrivateUserData == withPrivateUserData && encoded.requestedProperties == requestedProperties) {
+                return encoded.data;
+            }
+        }
+    }
+    return QByteArray();
+}
+
+void EntityItem::storeEncodedData(const EncodeCacheStamp& stamp, const EntityPropertyFlags& requestedProperties,
+                                  bool withPrivateUserData, const QByteArray& data) const {
+    // the whole state with and without the private user data, and a couple of deltas
+    const size_t MAX_ENCODED_DATA = 4;
+
+    std::lock_guard<std::mutex> lock(_encodeCacheMutex);
+
+    if (!(_encodeCacheStamp == stamp)) {
+        // edited since, what is cached is stale
+        _encodeCacheStamp = stamp;
+        _encodeCache.clear();
+        _nextEncodeCacheSlot = 0;
+    }
+
+    EncodedData encoded { requestedProperties, withPrivateUserData, data };
+    if (_encodeCache.size() < MAX_ENCODED_DATA) {
+        _encodeCache.push_back(encoded);
+    } else {
+        _encodeCache[_nextEncodeCacheSlot] = encoded;
+        _nextEncodeCacheSlot = (_nextEncodeCacheSlot + 1) % MAX_ENCODED_DATA;
+    }
+}
+
+quint64 EntityItem::getPropertiesVersion() const {
+    return resultWithReadLock<quint64>([&] {
+        return _propertiesVersion;
+    });
+}
+
+bool EntityItem::getPropertiesChangedSince(quint64 version, EntityPropertyFlags& changedProperties) const {
+    return resultWithReadLock<bool>([&] {
+        if (version < _allPropertiesChangedVersion) {
+            return false;
+        }
+
+        for (auto& propertyVersion : _propertyVersions) {
+            if (propertyVersion.second > version) {
+                changedProperties += (EntityPropertyList)propertyVersion.first;
+            }
+        }
+        return true;
     });
 }
 
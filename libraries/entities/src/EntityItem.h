@@ -12,8 +12,12 @@
 #ifndef hifi_EntityItem_h
 #define hifi_EntityItem_h
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -32,6 +36,7 @@
 
 #include "EntityItemID.h"
 #include "EntityItemPropertiesDefaults.h"
+#include "EntityJSONFilter.h"
 #include "EntityPropertyFlags.h"
 #include "EntityTypes.h"
 #include "SimulationOwner.h"
@@ -130,14 +135,26 @@ public:
     quint64 getLastBroadcast() const { return _lastBroadcast; }
     void setLastBroadcast(quint64 lastBroadcast) { _lastBroadcast = lastBroadcast; }
 
-    void markAsChangedOnServer();
+    // also has the entity journaled by its tree
+    void markAsChangedOnServer(); // anything may have changed
+    void markAsChangedOnServer(const EntityPropertyFlags& changedProperties);
     quint64 getLastChangedOnServer() const;
 
+    // The properties are versioned so that only what changed is sent to those that already know the entity:
+    // setProperties() bumps the version of the properties it changes, markAsChangedOnServer() of the ones it is given.
+    quint64 getPropertiesVersion() const;
+    // Returns false if anything may have changed since the given version, otherwise what did.
+    bool getPropertiesChangedSince(quint64 version, EntityPropertyFlags& changedProperties) const;
+
     virtual EntityPropertyFlags getEntityProperties(EncodeBitstreamParams& params) const;
 
+    // knownPropertiesVersion is the version of the properties the destination already has, 0 to send them all
+    // With the encode cache enabled, the encoded entity is kept and copied to the next destination that requests the
+    // same properties of the same state, instead of being encoded again.
     virtual OctreeElement::AppendState appendEntityData(OctreePacketData* packetData, EncodeBitstreamParams& params,
                                                         EntityTreeElementExtraEncodeDataPointer entityTreeElementExtraEncodeData,
-                                                        const bool destinationNodeCanGetAndSetPrivateUserData = false) const;
+                                                        const bool destinationNodeCanGetAndSetPrivateUserData = false,
+                                                        quint64 knownPropertiesVersion = 0) const;
 
     virtual void appendSubclassData(OctreePacketData* packetData, EncodeBitstreamParams& params,
                                     EntityTreeElementExtraEncodeDataPointer entityTreeElementExtraEncodeData,
@@ -159,6 +176,12 @@ public:
                                                 { somethingChanged = false; return 0; }
     static int expectedBytes();
 
+    // Only worth it where the same entities are sent to many destinations, the entity-server.
+    static void setEncodeCacheEnabled(bool enabled) { _encodeCacheEnabled = enabled; }
+    static quint64 getEncodeCacheHits() { return _encodeCacheHits; }
+    static quint64 getEncodeCacheMisses() { return _encodeCacheMisses; }
+    static quint64 getEncodeCacheBytesCopied() { return _encodeCacheBytesCopied; }
+
     static void adjustEditPacketForClockSkew(QByteArray& buffer, qint64 clockSkew);
 
     // perform update
@@ -527,7 +550,7 @@ public:
     QUuid getLastEditedBy() const { return _lastEditedBy; }
     void setLastEditedBy(QUuid value) { _lastEditedBy = value; }
 
-    virtual bool matchesJSONFilters(const QJsonObject& jsonFilters) const;
+    virtual bool matchesJSONFilters(const EntityJSONFilter& jsonFilter) const;
 
     virtual bool getMeshes(MeshProxyList& result) { return true; }
 
@@ -609,6 +632,46 @@ protected:
     quint64 _created { 0 };
     quint64 _changedOnServer { 0 };
 
+    void markPropertiesChanged(const EntityPropertyFlags& changedProperties);
+    void journalChangeOnServer();
+    quint64 _propertiesVersion { 1 };
+    quint64 _allPropertiesChangedVersion { 1 };
+    std::unordered_map<int, quint64> _propertyVersions; // of the properties changed since _allPropertiesChangedVersion
+
+    // everything the encoding depends on, besides the requested properties and the private user data permission
+    struct EncodeCacheStamp {
+        quint64 propertiesVersion { 0 };
+        quint64 lastEdited { 0 };
+        quint64 lastUpdated { 0 };
+        quint64 lastSimulated { 0 };
+
+        bool operator==(const EncodeCacheStamp& other) const {
+            return propertiesVersion == other.propertiesVersion && lastEdited == other.lastEdited &&
+                lastUpdated == other.lastUpdated && lastSimulated == other.lastSimulated;
+        }
+    };
+    struct EncodedData {
+        EntityPropertyFlags requestedProperties;
+        bool withPrivateUserData;
+        QByteArray data;
+    };
+    EncodeCacheStamp getEncodeCacheStamp() const;
+    QByteArray findEncodedData(const EncodeCacheStamp& stamp, const EntityPropertyFlags& requestedProperties,
+                               bool withPrivateUserData) const;
+    void storeEncodedData(const EncodeCacheStamp& stamp, const EntityPropertyFlags& requestedProperties,
+                          bool withPrivateUserData, const QByteArray& data) const;
+
+    // the whole state first, then the deltas of the destinations that know the entity
+    mutable std::mutex _encodeCacheMutex;
+    mutable EncodeCacheStamp _encodeCacheStamp;
+    mutable std::vector<EncodedData> _encodeCache;
+    mutable size_t _nextEncodeCacheSlot { 0 };
+
+    static bool _encodeCacheEnabled;
+    static std::atomic<quint64> _encodeCacheHits;
+    static std::atomic<quint64> _encodeCacheMisses;
+    static std::atomic<quint64> _encodeCacheBytesCopied;
+
     mutable AABox _cachedAABox;
     mutable AACube _maxAACube;
     mutable AACube _minAACube;
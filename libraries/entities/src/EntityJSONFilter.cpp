@@ -0,0 +1,43 @@
+//
+//  EntityJSONFilter.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityJSONFilter.h"
+
+#include "EntityTree.h"
+
+EntityJSONFilter::EntityJSONFilter(const QJsonObject& jsonFilters) :
+    _isEmpty(jsonFilters.isEmpty())
+{
+    // The intention for the query JSON filter is to be flexible to handle a variety of filters for ALL entity
+    // properties. Currently the only ones handled are '+' for serverScripts, which asks for the entities with a
+    // non-default serverScripts, and the name of the type of the entities.
+    static const QString SERVER_SCRIPTS_PROPERTY = "serverScripts";
+    static const QString ENTITY_TYPE_PROPERTY = "type";
+    static const QString AVATAR_PRIORITY_PROPERTY = "avatarPriority";
+
+    _wantsAvatarPriorityZones = jsonFilters.value(AVATAR_PRIORITY_PROPERTY).toBool();
+
+    for (auto it = jsonFilters.constBegin(); it != jsonFilters.constEnd(); ++it) {
+        if (it.key() == SERVER_SCRIPTS_PROPERTY && it.value() == EntityQueryFilterSymbol::NonDefault) {
+            _test = Test::NonDefaultServerScripts;
+            break;
+        } else if (it.key() == ENTITY_TYPE_PROPERTY) {
+            QString typeName = it.value().toString();
+            _type = EntityTypes::getEntityTypeFromName(typeName);
+
+            // a value that isn't the name of a type matches no entity
+            bool isTypeName = it.value().isString() && EntityTypes::getEntityTypeName(_type) == typeName;
+            _test = isTypeName ? Test::Type : Test::Nothing;
+            break;
+        }
+    }
+
+    // the json filter syntax did not match what we expected, every entity matches
+}
@@ -0,0 +1,52 @@
+//
+//  EntityJSONFilter.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityJSONFilter_h
+#define hifi_EntityJSONFilter_h
+
+#include <memory>
+
+#include <QtCore/QJsonObject>
+
+#include "EntityTypes.h"
+
+// The JSON filter of an entity query, compiled once when the query arrives so that the entities can be matched against
+// it without going through the JSON for each one of them. See EntityItem::matchesJSONFilters().
+class EntityJSONFilter {
+public:
+    // the property test of the filter, the first one found in the JSON in the order of its keys
+    enum class Test : uint8_t {
+        None, // matches every entity
+        NonDefaultServerScripts,
+        Type,
+        Nothing // matches no entity, for a type that doesn't exist
+    };
+
+    EntityJSONFilter() {}
+    explicit EntityJSONFilter(const QJsonObject& jsonFilters);
+
+    bool isEmpty() const { return _isEmpty; }
+
+    Test getTest() const { return _test; }
+    EntityTypes::EntityType getType() const { return _type; }
+
+    // for the avatar mixer, which is interested in the zones with an avatar priority or a screenshare
+    bool wantsAvatarPriorityZones() const { return _wantsAvatarPriorityZones; }
+
+private:
+    bool _isEmpty { true };
+    Test _test { Test::None };
+    EntityTypes::EntityType _type { EntityTypes::Unknown };
+    bool _wantsAvatarPriorityZones { false };
+};
+
+using EntityJSONFilterPointer = std::shared_ptr<const EntityJSONFilter>;
+
+#endif // hifi_EntityJSONFilter_h
@@ -0,0 +1,253 @@
+//
+//  EntityJournal.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityJournal.h"
+
+#include <udt/PacketHeaders.h>
+
+#include "EntitiesLogging.h"
+#include "EntitySnapshotFile.h"
+
+static const char JOURNAL_MAGIC[] = { 'H', 'F', 'E', 'N', 'T', 'J', 'N', 'L' };
+static const quint32 JOURNAL_FORMAT_VERSION = 2;
+
+// magic, format version, properties version, snapshot id, snapshot data version, data version
+static const int JOURNAL_HEADER_SIZE = sizeof(JOURNAL_MAGIC) + sizeof(quint32) + sizeof(quint32) +
+    NUM_BYTES_RFC4122_UUID + sizeof(qint64) + sizeof(qint64);
+// the data version is the last field of the header, written again in place when it is bumped
+static const int JOURNAL_DATA_VERSION_OFFSET = JOURNAL_HEADER_SIZE - sizeof(qint64);
+
+// type, payload size
+static const int JOURNAL_RECORD_HEADER_SIZE = sizeof(quint8) + sizeof(quint32);
+
+enum JournalRecordType : quint8 {
+    ENTITY_RECORD = 1,
+    DELETE_RECORD = 2
+};
+
+static quint32 propertiesVersion() {
+    return (quint32)versionForPacketType(PacketType::EntityAdd);
+}
+
+// Reads the data version from a header, false if the journal doesn't follow the snapshot with this id and data version.
+static bool readHeader(const uchar* header, const QUuid& snapshotID, qint64 snapshotDataVersion, qint64& dataVersion) {
+    const uchar* dataAt = header;
+    quint32 formatVersion;
+    quint32 version;
+    qint64 headerSnapshotDataVersion;
+    bool isValid = memcmp(dataAt, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0;
+    dataAt += sizeof(JOURNAL_MAGIC);
+    memcpy(&formatVersion, dataAt, sizeof(formatVersion));
+    dataAt += sizeof(formatVersion);
+    memcpy(&version, dataAt, sizeof(version));
+    dataAt += sizeof(version);
+    QUuid id = QUuid::fromRfc4122(QByteArray::fromRawData((const char*)dataAt, NUM_BYTES_RFC4122_UUID));
+    dataAt += NUM_BYTES_RFC4122_UUID;
+    memcpy(&headerSnapshotDataVersion, dataAt, sizeof(headerSnapshotDataVersion));
+    dataAt += sizeof(headerSnapshotDataVersion);
+    memcpy(&dataVersion, dataAt, sizeof(dataVersion));
+
+    return isValid && formatVersion == JOURNAL_FORMAT_VERSION && version == propertiesVersion() &&
+        id == snapshotID && headerSnapshotDataVersion == snapshotDataVersion;
+}
+
+bool EntityJournalWriter::create(const QString& fileName, const QUuid& snapshotID, qint64 snapshotDataVersion) {
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(entities) << "Cannot open entity journal for writing:" << fileName << _file.errorString();
+        return false;
+    }
+
+    QByteArray header;
+    header.reserve(JOURNAL_HEADER_SIZE);
+    header.append(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    quint32 formatVersion = JOURNAL_FORMAT_VERSION;
+    header.append((const char*)&formatVersion, sizeof(formatVersion));
+    quint32 version = propertiesVersion();
+    header.append((const char*)&version, sizeof(version));
+    header.append(snapshotID.toRfc4122());
+    header.append((const char*)&snapshotDataVersion, sizeof(snapshotDataVersion));
+    qint64 noDataVersion = -1;
+    header.append((const char*)&noDataVersion, sizeof(noDataVersion));
+
+    if (_file.write(header) != header.size() || !flush()) {
+        qCWarning(entities) << "Failed to write entity journal:" << fileName << _file.errorString();
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool EntityJournalWriter::openForAppend(const QString& fileName, qint64 validSize) {
+    close();
+
+    // a record cut short by a crash is dropped, the ones after it would never be replayed
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadWrite) || !_file.resize(validSize) || !_file.seek(validSize)) {
+        qCWarning(entities) << "Cannot open entity journal for appending:" << fileName << _file.errorString();
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool EntityJournalWriter::writeEntity(const EntityItem& entity) {
+    if (!EntitySnapshotWriter::encodeRecord(entity, _record, _editBuffer)) {
+        return false;
+    }
+    return writeRecord(ENTITY_RECORD, _record);
+}
+
+bool EntityJournalWriter::writeDelete(const EntityItemID& entityID) {
+    return writeRecord(DELETE_RECORD, entityID.toRfc4122());
+}
+
+bool EntityJournalWriter::writeDataVersion(qint64 dataVersion) {
+    if (!_file.isOpen()) {
+        return false;
+    }
+
+    qint64 end = _file.pos();
+    if (!_file.seek(JOURNAL_DATA_VERSION_OFFSET) ||
+        _file.write((const char*)&dataVersion, sizeof(dataVersion)) != sizeof(dataVersion) || !_file.seek(end)) {
+        qCWarning(entities) << "Failed to write entity journal:" << _file.fileName() << _file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool EntityJournalWriter::writeRecord(quint8 type, const QByteArray& payload) {
+    if (!_file.isOpen()) {
+        return false;
+    }
+
+    quint32 size = (quint32)payload.size();
+    QByteArray recordHeader;
+    recordHeader.append((const char*)&type, sizeof(type));
+    recordHeader.append((const char*)&size, sizeof(size));
+
+    if (_file.write(recordHeader) != recordHeader.size() || _file.write(payload) != payload.size()) {
+        qCWarning(entities) << "Failed to write entity journal:" << _file.fileName() << _file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool EntityJournalWriter::flush() {
+    return _file.isOpen() && _file.flush();
+}
+
+bool EntityJournalReader::open(const QString& fileName, const QUuid& snapshotID, qint64 snapshotDataVersion) {
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    qint64 size = _file.size();
+    if (size < JOURNAL_HEADER_SIZE) {
+        close();
+        return false;
+    }
+    _data = _file.map(0, size);
+    if (!_data) {
+        close();
+        return false;
+    }
+
+    if (!readHeader(_data, snapshotID, snapshotDataVersion, _dataVersion)) {
+        qCDebug(entities) << "Entity journal doesn't follow its snapshot:" << fileName;
+        close();
+        return false;
+    }
+
+    qint64 offset = JOURNAL_HEADER_SIZE;
+    while (offset + JOURNAL_RECORD_HEADER_SIZE <= size) {
+        quint8 type;
+        quint32 payloadSize;
+        memcpy(&type, _data + offset, sizeof(type));
+        memcpy(&payloadSize, _data + offset + sizeof(type), sizeof(payloadSize));
+
+        qint64 payloadOffset = offset + JOURNAL_RECORD_HEADER_SIZE;
+        if (payloadOffset + payloadSize > size) {
+            break;
+        }
+
+        const uchar* payload = _data + payloadOffset;
+        if (type == ENTITY_RECORD) {
+            // the id of the entity is only in its add messages
+            EntityItemID entityID;
+            EntityItemProperties properties;
+            if (!EntitySnapshotReader::decodeRecord(payload, payloadSize, entityID, properties)) {
+                break;
+            }
+            Change change;
+            change.offset = (quint64)payloadOffset;
+            change.size = payloadSize;
+            _changes[entityID] = change;
+        } else if (type == DELETE_RECORD && payloadSize == NUM_BYTES_RFC4122_UUID) {
+            Change change;
+            change.isDelete = true;
+            _changes[QUuid::fromRfc4122(QByteArray::fromRawData((const char*)payload, NUM_BYTES_RFC4122_UUID))] = change;
+        } else {
+            break;
+        }
+
+        offset = payloadOffset + payloadSize;
+    }
+
+    if (offset < size) {
+        qCWarning(entities) << "Entity journal ends with an incomplete record, ignoring its last" << (size - offset)
+            << "bytes:" << fileName;
+    }
+    _validSize = offset;
+
+    return true;
+}
+
+bool EntityJournalReader::readInfo(const QString& fileName, const QUuid& snapshotID, qint64 snapshotDataVersion,
+                                   qint64& dataVersion) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray header = file.read(JOURNAL_HEADER_SIZE);
+    return header.size() == JOURNAL_HEADER_SIZE &&
+        readHeader((const uchar*)header.constData(), snapshotID, snapshotDataVersion, dataVersion);
+}
+
+void EntityJournalReader::close() {
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    _file.close();
+    _validSize = 0;
+    _dataVersion = -1;
+    _changes.clear();
+}
+
+bool EntityJournalReader::isDeleted(const EntityItemID& entityID) const {
+    auto it = _changes.find(entityID);
+    return it != _changes.end() && it->isDelete;
+}
+
+bool EntityJournalReader::readEntity(const EntityItemID& entityID, EntityItemID& decodedEntityID,
+                                     EntityItemProperties& properties) const {
+    auto it = _changes.find(entityID);
+    if (it == _changes.end() || it->isDelete) {
+        return false;
+    }
+    return EntitySnapshotReader::decodeRecord(_data + it->offset, it->size, decodedEntityID, properties);
+}
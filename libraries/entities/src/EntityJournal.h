@@ -0,0 +1,105 @@
+//
+//  EntityJournal.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityJournal_h
+#define hifi_EntityJournal_h
+
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QUuid>
+
+#include "EntityItem.h"
+#include "EntityItemID.h"
+#include "EntityItemProperties.h"
+
+// The journal of the changes made to the entities after they were written to a binary snapshot, or read from one, so
+// that the entity server doesn't have to write the whole snapshot again to persist a few edits.
+//
+// The journal starts with a header that refers to the snapshot it follows, and holds the data version of the content
+// once it is bumped. It then holds a record for each change: the whole entity when it is added or changed, in the
+// encoding of the snapshot records, and its id when it is deleted. When the journal is replayed only the last record of
+// each entity counts, and a record cut short by a crash ends it.
+//
+// Journals are written with EntityJournalWriter and read with EntityJournalReader.
+
+// Appends the records to the journal file as they are written.
+class EntityJournalWriter {
+public:
+    ~EntityJournalWriter() { close(); }
+
+    static QString fileNameForSnapshot(const QString& snapshotFileName) { return snapshotFileName + ".journal"; }
+
+    // Starts a new journal for the snapshot with this id and data version, in place of the previous one.
+    bool create(const QString& fileName, const QUuid& snapshotID, qint64 snapshotDataVersion);
+
+    // Goes on with a journal that was replayed, after its complete records.
+    bool openForAppend(const QString& fileName, qint64 validSize);
+
+    bool isOpen() const { return _file.isOpen(); }
+    void close() { _file.close(); }
+
+    qint64 getSize() const { return _file.size(); }
+
+    bool writeEntity(const EntityItem& entity);
+    bool writeDelete(const EntityItemID& entityID);
+    bool writeDataVersion(qint64 dataVersion); // in the header
+
+    // Hands the records written so far to the system, they survive the server stopping from then on.
+    bool flush();
+
+private:
+    bool writeRecord(quint8 type, const QByteArray& payload);
+
+    QFile _file;
+    QByteArray _record;
+    QByteArray _editBuffer;
+};
+
+// Maps a journal in memory and finds the last change of each entity in it.
+class EntityJournalReader {
+public:
+    ~EntityJournalReader() { close(); }
+
+    // Fails if the journal doesn't follow the snapshot with this id and data version.
+    bool open(const QString& fileName, const QUuid& snapshotID, qint64 snapshotDataVersion);
+
+    // Reads only the header, for the data version: -1 if it wasn't bumped since the snapshot.
+    static bool readInfo(const QString& fileName, const QUuid& snapshotID, qint64 snapshotDataVersion,
+                         qint64& dataVersion);
+    void close();
+
+    // the size of the complete records, which are the ones replayed
+    qint64 getValidSize() const { return _validSize; }
+
+    // the data version of the content, or -1 if it wasn't bumped since the snapshot
+    qint64 getDataVersion() const { return _dataVersion; }
+
+    QList<EntityItemID> getChangedEntities() const { return _changes.keys(); }
+    bool hasChanged(const EntityItemID& entityID) const { return _changes.contains(entityID); }
+    bool isDeleted(const EntityItemID& entityID) const;
+
+    // Decodes the last state of an entity the journal has a change for, false if it was deleted.
+    bool readEntity(const EntityItemID& entityID, EntityItemID& decodedEntityID, EntityItemProperties& properties) const;
+
+private:
+    struct Change {
+        quint64 offset { 0 };
+        quint32 size { 0 };
+        bool isDelete { false };
+    };
+
+    QFile _file;
+    const uchar* _data { nullptr };
+    qint64 _validSize { 0 };
+    qint64 _dataVersion { -1 };
+    QHash<EntityItemID, Change> _changes;
+};
+
+#endif // hifi_EntityJournal_h
@@ -11,6 +11,22 @@
 
 #include "EntityNodeData.h"
 
+int EntityNodeData::parseData(ReceivedMessage& message) {
+    int bytesRead = OctreeQueryNode::parseData(message);
+
+    // the queries repeat the same filter, it is only compiled when it changes
+    auto jsonParameters = getJSONParameters();
+    if (jsonParameters != _jsonFilterParameters) {
+        _jsonFilterParameters = jsonParameters;
+        auto jsonFilter = std::make_shared<EntityJSONFilter>(jsonParameters);
+
+        QMutexLocker locker(&_jsonFilterLock);
+        _jsonFilter = jsonFilter;
+    }
+
+    return bytesRead;
+}
+
 bool EntityNodeData::insertFlaggedExtraEntity(const QUuid& filteredEntityID, const QUuid& extraEntityID) {
     _flaggedExtraEntities[filteredEntityID].insert(extraEntityID);
     return !_previousFlaggedExtraEntities[filteredEntityID].contains(extraEntityID);
@@ -16,6 +16,8 @@
 
 #include <OctreeQueryNode.h>
 
+#include "EntityJSONFilter.h"
+
 namespace EntityJSONQueryProperties {
     static const QString SERVER_SCRIPTS_PROPERTY = "serverScripts";
     static const QString FLAGS_PROPERTY = "flags";
@@ -27,6 +29,11 @@ class EntityNodeData : public OctreeQueryNode {
 public:
     virtual PacketType getMyPacketType() const override { return PacketType::EntityData; }
 
+    int parseData(ReceivedMessage& message) override;
+
+    // the JSON filter of the last query, compiled
+    EntityJSONFilterPointer getJSONFilter() const { QMutexLocker locker(&_jsonFilterLock); return _jsonFilter; }
+
     quint64 getLastDeletedEntitiesSentAt() const { return _lastDeletedEntitiesSentAt; }
     void setLastDeletedEntitiesSentAt(quint64 sentAt) { _lastDeletedEntitiesSentAt = sentAt; }
     
@@ -49,6 +56,10 @@ private:
     QSet<QUuid> _sentFilteredEntities;
     QHash<QUuid, QSet<QUuid>> _flaggedExtraEntities;
     QHash<QUuid, QSet<QUuid>> _previousFlaggedExtraEntities;
+
+    QJsonObject _jsonFilterParameters; // the parameters the filter was compiled from
+    EntityJSONFilterPointer _jsonFilter { std::make_shared<EntityJSONFilter>() };
+    mutable QMutex _jsonFilterLock;
 };
 
 #endif // hifi_EntityNodeData_h
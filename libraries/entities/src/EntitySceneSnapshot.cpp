@@ -0,0 +1,86 @@
+//
+//  EntitySceneSnapshot.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySceneSnapshot.h"
+
+#include <functional>
+
+#include <NumericalConstants.h>
+#include <OctreePacketData.h>
+
+// an entity larger than this is left to the traversals, which split it over packets
+static const int MAX_ENCODED_ENTITY_SIZE = 32 * BYTES_PER_KILOBYTE;
+
+static QByteArray encodeEntity(const EntityItem& entity, bool withPrivateUserData) {
+    OctreePacketData packetData(false, MAX_ENCODED_ENTITY_SIZE);
+    EncodeBitstreamParams params;
+    EntityTreeElementExtraEncodeDataPointer extraEncodeData { new EntityTreeElementExtraEncodeData() };
+
+    auto appendState = entity.appendEntityData(&packetData, params, extraEncodeData, withPrivateUserData);
+    if (appendState != OctreeElement::COMPLETED) {
+        return QByteArray();
+    }
+
+    return QByteArray((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+}
+
+EntitySceneSnapshotPointer EntitySceneSnapshot::capture(const EntityTreePointer& tree) {
+    auto snapshot = std::make_shared<EntitySceneSnapshot>();
+
+    std::vector<EntityItemPointer> entities;
+    tree->withReadLock([&] {
+        // the changes made from here on are newer than the snapshot
+        snapshot->_captureTime = usecTimestampNow();
+
+        std::function<void(const EntityTreeElementPointer&)> addElementEntities = [&](const EntityTreeElementPointer& element) {
+            element->forEachEntity([&](const EntityItemPointer& entity) {
+                entities.push_back(entity);
+            });
+            for (int i = 0; i < NUMBER_OF_CHILDREN; ++i) {
+                if (auto child = element->getChildAtIndex(i)) {
+                    addElementEntities(child);
+                }
+            }
+        };
+
+        auto root = std::static_pointer_cast<EntityTreeElement>(tree->getRoot());
+        if (root) {
+            addElementEntities(root);
+        }
+    });
+
+    snapshot->_entries.reserve(entities.size());
+    for (auto& entity : entities) {
+        if (entity->isDead()) {
+            continue;
+        }
+
+        Entry entry;
+        entry.entity = entity;
+        entry.propertiesVersion = entity->getPropertiesVersion();
+        entry.data = encodeEntity(*entity, false);
+        if (!entity->getPrivateUserData().isEmpty()) {
+            entry.dataWithPrivateUserData = encodeEntity(*entity, true);
+        }
+
+        // an entity that didn't fit or that was edited while being encoded is listed without its data
+        if (entity->getPropertiesVersion() != entry.propertiesVersion) {
+            entry.data.clear();
+        }
+        if (entry.data.isEmpty()) {
+            entry.dataWithPrivateUserData.clear();
+        }
+
+        snapshot->_dataSize += entry.data.size() + entry.dataWithPrivateUserData.size();
+        snapshot->_entries.push_back(std::move(entry));
+    }
+
+    return snapshot;
+}
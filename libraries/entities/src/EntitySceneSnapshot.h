@@ -0,0 +1,51 @@
+//
+//  EntitySceneSnapshot.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySceneSnapshot_h
+#define hifi_EntitySceneSnapshot_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+
+#include <EntityTree.h>
+
+// The entities of the tree as of a point in time, each encoded with all of its properties, for the entity-server to
+// send the scene to new viewers in bulk rather than entity by entity.
+class EntitySceneSnapshot {
+public:
+    struct Entry {
+        EntityItemWeakPointer entity;
+        quint64 propertiesVersion { 0 }; // of the encoded properties
+        QByteArray data; // as appended to an EntityData packet, without the private user data, empty if not encoded
+        QByteArray dataWithPrivateUserData; // empty when the entity has no private user data
+    };
+
+    // The entities are listed under the tree lock, and encoded after it is released, so it must not be called with the
+    // lock already held. An entity edited in the meantime, or too large to encode whole, is listed without its data,
+    // to be sent to the viewers the usual way.
+    static std::shared_ptr<const EntitySceneSnapshot> capture(const EntityTreePointer& tree);
+
+    // the viewers sent this snapshot have to be sent the changes made since then
+    uint64_t getCaptureTime() const { return _captureTime; }
+
+    const std::vector<Entry>& getEntries() const { return _entries; }
+    size_t getDataSize() const { return _dataSize; }
+
+private:
+    uint64_t _captureTime { 0 };
+    std::vector<Entry> _entries; // in the order of the tree, so that the entities close to each other are next to each other
+    size_t _dataSize { 0 };
+};
+
+using EntitySceneSnapshotPointer = std::shared_ptr<const EntitySceneSnapshot>;
+
+#endif // hifi_EntitySceneSnapshot_h
@@ -0,0 +1,73 @@
+//
+//  EntitySceneSnapshotCache.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySceneSnapshotCache.h"
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+#include "EntitiesLogging.h"
+
+const uint64_t EntitySceneSnapshotCache::MAX_SNAPSHOT_AGE = 5 * USECS_PER_SECOND;
+const uint64_t EntitySceneSnapshotCache::REFRESH_SNAPSHOT_AGE = 2 * USECS_PER_SECOND;
+
+EntitySceneSnapshotCache::~EntitySceneSnapshotCache() {
+    if (_captureThread.joinable()) {
+        _captureThread.join();
+    }
+}
+
+EntitySceneSnapshotPointer EntitySceneSnapshotCache::get() {
+    uint64_t now = usecTimestampNow();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    refresh(now);
+
+    if (!_snapshot || now > _snapshot->getCaptureTime() + MAX_SNAPSHOT_AGE) {
+        return EntitySceneSnapshotPointer();
+    }
+    return _snapshot;
+}
+
+void EntitySceneSnapshotCache::refresh() {
+    uint64_t now = usecTimestampNow();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    refresh(now);
+}
+
+bool EntitySceneSnapshotCache::isCapturing() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _isCapturing;
+}
+
+void EntitySceneSnapshotCache::refresh(uint64_t now) {
+    if (_isCapturing || (_snapshot && now < _snapshot->getCaptureTime() + REFRESH_SNAPSHOT_AGE)) {
+        return;
+    }
+
+    // the thread of the previous capture is done with it, only its exit is left to wait for
+    if (_captureThread.joinable()) {
+        _captureThread.join();
+    }
+
+    _isCapturing = true;
+    _captureThread = std::thread([this] {
+        quint64 start = usecTimestampNow();
+        auto snapshot = EntitySceneSnapshot::capture(_tree);
+
+        qCDebug(entities) << "Captured the scene for new viewers," << snapshot->getEntries().size() << "entities,"
+                          << snapshot->getDataSize() << "bytes in" << (usecTimestampNow() - start) << "usecs";
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _snapshot = snapshot;
+        _isCapturing = false;
+    });
+}
@@ -0,0 +1,51 @@
+//
+//  EntitySceneSnapshotCache.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySceneSnapshotCache_h
+#define hifi_EntitySceneSnapshotCache_h
+
+#include <mutex>
+#include <thread>
+
+#include "EntitySceneSnapshot.h"
+
+// The latest snapshot of the scene, captured on a thread of its own so that the send threads asking for it never
+// wait for a capture, nor hold the tree lock while one encodes the entities.
+class EntitySceneSnapshotCache {
+public:
+    // the changes since the capture are sent to the viewers after the snapshot, too many of them defeat its purpose
+    static const uint64_t MAX_SNAPSHOT_AGE;
+    // captured again ahead of time, so that a steady flow of new viewers keeps finding one that isn't too old
+    static const uint64_t REFRESH_SNAPSHOT_AGE;
+
+    EntitySceneSnapshotCache(const EntityTreePointer& tree) : _tree(tree) { }
+    ~EntitySceneSnapshotCache(); // waits for the capture in progress, if any
+
+    // Returns right away: the latest snapshot, or nullptr if there is none yet or it is too old. Has a new one
+    // captured if it is getting old.
+    EntitySceneSnapshotPointer get();
+
+    // Has a new snapshot captured unless the latest one is recent, or a capture is already in progress.
+    void refresh();
+
+    bool isCapturing() const;
+
+private:
+    void refresh(uint64_t now); // with the mutex held
+
+    EntityTreePointer _tree;
+
+    mutable std::mutex _mutex;
+    EntitySceneSnapshotPointer _snapshot;
+    bool _isCapturing { false };
+    std::thread _captureThread;
+};
+
+#endif // hifi_EntitySceneSnapshotCache_h
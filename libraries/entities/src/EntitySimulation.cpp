@@ -99,6 +99,8 @@ void EntitySimulation::expireMortalEntities(uint64_t now) {
 void EntitySimulation::callUpdateOnEntitiesThatNeedIt(uint64_t now) {
     PerformanceTimer perfTimer("updatingEntities");
     QMutexLocker lock(&_mutex);
+    // what the entity-server simulates is persisted, like the edits
+    bool isServer = _entityTree && _entityTree->getIsServer();
     SetOfEntities::iterator itemItr = _entitiesToUpdate.begin();
     while (itemItr != _entitiesToUpdate.end()) {
         EntityItemPointer entity = *itemItr;
@@ -108,6 +110,9 @@ void EntitySimulation::callUpdateOnEntitiesThatNeedIt(uint64_t now) {
             itemItr = _entitiesToUpdate.erase(itemItr);
         } else {
             entity->update(now);
+            if (isServer) {
+                _entityTree->journalEntityChange(entity->getEntityItemID(), entity);
+            }
             ++itemItr;
         }
     }
@@ -120,6 +125,8 @@ void EntitySimulation::sortEntitiesThatMoved() {
     // External changes to entity position/shape are expected to be sorted outside of the EntitySimulation.
     MovingEntitiesOperator moveOperator;
     AACube domainBounds(glm::vec3((float)-HALF_TREE_SCALE), (float)TREE_SCALE);
+    // what the entity-server moves is persisted, like the edits
+    bool isServer = _entityTree && _entityTree->getIsServer();
     SetOfEntities::iterator itemItr = _entitiesToSort.begin();
     while (itemItr != _entitiesToSort.end()) {
         EntityItemPointer entity = *itemItr;
@@ -133,6 +140,9 @@ void EntitySimulation::sortEntitiesThatMoved() {
             prepareEntityForDelete(entity);
         } else {
             moveOperator.addEntityToMoveList(entity, newCube);
+            if (isServer) {
+                _entityTree->journalEntityChange(entity->getEntityItemID(), entity);
+            }
             ++itemItr;
         }
     }
@@ -0,0 +1,287 @@
+//
+//  EntitySnapshotFile.cpp
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySnapshotFile.h"
+
+#include <NumericalConstants.h>
+#include <udt/PacketHeaders.h>
+
+#include "EntitiesLogging.h"
+
+static const char SNAPSHOT_MAGIC[] = { 'H', 'F', 'E', 'N', 'T', 'S', 'N', 'P' };
+static const quint32 SNAPSHOT_FORMAT_VERSION = 1;
+
+// magic, format version, properties version, id, data version, number of entities, index offset
+static const int SNAPSHOT_HEADER_SIZE = sizeof(SNAPSHOT_MAGIC) + sizeof(quint32) + sizeof(quint32) +
+    NUM_BYTES_RFC4122_UUID + sizeof(qint64) + sizeof(quint32) + sizeof(quint64);
+
+// id, record offset, record size
+static const int SNAPSHOT_INDEX_ENTRY_SIZE = NUM_BYTES_RFC4122_UUID + sizeof(quint64) + sizeof(quint32);
+
+// the add messages of most entities fit in one buffer of this size, the larger ones are split or get a larger buffer
+static const int INITIAL_EDIT_BUFFER_SIZE = 16 * BYTES_PER_KILOBYTE;
+static const int MAX_EDIT_BUFFER_SIZE = 16 * BYTES_PER_KILOBYTE * BYTES_PER_KILOBYTE;
+
+static quint32 propertiesVersion() {
+    return (quint32)versionForPacketType(PacketType::EntityAdd);
+}
+
+static QByteArray writeHeader(const QUuid& id, qint64 dataVersion, quint32 numEntities, quint64 indexOffset) {
+    QByteArray header;
+    header.reserve(SNAPSHOT_HEADER_SIZE);
+
+    header.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    quint32 formatVersion = SNAPSHOT_FORMAT_VERSION;
+    header.append((const char*)&formatVersion, sizeof(formatVersion));
+    quint32 version = propertiesVersion();
+    header.append((const char*)&version, sizeof(version));
+    header.append(id.toRfc4122());
+    header.append((const char*)&dataVersion, sizeof(dataVersion));
+    header.append((const char*)&numEntities, sizeof(numEntities));
+    header.append((const char*)&indexOffset, sizeof(indexOffset));
+
+    return header;
+}
+
+static bool readHeader(const uchar* data, qint64 size, QUuid& id, qint64& dataVersion,
+                       quint32& numEntities, quint64& indexOffset) {
+    if (size < SNAPSHOT_HEADER_SIZE || memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        return false;
+    }
+    const uchar* dataAt = data + sizeof(SNAPSHOT_MAGIC);
+
+    quint32 formatVersion;
+    memcpy(&formatVersion, dataAt, sizeof(formatVersion));
+    dataAt += sizeof(formatVersion);
+
+    quint32 version;
+    memcpy(&version, dataAt, sizeof(version));
+    dataAt += sizeof(version);
+
+    if (formatVersion != SNAPSHOT_FORMAT_VERSION || version != propertiesVersion()) {
+        qCDebug(entities) << "Entity snapshot has version" << formatVersion << version << "- expected"
+            << SNAPSHOT_FORMAT_VERSION << propertiesVersion();
+        return false;
+    }
+
+    id = QUuid::fromRfc4122(QByteArray::fromRawData((const char*)dataAt, NUM_BYTES_RFC4122_UUID));
+    dataAt += NUM_BYTES_RFC4122_UUID;
+    memcpy(&dataVersion, dataAt, sizeof(dataVersion));
+    dataAt += sizeof(dataVersion);
+    memcpy(&numEntities, dataAt, sizeof(numEntities));
+    dataAt += sizeof(numEntities);
+    memcpy(&indexOffset, dataAt, sizeof(indexOffset));
+
+    return true;
+}
+
+bool EntitySnapshotWriter::begin(const QUuid& id, qint64 dataVersion) {
+    _id = id;
+    _dataVersion = dataVersion;
+    _index.clear();
+
+    if (!_file.open(QIODevice::WriteOnly)) {
+        qCWarning(entities) << "Cannot open entity snapshot for writing:" << _file.fileName() << _file.errorString();
+        return false;
+    }
+
+    // the header is written again with the index offset once the records are written
+    QByteArray header = writeHeader(_id, _dataVersion, 0, 0);
+    return _file.write(header) == header.size();
+}
+
+bool EntitySnapshotWriter::encodeRecord(const EntityItem& entity, QByteArray& record, QByteArray& editBuffer) {
+    EncodeBitstreamParams params;
+    EntityItemProperties properties = entity.getProperties();
+    EntityPropertyFlags requestedProperties = entity.getEntityProperties(params);
+    EntityPropertyFlags didntFitProperties;
+    int editBufferSize = INITIAL_EDIT_BUFFER_SIZE;
+
+    record.resize(0);
+
+    OctreeElement::AppendState appendState = OctreeElement::PARTIAL;
+    while (appendState == OctreeElement::PARTIAL) {
+        editBuffer.resize(editBufferSize);
+        appendState = EntityItemProperties::encodeEntityEditPacket(PacketType::EntityAdd, entity.getEntityItemID(),
+                                                                   properties, editBuffer, requestedProperties,
+                                                                   didntFitProperties);
+
+        if (appendState == OctreeElement::NONE) {
+            // a property doesn't fit in the buffer on its own
+            if (editBufferSize >= MAX_EDIT_BUFFER_SIZE) {
+                qCWarning(entities) << "Entity" << entity.getEntityItemID() << "is too large for the entity snapshot";
+                return false;
+            }
+            editBufferSize *= 2;
+            appendState = OctreeElement::PARTIAL;
+            continue;
+        }
+
+        quint32 messageSize = (quint32)editBuffer.size();
+        record.append((const char*)&messageSize, sizeof(messageSize));
+        record.append(editBuffer);
+
+        requestedProperties = didntFitProperties;
+    }
+
+    return true;
+}
+
+bool EntitySnapshotWriter::append(const EntityItem& entity) {
+    if (!encodeRecord(entity, _record, _editBuffer)) {
+        return false;
+    }
+
+    IndexEntry entry;
+    entry.id = entity.getEntityItemID();
+    entry.offset = (quint64)_file.pos();
+    entry.size = (quint32)_record.size();
+
+    if (_file.write(_record) != _record.size()) {
+        qCWarning(entities) << "Failed to write entity snapshot:" << _file.fileName() << _file.errorString();
+        return false;
+    }
+
+    _index.push_back(entry);
+    return true;
+}
+
+bool EntitySnapshotWriter::finish() {
+    quint64 indexOffset = (quint64)_file.pos();
+
+    QByteArray index;
+    index.reserve((int)_index.size() * SNAPSHOT_INDEX_ENTRY_SIZE);
+    for (const auto& entry : _index) {
+        index.append(entry.id.toRfc4122());
+        index.append((const char*)&entry.offset, sizeof(entry.offset));
+        index.append((const char*)&entry.size, sizeof(entry.size));
+    }
+
+    QByteArray header = writeHeader(_id, _dataVersion, (quint32)_index.size(), indexOffset);
+    if (_file.write(index) != index.size() || !_file.seek(0) || _file.write(header) != header.size()) {
+        qCWarning(entities) << "Failed to write entity snapshot:" << _file.fileName() << _file.errorString();
+        return false;
+    }
+
+    return _file.commit();
+}
+
+bool EntitySnapshotReader::open(const QString& fileName) {
+    close();
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::ReadOnly)) {
+        qCWarning(entities) << "Cannot open entity snapshot for reading:" << fileName << _file.errorString();
+        return false;
+    }
+
+    _size = _file.size();
+    _data = _file.map(0, _size);
+    if (!_data || !readHeader(_data, _size, _id, _dataVersion, _numEntities, _indexOffset)) {
+        qCWarning(entities) << "Not a valid entity snapshot:" << fileName;
+        close();
+        return false;
+    }
+
+    if (_indexOffset < (quint64)SNAPSHOT_HEADER_SIZE ||
+        _indexOffset + (quint64)_numEntities * SNAPSHOT_INDEX_ENTRY_SIZE != (quint64)_size) {
+        qCWarning(entities) << "Entity snapshot is truncated:" << fileName;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void EntitySnapshotReader::close() {
+    if (_data) {
+        _file.unmap(const_cast<uchar*>(_data));
+        _data = nullptr;
+    }
+    _file.close();
+    _size = 0;
+    _numEntities = 0;
+    _indexOffset = 0;
+}
+
+bool EntitySnapshotReader::readInfo(const QString& fileName, QUuid& id, qint64& dataVersion) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QByteArray header = file.read(SNAPSHOT_HEADER_SIZE);
+    quint32 numEntities;
+    quint64 indexOffset;
+    return readHeader((const uchar*)header.constData(), header.size(), id, dataVersion, numEntities, indexOffset);
+}
+
+const uchar* EntitySnapshotReader::getIndexEntry(int index) const {
+    if (!_data || index < 0 || index >= (int)_numEntities) {
+        return nullptr;
+    }
+    return _data + _indexOffset + (quint64)index * SNAPSHOT_INDEX_ENTRY_SIZE;
+}
+
+EntityItemID EntitySnapshotReader::getEntityID(int index) const {
+    const uchar* entry = getIndexEntry(index);
+    if (!entry) {
+        return UNKNOWN_ENTITY_ID;
+    }
+    return QUuid::fromRfc4122(QByteArray::fromRawData((const char*)entry, NUM_BYTES_RFC4122_UUID));
+}
+
+bool EntitySnapshotReader::readEntity(int index, EntityItemID& entityID, EntityItemProperties& properties) const {
+    const uchar* entry = getIndexEntry(index);
+    if (!entry) {
+        return false;
+    }
+
+    quint64 offset;
+    quint32 size;
+    memcpy(&offset, entry + NUM_BYTES_RFC4122_UUID, sizeof(offset));
+    memcpy(&size, entry + NUM_BYTES_RFC4122_UUID + sizeof(offset), sizeof(size));
+    if (offset < (quint64)SNAPSHOT_HEADER_SIZE || offset + size > _indexOffset) {
+        return false;
+    }
+
+    return decodeRecord(_data + offset, size, entityID, properties);
+}
+
+bool EntitySnapshotReader::decodeRecord(const uchar* data, quint32 size, EntityItemID& entityID,
+                                        EntityItemProperties& properties) {
+    // the record is the add messages of the entity, each one sets some of its properties
+    const uchar* dataAt = data;
+    quint32 bytesLeftToRead = size;
+    bool hasMessage = false;
+    while (bytesLeftToRead > 0) {
+        quint32 messageSize;
+        if (bytesLeftToRead < sizeof(messageSize)) {
+            return false;
+        }
+        memcpy(&messageSize, dataAt, sizeof(messageSize));
+        dataAt += sizeof(messageSize);
+        bytesLeftToRead -= sizeof(messageSize);
+
+        if (messageSize > bytesLeftToRead) {
+            return false;
+        }
+
+        int processedBytes = 0;
+        if (!EntityItemProperties::decodeEntityEditPacket(dataAt, (int)messageSize, processedBytes, entityID, properties)) {
+            return false;
+        }
+        dataAt += messageSize;
+        bytesLeftToRead -= messageSize;
+        hasMessage = true;
+    }
+
+    return hasMessage;
+}
@@ -0,0 +1,103 @@
+//
+//  EntitySnapshotFile.h
+//  libraries/entities/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySnapshotFile_h
+#define hifi_EntitySnapshotFile_h
+
+#include <vector>
+
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QUuid>
+
+#include "EntityItem.h"
+#include "EntityItemID.h"
+#include "EntityItemProperties.h"
+
+// The binary snapshot the entity server persists its entities to, which loads in a fraction of the time of the JSON
+// export of the same entities.
+//
+// The file starts with a header that holds the version of the entity properties encoding, and the id and data version
+// of the content. Each entity follows as a record of the add messages that create it, in the edit packet encoding of
+// its properties, and an index of the entities and of where their records are ends the file. A snapshot is only read
+// back by a server with the same properties encoding, content from older versions goes through the JSON import.
+//
+// Snapshot files are written with EntitySnapshotWriter and read with EntitySnapshotReader. The changes made after a
+// snapshot are appended to its journal, see EntityJournal.h.
+
+// Writes the records of the entities one after the other as they are appended, to a file that replaces the previous
+// snapshot once it is complete.
+class EntitySnapshotWriter {
+public:
+    EntitySnapshotWriter(const QString& fileName) : _file(fileName) {}
+
+    bool begin(const QUuid& id, qint64 dataVersion);
+
+    // Encodes the entity and writes its record, the entity has to be locked by its own lock only.
+    bool append(const EntityItem& entity);
+
+    // Writes the index, the snapshot replaces the file only if this succeeds.
+    bool finish();
+
+    int getNumEntities() const { return (int)_index.size(); }
+
+    // Encodes the record of an entity, as it is in a snapshot, with the edit buffer to encode its add messages to.
+    static bool encodeRecord(const EntityItem& entity, QByteArray& record, QByteArray& editBuffer);
+
+private:
+    struct IndexEntry {
+        QUuid id;
+        quint64 offset;
+        quint32 size;
+    };
+
+    QSaveFile _file;
+    QUuid _id;
+    qint64 _dataVersion { 0 };
+    std::vector<IndexEntry> _index;
+    QByteArray _editBuffer;
+    QByteArray _record;
+};
+
+// Maps a snapshot file in memory and decodes its entities one at a time, only when they are asked for.
+class EntitySnapshotReader {
+public:
+    ~EntitySnapshotReader() { close(); }
+
+    bool open(const QString& fileName);
+    void close();
+
+    // Reads the id and data version of a snapshot, without mapping the rest of it.
+    static bool readInfo(const QString& fileName, QUuid& id, qint64& dataVersion);
+
+    const QUuid& getID() const { return _id; }
+    qint64 getDataVersion() const { return _dataVersion; }
+
+    int getNumEntities() const { return (int)_numEntities; }
+    EntityItemID getEntityID(int index) const;
+
+    bool readEntity(int index, EntityItemID& entityID, EntityItemProperties& properties) const;
+
+    static bool decodeRecord(const uchar* data, quint32 size, EntityItemID& entityID, EntityItemProperties& properties);
+
+private:
+    const uchar* getIndexEntry(int index) const;
+
+    QFile _file;
+    const uchar* _data { nullptr };
+    qint64 _size { 0 };
+
+    QUuid _id;
+    qint64 _dataVersion { 0 };
+    quint32 _numEntities { 0 };
+    quint64 _indexOffset { 0 };
+};
+
+#endif // hifi_EntitySnapshotFile_h
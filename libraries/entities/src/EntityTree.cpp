@@ -40,6 +40,8 @@
 #include "LogHandler.h"
 #include "EntityEditFilters.h"
 #include "EntityDynamicFactoryInterface.h"
+#include "EntityJournal.h"
+#include "EntitySnapshotFile.h"
 
 static const quint64 DELETED_ENTITIES_EXTRA_USECS_TO_CONSIDER = USECS_PER_MSEC * 50;
 const float EntityTree::DEFAULT_MAX_TMP_ENTITY_LIFETIME = 60 * 60; // 1 hour
@@ -134,6 +136,13 @@ void EntityTree::eraseDomainAndNonOwnedEntities() {
 void EntityTree::eraseAllOctreeElements(bool createNewRoot) {
     emit clearingEntities();
 
+    {
+        // the journal can't follow the entities from here on, the next snapshot starts a new one
+        std::lock_guard<std::mutex> lock(_journalMutex);
+        _isJournaling = false;
+        _journalChanges.clear();
+    }
+
     if (_simulation) {
         _simulation->clearEntities();
     }
@@ -309,6 +318,7 @@ void EntityTree::postAddEntity(EntityItemPointer entity) {
 
     emit addingEntity(entity->getEntityItemID());
     emit addingEntityPointer(entity.get());
+    journalEntityChange(entity->getEntityItemID(), entity);
 }
 
 bool EntityTree::updateEntity(const EntityItemID& entityID, const EntityItemProperties& properties, const SharedNodePointer& senderNode) {
@@ -324,7 +334,7 @@ bool EntityTree::updateEntity(const EntityItemID& entityID, const EntityItemProp
 }
 
 bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperties& origProperties,
-        const SharedNodePointer& senderNode) {
+        const SharedNodePointer& senderNode, bool inPlace) {
     EntityTreeElementPointer containingElement = entity->getElement();
     if (!containingElement) {
         return false;
@@ -363,10 +373,10 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
                 if (!success) {
                     qCWarning(entities) << "failed to get query-cube for" << entity->getID();
                 }
-                UpdateEntityOperator theOperator(getThisPointer(), containingElement, entity, queryCube);
-                recurseTreeWithOperator(&theOperator);
+                updateEntityElement(containingElement, entity, queryCube, inPlace);
                 if (entity->setProperties(tempProperties)) {
                     emit editingEntityPointer(entity);
+                    journalEntityChange(entity->getEntityItemID(), entity);
                 }
                 _isDirty = true;
             }
@@ -460,10 +470,10 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
         } else {
             newQueryAACube = entity->getQueryAACube();
         }
-        UpdateEntityOperator theOperator(getThisPointer(), containingElement, entity, newQueryAACube);
-        recurseTreeWithOperator(&theOperator);
+        updateEntityElement(containingElement, entity, newQueryAACube, inPlace);
         if (entity->setProperties(properties)) {
             emit editingEntityPointer(entity);
+            journalEntityChange(entity->getEntityItemID(), entity);
         }
 
         // if the entity has children, run UpdateEntityOperator on them.  If the children have children, recurse
@@ -494,8 +504,7 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
                 addToNeedsParentFixupList(childEntity);
             }
 
-            UpdateEntityOperator theChildOperator(getThisPointer(), childContainingElement, childEntity, queryCube);
-            recurseTreeWithOperator(&theChildOperator);
+            updateEntityElement(childContainingElement, childEntity, queryCube, false);
             foreach (SpatiallyNestablePointer childChild, childEntity->getChildren()) {
                 if (childChild && childChild->getNestableType() == NestableType::Entity) {
                     toProcess.enqueue(childChild);
@@ -536,6 +545,98 @@ bool EntityTree::updateEntity(EntityItemPointer entity, const EntityItemProperti
     return true;
 }
 
+bool EntityTree::canUpdateEntityInPlace(const EntityItemPointer& entity, const EntityItemProperties& properties) const {
+    // reparenting, and moving the children along, is left to the write lock
+    if (properties.parentIDChanged() || properties.parentJointIndexChanged() || entity->hasChildren()) {
+        return false;
+    }
+
+    EntityTreeElementPointer containingElement = entity->getElement();
+    if (!containingElement) {
+        return false;
+    }
+
+    // the entity has to stay in the element it is in, with UpdateEntityOperator's notion of the right element
+    AACube newQueryAACube = properties.queryAACubeChanged() ? properties.getQueryAACube() : entity->getQueryAACube();
+    AABox oldEntityBox = entity->getQueryAACube().clamp((float)-HALF_TREE_SCALE, (float)HALF_TREE_SCALE);
+    AABox newEntityBox = newQueryAACube.clamp((float)-HALF_TREE_SCALE, (float)HALF_TREE_SCALE);
+    return containingElement->bestFitBounds(oldEntityBox) && containingElement->bestFitBounds(newEntityBox);
+}
+
+void EntityTree::updateEntityElement(const EntityTreeElementPointer& containingElement, const EntityItemPointer& entity,
+                                     const AACube& newQueryAACube, bool inPlace) {
+    if (!inPlace) {
+        if (_isBatchingEdits) {
+            // moved along with the other entities of the batch, once their edits are all applied
+            _batchedEntityMoves.insert(entity);
+            return;
+        }
+        UpdateEntityOperator theOperator(getThisPointer(), containingElement, entity, newQueryAACube);
+        recurseTreeWithOperator(&theOperator);
+        return;
+    }
+
+    markEntityElementChanged(containingElement);
+}
+
+void EntityTree::markEntityElementChanged(const EntityTreeElementPointer& containingElement) {
+    // what UpdateEntityOperator does for an entity that stays where it is, without pruning along the way: mark the
+    // elements down to it as changed for the traversals
+    containingElement->bumpChangedContent();
+
+    const AACube& containingCube = containingElement->getAACube();
+    OctreeElementPointer element = getRoot();
+    while (element) {
+        element->markWithChangedTime();
+        if (element == containingElement) {
+            break;
+        }
+
+        OctreeElementPointer nextElement;
+        for (int i = 0; i < NUMBER_OF_CHILDREN && !nextElement; ++i) {
+            OctreeElementPointer child = element->getChildAtIndex(i);
+            if (child && child->getAACube().contains(containingCube)) {
+                nextElement = child;
+            }
+        }
+        element = nextElement;
+    }
+}
+
+void EntityTree::beginEditBatch() {
+    _isBatchingEdits = true;
+}
+
+void EntityTree::endEditBatch() {
+    _isBatchingEdits = false;
+    applyBatchedEntityMoves();
+}
+
+void EntityTree::applyBatchedEntityMoves() {
+    // one pass for all the entities the batch moved to other elements, however many times each was edited
+    MovingEntitiesOperator moveOperator;
+    for (auto& entity : _batchedEntityMoves) {
+        EntityTreeElementPointer containingElement = entity->getElement();
+        if (!containingElement) {
+            // deleted by a later edit of the batch
+            continue;
+        }
+
+        AACube queryCube = entity->getQueryAACube();
+        if (containingElement->bestFitBounds(queryCube.clamp((float)-HALF_TREE_SCALE, (float)HALF_TREE_SCALE))) {
+            markEntityElementChanged(containingElement);
+        } else {
+            moveOperator.addEntityToMoveList(entity, queryCube);
+        }
+    }
+    _batchedEntityMoves.clear();
+
+    if (moveOperator.hasMovingEntities()) {
+        PerformanceTimer perfTimer("recurseTreeWithOperator");
+        recurseTreeWithOperator(&moveOperator);
+    }
+}
+
 EntityItemPointer EntityTree::addEntity(const EntityItemID& entityID, const EntityItemProperties& properties, bool isClone) {
     EntityItemProperties props = properties;
 
@@ -735,6 +836,11 @@ void EntityTree::deleteEntitiesByPointer(const std::vector<EntityItemPointer>& e
     //TODO: assert(treeIsLocked);
     // NOTE: there is no entity validation (i.e. is entity in tree?) nor snarfing of children beyond this point.
     // Get those done BEFORE calling this method.
+    if (!_batchedEntityMoves.empty()) {
+        // DeleteEntityOperator finds the entities by the elements they fit in, which is where the moves put them
+        applyBatchedEntityMoves();
+    }
+
     for (auto entity : entities) {
         cleanupCloneIDs(entity->getID());
     }
@@ -744,6 +850,7 @@ void EntityTree::deleteEntitiesByPointer(const std::vector<EntityItemPointer>& e
             theOperator.addEntityToDeleteList(entity);
             emit deletingEntity(entity->getID());
             emit deletingEntityPointer(entity.get());
+            journalEntityChange(entity->getID(), EntityItemPointer());
         }
     }
 
@@ -1417,7 +1524,7 @@ bool EntityTree::isScriptInWhitelist(const QString& scriptProperty) {
     // grab a URL representation of the entity script so we can check the host for this script
     auto entityScriptURL = QUrl::fromUserInput(scriptProperty);
 
-    for (const auto& whiteListedPrefix : _entityScriptSourceWhitelist) {
+    for (const auto& whiteListedPrefix : qAsConst(_entityScriptSourceWhitelist)) {
         auto whiteListURL = QUrl::fromUserInput(whiteListedPrefix);
 
         // check if this script URL matches the whitelist domain and, optionally, is beneath the path
@@ -1778,327 +1885,372 @@ int EntityTree::processEditPacketData(ReceivedMessage& message, const unsigned c
         return 0;
     }
 
-    int processedBytes = 0;
-    bool isAdd = false;
-    bool isClone = false;
     // we handle these types of "edit" packets
     switch (message.getType()) {
         case PacketType::EntityErase: {
             QByteArray dataByteArray = QByteArray::fromRawData(reinterpret_cast<const char*>(editData), maxLength);
-            processedBytes = processEraseMessageDetails(dataByteArray, senderNode);
-            break;
+            return processEraseMessageDetails(dataByteArray, senderNode);
         }
 
         case PacketType::EntityClone:
-            isClone = true; // fall through to next case
-            // FALLTHRU
         case PacketType::EntityAdd:
-            isAdd = true;  // fall through to next case
-            // FALLTHRU
         case PacketType::EntityPhysics:
         case PacketType::EntityEdit: {
-            quint64 startDecode = 0, endDecode = 0;
-            quint64 startLookup = 0, endLookup = 0;
-            quint64 startUpdate = 0, endUpdate = 0;
-            quint64 startCreate = 0, endCreate = 0;
-            quint64 startFilter = 0, endFilter = 0;
-            quint64 startLogging = 0, endLogging = 0;
+            auto edit = decodeEdit(message, editData, maxLength, senderNode);
+            applyDecodedEdit(*edit, senderNode, false);
+            return edit->processedBytes;
+        }
 
-            bool suppressDisallowedClientScript = false;
-            bool suppressDisallowedServerScript = false;
-            bool suppressDisallowedPrivateUserData = false;
-            bool isPhysics = message.getType() == PacketType::EntityPhysics;
+        default:
+            return 0;
+    }
+}
 
-            _totalEditMessages++;
+OctreeDecodedEditPointer EntityTree::decodeEditPacketData(ReceivedMessage& message, const unsigned char* editData,
+                                                          int maxLength, const SharedNodePointer& senderNode) {
+    // erases are applied as they are decoded
+    PacketType packetType = message.getType();
+    if (!getIsServer() || !handlesEditPacketType(packetType) || packetType == PacketType::EntityErase) {
+        return nullptr;
+    }
+    return decodeEdit(message, editData, maxLength, senderNode);
+}
 
-            EntityItemID entityItemID;
-            EntityItemProperties properties;
-            startDecode = usecTimestampNow();
-
-            bool validEditPacket = false;
-            EntityItemID entityIDToClone;
-            EntityItemPointer entityToClone;
-            if (isClone) {
-                QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(editData), maxLength);
-                validEditPacket = EntityItemProperties::decodeCloneEntityMessage(buffer, processedBytes, entityIDToClone, entityItemID);
-                if (validEditPacket) {
-                    entityToClone = findEntityByEntityItemID(entityIDToClone);
-                    if (entityToClone) {
-                        properties = entityToClone->getProperties();
-                    }
-                }
-            } else {
-                validEditPacket = EntityItemProperties::decodeEntityEditPacket(editData, maxLength, processedBytes, entityItemID, properties);
-            }
+bool EntityTree::processDecodedEditInPlace(OctreeDecodedEdit& edit, const SharedNodePointer& senderNode) {
+    auto& entityEdit = static_cast<DecodedEdit&>(edit);
+    if (entityEdit.packetType != PacketType::EntityEdit && entityEdit.packetType != PacketType::EntityPhysics) {
+        return false;
+    }
+    return applyDecodedEdit(entityEdit, senderNode, true);
+}
 
-            endDecode = usecTimestampNow();
+void EntityTree::processDecodedEdit(OctreeDecodedEdit& edit, const SharedNodePointer& senderNode) {
+    applyDecodedEdit(static_cast<DecodedEdit&>(edit), senderNode, false);
+}
 
-            EntityItemPointer existingEntity;
-            if (!isAdd) {
-                // search for the entity by EntityItemID
-                startLookup = usecTimestampNow();
-                existingEntity = findEntityByEntityItemID(entityItemID);
-                endLookup = usecTimestampNow();
-                if (!existingEntity) {
-                    // this is not an add-entity operation, and we don't know about the identified entity.
-                    validEditPacket = false;
-                }
-            }
+std::unique_ptr<EntityTree::DecodedEdit> EntityTree::decodeEdit(ReceivedMessage& message, const unsigned char* editData,
+                                                                 int maxLength, const SharedNodePointer& senderNode) {
+    std::unique_ptr<DecodedEdit> edit(new DecodedEdit());
+    edit->packetType = message.getType();
 
-            if (validEditPacket && !_entityScriptSourceWhitelist.isEmpty()) {
+    quint64 startDecode = usecTimestampNow();
+    if (edit->packetType == PacketType::EntityClone) {
+        QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<const char*>(editData), maxLength);
+        edit->validEditPacket = EntityItemProperties::decodeCloneEntityMessage(buffer, edit->processedBytes,
+                                                                               edit->entityIDToClone, edit->entityItemID);
+        edit->decodeTime = usecTimestampNow() - startDecode;
+        // the properties of a clone are those of the entity it clones, they are validated when it is looked up
+    } else {
+        edit->validEditPacket = EntityItemProperties::decodeEntityEditPacket(editData, maxLength, edit->processedBytes,
+                                                                             edit->entityItemID, edit->properties);
+        edit->decodeTime = usecTimestampNow() - startDecode;
+        validateEdit(*edit, senderNode);
+    }
 
-                bool wasDeletedBecauseOfClientScript = false;
+    return edit;
+}
 
-                // check the client entity script to make sure its URL is in the whitelist
-                if (!properties.getScript().isEmpty()) {
-                    bool clientScriptPassedWhitelist = isScriptInWhitelist(properties.getScript());
+void EntityTree::validateEdit(DecodedEdit& edit, const SharedNodePointer& senderNode) {
+    bool isClone = edit.packetType == PacketType::EntityClone;
+    bool isAdd = isClone || edit.packetType == PacketType::EntityAdd;
 
-                    if (!clientScriptPassedWhitelist) {
-                        if (wantEditLogging()) {
-                            qCDebug(entities) << "User [" << senderNode->getUUID()
-                                << "] attempting to set entity script not on whitelist, edit rejected";
-                        }
+    if (edit.validEditPacket && !_entityScriptSourceWhitelist.isEmpty()) {
 
-                        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
-                        if (isAdd) {
-                            QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                            _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                            validEditPacket = false;
-                            wasDeletedBecauseOfClientScript = true;
-                        } else {
-                            suppressDisallowedClientScript = true;
-                        }
-                    }
-                }
+        bool wasDeletedBecauseOfClientScript = false;
 
-                // check all server entity scripts to make sure their URLs are in the whitelist
-                if (!properties.getServerScripts().isEmpty()) {
-                    bool serverScriptPassedWhitelist = isScriptInWhitelist(properties.getServerScripts());
+        // check the client entity script to make sure its URL is in the whitelist
+        if (!edit.properties.getScript().isEmpty()) {
+            bool clientScriptPassedWhitelist = isScriptInWhitelist(edit.properties.getScript());
 
-                    if (!serverScriptPassedWhitelist) {
-                        if (wantEditLogging()) {
-                            qCDebug(entities) << "User [" << senderNode->getUUID()
-                                << "] attempting to set server entity script not on whitelist, edit rejected";
-                        }
+            if (!clientScriptPassedWhitelist) {
+                if (wantEditLogging()) {
+                    qCDebug(entities) << "User [" << senderNode->getUUID()
+                        << "] attempting to set entity script not on whitelist, edit rejected";
+                }
 
-                        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
-                        if (isAdd) {
-                            // Make sure we didn't already need to send back a delete because the client script failed
-                            // the whitelist check
-                            if (!wasDeletedBecauseOfClientScript) {
-                                QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                                _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                                validEditPacket = false;
-                            }
-                        } else {
-                            suppressDisallowedServerScript = true;
-                        }
-                    }
+                // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
+                if (isAdd) {
+                    QWriteLocker locker(&_recentlyDeletedEntitiesLock);
+                    _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), edit.entityItemID);
+                    edit.validEditPacket = false;
+                    wasDeletedBecauseOfClientScript = true;
+                } else {
+                    edit.suppressDisallowedClientScript = true;
                 }
             }
+        }
 
-            if (!properties.getPrivateUserData().isEmpty() && validEditPacket && !senderNode->getCanGetAndSetPrivateUserData()) {
+        // check all server entity scripts to make sure their URLs are in the whitelist
+        if (!edit.properties.getServerScripts().isEmpty()) {
+            bool serverScriptPassedWhitelist = isScriptInWhitelist(edit.properties.getServerScripts());
+
+            if (!serverScriptPassedWhitelist) {
                 if (wantEditLogging()) {
                     qCDebug(entities) << "User [" << senderNode->getUUID()
-                        << "] is attempting to set private user data but user isn't allowed; edit rejected...";
+                        << "] attempting to set server entity script not on whitelist, edit rejected";
                 }
 
                 // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
                 if (isAdd) {
-                    QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                    _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                    validEditPacket = false;
+                    // Make sure we didn't already need to send back a delete because the client script failed
+                    // the whitelist check
+                    if (!wasDeletedBecauseOfClientScript) {
+                        QWriteLocker locker(&_recentlyDeletedEntitiesLock);
+                        _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), edit.entityItemID);
+                        edit.validEditPacket = false;
+                    }
                 } else {
-                    suppressDisallowedPrivateUserData = true;
+                    edit.suppressDisallowedServerScript = true;
                 }
             }
+        }
+    }
 
-            if (!isClone) {
-                if ((isAdd || properties.lifetimeChanged()) &&
-                    ((!senderNode->getCanRez() && senderNode->getCanRezTmp()) ||
-                    (!senderNode->getCanRezCertified() && senderNode->getCanRezTmpCertified()))) {
-                    // this node is only allowed to rez temporary entities.  if need be, cap the lifetime.
-                    if (properties.getLifetime() == ENTITY_ITEM_IMMORTAL_LIFETIME ||
-                        properties.getLifetime() > _maxTmpEntityLifetime) {
-                        properties.setLifetime(_maxTmpEntityLifetime);
-                        bumpTimestamp(properties);
-                    }
-                }
+    if (!edit.properties.getPrivateUserData().isEmpty() && edit.validEditPacket && !senderNode->getCanGetAndSetPrivateUserData()) {
+        if (wantEditLogging()) {
+            qCDebug(entities) << "User [" << senderNode->getUUID()
+                << "] is attempting to set private user data but user isn't allowed; edit rejected...";
+        }
 
-                if (isAdd && properties.getLocked() && !senderNode->isAllowedEditor()) {
-                    // if a node can't change locks, don't allow it to create an already-locked entity -- automatically
-                    // clear the locked property and allow the unlocked entity to be created.
-                    properties.setLocked(false);
-                    bumpTimestamp(properties);
-                }
+        // If this was an add, we also want to tell the client that sent this edit that the entity was not added.
+        if (isAdd) {
+            QWriteLocker locker(&_recentlyDeletedEntitiesLock);
+            _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), edit.entityItemID);
+            edit.validEditPacket = false;
+        } else {
+            edit.suppressDisallowedPrivateUserData = true;
+        }
+    }
+
+    if (!isClone) {
+        if ((isAdd || edit.properties.lifetimeChanged()) &&
+            ((!senderNode->getCanRez() && senderNode->getCanRezTmp()) ||
+            (!senderNode->getCanRezCertified() && senderNode->getCanRezTmpCertified()))) {
+            // this node is only allowed to rez temporary entities.  if need be, cap the lifetime.
+            if (edit.properties.getLifetime() == ENTITY_ITEM_IMMORTAL_LIFETIME ||
+                edit.properties.getLifetime() > _maxTmpEntityLifetime) {
+                edit.properties.setLifetime(_maxTmpEntityLifetime);
+                bumpTimestamp(edit.properties);
             }
+        }
 
-            // If we got a valid edit packet, then it could be a new entity or it could be an update to
-            // an existing entity... handle appropriately
-            if (validEditPacket) {
-                startFilter = usecTimestampNow();
-                bool wasChanged = false;
-                // Having (un)lock rights bypasses the filter, unless it's a physics result.
-                FilterType filterType = isPhysics ? FilterType::Physics : (isAdd ? FilterType::Add : FilterType::Edit);
-                bool allowed = (!isPhysics && senderNode->isAllowedEditor()) || filterProperties(existingEntity, properties, properties, wasChanged, filterType);
-                if (!allowed) {
-                    // the update failed and we need to convey that fact to the sender
-                    // our method is to re-assert the current properties and bump the lastEdited timestamp
-                    auto timestamp = properties.getLastEdited();
-                    properties = EntityItemProperties();
-                    properties.setLastEdited(timestamp);
-                }
-                if (!allowed || wasChanged) {
-                    bumpTimestamp(properties);
-                    // For now, free ownership on any modification.
-                    properties.clearSimulationOwner();
-                }
-                endFilter = usecTimestampNow();
+        if (isAdd && edit.properties.getLocked() && !senderNode->isAllowedEditor()) {
+            // if a node can't change locks, don't allow it to create an already-locked entity -- automatically
+            // clear the locked property and allow the unlocked entity to be created.
+            edit.properties.setLocked(false);
+            bumpTimestamp(edit.properties);
+        }
+    }
+}
 
-                if (existingEntity && !isAdd) {
+bool EntityTree::applyDecodedEdit(DecodedEdit& edit, const SharedNodePointer& senderNode, bool inPlace) {
+    quint64 startLookup = 0, endLookup = 0;
+    quint64 startUpdate = 0, endUpdate = 0;
+    quint64 startCreate = 0, endCreate = 0;
+    quint64 startFilter = 0, endFilter = 0;
+    quint64 startLogging = 0, endLogging = 0;
 
-                    if (suppressDisallowedClientScript) {
-                        bumpTimestamp(properties);
-                        properties.setScript(existingEntity->getScript());
-                    }
+    bool isClone = edit.packetType == PacketType::EntityClone;
+    bool isAdd = isClone || edit.packetType == PacketType::EntityAdd;
+    bool isPhysics = edit.packetType == PacketType::EntityPhysics;
+    const EntityItemID& entityItemID = edit.entityItemID;
+    const EntityItemID& entityIDToClone = edit.entityIDToClone;
 
-                    if (suppressDisallowedServerScript) {
-                        bumpTimestamp(properties);
-                        properties.setServerScripts(existingEntity->getServerScripts());
-                    }
+    EntityItemPointer entityToClone;
+    if (isClone && edit.validEditPacket) {
+        entityToClone = findEntityByEntityItemID(entityIDToClone);
+        if (entityToClone) {
+            edit.properties = entityToClone->getProperties();
+        }
+        validateEdit(edit, senderNode);
+    }
+    bool validEditPacket = edit.validEditPacket;
 
-                    if (suppressDisallowedPrivateUserData) {
-                        bumpTimestamp(properties);
-                        properties.setPrivateUserData(existingEntity->getPrivateUserData());
+    // an edit that can't be applied in place is applied again with the write lock, leave it as it was decoded
+    EntityItemProperties properties = inPlace ? edit.properties : std::move(edit.properties);
+    bool allowed = edit.filterAllowed;
+
+    EntityItemPointer existingEntity;
+    if (!isAdd) {
+        // search for the entity by EntityItemID
+        startLookup = usecTimestampNow();
+        existingEntity = findEntityByEntityItemID(entityItemID);
+        endLookup = usecTimestampNow();
+        if (!existingEntity) {
+            // this is not an add-entity operation, and we don't know about the identified entity.
+            validEditPacket = false;
+        }
+    }
+
+    // If we got a valid edit packet, then it could be a new entity or it could be an update to
+    // an existing entity... handle appropriately
+    if (validEditPacket) {
+        startFilter = usecTimestampNow();
+        // the filter already ran if this edit was tried in place first
+        if (!edit.wasFiltered) {
+            bool wasChanged = false;
+            // Having (un)lock rights bypasses the filter, unless it's a physics result.
+            FilterType filterType = isPhysics ? FilterType::Physics : (isAdd ? FilterType::Add : FilterType::Edit);
+            allowed = (!isPhysics && senderNode->isAllowedEditor()) || filterProperties(existingEntity, properties, properties, wasChanged, filterType);
+            if (!allowed) {
+                // the update failed and we need to convey that fact to the sender
+                // our method is to re-assert the current properties and bump the lastEdited timestamp
+                auto timestamp = properties.getLastEdited();
+                properties = EntityItemProperties();
+                properties.setLastEdited(timestamp);
+            }
+            if (!allowed || wasChanged) {
+                bumpTimestamp(properties);
+                // For now, free ownership on any modification.
+                properties.clearSimulationOwner();
+            }
+        }
+        endFilter = usecTimestampNow();
+
+        if (existingEntity && !isAdd) {
+            if (inPlace && !canUpdateEntityInPlace(existingEntity, properties)) {
+                // it moves to another element, the edit is processed again with the write lock, as it was filtered
+                edit.properties = std::move(properties);
+                edit.filterAllowed = allowed;
+                edit.wasFiltered = true;
+                return false;
+            }
+
+            if (edit.suppressDisallowedClientScript) {
+                bumpTimestamp(properties);
+                properties.setScript(existingEntity->getScript());
+            }
+
+            if (edit.suppressDisallowedServerScript) {
+                bumpTimestamp(properties);
+                properties.setServerScripts(existingEntity->getServerScripts());
+            }
+
+            if (edit.suppressDisallowedPrivateUserData) {
+                bumpTimestamp(properties);
+                properties.setPrivateUserData(existingEntity->getPrivateUserData());
+            }
+
+            // if the EntityItem exists, then update it
+            startLogging = usecTimestampNow();
+            if (wantEditLogging()) {
+                qCDebug(entities) << "User [" << senderNode->getUUID() << "] editing entity. ID:" << entityItemID;
+                qCDebug(entities) << "   properties:" << properties;
+            }
+            if (wantTerseEditLogging()) {
+                QList<QString> changedProperties = properties.listChangedProperties();
+                fixupTerseEditLogging(properties, changedProperties);
+                qCDebug(entities) << senderNode->getUUID() << "edit" <<
+                    existingEntity->getDebugName() << changedProperties;
+            }
+            endLogging = usecTimestampNow();
+
+            startUpdate = usecTimestampNow();
+            if (!isPhysics) {
+                properties.setLastEditedBy(senderNode->getUUID());
+            }
+            updateEntity(existingEntity, properties, senderNode, inPlace);
+            existingEntity->markAsChangedOnServer(properties.getChangedProperties());
+            endUpdate = usecTimestampNow();
+            _totalUpdates++;
+        } else if (isAdd) {
+            bool failedAdd = !allowed;
+            bool isCertified = !properties.getCertificateID().isEmpty();
+            bool isCloneable = properties.getCloneable();
+            int cloneLimit = properties.getCloneLimit();
+            if (!allowed) {
+                qCDebug(entities) << "Filtered entity add. ID:" << entityItemID;
+            } else if (!isClone && !isCertified && !senderNode->getCanRez() && !senderNode->getCanRezTmp()) {
+                failedAdd = true;
+                qCDebug(entities) << "User without 'uncertified rez rights' [" << senderNode->getUUID()
+                    << "] attempted to add an uncertified entity with ID:" << entityItemID;
+            } else if (!isClone && isCertified && !senderNode->getCanRezCertified() && !senderNode->getCanRezTmpCertified()) {
+                failedAdd = true;
+                qCDebug(entities) << "User without 'certified rez rights' [" << senderNode->getUUID()
+                    << "] attempted to add a certified entity with ID:" << entityItemID;
+            } else if (isClone && isCertified && !properties.getCertificateType().contains(DOMAIN_UNLIMITED)) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone certified entity from entity ID:" << entityIDToClone;
+            } else if (isClone && !isCloneable) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone non-cloneable entity from entity ID:" << entityIDToClone;
+            } else if (isClone && entityToClone && entityToClone->getCloneIDs().size() >= cloneLimit && cloneLimit != 0) {
+                failedAdd = true;
+                qCDebug(entities) << "User attempted to clone entity ID:" << entityIDToClone << " which reached it's cloneable limit.";
+            } else {
+                if (isClone) {
+                    properties.convertToCloneProperties(entityIDToClone);
+                }
+
+                // this is a new entity... assign a new entityID
+                properties.setLastEditedBy(senderNode->getUUID());
+                startCreate = usecTimestampNow();
+                EntityItemPointer newEntity = addEntity(entityItemID, properties);
+                endCreate = usecTimestampNow();
+                _totalCreates++;
+
+                if (newEntity && isCertified && getIsServer()) {
+                    if (!properties.verifyStaticCertificateProperties()) {
+                        qCDebug(entities) << "User" << senderNode->getUUID()
+                            << "attempted to add a certified entity with ID" << entityItemID << "which failed"
+                            << "static certificate verification.";
+                        // Delete the entity we just added if it doesn't pass static certificate verification
+                        deleteEntity(entityItemID, true);
+                    } else {
+                        validatePop(properties.getCertificateID(), entityItemID, senderNode);
                     }
+                }
+
+                if (newEntity && isClone) {
+                    entityToClone->addCloneID(newEntity->getEntityItemID());
+                    newEntity->setCloneOriginID(entityIDToClone);
+                }
 
-                    // if the EntityItem exists, then update it
+                if (newEntity) {
+                    newEntity->markAsChangedOnServer();
+                    notifyNewlyCreatedEntity(*newEntity, senderNode);
+                    
                     startLogging = usecTimestampNow();
                     if (wantEditLogging()) {
-                        qCDebug(entities) << "User [" << senderNode->getUUID() << "] editing entity. ID:" << entityItemID;
+                        qCDebug(entities) << "User [" << senderNode->getUUID() << "] added entity. ID:"
+                                          << newEntity->getEntityItemID();
                         qCDebug(entities) << "   properties:" << properties;
                     }
                     if (wantTerseEditLogging()) {
                         QList<QString> changedProperties = properties.listChangedProperties();
                         fixupTerseEditLogging(properties, changedProperties);
-                        qCDebug(entities) << senderNode->getUUID() << "edit" <<
-                            existingEntity->getDebugName() << changedProperties;
+                        qCDebug(entities) << senderNode->getUUID() << "add" << entityItemID << changedProperties;
                     }
                     endLogging = usecTimestampNow();
 
-                    startUpdate = usecTimestampNow();
-                    if (!isPhysics) {
-                        properties.setLastEditedBy(senderNode->getUUID());
-                    }
-                    updateEntity(existingEntity, properties, senderNode);
-                    existingEntity->markAsChangedOnServer();
-                    endUpdate = usecTimestampNow();
-                    _totalUpdates++;
-                } else if (isAdd) {
-                    bool failedAdd = !allowed;
-                    bool isCertified = !properties.getCertificateID().isEmpty();
-                    bool isCloneable = properties.getCloneable();
-                    int cloneLimit = properties.getCloneLimit();
-                    if (!allowed) {
-                        qCDebug(entities) << "Filtered entity add. ID:" << entityItemID;
-                    } else if (!isClone && !isCertified && !senderNode->getCanRez() && !senderNode->getCanRezTmp()) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User without 'uncertified rez rights' [" << senderNode->getUUID()
-                            << "] attempted to add an uncertified entity with ID:" << entityItemID;
-                    } else if (!isClone && isCertified && !senderNode->getCanRezCertified() && !senderNode->getCanRezTmpCertified()) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User without 'certified rez rights' [" << senderNode->getUUID()
-                            << "] attempted to add a certified entity with ID:" << entityItemID;
-                    } else if (isClone && isCertified && !properties.getCertificateType().contains(DOMAIN_UNLIMITED)) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone certified entity from entity ID:" << entityIDToClone;
-                    } else if (isClone && !isCloneable) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone non-cloneable entity from entity ID:" << entityIDToClone;
-                    } else if (isClone && entityToClone && entityToClone->getCloneIDs().size() >= cloneLimit && cloneLimit != 0) {
-                        failedAdd = true;
-                        qCDebug(entities) << "User attempted to clone entity ID:" << entityIDToClone << " which reached it's cloneable limit.";
-                    } else {
-                        if (isClone) {
-                            properties.convertToCloneProperties(entityIDToClone);
-                        }
-
-                        // this is a new entity... assign a new entityID
-                        properties.setLastEditedBy(senderNode->getUUID());
-                        startCreate = usecTimestampNow();
-                        EntityItemPointer newEntity = addEntity(entityItemID, properties);
-                        endCreate = usecTimestampNow();
-                        _totalCreates++;
-
-                        if (newEntity && isCertified && getIsServer()) {
-                            if (!properties.verifyStaticCertificateProperties()) {
-                                qCDebug(entities) << "User" << senderNode->getUUID()
-                                    << "attempted to add a certified entity with ID" << entityItemID << "which failed"
-                                    << "static certificate verification.";
-                                // Delete the entity we just added if it doesn't pass static certificate verification
-                                deleteEntity(entityItemID, true);
-                            } else {
-                                validatePop(properties.getCertificateID(), entityItemID, senderNode);
-                            }
-                        }
-
-                        if (newEntity && isClone) {
-                            entityToClone->addCloneID(newEntity->getEntityItemID());
-                            newEntity->setCloneOriginID(entityIDToClone);
-                        }
-
-                        if (newEntity) {
-                            newEntity->markAsChangedOnServer();
-                            notifyNewlyCreatedEntity(*newEntity, senderNode);
-                            
-                            startLogging = usecTimestampNow();
-                            if (wantEditLogging()) {
-                                qCDebug(entities) << "User [" << senderNode->getUUID() << "] added entity. ID:"
-                                                  << newEntity->getEntityItemID();
-                                qCDebug(entities) << "   properties:" << properties;
-                            }
-                            if (wantTerseEditLogging()) {
-                                QList<QString> changedProperties = properties.listChangedProperties();
-                                fixupTerseEditLogging(properties, changedProperties);
-                                qCDebug(entities) << senderNode->getUUID() << "add" << entityItemID << changedProperties;
-                            }
-                            endLogging = usecTimestampNow();
-
-                        } else {
-                            failedAdd = true;
-                            qCDebug(entities) << "Add entity failed ID:" << entityItemID;
-                        }
-                    }
-                    if (failedAdd) { // Let client know it failed, so that they don't have an entity that no one else sees.
-                        QWriteLocker locker(&_recentlyDeletedEntitiesLock);
-                        _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
-                    }
                 } else {
-                    HIFI_FCDEBUG(entities(), "Edit failed. [" << message.getType() <<"] " <<
-                            "entity id:" << entityItemID << 
-                            "existingEntity pointer:" << existingEntity.get());
+                    failedAdd = true;
+                    qCDebug(entities) << "Add entity failed ID:" << entityItemID;
                 }
             }
+            if (failedAdd) { // Let client know it failed, so that they don't have an entity that no one else sees.
+                QWriteLocker locker(&_recentlyDeletedEntitiesLock);
+                _recentlyDeletedEntityItemIDs.insert(usecTimestampNow(), entityItemID);
+            }
+        } else {
+            HIFI_FCDEBUG(entities(), "Edit failed. [" << edit.packetType <<"] " <<
+                    "entity id:" << entityItemID << 
+                    "existingEntity pointer:" << existingEntity.get());
+        }
+    }
 
 
-            _totalDecodeTime += endDecode - startDecode;
-            _totalLookupTime += endLookup - startLookup;
-            _totalUpdateTime += endUpdate - startUpdate;
-            _totalCreateTime += endCreate - startCreate;
-            _totalLoggingTime += endLogging - startLogging;
-            _totalFilterTime += endFilter - startFilter;
-
-            break;
-        }
+    _totalEditMessages++;
+    _totalDecodeTime += edit.decodeTime;
+    _totalLookupTime += endLookup - startLookup;
+    _totalUpdateTime += endUpdate - startUpdate;
+    _totalCreateTime += endCreate - startCreate;
+    _totalLoggingTime += endLogging - startLogging;
+    _totalFilterTime += endFilter - startFilter;
 
-        default:
-            processedBytes = 0;
-            break;
-    }
-    return processedBytes;
+    return true;
 }
 
-
 void EntityTree::notifyNewlyCreatedEntity(const EntityItem& newEntity, const SharedNodePointer& senderNode) {
     _newlyCreatedHooksLock.lockForRead();
     for (int i = 0; i < _newlyCreatedHooks.size(); i++) {
@@ -3097,17 +3249,255 @@ bool EntityTree::readFromMap(QVariantMap& map) {
     return success;
 }
 
+std::vector<EntityItemPointer> EntityTree::listEntities(const OctreeElementPointer& element) {
+    std::vector<EntityItemPointer> entities;
+    withReadLock([&] {
+        OctreeElementPointer top = element ? element : _rootElement;
+        recurseElementWithOperation(top, [&](const OctreeElementPointer& treeElement, void* extraData) {
+            std::static_pointer_cast<EntityTreeElement>(treeElement)->forEachEntity([&](const EntityItemPointer& entity) {
+                entities.push_back(entity);
+            });
+            return true;
+        }, nullptr);
+    });
+    return entities;
+}
+
+std::vector<EntityItemProperties> EntityTree::copyEntityProperties(const OctreeElementPointer& element) {
+    std::vector<EntityItemProperties> entityProperties;
+    // the write lock rather than the read lock, which the edits applied in place only need
+    withWriteLock([&] {
+        OctreeElementPointer top = element ? element : _rootElement;
+        recurseElementWithOperation(top, [&](const OctreeElementPointer& treeElement, void* extraData) {
+            std::static_pointer_cast<EntityTreeElement>(treeElement)->forEachEntity([&](const EntityItemPointer& entity) {
+                entityProperties.push_back(entity->getProperties());
+            });
+            return true;
+        }, nullptr);
+    });
+    return entityProperties;
+}
+
 bool EntityTree::writeToJSON(QString& jsonString, const OctreeElementPointer& element) {
+    // the properties of all the entities are copied as they are at one point in time, and serialized once the tree
+    // lock is released, so that the edits to the tree aren't held up for the whole export
+    std::vector<EntityItemProperties> entityProperties = copyEntityProperties(element);
+
     QScriptEngine scriptEngine;
     RecurseOctreeToJSONOperator theOperator(element, &scriptEngine, jsonString);
-    withReadLock([&] {
-        recurseTreeWithOperator(&theOperator);
-    });
+    for (const auto& properties : entityProperties) {
+        theOperator.processProperties(properties);
+    }
 
     jsonString = theOperator.getJson();
     return true;
 }
 
+bool EntityTree::writeToBinaryFile(const QString& fileName, const OctreeElementPointer& element) {
+    // only a snapshot of the whole tree has a journal
+    bool isWholeTree = !element || element == _rootElement;
+    if (isWholeTree) {
+        // the changes made from here on go to the journal of the new snapshot, the ones still pending go there too if
+        // the old journal is replaced by then, or to the old one if the new snapshot fails
+        std::lock_guard<std::mutex> lock(_journalMutex);
+        _isJournaling = true;
+    }
+
+    // the entities are listed under the tree lock, and encoded after it is released, each under its own lock: what
+    // changes meanwhile is journaled, so loading the snapshot and its journal still gives one point in time
+    std::vector<EntityItemPointer> entities = listEntities(element);
+
+    EntitySnapshotWriter writer(fileName);
+    if (!writer.begin(_persistID, _persistDataVersion)) {
+        return false;
+    }
+
+    for (const auto& entity : entities) {
+        // like the JSON export, leave out the entities whose parent can't be found
+        if (entity->isDead() || !entity->isParentIDValid()) {
+            continue;
+        }
+        if (!writer.append(*entity)) {
+            return false;
+        }
+    }
+
+    if (!writer.finish()) {
+        return false;
+    }
+
+    if (isWholeTree) {
+        if (!_journal) {
+            _journal.reset(new EntityJournalWriter());
+        }
+        _journal->create(EntityJournalWriter::fileNameForSnapshot(fileName), _persistID, _persistDataVersion);
+        _journalDataVersion = _persistDataVersion;
+    }
+    return true;
+}
+
+bool EntityTree::readFromBinaryFile(const QString& fileName) {
+    // the entities added while reading aren't changes to journal
+    {
+        std::lock_guard<std::mutex> lock(_journalMutex);
+        _isJournaling = false;
+        _journalChanges.clear();
+    }
+    if (_journal) {
+        _journal->close();
+    }
+
+    EntitySnapshotReader reader;
+    if (!reader.open(fileName)) {
+        return false;
+    }
+
+    // the changes made after the snapshot was written replace the entities they were made to
+    QString journalFileName = EntityJournalWriter::fileNameForSnapshot(fileName);
+    EntityJournalReader journal;
+    bool hasJournal = journal.open(journalFileName, reader.getID(), reader.getDataVersion());
+
+    _persistID = reader.getID();
+    _persistDataVersion = (int)reader.getDataVersion();
+    if (hasJournal && journal.getDataVersion() >= 0) {
+        _persistDataVersion = (int)journal.getDataVersion();
+    }
+
+    QMap<QUuid, QVector<QUuid>> cloneIDs;
+
+    bool success = true;
+    auto addDecodedEntity = [&](const EntityItemID& entityItemID, const EntityItemProperties& properties) {
+        EntityItemPointer entity = addEntity(entityItemID, properties);
+        if (!entity) {
+            qCDebug(entities) << "adding Entity failed:" << entityItemID << properties.getType();
+            success = false;
+            return;
+        }
+
+        const QUuid& cloneOriginID = entity->getCloneOriginID();
+        if (!cloneOriginID.isNull()) {
+            cloneIDs[cloneOriginID].push_back(entity->getEntityItemID());
+        }
+    };
+
+    for (int i = 0; i < reader.getNumEntities(); ++i) {
+        if (hasJournal && journal.hasChanged(reader.getEntityID(i))) {
+            continue;
+        }
+
+        EntityItemID entityItemID;
+        EntityItemProperties properties;
+        if (!reader.readEntity(i, entityItemID, properties)) {
+            qCDebug(entities) << "decoding Entity failed:" << reader.getEntityID(i);
+            success = false;
+            continue;
+        }
+        addDecodedEntity(entityItemID, properties);
+    }
+
+    if (hasJournal) {
+        for (const auto& changedID : journal.getChangedEntities()) {
+            if (journal.isDeleted(changedID)) {
+                continue;
+            }
+
+            EntityItemID entityItemID;
+            EntityItemProperties properties;
+            if (!journal.readEntity(changedID, entityItemID, properties)) {
+                qCDebug(entities) << "decoding journaled Entity failed:" << changedID;
+                success = false;
+                continue;
+            }
+            addDecodedEntity(entityItemID, properties);
+        }
+    }
+
+    for (const auto& entityID : cloneIDs.keys()) {
+        auto entity = findEntityByID(entityID);
+        if (entity) {
+            entity->setCloneIDs(cloneIDs.value(entityID));
+        }
+    }
+
+    // the changes made from here on are appended to the journal
+    {
+        std::lock_guard<std::mutex> lock(_journalMutex);
+        _isJournaling = true;
+    }
+    if (!_journal) {
+        _journal.reset(new EntityJournalWriter());
+    }
+    if (hasJournal) {
+        _journal->openForAppend(journalFileName, journal.getValidSize());
+    } else {
+        _journal->create(journalFileName, reader.getID(), reader.getDataVersion());
+    }
+    _journalDataVersion = _persistDataVersion;
+
+    return success;
+}
+
+bool EntityTree::readBinaryFileInfo(const QString& fileName, QUuid& id, int64_t& dataVersion) const {
+    qint64 snapshotDataVersion;
+    if (!EntitySnapshotReader::readInfo(fileName, id, snapshotDataVersion)) {
+        return false;
+    }
+    dataVersion = snapshotDataVersion;
+
+    qint64 journalDataVersion;
+    if (EntityJournalReader::readInfo(EntityJournalWriter::fileNameForSnapshot(fileName), id, snapshotDataVersion,
+                                      journalDataVersion) && journalDataVersion >= 0) {
+        dataVersion = journalDataVersion;
+    }
+    return true;
+}
+
+bool EntityTree::writeToBinaryJournal(qint64& journalSize) {
+    QHash<EntityItemID, EntityItemPointer> changes;
+    {
+        std::lock_guard<std::mutex> lock(_journalMutex);
+        if (!_isJournaling) {
+            return false;
+        }
+        changes.swap(_journalChanges);
+    }
+
+    if (!_journal || !_journal->isOpen()) {
+        return false;
+    }
+
+    bool success = true;
+    for (auto it = changes.cbegin(); success && it != changes.cend(); ++it) {
+        const EntityItemPointer& entity = it.value();
+        if (entity && !entity->isDead()) {
+            success = _journal->writeEntity(*entity);
+        } else {
+            success = _journal->writeDelete(it.key());
+        }
+    }
+
+    if (success && _persistDataVersion != _journalDataVersion) {
+        success = _journal->writeDataVersion(_persistDataVersion);
+        _journalDataVersion = _persistDataVersion;
+    }
+
+    if (!success || !_journal->flush()) {
+        // the changes that didn't make it are only persisted by the next snapshot
+        _journal->close();
+        return false;
+    }
+
+    journalSize = _journal->getSize();
+    return true;
+}
+
+void EntityTree::journalEntityChange(const EntityItemID& entityID, const EntityItemPointer& entity) {
+    std::lock_guard<std::mutex> lock(_journalMutex);
+    if (_isJournaling) {
+        _journalChanges[entityID] = entity;
+    }
+}
+
 void EntityTree::resetClientEditStats() {
     _treeResetTime = usecTimestampNow();
     _maxEditDelta = 0;
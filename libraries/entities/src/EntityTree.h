@@ -12,6 +12,9 @@
 #ifndef hifi_EntityTree_h
 #define hifi_EntityTree_h
 
+#include <mutex>
+#include <unordered_set>
+
 #include <QSet>
 #include <QVector>
 
@@ -27,6 +30,7 @@ class EntityTree;
 using EntityTreePointer = std::shared_ptr<EntityTree>;
 
 class EntitySimulation;
+class EntityJournalWriter;
 
 namespace EntityQueryFilterSymbol {
     static const QString NonDefault = "+";
@@ -89,6 +93,12 @@ public:
     void fixupTerseEditLogging(EntityItemProperties& properties, QList<QString>& changedProperties);
     virtual int processEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
                                       const SharedNodePointer& senderNode) override;
+    virtual OctreeDecodedEditPointer decodeEditPacketData(ReceivedMessage& message, const unsigned char* editData,
+                                                          int maxLength, const SharedNodePointer& senderNode) override;
+    virtual bool processDecodedEditInPlace(OctreeDecodedEdit& edit, const SharedNodePointer& senderNode) override;
+    virtual void processDecodedEdit(OctreeDecodedEdit& edit, const SharedNodePointer& senderNode) override;
+    virtual void beginEditBatch() override;
+    virtual void endEditBatch() override;
     virtual void processChallengeOwnershipRequestPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
     virtual void processChallengeOwnershipReplyPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
     virtual void processChallengeOwnershipPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) override;
@@ -198,6 +208,14 @@ public:
     virtual bool readFromMap(QVariantMap& entityDescription) override;
     virtual bool writeToJSON(QString& jsonString, const OctreeElementPointer& element) override;
 
+    virtual bool writeToBinaryFile(const QString& fileName, const OctreeElementPointer& element) override;
+    virtual bool readFromBinaryFile(const QString& fileName) override;
+    virtual bool readBinaryFileInfo(const QString& fileName, QUuid& id, int64_t& dataVersion) const override;
+    virtual bool writeToBinaryJournal(qint64& journalSize) override;
+    // Has the entity written to the journal with the next changes, or its deletion if entity is null. The edits and
+    // deletes do it on their own, the simulation does it for the changes it makes.
+    void journalEntityChange(const EntityItemID& entityID, const EntityItemPointer& entity);
+
 
     glm::vec3 getContentsDimensions();
     float getContentsLargestDimension();
@@ -296,7 +314,35 @@ protected:
     void recursivelyFilterAndCollectForDelete(const EntityItemPointer& entity, std::vector<EntityItemPointer>& entitiesToDelete, bool force) const;
     void processRemovedEntities(const DeleteEntityOperator& theOperator);
     bool updateEntity(EntityItemPointer entity, const EntityItemProperties& properties,
-            const SharedNodePointer& senderNode = SharedNodePointer(nullptr));
+            const SharedNodePointer& senderNode = SharedNodePointer(nullptr), bool inPlace = false);
+
+    // an add, clone or edit of an entity, decoded and checked against the permissions of its sender
+    struct DecodedEdit : public OctreeDecodedEdit {
+        PacketType packetType { PacketType::Unknown };
+        EntityItemID entityItemID;
+        EntityItemID entityIDToClone;
+        EntityItemProperties properties;
+        bool validEditPacket { false };
+        bool suppressDisallowedClientScript { false };
+        bool suppressDisallowedServerScript { false };
+        bool suppressDisallowedPrivateUserData { false };
+        // set once the edit filter has run on the properties, so that it doesn't run again when an edit that can't be
+        // applied in place is applied with the write lock
+        bool wasFiltered { false };
+        bool filterAllowed { true };
+        quint64 decodeTime { 0 };
+    };
+    std::unique_ptr<DecodedEdit> decodeEdit(ReceivedMessage& message, const unsigned char* editData, int maxLength,
+                                            const SharedNodePointer& senderNode);
+    void validateEdit(DecodedEdit& edit, const SharedNodePointer& senderNode);
+    // Returns false if it is applied in place but can't be, the edit is then left as it was filtered.
+    bool applyDecodedEdit(DecodedEdit& edit, const SharedNodePointer& senderNode, bool inPlace);
+
+    bool canUpdateEntityInPlace(const EntityItemPointer& entity, const EntityItemProperties& properties) const;
+    void updateEntityElement(const EntityTreeElementPointer& containingElement, const EntityItemPointer& entity,
+                             const AACube& newQueryAACube, bool inPlace);
+    void markEntityElementChanged(const EntityTreeElementPointer& containingElement);
+    void applyBatchedEntityMoves();
     static bool sendEntitiesOperation(const OctreeElementPointer& element, void* extraData);
     static void bumpTimestamp(EntityItemProperties& properties);
 
@@ -367,11 +413,14 @@ protected:
 
     float _maxTmpEntityLifetime { DEFAULT_MAX_TMP_ENTITY_LIFETIME };
 
-    bool filterProperties(const EntityItemPointer& existingEntity, EntityItemProperties& propertiesIn, EntityItemProperties& propertiesOut, bool& wasChanged, FilterType filterType) const;
+    virtual bool filterProperties(const EntityItemPointer& existingEntity, EntityItemProperties& propertiesIn, EntityItemProperties& propertiesOut, bool& wasChanged, FilterType filterType) const;
     bool _hasEntityEditFilter{ false };
     QStringList _entityScriptSourceWhitelist;
 
     MovingEntitiesOperator _entityMover;
+
+    bool _isBatchingEdits { false };
+    std::unordered_set<EntityItemPointer> _batchedEntityMoves; // moved to the elements they fit in by endEditBatch(), or before a delete
     QHash<EntityItemID, EntityItemPointer> _entitiesToAdd;
 
     Q_INVOKABLE void startChallengeOwnershipTimer(const EntityItemID& entityItemID);
@@ -398,6 +447,20 @@ private:
 
     void updateEntityQueryAACubeWorker(SpatiallyNestablePointer object, EntityEditPacketSender* packetSender,
                                        MovingEntitiesOperator& moveOperator, bool force, bool tellServer);
+
+    // the entities under an element, or in the whole tree, listed under the tree lock
+    std::vector<EntityItemPointer> listEntities(const OctreeElementPointer& element);
+    // their properties, copied under one hold of the write lock
+    std::vector<EntityItemProperties> copyEntityProperties(const OctreeElementPointer& element);
+
+    // the journal of the binary snapshot last read or written, which only the persist thread writes to
+    std::unique_ptr<EntityJournalWriter> _journal;
+    qint64 _journalDataVersion { 0 };
+
+    // the changes not written to the journal yet, with no entity for the deleted ones
+    std::mutex _journalMutex;
+    bool _isJournaling { false };
+    QHash<EntityItemID, EntityItemPointer> _journalChanges;
 };
 
 void convertGrabUserDataToProperties(EntityItemProperties& properties);
@@ -34,9 +34,13 @@ void RecurseOctreeToJSONOperator::processEntity(const EntityItemPointer& entity)
         return;  // we weren't able to resolve a parent from _parentID, so don't save this entity.
     }
 
+    processProperties(entity->getProperties());
+}
+
+void RecurseOctreeToJSONOperator::processProperties(const EntityItemProperties& properties) {
     QScriptValue qScriptValues = _skipDefaults
-        ? EntityItemNonDefaultPropertiesToScriptValue(_engine, entity->getProperties())
-        : EntityItemPropertiesToScriptValue(_engine, entity->getProperties());
+        ? EntityItemNonDefaultPropertiesToScriptValue(_engine, properties)
+        : EntityItemPropertiesToScriptValue(_engine, properties);
 
     if (_comma) {
         _json += ',';
@@ -20,8 +20,12 @@ public:
 
     QString getJson() const { return _json; }
 
-private:
+    // Appends an entity without going through the tree, the entity has to be locked by its own lock only.
     void processEntity(const EntityItemPointer& entity);
+    // Appends an entity from a copy of its properties, which takes no lock.
+    void processProperties(const EntityItemProperties& properties);
+
+private:
 
     QScriptEngine* _engine;
     QScriptValue _toStringMethod;
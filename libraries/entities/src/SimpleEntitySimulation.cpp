@@ -36,7 +36,7 @@ void SimpleEntitySimulation::clearOwnership(const QUuid& ownerID) {
 
             // remove ownership and dirty all the tree elements that contain the it
             entity->clearSimulationOwnership();
-            entity->markAsChangedOnServer();
+            entity->markAsChangedOnServer(PROP_SIMULATION_OWNER);
             if (auto element = entity->getElement()) {
                 DirtyOctreeElementOperator op(element);
                 getEntityTree()->recurseTreeWithOperator(&op);
@@ -172,7 +172,7 @@ void SimpleEntitySimulation::expireStaleOwnerships(uint64_t now) {
 
                 // remove ownership and dirty all the tree elements that contain the it
                 entity->clearSimulationOwnership();
-                entity->markAsChangedOnServer();
+                entity->markAsChangedOnServer(PROP_SIMULATION_OWNER);
                 DirtyOctreeElementOperator op(entity->getElement());
                 getEntityTree()->recurseTreeWithOperator(&op);
             } else {
@@ -203,7 +203,8 @@ void SimpleEntitySimulation::stopOwnerlessEntities(uint64_t now) {
                     entity->setAcceleration(Vectors::ZERO);
 
                     // dirty all the tree elements that contain it
-                    entity->markAsChangedOnServer();
+                    entity->markAsChangedOnServer(EntityPropertyFlags(PROP_VELOCITY) + PROP_ANGULAR_VELOCITY +
+                                                  PROP_ACCELERATION);
                     DirtyOctreeElementOperator op(entity->getElement());
                     getEntityTree()->recurseTreeWithOperator(&op);
                 }
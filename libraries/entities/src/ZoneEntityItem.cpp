@@ -471,17 +471,15 @@ void ZoneEntityItem::fetchCollisionGeometryResource() {
     }
 }
 
-bool ZoneEntityItem::matchesJSONFilters(const QJsonObject& jsonFilters) const {
+bool ZoneEntityItem::matchesJSONFilters(const EntityJSONFilter& jsonFilter) const {
     // currently the only property filter we handle in ZoneEntityItem is value of avatarPriority
 
-    static const QString AVATAR_PRIORITY_PROPERTY = "avatarPriority";
-
     // If set match zones of interest to avatar mixer:
-    if (jsonFilters.contains(AVATAR_PRIORITY_PROPERTY) && jsonFilters[AVATAR_PRIORITY_PROPERTY].toBool()
+    if (jsonFilter.wantsAvatarPriorityZones()
         && (_avatarPriority != COMPONENT_MODE_INHERIT || _screenshare != COMPONENT_MODE_INHERIT)) {
         return true;
     }
 
     // Chain to base:
-    return EntityItem::matchesJSONFilters(jsonFilters);
+    return EntityItem::matchesJSONFilters(jsonFilter);
 }
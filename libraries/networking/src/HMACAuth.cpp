@@ -16,7 +16,115 @@
 
 #include <QUuid>
 #include "NetworkLogging.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+
+namespace {
+
+const int SIPHASH_KEY_BYTES = 16;
+const int SIPHASH_OUTPUT_BYTES = 16;
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t readLittleEndian64(const unsigned char* bytes) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+inline void writeLittleEndian64(uint64_t value, unsigned char* bytes) {
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+struct SipHashState {
+    uint64_t v0, v1, v2, v3;
+
+    void round() {
+        v0 += v1; v1 = rotateLeft(v1, 13); v1 ^= v0; v0 = rotateLeft(v0, 32);
+        v2 += v3; v3 = rotateLeft(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = rotateLeft(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = rotateLeft(v1, 17); v1 ^= v2; v2 = rotateLeft(v2, 32);
+    }
+
+    void compress(uint64_t message) {
+        v3 ^= message;
+        round();
+        round();
+        v0 ^= message;
+    }
+
+    uint64_t finalize() {
+        round();
+        round();
+        round();
+        round();
+        return v0 ^ v1 ^ v2 ^ v3;
+    }
+};
+
+// SipHash-2-4 with 128-bit output, as described in https://131002.net/siphash/siphash.pdf
+// The message is data followed by tail, so a packet and a payload held elsewhere can be hashed in place.
+void sipHash128(uint64_t key0, uint64_t key1, const unsigned char* data, int dataLen,
+                const unsigned char* tail, int tailLen, unsigned char* output) {
+    SipHashState state {
+        0x736f6d6570736575ULL ^ key0,
+        0x646f72616e646f6dULL ^ key1 ^ 0xee,
+        0x6c7967656e657261ULL ^ key0,
+        0x7465646279746573ULL ^ key1
+    };
+
+    const int BLOCK_BYTES = sizeof(uint64_t);
+    unsigned char partialBlock[BLOCK_BYTES];
+    int partialBlockSize = 0;
+
+    auto absorb = [&](const unsigned char* bytes, int numBytes) {
+        // complete a block left over from the previous span first
+        while (partialBlockSize > 0 && numBytes > 0) {
+            partialBlock[partialBlockSize++] = *bytes++;
+            --numBytes;
+
+            if (partialBlockSize == BLOCK_BYTES) {
+                state.compress(readLittleEndian64(partialBlock));
+                partialBlockSize = 0;
+            }
+        }
+
+        const int remainingBytes = numBytes % BLOCK_BYTES;
+        const unsigned char* end = bytes + (numBytes - remainingBytes);
+        for (; bytes != end; bytes += BLOCK_BYTES) {
+            state.compress(readLittleEndian64(bytes));
+        }
+
+        if (remainingBytes > 0) {
+            memcpy(partialBlock, bytes, remainingBytes);
+            partialBlockSize = remainingBytes;
+        }
+    };
+
+    absorb(data, dataLen);
+    absorb(tail, tailLen);
+
+    // the final block holds the remaining bytes and the low byte of the length in its most significant byte
+    uint64_t lastBlock = ((uint64_t)(dataLen + tailLen)) << 56;
+    for (int i = partialBlockSize - 1; i >= 0; --i) {
+        lastBlock |= ((uint64_t)partialBlock[i]) << (8 * i);
+    }
+    state.compress(lastBlock);
+
+    state.v2 ^= 0xee;
+    writeLittleEndian64(state.finalize(), output);
+    state.v1 ^= 0xdd;
+    writeLittleEndian64(state.finalize(), output + sizeof(uint64_t));
+}
+
+}
 
 #if OPENSSL_VERSION_NUMBER >= 0x10100000
 HMACAuth::HMACAuth(AuthMethod authMethod)
@@ -42,10 +150,28 @@ HMACAuth::~HMACAuth() {
 }
 #endif
 
+void HMACAuth::setAuthMethod(AuthMethod authMethod) {
+    QMutexLocker lock(&_lock);
+    _authMethod = authMethod;
+    _sipHashPendingData.clear();
+}
+
 bool HMACAuth::setKey(const char* keyValue, int keyLen) {
+    // SipHash takes exactly 128 bits of key - longer keys are truncated and shorter keys are zero padded. The key is
+    // kept whatever the method, so that a switch to SipHash never hashes with a stale key.
+    unsigned char key[SIPHASH_KEY_BYTES] {};
+    memcpy(key, keyValue, std::max(0, std::min(keyLen, SIPHASH_KEY_BYTES)));
+    auto sipHashKey = std::make_shared<SipHashKey>();
+    sipHashKey->key0 = readLittleEndian64(key);
+    sipHashKey->key1 = readLittleEndian64(key + sizeof(uint64_t));
+    std::atomic_store(&_sipHashKey, std::shared_ptr<const SipHashKey>(sipHashKey));
+
     const EVP_MD* sslStruct = nullptr;
 
     switch (_authMethod) {
+    case SIPHASH:
+        return true;
+
     case MD5:
         sslStruct = EVP_md5();
         break;
@@ -81,13 +207,27 @@ bool HMACAuth::setKey(const QUuid& uidKey) {
 
 bool HMACAuth::addData(const char* data, int dataLen) {
     QMutexLocker lock(&_lock);
+    if (_authMethod == SIPHASH) {
+        // SipHash has no incremental interface here, so hold on to the data until result() is called
+        _sipHashPendingData.append(data, dataLen);
+        return true;
+    }
     return (bool) HMAC_Update(_hmacContext, reinterpret_cast<const unsigned char*>(data), dataLen);
 }
 
 HMACAuth::HMACHash HMACAuth::result() {
+    QMutexLocker lock(&_lock);
+    if (_authMethod == SIPHASH) {
+        HMACHash hashValue(SIPHASH_OUTPUT_BYTES);
+        auto sipHashKey = std::atomic_load(&_sipHashKey);
+        sipHash128(sipHashKey->key0, sipHashKey->key1, reinterpret_cast<const unsigned char*>(_sipHashPendingData.constData()),
+                   _sipHashPendingData.size(), nullptr, 0, hashValue.data());
+        _sipHashPendingData.clear();
+        return hashValue;
+    }
+
     HMACHash hashValue(EVP_MAX_MD_SIZE);
     unsigned int hashLen;
-    QMutexLocker lock(&_lock);
     
     auto hmacResult = HMAC_Final(_hmacContext, &hashValue[0], &hashLen);
     
@@ -105,8 +245,21 @@ HMACAuth::HMACHash HMACAuth::result() {
 }
 
 bool HMACAuth::calculateHash(HMACHash& hashResult, const char* data, int dataLen) {
+    return calculateHash(hashResult, data, dataLen, nullptr, 0);
+}
+
+bool HMACAuth::calculateHash(HMACHash& hashResult, const char* data, int dataLen, const char* tail, int tailLen) {
+    if (_authMethod == SIPHASH) {
+        // the SipHash state lives on the stack, so there is nothing to lock
+        hashResult.resize(SIPHASH_OUTPUT_BYTES);
+        auto sipHashKey = std::atomic_load(&_sipHashKey);
+        sipHash128(sipHashKey->key0, sipHashKey->key1, reinterpret_cast<const unsigned char*>(data), dataLen,
+                   reinterpret_cast<const unsigned char*>(tail), tailLen, hashResult.data());
+        return true;
+    }
+
     QMutexLocker lock(&_lock);
-    if (!addData(data, dataLen)) {
+    if (!addData(data, dataLen) || (tailLen > 0 && !addData(tail, tailLen))) {
         qCWarning(networking) << "Error occured calling HMACAuth::addData()";
         assert(false);
         return false;
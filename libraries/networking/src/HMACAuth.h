@@ -12,24 +12,35 @@
 #ifndef hifi_HMACAuth_h
 #define hifi_HMACAuth_h
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <QtCore/QByteArray>
 #include <QtCore/QMutex>
 
 class QUuid;
 
 class HMACAuth {
 public:
-    enum AuthMethod { MD5, SHA1, SHA224, SHA256, RIPEMD160 };
+    // SIPHASH is SipHash-2-4 with a 128-bit output. It is not an HMAC, but it is a keyed MAC that produces
+    // the same 16 byte verification hash as MD5 at a fraction of the cost, and it is computed without taking _lock.
+    enum AuthMethod { MD5, SHA1, SHA224, SHA256, RIPEMD160, SIPHASH };
     using HMACHash = std::vector<unsigned char>;
     
     explicit HMACAuth(AuthMethod authMethod = MD5);
     ~HMACAuth();
 
+    AuthMethod getAuthMethod() const { return _authMethod; }
+    // Changing to an HMAC method invalidates the current key - call setKey() again afterwards. SipHash keeps the last key.
+    void setAuthMethod(AuthMethod authMethod);
+
     bool setKey(const char* keyValue, int keyLen);
     bool setKey(const QUuid& uidKey);
     // Calculate complete hash in one.
     bool calculateHash(HMACHash& hashResult, const char* data, int dataLen);
+    // Calculate the hash of data followed by tail, without joining them first.
+    bool calculateHash(HMACHash& hashResult, const char* data, int dataLen, const char* tail, int tailLen);
 
     // Append to data to be hashed.
     bool addData(const char* data, int dataLen);
@@ -41,7 +52,15 @@ public:
 private:
     QMutex _lock { QMutex::Recursive };
     struct hmac_ctx_st* _hmacContext;
-    AuthMethod _authMethod;
+    std::atomic<AuthMethod> _authMethod;
+
+    // the key is swapped whole, so that a hash computed while it is re-keyed gets either the old or the new key
+    struct SipHashKey {
+        uint64_t key0 { 0 };
+        uint64_t key1 { 0 };
+    };
+    std::shared_ptr<const SipHashKey> _sipHashKey { std::make_shared<const SipHashKey>() };
+    QByteArray _sipHashPendingData;
 };
 
 #endif  // hifi_HMACAuth_h
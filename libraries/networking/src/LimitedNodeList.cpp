@@ -127,6 +127,11 @@ LimitedNodeList::LimitedNodeList(int socketListenPort, int dtlsListenPort) :
     }
 }
 
+LimitedNodeList::~LimitedNodeList() {
+    // retired tables are deleted along with _nodeTableEpochs
+    delete _nodeTable.load();
+}
+
 QUuid LimitedNodeList::getSessionUUID() const {
     QReadLocker lock { &_sessionUUIDLock };
     return _sessionUUID;
@@ -320,13 +325,15 @@ bool LimitedNodeList::packetSourceAndHashMatchAndTrackBandwidth(const udt::Packe
     } else {
         NLPacket::LocalID sourceLocalID = Node::NULL_LOCAL_ID;
 
+        // keeps the source node alive while we check the packet, without taking a reference to it
+        NodeTableGuard nodeTableGuard(_nodeTableEpochs);
+
         // check if we were passed a sourceNode hint or if we need to look it up
         if (!sourceNode) {
             // figure out which node this is from
             sourceLocalID = NLPacket::sourceIDInHeader(packet);
 
-            SharedNodePointer matchingNode = nodeWithLocalID(sourceLocalID);
-            sourceNode = matchingNode.data();
+            sourceNode = nodeWithLocalID(sourceLocalID, nodeTableGuard);
         }
 
         QUuid sourceID = sourceNode ? sourceNode->getUUID() : QUuid();
@@ -354,7 +361,7 @@ bool LimitedNodeList::packetSourceAndHashMatchAndTrackBandwidth(const udt::Packe
                     expectedHash = NLPacket::hashForPacketAndHMAC(packet, *sourceNodeHMACAuth);
                 }
 
-                // check if the HMAC-md5 hash in the header matches the hash we would expect
+                // check if the verification hash in the header matches the hash we would expect
                 if (!sourceNodeHMACAuth || packetHeaderHash != expectedHash) {
                     static QMultiMap<QUuid, PacketType> hashDebugSuppressMap;
 
@@ -385,6 +392,17 @@ bool LimitedNodeList::packetSourceAndHashMatchAndTrackBandwidth(const udt::Packe
     return false;
 }
 
+void LimitedNodeList::setAuthenticationMethod(HMACAuth::AuthMethod authMethod) {
+    if (_authenticationMethod.exchange(authMethod) != authMethod) {
+        qCDebug(networking) << "Packet verification method changed to"
+            << (authMethod == HMACAuth::SIPHASH ? "SipHash-2-4" : "HMAC-MD5");
+
+        eachNode([authMethod](const SharedNodePointer& node) {
+            node->setAuthenticationMethod(authMethod);
+        });
+    }
+}
+
 void LimitedNodeList::fillPacketHeader(const NLPacket& packet, HMACAuth* hmacAuth) {
     if (!PacketTypeEnum::getNonSourcedPackets().contains(packet.getType())) {
         packet.writeSourceID(getSessionLocalID());
@@ -577,17 +595,69 @@ NodeData* LimitedNodeList::getOrCreateLinkedData(SharedNodePointer node) {
 }
 
 SharedNodePointer LimitedNodeList::nodeWithUUID(const QUuid& nodeUUID) {
-    QReadLocker readLocker(&_nodeMutex);
+    NodeTableGuard guard(_nodeTableEpochs);
+    const auto& nodeTable = currentNodeTable();
 
-    NodeHash::const_iterator it = _nodeHash.find(nodeUUID);
-    return it == _nodeHash.cend() ? SharedNodePointer() : it->second;
- }
+    auto it = nodeTable.indicesByUUID.find(nodeUUID);
+    return it == nodeTable.indicesByUUID.cend() ? SharedNodePointer() : nodeTable.nodes[it->second];
+}
 
 SharedNodePointer LimitedNodeList::nodeWithLocalID(Node::LocalID localID) const {
-    QReadLocker readLocker(&_nodeMutex);
+    NodeTableGuard guard(_nodeTableEpochs);
+
+    auto node = _nodesByLocalID.load(localID);
+    return node ? *node : SharedNodePointer();
+}
 
-    LocalIDMapping::const_iterator idIter = _localIDMap.find(localID);
-    return idIter == _localIDMap.cend() ? nullptr : idIter->second;
+Node* LimitedNodeList::nodeWithLocalID(Node::LocalID localID, const NodeTableGuard& guard) const {
+    Q_UNUSED(guard);
+    auto node = _nodesByLocalID.load(localID);
+    return node ? node->data() : nullptr;
+}
+
+void LimitedNodeList::publishNodeTable() {
+    std::lock_guard<std::mutex> publishLock(_nodeTablePublishMutex);
+
+    auto nodeTable = new NodeTable();
+    {
+        QReadLocker readLocker(&_nodeMutex);
+
+        nodeTable->nodes.reserve(_nodeHash.size());
+        nodeTable->localIDs.reserve(_nodeHash.size());
+        nodeTable->indicesByUUID.reserve(_nodeHash.size());
+        for (const auto& pair : _nodeHash) {
+            nodeTable->indicesByUUID.emplace(pair.first, nodeTable->nodes.size());
+            nodeTable->nodes.push_back(pair.second);
+            nodeTable->localIDs.push_back(pair.second->getLocalID());
+        }
+    }
+
+    // point the local IDs at the new table before clearing the ones that are gone,
+    // so that a node that stays in the table can always be found
+    for (size_t i = 0; i < nodeTable->nodes.size(); ++i) {
+        if (nodeTable->localIDs[i] != Node::NULL_LOCAL_ID) {
+            _nodesByLocalID.store(nodeTable->localIDs[i], &nodeTable->nodes[i]);
+        }
+    }
+
+    auto oldNodeTable = _nodeTable.exchange(nodeTable);
+
+    // pages of the local ID table that empty out go the same way as the old table,
+    // once no reader can still be looking at them
+    std::vector<std::atomic<const SharedNodePointer*>*> emptiedPages;
+    for (size_t i = 0; i < oldNodeTable->nodes.size(); ++i) {
+        _nodesByLocalID.clear(oldNodeTable->localIDs[i], &oldNodeTable->nodes[i], [&](auto page) {
+            emptiedPages.push_back(page);
+        });
+    }
+
+    _nodeTableEpochs.retire([oldNodeTable, emptiedPages] {
+        delete oldNodeTable;
+        for (auto page : emptiedPages) {
+            delete[] page;
+        }
+    });
+    _nodeTableEpochs.reclaim();
 }
 
 void LimitedNodeList::eraseAllNodes(QString reason) {
@@ -606,10 +676,11 @@ void LimitedNodeList::eraseAllNodes(QString reason) {
                 killedNodes.push_back(pair.second);
             }
         }
-        _localIDMap.clear();
         _nodeHash.clear();
     }
 
+    publishNodeTable();
+
     foreach(const SharedNodePointer& killedNode, killedNodes) {
         handleNodeKill(killedNode);
     }
@@ -631,9 +702,9 @@ bool LimitedNodeList::killNodeWithUUID(const QUuid& nodeUUID, ConnectionID newCo
     if (matchingNode) {
         {
             QWriteLocker writeLocker(&_nodeMutex);
-            _localIDMap.unsafe_erase(matchingNode->getLocalID());
             _nodeHash.unsafe_erase(matchingNode->getUUID());
         }
+        publishNodeTable();
 
         handleNodeKill(matchingNode, newConnectionID);
         return true;
@@ -679,10 +750,15 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
         matchingNode->setPublicSocket(publicSocket);
         matchingNode->setLocalSocket(localSocket);
         matchingNode->setPermissions(permissions);
+        matchingNode->setAuthenticationMethod(_authenticationMethod);
         matchingNode->setConnectionSecret(connectionSecret);
         matchingNode->setIsReplicated(isReplicated);
         matchingNode->setIsUpstream(isUpstream || NodeType::isUpstream(nodeType));
-        matchingNode->setLocalID(localID);
+
+        if (matchingNode->getLocalID() != localID) {
+            matchingNode->setLocalID(localID);
+            publishNodeTable();
+        }
 
         return matchingNode;
     }
@@ -691,9 +767,9 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
         if (node) {
             {
                 QWriteLocker writeLocker(&_nodeMutex);
-                _localIDMap.unsafe_erase(node->getLocalID());
                 _nodeHash.unsafe_erase(node->getUUID());
             }
+            publishNodeTable();
             handleNodeKill(node);
         }
     };
@@ -718,6 +794,7 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
     Node* newNode = new Node(uuid, nodeType, publicSocket, localSocket);
     newNode->setIsReplicated(isReplicated);
     newNode->setIsUpstream(isUpstream || NodeType::isUpstream(nodeType));
+    newNode->setAuthenticationMethod(_authenticationMethod);
     newNode->setConnectionSecret(connectionSecret);
     newNode->setPermissions(permissions);
     newNode->setLocalID(localID);
@@ -736,8 +813,8 @@ SharedNodePointer LimitedNodeList::addOrUpdateNode(const QUuid& uuid, NodeType_t
         QReadLocker readLocker(&_nodeMutex);
         // insert the new node and release our read lock
         _nodeHash.insert({ newNode->getUUID(), newNodePointer });
-        _localIDMap.insert({ localID, newNodePointer });
     }
+    publishNodeTable();
 
     qCDebug(networking) << "Added" << *newNode;
 
@@ -901,7 +978,6 @@ void LimitedNodeList::removeSilentNodes() {
         if (!node->isForcedNeverSilent()
             && (usecTimestampNow() - node->getLastHeardMicrostamp()) > (NODE_SILENCE_THRESHOLD_MSECS * USECS_PER_MSEC)) {
             // call the NodeHash erase to get rid of this node
-            _localIDMap.unsafe_erase(node->getLocalID());
             it = _nodeHash.unsafe_erase(it);
 
             killedNodes.insert(node);
@@ -913,6 +989,13 @@ void LimitedNodeList::removeSilentNodes() {
         node->getMutex().unlock();
     });
 
+    if (!killedNodes.isEmpty()) {
+        publishNodeTable();
+    } else {
+        // give the node tables retired while they were being read another chance to be deleted
+        _nodeTableEpochs.reclaim();
+    }
+
     foreach(const SharedNodePointer& killedNode, killedNodes) {
         auto now = usecTimestampNow();
         qCDebug(networking_ice) << "Removing silent node" << *killedNode << "\n"
@@ -935,8 +1018,15 @@ void LimitedNodeList::sampleConnectionStats() {
     int elapsedSum { 0 };
     int elapsedCount { 0 };
 
+    ConnectionTimings timings;
+
     auto allStats = _nodeSocket.sampleStatsForAllConnections();
     for (const auto& stats : allStats) {
+        timings.rtt.merge(stats.second.rttSamples);
+        timings.jitter.merge(stats.second.jitter);
+        timings.queueingDelay.merge(stats.second.queueingDelay);
+        timings.retransmitLatency.merge(stats.second.retransmitLatency);
+
         auto node = findNodeWithAddr(stats.first);
         if (node && node->getActiveSocket() &&
             *node->getActiveSocket() == stats.first) {
@@ -972,6 +1062,14 @@ void LimitedNodeList::sampleConnectionStats() {
         _inboundKbps = 0.0f;
         _outboundKbps = 0.0f;
     }
+
+    std::lock_guard<std::mutex> lock(_connectionTimingsMutex);
+    _connectionTimings = std::move(timings);
+}
+
+LimitedNodeList::ConnectionTimings LimitedNodeList::getConnectionTimings() const {
+    std::lock_guard<std::mutex> lock(_connectionTimingsMutex);
+    return _connectionTimings;
 }
 
 const uint32_t RFC_5389_MAGIC_COOKIE = 0x2112A442;
@@ -1285,23 +1383,15 @@ void LimitedNodeList::sendPeerQueryToIceServer(const HifiSockAddr& iceServerSock
 }
 
 SharedNodePointer LimitedNodeList::findNodeWithAddr(const HifiSockAddr& addr) {
-    QReadLocker locker(&_nodeMutex);
-    auto it = std::find_if(std::begin(_nodeHash), std::end(_nodeHash), [&addr](const UUIDNodePair& pair) {
-        return pair.second->getPublicSocket() == addr
-            || pair.second->getLocalSocket() == addr
-            || pair.second->getSymmetricSocket() == addr;
+    return nodeMatchingPredicate([&addr](const SharedNodePointer& node) {
+        return node->getPublicSocket() == addr
+            || node->getLocalSocket() == addr
+            || node->getSymmetricSocket() == addr;
     });
-    return (it != std::end(_nodeHash)) ? it->second : SharedNodePointer();
 }
 
 bool LimitedNodeList::sockAddrBelongsToNode(const HifiSockAddr& sockAddr) {
-    QReadLocker locker(&_nodeMutex);
-    auto it = std::find_if(std::begin(_nodeHash), std::end(_nodeHash), [&sockAddr](const UUIDNodePair& pair) {
-        return pair.second->getPublicSocket() == sockAddr
-            || pair.second->getLocalSocket() == sockAddr
-            || pair.second->getSymmetricSocket() == sockAddr;
-    });
-    return it != std::end(_nodeHash);
+    return !findNodeWithAddr(sockAddr).isNull();
 }
 
 void LimitedNodeList::sendPacketToIceServer(PacketType packetType, const HifiSockAddr& iceServerSockAddr,
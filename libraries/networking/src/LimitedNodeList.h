@@ -14,10 +14,13 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <atomic>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 #ifndef _WIN32
 #include <unistd.h> // not on windows, not needed for mac or windows
@@ -35,8 +38,11 @@
 
 #include <DependencyManager.h>
 #include <SharedUtil.h>
+#include <shared/EpochReclamation.h>
+#include <shared/HdrHistogram.h>
 
 #include "DomainHandler.h"
+#include "LocalIDTable.h"
 #include "Node.h"
 #include "NLPacket.h"
 #include "NLPacketList.h"
@@ -81,6 +87,12 @@ namespace PingType {
     const PingType_t Symmetric = 3;
 }
 
+// what each entry in a DomainList packet describes
+enum class DomainListEntryType : quint8 {
+    Node = 0,
+    RemovedNode
+};
+
 class LimitedNodeList : public QObject, public Dependency {
     Q_OBJECT
     SINGLETON_DEPENDENCY
@@ -166,11 +178,20 @@ public:
 
     std::function<void(Node*)> linkedDataCreateCallback;
 
-    size_t size() const { QReadLocker readLock(&_nodeMutex); return _nodeHash.size(); }
+    size_t size() const { NodeTableGuard guard(_nodeTableEpochs); return currentNodeTable().nodes.size(); }
 
     SharedNodePointer nodeWithUUID(const QUuid& nodeUUID);
     SharedNodePointer nodeWithLocalID(Node::LocalID localID) const;
 
+    // Readers of the node table hold a guard instead of a lock. Iteration and local ID lookups go through an immutable
+    // snapshot of the table that is replaced whenever a node is added or removed, and that stays alive (along with its
+    // nodes) for as long as any guard that could have seen it.
+    using NodeTableGuard = EpochReclamation::ReadGuard;
+
+    // Returns the node with this local ID without taking a reference to it - the NodeTableGuard
+    // given must be held for as long as the node is used.
+    Node* nodeWithLocalID(Node::LocalID localID, const NodeTableGuard& guard) const;
+
     SharedNodePointer addOrUpdateNode(const QUuid& uuid, NodeType_t nodeType,
                                       const HifiSockAddr& publicSocket, const HifiSockAddr& localSocket,
                                       Node::LocalID localID = Node::NULL_LOCAL_ID, bool isReplicated = false,
@@ -205,10 +226,10 @@ public:
     using value_type = SharedNodePointer;
     using const_iterator = std::vector<value_type>::const_iterator;
 
-    // Cede control of iteration under a single read lock (e.g. for use by thread pools)
-    // Use this for nested loops instead of taking nested read locks!
-    //   This allows multiple threads (i.e. a thread pool) to share a lock
-    //   without deadlocking when a dying node attempts to acquire a write lock
+    // Cede control of iteration over a single snapshot of the node table (e.g. for use by thread pools)
+    // Use this for nested loops instead of iterating the nodes again in the functor!
+    //   The iterators stay valid until the functor returns, and every thread
+    //   the functor hands them to sees the same set of nodes
     template<typename NestedNodeLambda>
     void nestedEach(NestedNodeLambda functor,
                     int* lockWaitOut = nullptr,
@@ -217,26 +238,16 @@ public:
         quint64 start, endTransform, endFunctor;
 
         start = usecTimestampNow();
-        std::vector<SharedNodePointer> nodes;
-        {
-            QReadLocker readLock(&_nodeMutex);
-            auto endLock = usecTimestampNow();
-            if (lockWaitOut) {
-                *lockWaitOut = (endLock - start);
-            }
+        NodeTableGuard guard(_nodeTableEpochs);
+        const auto& nodes = currentNodeTable().nodes;
 
-            // Size of _nodeHash could change at any time,
-            // so reserve enough memory for the current size
-            // and then back insert all the nodes found
-            nodes.reserve(_nodeHash.size());
-            std::transform(_nodeHash.cbegin(), _nodeHash.cend(), std::back_inserter(nodes), [&](const NodeHash::value_type& it) {
-                return it.second;
-            });
-
-            endTransform = usecTimestampNow();
-            if (nodeTransformOut) {
-                *nodeTransformOut = (endTransform - endLock);
-            }
+        // there is no longer a lock to wait on, or nodes to copy
+        endTransform = usecTimestampNow();
+        if (lockWaitOut) {
+            *lockWaitOut = (endTransform - start);
+        }
+        if (nodeTransformOut) {
+            *nodeTransformOut = 0;
         }
 
         functor(nodes.cbegin(), nodes.cend());
@@ -248,30 +259,30 @@ public:
 
     template<typename NodeLambda>
     void eachNode(NodeLambda functor) {
-        QReadLocker readLock(&_nodeMutex);
+        NodeTableGuard guard(_nodeTableEpochs);
 
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            functor(it->second);
+        for (const auto& node : currentNodeTable().nodes) {
+            functor(node);
         }
     }
 
     template<typename PredLambda, typename NodeLambda>
     void eachMatchingNode(PredLambda predicate, NodeLambda functor) {
-        QReadLocker readLock(&_nodeMutex);
+        NodeTableGuard guard(_nodeTableEpochs);
 
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            if (predicate(it->second)) {
-                functor(it->second);
+        for (const auto& node : currentNodeTable().nodes) {
+            if (predicate(node)) {
+                functor(node);
             }
         }
     }
 
     template<typename BreakableNodeLambda>
     void eachNodeBreakable(BreakableNodeLambda functor) {
-        QReadLocker readLock(&_nodeMutex);
+        NodeTableGuard guard(_nodeTableEpochs);
 
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            if (!functor(it->second)) {
+        for (const auto& node : currentNodeTable().nodes) {
+            if (!functor(node)) {
                 break;
             }
         }
@@ -279,25 +290,22 @@ public:
 
     template<typename PredLambda>
     SharedNodePointer nodeMatchingPredicate(const PredLambda predicate) {
-        QReadLocker readLock(&_nodeMutex);
+        NodeTableGuard guard(_nodeTableEpochs);
 
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            if (predicate(it->second)) {
-                return it->second;
+        for (const auto& node : currentNodeTable().nodes) {
+            if (predicate(node)) {
+                return node;
             }
         }
 
         return SharedNodePointer();
     }
 
-    // This is unsafe because it does not take a lock
-    // Must only be called when you know that a read lock on the node mutex is held
-    // and will be held for the duration of your iteration
+    // This used to require the caller to hold a read lock on the node mutex - it is kept for the callers
+    // that iterate from inside nestedEach, and is now the same as eachNode
     template<typename NodeLambda>
     void unsafeEachNode(NodeLambda functor) {
-        for (NodeHash::const_iterator it = _nodeHash.cbegin(); it != _nodeHash.cend(); ++it) {
-            functor(it->second);
-        }
+        eachNode(functor);
     }
 
     void putLocalPortIntoSharedMemory(const QString key, QObject* parent, quint16 localPort);
@@ -310,6 +318,11 @@ public:
     udt::Socket::StatsVector sampleStatsForAllConnections() { return _nodeSocket.sampleStatsForAllConnections(); }
 
     void setConnectionMaxBandwidth(int maxBandwidth) { _nodeSocket.setConnectionMaxBandwidth(maxBandwidth); }
+    void setConnectionCoalescingWindow(int coalescingWindow) { _nodeSocket.setConnectionCoalescingWindow(coalescingWindow); }
+
+    // only applies to connections created after the call
+    void setCongestionControlFactory(std::unique_ptr<udt::CongestionControlVirtualFactory> ccFactory)
+        { _nodeSocket.setCongestionControlFactory(std::move(ccFactory)); }
 
     void setPacketFilterOperator(udt::PacketFilterOperator filterOperator) { _nodeSocket.setPacketFilterOperator(filterOperator); }
     bool packetVersionMatch(const udt::Packet& packet);
@@ -318,6 +331,8 @@ public:
     bool isPacketVerified(const udt::Packet& packet) { return isPacketVerifiedWithSource(packet); }
     void setAuthenticatePackets(bool useAuthentication) { _useAuthentication = useAuthentication; }
     bool getAuthenticatePackets() const { return _useAuthentication; }
+    void setAuthenticationMethod(HMACAuth::AuthMethod authMethod);
+    HMACAuth::AuthMethod getAuthenticationMethod() const { return _authenticationMethod; }
 
     void setFlagTimeForConnectionStep(bool flag) { _flagTimeForConnectionStep = flag; }
     bool isFlagTimeForConnectionStep() { return _flagTimeForConnectionStep; }
@@ -336,6 +351,15 @@ public:
     float getInboundKbps() const { return _inboundKbps; }
     float getOutboundKbps() const { return _outboundKbps; }
 
+    // distributions of the connection timings over the last stats interval, merged across all connections
+    struct ConnectionTimings {
+        HdrHistogram rtt;
+        HdrHistogram jitter;
+        HdrHistogram queueingDelay;
+        HdrHistogram retransmitLatency;
+    };
+    ConnectionTimings getConnectionTimings() const;
+
     void setDropOutgoingNodeTraffic(bool squelchOutgoingNodeTraffic) { _dropOutgoingNodeTraffic = squelchOutgoingNodeTraffic; }
 
     const std::set<NodeType_t> SOLO_NODE_TYPES = {
@@ -410,6 +434,7 @@ protected:
     };
 
     LimitedNodeList(int socketListenPort = INVALID_PORT, int dtlsListenPort = INVALID_PORT);
+    ~LimitedNodeList();
     LimitedNodeList(LimitedNodeList const&) = delete; // Don't implement, needed to avoid copies of singleton
     void operator=(LimitedNodeList const&) = delete; // Don't implement, needed to avoid copies of singleton
 
@@ -436,6 +461,18 @@ protected:
     void removeDelayedAdd(QUuid nodeUUID);
     bool isDelayedNode(QUuid nodeUUID);
 
+    // The node table readers see - must only be used while holding a NodeTableGuard
+    struct NodeTable {
+        std::vector<SharedNodePointer> nodes;
+        std::vector<Node::LocalID> localIDs; // the local ID each node had when the table was published
+        std::unordered_map<QUuid, size_t, UUIDHasher> indicesByUUID;
+    };
+    const NodeTable& currentNodeTable() const { return *_nodeTable.load(); }
+
+    // Replaces the snapshot of the node table after _nodeHash changed, must be called without holding _nodeMutex
+    void publishNodeTable();
+
+    // _nodeHash is the table writers work on, under _nodeMutex
     NodeHash _nodeHash;
     mutable QReadWriteLock _nodeMutex { QReadWriteLock::Recursive };
     udt::Socket _nodeSocket;
@@ -445,6 +482,7 @@ protected:
     HifiSockAddr _stunSockAddr { STUN_SERVER_HOSTNAME, STUN_SERVER_PORT };
     bool _hasTCPCheckedLocalSocket { false };
     bool _useAuthentication { true };
+    std::atomic<HMACAuth::AuthMethod> _authenticationMethod { HMACAuth::MD5 };
 
     PacketReceiver* _packetReceiver;
 
@@ -484,8 +522,12 @@ private slots:
 private:
     mutable QReadWriteLock _sessionUUIDLock;
     QUuid _sessionUUID;
-    using LocalIDMapping = tbb::concurrent_unordered_map<Node::LocalID, SharedNodePointer>;
-    LocalIDMapping _localIDMap;
+
+    mutable EpochReclamation _nodeTableEpochs;
+    std::atomic<const NodeTable*> _nodeTable { new NodeTable() };
+    std::mutex _nodeTablePublishMutex;
+    // each local ID points at the node's entry in the current (or a retired but still guarded) node table
+    LocalIDTable<const SharedNodePointer> _nodesByLocalID;
     Node::LocalID _sessionLocalID { 0 };
     bool _flagTimeForConnectionStep { false }; // only keep track in interface
 
@@ -498,6 +540,9 @@ private:
     float _inboundKbps { 0.0f };
     float _outboundKbps { 0.0f };
 
+    mutable std::mutex _connectionTimingsMutex;
+    ConnectionTimings _connectionTimings;
+
     bool _dropOutgoingNodeTraffic { false };
 
     quint64 _sendErrorStatsTime { (quint64)0 };
@@ -0,0 +1,88 @@
+//
+//  LocalIDTable.h
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_LocalIDTable_h
+#define hifi_LocalIDTable_h
+
+#include <atomic>
+#include <limits>
+
+#include <UUID.h>
+
+// Maps every local ID to a pointer that can be loaded without a lock.
+// The table is split into small pages that only exist while one of their local IDs is set, so an instance that sees
+// a handful of nodes costs a few KB rather than one slot for each of the 65536 possible local IDs.
+// Loads may run on any thread, stores and clears must come from one writer at a time. A page that empties is handed
+// to the retire functor given to clear, which must keep it alive until no reader can still be looking at it.
+template <typename T>
+class LocalIDTable {
+public:
+    static const size_t NUM_LOCAL_IDS = std::numeric_limits<NetworkLocalID>::max() + 1;
+    static const size_t PAGE_SIZE = 64;
+    static const size_t NUM_PAGES = NUM_LOCAL_IDS / PAGE_SIZE;
+
+    LocalIDTable() = default;
+    LocalIDTable(const LocalIDTable&) = delete;
+    LocalIDTable& operator=(const LocalIDTable&) = delete;
+
+    ~LocalIDTable() {
+        for (auto& page : _pages) {
+            delete[] page.load();
+        }
+    }
+
+    T* load(NetworkLocalID localID) const {
+        auto page = _pages[localID / PAGE_SIZE].load(std::memory_order_acquire);
+        return page ? page[localID % PAGE_SIZE].load(std::memory_order_acquire) : nullptr;
+    }
+
+    // value must not be null, use clear to remove an entry
+    void store(NetworkLocalID localID, T* value) {
+        auto& pageSlot = _pages[localID / PAGE_SIZE];
+        auto page = pageSlot.load(std::memory_order_relaxed);
+        if (!page) {
+            page = new std::atomic<T*>[PAGE_SIZE]();
+            pageSlot.store(page, std::memory_order_release);
+            ++_numAllocatedPages;
+        }
+        if (!page[localID % PAGE_SIZE].exchange(value, std::memory_order_acq_rel)) {
+            ++_numUsedSlots[localID / PAGE_SIZE];
+        }
+    }
+
+    // Clears the entry for this local ID only if it still holds the expected value.
+    // If that leaves its page empty, the page is unlinked and passed to retire(std::atomic<T*>* page).
+    template <typename RetireFunctor>
+    bool clear(NetworkLocalID localID, T* expected, RetireFunctor retire) {
+        auto& pageSlot = _pages[localID / PAGE_SIZE];
+        auto page = pageSlot.load(std::memory_order_relaxed);
+        if (!page || !page[localID % PAGE_SIZE].compare_exchange_strong(expected, nullptr)) {
+            return false;
+        }
+
+        if (--_numUsedSlots[localID / PAGE_SIZE] == 0) {
+            pageSlot.store(nullptr, std::memory_order_release);
+            --_numAllocatedPages;
+            retire(page);
+        }
+        return true;
+    }
+
+    size_t getNumAllocatedPages() const { return _numAllocatedPages; }
+
+private:
+    std::atomic<std::atomic<T*>*> _pages[NUM_PAGES] {};
+
+    // only touched by the writer
+    uint8_t _numUsedSlots[NUM_PAGES] {};
+    size_t _numAllocatedPages { 0 };
+};
+
+#endif // hifi_LocalIDTable_h
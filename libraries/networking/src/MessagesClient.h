@@ -167,6 +167,10 @@ public:
     static std::unique_ptr<NLPacketList> encodeMessagesPacket(QString channel, QString message, QUuid senderID);
     static std::unique_ptr<NLPacketList> encodeMessagesDataPacket(QString channel, QByteArray data, QUuid senderID);
 
+    // the payload of a MessagesData packet, message is UTF-8 if isText is true
+    static QByteArray encodeMessagesPayload(const QString& channel, bool isText, const QByteArray& message,
+                                            const QUuid& senderID);
+
 signals:
     /**jsdoc
      * Triggered when a text message is received.
@@ -0,0 +1,319 @@
+//
+//  MessagesFanOut.cpp
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MessagesFanOut.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "NLPacketList.h"
+#include "NodeList.h"
+
+MessagesFanOut::MessagesFanOut(int numThreads, SendFunction sendFunction) :
+    _sendFunction(sendFunction)
+{
+    if (!_sendFunction) {
+        _sendFunction = [](const Node& node, const QByteArray& payload) {
+            // the packet list only references the payload, it is shared with every other subscriber
+            auto packetList = NLPacketList::create(PacketType::MessagesData, QByteArray(), true, true);
+            packetList->writeExternal(payload);
+            DependencyManager::get<NodeList>()->sendPacketList(std::move(packetList), node);
+        };
+    }
+
+    setNumThreads(numThreads);
+}
+
+MessagesFanOut::~MessagesFanOut() {
+    for (auto& worker : _workers) {
+        worker->stop();
+    }
+}
+
+void MessagesFanOut::setNumThreads(int numThreads) {
+    // clamp to allowed size
+    {
+        int maxThreads = QThread::idealThreadCount();
+        if (maxThreads == -1) {
+            // idealThreadCount returns -1 if cores cannot be detected
+            static const int MAX_THREADS_IF_UNKNOWN = 4;
+            maxThreads = MAX_THREADS_IF_UNKNOWN;
+        }
+
+        int clampedThreads = std::min(std::max(1, numThreads), maxThreads);
+        if (clampedThreads != numThreads) {
+            qWarning("%s: clamped to %d (was %d)", __FUNCTION__, clampedThreads, numThreads);
+            numThreads = clampedThreads;
+        }
+    }
+
+    if (numThreads == (int)_workers.size()) {
+        return;
+    }
+
+    qDebug("%s: set %d threads (was %d)", __FUNCTION__, numThreads, (int)_workers.size());
+
+    // the subscribers are spread over the workers by local ID, so changing the number of workers moves most of them
+    // to another one - stop the old workers and hand what they had over to the new ones
+    std::deque<Job> jobs;
+    std::vector<Subscriber> subscribers;
+    for (auto& worker : _workers) {
+        worker->stop();
+        worker->takeState(jobs, subscribers);
+    }
+
+    std::vector<std::unique_ptr<Worker>> oldWorkers;
+    oldWorkers.swap(_workers);
+    for (int i = 0; i < numThreads; ++i) {
+        _workers.emplace_back(new Worker(*this));
+    }
+
+    // a subscriber is adopted before the jobs are pushed, so what was held back for it still goes out first
+    for (auto& subscriber : subscribers) {
+        workerForNode(*subscriber.node).adopt(std::move(subscriber));
+    }
+    for (auto& job : jobs) {
+        dispatch(std::move(job));
+    }
+
+    for (auto& worker : _workers) {
+        worker->start();
+    }
+}
+
+void MessagesFanOut::setSettings(const Settings& settings) {
+    std::lock_guard<std::mutex> lock(_settingsMutex);
+    _settings = settings;
+}
+
+void MessagesFanOut::publish(const QByteArray& payload, const std::vector<SharedNodePointer>& subscribers) {
+    if (subscribers.empty()) {
+        return;
+    }
+
+    dispatch({ Job::Publish, payload, subscribers });
+}
+
+void MessagesFanOut::forget(const SharedNodePointer& node) {
+    workerForNode(*node).push({ Job::Forget, QByteArray(), { node } });
+}
+
+void MessagesFanOut::dispatch(Job job) {
+    // split the subscribers between the workers that serve them
+    std::vector<std::vector<SharedNodePointer>> subscribersByWorker(_workers.size());
+    for (auto& subscriber : job.subscribers) {
+        subscribersByWorker[subscriber->getLocalID() % _workers.size()].push_back(subscriber);
+    }
+
+    for (size_t i = 0; i < _workers.size(); ++i) {
+        if (!subscribersByWorker[i].empty()) {
+            _workers[i]->push({ job.type, job.payload, std::move(subscribersByWorker[i]) });
+        }
+    }
+}
+
+MessagesFanOut::Stats MessagesFanOut::getStats() const {
+    Stats stats;
+    stats.numSent = _numSent;
+    stats.numDelayed = _numDelayed;
+    stats.numDropped = _numDropped;
+    stats.numQueued = _numQueued;
+    return stats;
+}
+
+void MessagesFanOut::Worker::push(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(std::move(job));
+    }
+    _condition.notify_one();
+}
+
+void MessagesFanOut::Worker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+    }
+    _condition.notify_one();
+    wait();
+}
+
+void MessagesFanOut::Worker::adopt(Subscriber subscriber) {
+    auto localID = subscriber.node->getLocalID();
+    if (!subscriber.queuedPayloads.empty()) {
+        _delayedSubscribers.insert(localID);
+    }
+    _subscribers[localID] = std::move(subscriber);
+}
+
+void MessagesFanOut::Worker::takeState(std::deque<Job>& jobs, std::vector<Subscriber>& subscribers) {
+    std::move(_jobs.begin(), _jobs.end(), std::back_inserter(jobs));
+    _jobs.clear();
+
+    for (auto& subscriber : _subscribers) {
+        subscribers.push_back(std::move(subscriber.second));
+    }
+    _subscribers.clear();
+    _delayedSubscribers.clear();
+}
+
+void MessagesFanOut::Worker::run() {
+    // flush straight away, in case subscribers with messages held back were adopted
+    Clock::time_point wakeTime = Clock::now();
+
+    while (true) {
+        std::deque<Job> jobs;
+
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            auto hasWork = [&] {
+                return !_jobs.empty() || _isStopping;
+            };
+
+            if (_delayedSubscribers.empty()) {
+                _condition.wait(lock, hasWork);
+            } else {
+                _condition.wait_until(lock, wakeTime, hasWork);
+            }
+
+            if (_isStopping) {
+                break;
+            }
+
+            jobs.swap(_jobs);
+        }
+
+        Settings settings;
+        {
+            std::lock_guard<std::mutex> lock(_pool._settingsMutex);
+            settings = _pool._settings;
+        }
+
+        auto now = Clock::now();
+
+        for (auto& job : jobs) {
+            process(job, settings, now);
+        }
+
+        wakeTime = Clock::time_point::max();
+        flush(settings, now, wakeTime);
+    }
+}
+
+void MessagesFanOut::Worker::process(Job& job, const Settings& settings, Clock::time_point now) {
+    for (auto& node : job.subscribers) {
+        auto it = _subscribers.find(node->getLocalID());
+
+        if (job.type == Job::Forget) {
+            if (it != _subscribers.end() && it->second.node == node) {
+                _pool._numQueued -= it->second.queuedPayloads.size();
+                _delayedSubscribers.erase(it->first);
+                _subscribers.erase(it);
+            }
+            continue;
+        }
+
+        if (it == _subscribers.end() || it->second.node != node) {
+            // a new subscriber, or a new node that was given the local ID of one that left
+            if (it != _subscribers.end()) {
+                _pool._numQueued -= it->second.queuedPayloads.size();
+                _delayedSubscribers.erase(it->first);
+            }
+
+            it = _subscribers.emplace(node->getLocalID(), Subscriber()).first;
+            it->second = Subscriber();
+            it->second.node = node;
+            it->second.tokens = (float)std::max(1, settings.maxBurst);
+            it->second.lastRefill = now;
+        }
+
+        deliver(it->second, job.payload, settings, now);
+    }
+}
+
+void MessagesFanOut::Worker::deliver(Subscriber& subscriber, const QByteArray& payload, const Settings& settings,
+                                     Clock::time_point now) {
+    if (settings.maxMessagesPerSecond <= 0.0f) {
+        send(*subscriber.node, payload);
+        return;
+    }
+
+    refill(subscriber, settings, now);
+
+    if (subscriber.queuedPayloads.empty() && subscriber.tokens >= 1.0f) {
+        subscriber.tokens -= 1.0f;
+        send(*subscriber.node, payload);
+        return;
+    }
+
+    // the subscriber is over its limit, hold the message back until it has room for it
+    if ((int)subscriber.queuedPayloads.size() >= settings.maxQueuedMessages) {
+        ++_pool._numDropped;
+
+        if (settings.dropPolicy == DropPolicy::DropNewest || subscriber.queuedPayloads.empty()) {
+            return;
+        }
+
+        subscriber.queuedPayloads.pop_front();
+        --_pool._numQueued;
+    }
+
+    subscriber.queuedPayloads.push_back(payload);
+    ++_pool._numQueued;
+    ++_pool._numDelayed;
+
+    _delayedSubscribers.insert(subscriber.node->getLocalID());
+}
+
+void MessagesFanOut::Worker::flush(const Settings& settings, Clock::time_point now, Clock::time_point& wakeTime) {
+    auto it = _delayedSubscribers.begin();
+
+    while (it != _delayedSubscribers.end()) {
+        auto& subscriber = _subscribers[*it];
+        bool isLimited = settings.maxMessagesPerSecond > 0.0f;
+
+        if (isLimited) {
+            refill(subscriber, settings, now);
+        }
+
+        while (!subscriber.queuedPayloads.empty() && (!isLimited || subscriber.tokens >= 1.0f)) {
+            subscriber.tokens -= isLimited ? 1.0f : 0.0f;
+            send(*subscriber.node, subscriber.queuedPayloads.front());
+            subscriber.queuedPayloads.pop_front();
+            --_pool._numQueued;
+        }
+
+        if (subscriber.queuedPayloads.empty()) {
+            it = _delayedSubscribers.erase(it);
+        } else {
+            // wake up as soon as the subscriber has room for the next message
+            std::chrono::duration<float> untilNextMessage((1.0f - subscriber.tokens) / settings.maxMessagesPerSecond);
+            wakeTime = std::min(wakeTime, now + std::chrono::duration_cast<Clock::duration>(untilNextMessage));
+            ++it;
+        }
+    }
+}
+
+void MessagesFanOut::Worker::refill(Subscriber& subscriber, const Settings& settings, Clock::time_point now) {
+    std::chrono::duration<float> elapsed = now - subscriber.lastRefill;
+    float maxTokens = (float)std::max(1, settings.maxBurst);
+
+    subscriber.tokens = std::min(maxTokens, subscriber.tokens + elapsed.count() * settings.maxMessagesPerSecond);
+    subscriber.lastRefill = now;
+}
+
+void MessagesFanOut::Worker::send(const Node& node, const QByteArray& payload) {
+    if (!node.getActiveSocket()) {
+        return;
+    }
+
+    _pool._sendFunction(node, payload);
+    ++_pool._numSent;
+}
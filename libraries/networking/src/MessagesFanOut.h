@@ -0,0 +1,145 @@
+//
+//  MessagesFanOut.h
+//  libraries/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MessagesFanOut_h
+#define hifi_MessagesFanOut_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QThread>
+
+#include "Node.h"
+
+// Sends serialized messages to their subscribers from a pool of worker threads.
+//
+// Every subscriber is always served by the same worker (picked from its local ID), so the messages it receives stay in
+// the order they were published in, and the rate limiting state of a subscriber is only ever touched by one thread.
+// The payload of a message is shared by all the packet lists that carry it, it is never copied per subscriber.
+class MessagesFanOut {
+public:
+    // sends one payload to one subscriber, called from the worker threads
+    using SendFunction = std::function<void(const Node& node, const QByteArray& payload)>;
+
+    enum class DropPolicy {
+        DropOldest, // a subscriber that is over its limit gets the most recent messages
+        DropNewest // a subscriber that is over its limit gets the messages it already had queued
+    };
+
+    struct Settings {
+        float maxMessagesPerSecond { 0.0f }; // per subscriber, 0 for no limit
+        int maxBurst { 0 }; // messages a subscriber can receive at once after being idle
+        int maxQueuedMessages { 0 }; // messages held back per subscriber before they are dropped
+        DropPolicy dropPolicy { DropPolicy::DropOldest };
+    };
+
+    struct Stats {
+        quint64 numSent { 0 };
+        quint64 numDelayed { 0 };
+        quint64 numDropped { 0 };
+        quint64 numQueued { 0 };
+    };
+
+    // the payloads go out as MessagesData packet lists through the NodeList unless another send function is given
+    MessagesFanOut(int numThreads = QThread::idealThreadCount(), SendFunction sendFunction = SendFunction());
+    ~MessagesFanOut();
+
+    // Subscribers move to the worker that serves them in the new pool, along with what is held back for them
+    // and the messages not handed to the old workers yet. Must be called from the thread that publishes.
+    void setNumThreads(int numThreads);
+    int numThreads() const { return (int)_workers.size(); }
+
+    void setSettings(const Settings& settings);
+
+    // Queues the payload for each of the subscribers. Must be called from a single thread.
+    void publish(const QByteArray& payload, const std::vector<SharedNodePointer>& subscribers);
+
+    // Drops what is queued for a node that is gone.
+    void forget(const SharedNodePointer& node);
+
+    Stats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        enum Type { Publish, Forget };
+
+        Type type;
+        QByteArray payload;
+        std::vector<SharedNodePointer> subscribers;
+    };
+
+    struct Subscriber {
+        SharedNodePointer node;
+        float tokens { 0.0f };
+        Clock::time_point lastRefill;
+        std::deque<QByteArray> queuedPayloads;
+    };
+
+    class Worker : public QThread {
+    public:
+        Worker(MessagesFanOut& pool) : _pool(pool) {}
+
+        void push(Job job);
+        void stop();
+
+        // only while the worker is not running
+        void adopt(Subscriber subscriber);
+        void takeState(std::deque<Job>& jobs, std::vector<Subscriber>& subscribers);
+
+        void run() override;
+
+    private:
+        void process(Job& job, const Settings& settings, Clock::time_point now);
+        void deliver(Subscriber& subscriber, const QByteArray& payload, const Settings& settings, Clock::time_point now);
+        void flush(const Settings& settings, Clock::time_point now, Clock::time_point& wakeTime);
+        void refill(Subscriber& subscriber, const Settings& settings, Clock::time_point now);
+        void send(const Node& node, const QByteArray& payload);
+
+        MessagesFanOut& _pool;
+
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::deque<Job> _jobs; // guarded by _mutex
+        bool _isStopping { false }; // guarded by _mutex
+
+        // only used on the worker thread
+        std::unordered_map<Node::LocalID, Subscriber> _subscribers;
+        std::unordered_set<Node::LocalID> _delayedSubscribers;
+    };
+
+    Worker& workerForNode(const Node& node) { return *_workers[node.getLocalID() % _workers.size()]; }
+
+    // hands a job to the workers that serve its subscribers
+    void dispatch(Job job);
+
+    SendFunction _sendFunction;
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    mutable std::mutex _settingsMutex;
+    Settings _settings;
+
+    std::atomic<quint64> _numSent { 0 };
+    std::atomic<quint64> _numDelayed { 0 };
+    std::atomic<quint64> _numDropped { 0 };
+    std::atomic<quint64> _numQueued { 0 };
+};
+
+#endif // hifi_MessagesFanOut_h
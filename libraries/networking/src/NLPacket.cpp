@@ -158,7 +158,8 @@ QByteArray NLPacket::hashForPacketAndHMAC(const udt::Packet& packet, HMACAuth& h
     
     // add the packet payload and the connection UUID
     HMACAuth::HMACHash hashResult;
-    if (!hash.calculateHash(hashResult, packet.getData() + offset, packet.getDataSize() - offset)) {
+    if (!hash.calculateHash(hashResult, packet.getData() + offset, packet.getDataSize() - offset,
+                            packet.getExternalPayload(), packet.getExternalPayloadSize())) {
         return QByteArray();
     }
     return QByteArray((const char*) hashResult.data(), (int) hashResult.size());
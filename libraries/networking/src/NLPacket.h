@@ -33,7 +33,7 @@ public:
     //    |  Packet Type  |    Version    | Local Node ID - sourced only  |
     //    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
     //    |                                                               |
-    //    |                 MD5 Verification - 16 bytes                   |
+    //    |          Verification (HMAC-MD5 or SipHash) - 16 bytes        |
     //    |                 (ONLY FOR VERIFIED PACKETS)                   |
     //    |                                                               |
     //    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -213,13 +213,23 @@ void Node::setConnectionSecret(const QUuid& connectionSecret) {
     }
 
     if (!_authenticateHash) {
-        _authenticateHash.reset(new HMACAuth());
+        _authenticateHash.reset(new HMACAuth(_authenticationMethod));
     }
 
     _connectionSecret = connectionSecret;
     _authenticateHash->setKey(_connectionSecret);
 }
 
+void Node::setAuthenticationMethod(HMACAuth::AuthMethod authMethod) {
+    _authenticationMethod = authMethod;
+
+    if (_authenticateHash && _authenticateHash->getAuthMethod() != authMethod) {
+        // re-key the existing hash so that senders holding a pointer to it pick up the new method
+        _authenticateHash->setAuthMethod(authMethod);
+        _authenticateHash->setKey(_connectionSecret);
+    }
+}
+
 void Node::updateStats(Stats stats) {
     _stats = stats;
 }
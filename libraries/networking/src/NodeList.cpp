@@ -110,6 +110,14 @@ NodeList::NodeList(char newOwnerType, int socketListenPort, int dtlsListenPort)
     // anytime we get a new node we may need to re-send our set of ignored node IDs to it
     connect(this, &LimitedNodeList::nodeActivated, this, &NodeList::maybeSendIgnoreSetToNode);
 
+    // a node we killed without being told to by the domain-server (e.g. because it went silent) may still be in the domain,
+    // so ask for a full domain list instead of what changed since our revision, to get it back if it is
+    connect(this, &LimitedNodeList::nodeKilled, this, [this] {
+        if (!_isApplyingDomainServerUpdate) {
+            _domainListRevision = 0;
+        }
+    });
+
     // setup our timer to send keepalive pings (it's started and stopped on domain connect/disconnect)
     _keepAlivePingTimer.setInterval(KEEPALIVE_PING_INTERVAL_MS); // 1s, Qt::CoarseTimer acceptable
     connect(&_keepAlivePingTimer, &QTimer::timeout, this, &NodeList::sendKeepAlivePings);
@@ -288,6 +296,9 @@ void NodeList::reset(QString reason, bool skipDomainHandlerReset) {
     setSessionUUID(QUuid());
     setSessionLocalID(Node::NULL_LOCAL_ID);
 
+    // we no longer hold any of the domain's node table
+    resetDomainListRevision();
+
     // if we setup the DTLS socket, also disconnect from the DTLS socket readyRead() so it can handle handshaking
     if (_dtlsSocket) {
         disconnect(_dtlsSocket, 0, this, 0);
@@ -466,6 +477,11 @@ void NodeList::sendDomainServerCheckIn() {
         packetStream << _ownerType.load() << publicSockAddr << localSockAddr << _nodeTypesOfInterest.toList();
         packetStream << DependencyManager::get<AddressManager>()->getPlaceName();
 
+        if (domainPacketType == PacketType::DomainListRequest) {
+            // let the domain-server know which revision of its node table we hold, so that it only sends what changed since
+            packetStream << _domainListRevision.load();
+        }
+
         if (!domainIsConnected) {
             DataServerAccountInfo& accountInfo = accountManager->getAccountInfo();
             packetStream << accountInfo.getUsername();
@@ -692,6 +708,9 @@ void NodeList::processDomainServerList(QSharedPointer<ReceivedMessage> message)
     // Is packet authentication enabled?
     bool isAuthenticated;
     packetStream >> isAuthenticated;
+    // Which keyed hash is used to verify packets?
+    quint8 authenticationMethod;
+    packetStream >> authenticationMethod;
 
     qint64 now = qint64(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
 
@@ -707,9 +726,17 @@ void NodeList::processDomainServerList(QSharedPointer<ReceivedMessage> message)
     bool newConnection;
     packetStream >> newConnection;
 
+    // the node table revision this list builds on (0 for a full list), the one it brings us to,
+    // and the number of entries in the list across all of its packets
+    quint64 baseRevision;
+    quint64 revision;
+    quint32 numEntries;
+    packetStream >> baseRevision >> revision >> numEntries;
+
     if (newConnection) {
         _nodeConnectTimestamp = usecTimestampNow();
         _connectReason = Connect;
+        resetDomainListRevision();
     }
 
     qint64 pingLagTime = (now - qint64(connectRequestTimestamp)) / qint64(USECS_PER_MSEC);
@@ -785,13 +812,57 @@ void NodeList::processDomainServerList(QSharedPointer<ReceivedMessage> message)
 
     setPermissions(newPermissions);
     setAuthenticatePackets(isAuthenticated);
+    setAuthenticationMethod(authenticationMethod == HMACAuth::SIPHASH ? HMACAuth::SIPHASH : HMACAuth::MD5);
+
+    if (revision != 0 && revision < _domainListRevision) {
+        // we've already applied a newer list than this one, what it says about the other nodes is out of date
+        return;
+    }
+
+    if (baseRevision != _pendingDomainListBaseRevision || revision != _pendingDomainListRevision) {
+        // this is the first packet we've seen of this list
+        _pendingDomainListBaseRevision = baseRevision;
+        _pendingDomainListRevision = revision;
+        _pendingDomainListEntries.clear();
+    }
+
+    _isApplyingDomainServerUpdate = true;
 
     // pull each node in the packet
     while (packetStream.device()->pos() < message->getSize()) {
-        parseNodeFromPacketStream(packetStream);
+        quint8 entryType;
+        packetStream >> entryType;
+
+        if (entryType == (quint8)DomainListEntryType::RemovedNode) {
+            QUuid nodeUUID;
+            packetStream >> nodeUUID;
+
+            killNodeWithUUID(nodeUUID);
+            removeDelayedAdd(nodeUUID);
+
+            _pendingDomainListEntries.insert(nodeUUID);
+        } else {
+            _pendingDomainListEntries.insert(parseNodeFromPacketStream(packetStream));
+        }
+    }
+
+    _isApplyingDomainServerUpdate = false;
+
+    // the packets of a list can be lost or re-ordered, we only hold its revision once all of its entries made it here
+    // and it built on the revision we held (or on nothing, for a full list)
+    if (revision != 0 && (baseRevision == 0 || baseRevision == _domainListRevision)
+        && (quint32)_pendingDomainListEntries.size() >= numEntries) {
+        _domainListRevision = revision;
     }
 }
 
+void NodeList::resetDomainListRevision() {
+    _domainListRevision = 0;
+    _pendingDomainListBaseRevision = 0;
+    _pendingDomainListRevision = 0;
+    _pendingDomainListEntries.clear();
+}
+
 void NodeList::processDomainServerAddedNode(QSharedPointer<ReceivedMessage> message) {
     // setup a QDataStream
     QDataStream packetStream(message->getMessage());
@@ -804,11 +875,14 @@ void NodeList::processDomainServerRemovedNode(QSharedPointer<ReceivedMessage> me
     // read the UUID from the packet, remove it if it exists
     QUuid nodeUUID = QUuid::fromRfc4122(message->readWithoutCopy(NUM_BYTES_RFC4122_UUID));
     qCDebug(networking) << "Received packet from domain-server to remove node with UUID" << uuidStringWithoutCurlyBraces(nodeUUID);
+
+    _isApplyingDomainServerUpdate = true;
     killNodeWithUUID(nodeUUID);
     removeDelayedAdd(nodeUUID);
+    _isApplyingDomainServerUpdate = false;
 }
 
-void NodeList::parseNodeFromPacketStream(QDataStream& packetStream) {
+QUuid NodeList::parseNodeFromPacketStream(QDataStream& packetStream) {
     NewNodeInfo info;
 
     packetStream >> info.type
@@ -827,6 +901,8 @@ void NodeList::parseNodeFromPacketStream(QDataStream& packetStream) {
     }
 
     addNewNode(info);
+
+    return info.uuid;
 }
 
 void NodeList::sendAssignment(Assignment& assignment) {
@@ -160,7 +160,8 @@ private:
 
     void sendDSPathQuery(const QString& newPath);
 
-    void parseNodeFromPacketStream(QDataStream& packetStream);
+    QUuid parseNodeFromPacketStream(QDataStream& packetStream);
+    void resetDomainListRevision();
 
     void pingPunchForInactiveNode(const SharedNodePointer& node);
 
@@ -176,6 +177,13 @@ private:
 
     bool _sendDomainServerCheckInEnabled { true };
 
+    // the revision of the domain-server's node table we hold, sent with each domain list request (0 if we need a full list)
+    std::atomic<quint64> _domainListRevision { 0 };
+    quint64 _pendingDomainListBaseRevision { 0 };
+    quint64 _pendingDomainListRevision { 0 };
+    QSet<QUuid> _pendingDomainListEntries;
+    bool _isApplyingDomainServerUpdate { false };
+
     mutable QReadWriteLock _ignoredSetLock;
     tbb::concurrent_unordered_set<QUuid, UUIDHasher> _ignoredNodeIDs;
     mutable QReadWriteLock _personalMutedSetLock;
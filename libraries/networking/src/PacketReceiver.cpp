@@ -13,6 +13,7 @@
 #include "PacketReceiver.h"
 
 #include <QMutexLocker>
+#include <QThread>
 
 #include "DependencyManager.h"
 #include "NetworkLogging.h"
@@ -25,6 +26,13 @@ PacketReceiver::PacketReceiver(QObject* parent) : QObject(parent) {
     qRegisterMetaType<QSharedPointer<ReceivedMessage>>();
 }
 
+PacketReceiver::~PacketReceiver() {
+    // the retired handlers are deleted along with _handlerEpochs
+    for (auto& handler : _handlers) {
+        delete handler.load();
+    }
+}
+
 bool PacketReceiver::registerListenerForTypes(PacketTypeList types, QObject* listener, const char* slot) {
     Q_ASSERT_X(!types.empty(), "PacketReceiver::registerListenerForTypes", "No types to register");
     Q_ASSERT_X(listener, "PacketReceiver::registerListenerForTypes", "No object to register");
@@ -169,13 +177,75 @@ void PacketReceiver::registerVerifiedListener(PacketType type, QObject* object,
     Q_ASSERT_X(object, "PacketReceiver::registerVerifiedListener", "No object to register");
     QMutexLocker locker(&_packetListenerLock);
 
-    if (_messageListenerMap.contains(type)) {
+    if (_messageListenerMap.contains(type) || _handlers[type].load()) {
         qCWarning(networking) << "Registering a packet listener for packet type" << type
             << "that will remove a previously registered listener";
     }
     
     // add the mapping
     _messageListenerMap[type] = { QPointer<QObject>(object), slot, deliverPending };
+    replaceHandler(type, nullptr);
+}
+
+bool PacketReceiver::registerHandler(PacketType type, QObject* owner, MessageHandler handler,
+                                     HandlerDispatch dispatch, bool deliverPending) {
+    return registerHandler(type, new Handler {
+        QPointer<QObject>(owner), std::make_shared<const MessageHandler>(std::move(handler)), HandlerExecutor(),
+        dispatch, deliverPending
+    });
+}
+
+bool PacketReceiver::registerHandler(PacketType type, QObject* owner, MessageHandler handler, HandlerExecutor executor,
+                                     bool deliverPending) {
+    Q_ASSERT_X(executor, "PacketReceiver::registerHandler", "No executor to dispatch with");
+
+    return registerHandler(type, new Handler {
+        QPointer<QObject>(owner), std::make_shared<const MessageHandler>(std::move(handler)), std::move(executor),
+        HandlerDispatch::Direct, deliverPending
+    });
+}
+
+bool PacketReceiver::registerHandler(PacketType type, Handler* handler) {
+    Q_ASSERT_X(handler->owner, "PacketReceiver::registerHandler", "No object to register");
+    Q_ASSERT_X(*handler->function, "PacketReceiver::registerHandler", "No handler to register");
+
+    if ((size_t)type >= _handlers.size() || !handler->owner || !*handler->function) {
+        qCWarning(networking) << "FAILED to Register a packet handler for packet type" << type;
+        delete handler;
+        return false;
+    }
+
+    qCDebug(networking) << "Registering a packet handler for packet type" << type;
+
+    QMutexLocker locker(&_packetListenerLock);
+
+    if (_messageListenerMap.contains(type) || _handlers[type].load()) {
+        qCWarning(networking) << "Registering a packet handler for packet type" << type
+            << "that will remove a previously registered listener";
+    }
+
+    _messageListenerMap.remove(type);
+    replaceHandler(type, handler);
+
+    return true;
+}
+
+void PacketReceiver::unregisterHandler(PacketType type) {
+    QMutexLocker locker(&_packetListenerLock);
+    replaceHandler(type, nullptr);
+}
+
+void PacketReceiver::replaceHandler(PacketType type, const Handler* handler) {
+    auto previousHandler = _handlers[type].exchange(handler);
+
+    if (previousHandler) {
+        // a message being dispatched on another thread could still be using it
+        _handlerEpochs.retire([previousHandler] {
+            delete previousHandler;
+        });
+    }
+
+    _handlerEpochs.reclaim();
 }
 
 void PacketReceiver::unregisterListener(QObject* listener) {
@@ -194,6 +264,14 @@ void PacketReceiver::unregisterListener(QObject* listener) {
                 ++it;
             }
         }
+
+        // and any handlers it owns
+        for (size_t type = 0; type < _handlers.size(); ++type) {
+            auto handler = _handlers[type].load();
+            if (handler && handler->owner == listener) {
+                replaceHandler((PacketType)type, nullptr);
+            }
+        }
     }
     
     QMutexLocker directConnectSetLocker(&_directConnectSetMutex);
@@ -258,6 +336,11 @@ void PacketReceiver::handleVerifiedMessage(QSharedPointer<ReceivedMessage> recei
     if (receivedMessage->getSourceID() != Node::NULL_LOCAL_ID) {
         matchingNode = nodeList->nodeWithLocalID(receivedMessage->getSourceID());
     }
+
+    if (dispatchToHandler(receivedMessage, matchingNode, justReceived)) {
+        return;
+    }
+
     QMutexLocker packetListenerLocker(&_packetListenerLock);
     
     auto it = _messageListenerMap.find(receivedMessage->getType());
@@ -326,3 +409,49 @@ void PacketReceiver::handleVerifiedMessage(QSharedPointer<ReceivedMessage> recei
         _messageListenerMap.insert(receivedMessage->getType(), { nullptr, QMetaMethod(), false });
     }
 }
+
+bool PacketReceiver::dispatchToHandler(const QSharedPointer<ReceivedMessage>& message, const SharedNodePointer& sourceNode,
+                                       bool justReceived) {
+    size_t type = message->getType();
+    if (type >= _handlers.size()) {
+        return false;
+    }
+
+    EpochReclamation::ReadGuard guard(_handlerEpochs);
+
+    auto handler = _handlers[type].load(std::memory_order_acquire);
+    if (!handler) {
+        return false;
+    }
+
+    if ((handler->deliverPending && !justReceived) || (!handler->deliverPending && !message->isComplete())) {
+        return true;
+    }
+
+    QObject* owner = handler->owner.data();
+
+    if (!owner) {
+        qCDebug(networking).nospace() << "Owner of the handler for packet " << message->getType()
+            << " has been destroyed. Removing the handler.";
+
+        QMutexLocker locker(&_packetListenerLock);
+        if (_handlers[type].load() == handler) {
+            replaceHandler(message->getType(), nullptr);
+        }
+    } else if (handler->executor) {
+        auto function = handler->function;
+        handler->executor([function, message, sourceNode] {
+            (*function)(message, sourceNode);
+        });
+    } else if (handler->dispatch == HandlerDispatch::Direct || owner->thread() == QThread::currentThread()) {
+        (*handler->function)(message, sourceNode);
+    } else {
+        // the owner is the context of the queued call, so it is dropped if the owner goes away before it runs
+        auto function = handler->function;
+        QMetaObject::invokeMethod(owner, [function, message, sourceNode] {
+            (*function)(message, sourceNode);
+        }, Qt::QueuedConnection);
+    }
+
+    return true;
+}
@@ -13,6 +13,10 @@
 #ifndef hifi_PacketReceiver_h
 #define hifi_PacketReceiver_h
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 
@@ -23,8 +27,11 @@
 #include <QtCore/QPointer>
 #include <QtCore/QSet>
 
+#include <shared/EpochReclamation.h>
+
 #include "NLPacket.h"
 #include "NLPacketList.h"
+#include "Node.h"
 #include "ReceivedMessage.h"
 #include "udt/PacketHeaders.h"
 
@@ -44,8 +51,19 @@ class PacketReceiver : public QObject {
     Q_OBJECT
 public:
     using PacketTypeList = std::vector<PacketType>;
+
+    // the node is null for non-sourced packets
+    using MessageHandler = std::function<void(QSharedPointer<ReceivedMessage>, SharedNodePointer)>;
+    // runs the given task on a queue of the caller's choosing (e.g. a worker pool)
+    using HandlerExecutor = std::function<void(std::function<void()>)>;
+
+    enum class HandlerDispatch {
+        OwnerThread, // on the owner's thread, queued if the message was received on another one
+        Direct // on the thread the message was received on, the handler must be thread-safe
+    };
     
     PacketReceiver(QObject* parent = 0);
+    ~PacketReceiver();
     PacketReceiver(const PacketReceiver&) = delete;
 
     PacketReceiver& operator=(const PacketReceiver&) = delete;
@@ -57,7 +75,33 @@ public:
     // for the message is received.
     bool registerListener(PacketType type, QObject* listener, const char* slot, bool deliverPending = false);
     bool registerListenerForTypes(PacketTypeList types, QObject* listener, const char* slot);
-    void unregisterListener(QObject* listener);
+    void unregisterListener(QObject* listener); // also unregisters the handlers the listener owns
+
+    // Typed handlers are looked up in a flat table indexed by packet type, without locks and without going through
+    // QMetaMethod. A handler replaces any listener previously registered for its type, and the other way around.
+    // The owner bounds the lifetime of the handler, it is dropped once the owner is destroyed.
+    bool registerHandler(PacketType type, QObject* owner, MessageHandler handler,
+                         HandlerDispatch dispatch = HandlerDispatch::OwnerThread, bool deliverPending = false);
+    bool registerHandler(PacketType type, QObject* owner, MessageHandler handler, HandlerExecutor executor,
+                         bool deliverPending = false);
+
+    template <typename T>
+    bool registerHandler(PacketType type, T* owner, void (T::*method)(QSharedPointer<ReceivedMessage>, SharedNodePointer),
+                         HandlerDispatch dispatch = HandlerDispatch::OwnerThread, bool deliverPending = false) {
+        return registerHandler(type, owner, [owner, method](QSharedPointer<ReceivedMessage> message, SharedNodePointer node) {
+            (owner->*method)(message, node);
+        }, dispatch, deliverPending);
+    }
+
+    template <typename T>
+    bool registerHandler(PacketType type, T* owner, void (T::*method)(QSharedPointer<ReceivedMessage>),
+                         HandlerDispatch dispatch = HandlerDispatch::OwnerThread, bool deliverPending = false) {
+        return registerHandler(type, owner, [owner, method](QSharedPointer<ReceivedMessage> message, SharedNodePointer) {
+            (owner->*method)(message);
+        }, dispatch, deliverPending);
+    }
+
+    void unregisterHandler(PacketType type);
     
     void handleVerifiedPacket(std::unique_ptr<udt::Packet> packet);
     void handleVerifiedMessagePacket(std::unique_ptr<udt::Packet> message);
@@ -70,7 +114,20 @@ private:
         bool deliverPending;
     };
 
+    // handlers are immutable once registered, and replaced as a whole
+    struct Handler {
+        QPointer<QObject> owner;
+        std::shared_ptr<const MessageHandler> function; // shared with the tasks queued for it
+        HandlerExecutor executor;
+        HandlerDispatch dispatch;
+        bool deliverPending;
+    };
+
     void handleVerifiedMessage(QSharedPointer<ReceivedMessage> message, bool justReceived);
+    bool dispatchToHandler(const QSharedPointer<ReceivedMessage>& message, const SharedNodePointer& sourceNode,
+                           bool justReceived);
+    bool registerHandler(PacketType type, Handler* handler);
+    void replaceHandler(PacketType type, const Handler* handler); // must hold _packetListenerLock
 
     // these are brutal hacks for now - ideally GenericThread / ReceivedPacketProcessor
     // should be changed to have a true event loop and be able to handle our QMetaMethod::invoke
@@ -83,6 +140,10 @@ private:
     QMutex _packetListenerLock;
     QHash<PacketType, Listener> _messageListenerMap;
 
+    // written under _packetListenerLock, read under a guard from _handlerEpochs
+    EpochReclamation _handlerEpochs;
+    std::array<std::atomic<const Handler*>, PacketType::NUM_PACKET_TYPE> _handlers {};
+
     bool _shouldDropPackets = false;
     QMutex _directConnectSetMutex;
     QSet<QObject*> _directlyConnectedObjects;
@@ -66,6 +66,10 @@ protected:
     /// \param QByteArray& the packet to be processed
     virtual void processPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) = 0;
 
+    /// Override to process the packets taken off the queue together. Default processes them one by one with
+    /// processPacket(), calling midProcess() after each.
+    virtual void processPackets(std::list<NodeSharedReceivedMessagePair>& packets);
+
     /// Implements generic processing behavior for this thread.
     virtual bool process() override;
 
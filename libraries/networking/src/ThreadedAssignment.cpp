@@ -106,6 +106,16 @@ void ThreadedAssignment::commonInit(const QString& targetName, NodeType_t nodeTy
     connect(&nodeList->getDomainHandler(), &DomainHandler::disconnectedFromDomain, &_statsTimer, &QTimer::stop);
 }
 
+static QJsonObject timingStats(const HdrHistogram& histogram) {
+    QJsonObject stats;
+    stats["samples"] = (double)histogram.getTotalCount();
+    stats["p50_usecs"] = (double)histogram.getValueAtPercentile(50.0);
+    stats["p90_usecs"] = (double)histogram.getValueAtPercentile(90.0);
+    stats["p99_usecs"] = (double)histogram.getValueAtPercentile(99.0);
+    stats["max_usecs"] = (double)histogram.getMax();
+    return stats;
+}
+
 void ThreadedAssignment::addPacketStatsAndSendStatsPacket(QJsonObject statsObject) {
     auto nodeList = DependencyManager::get<NodeList>();
 
@@ -119,6 +129,12 @@ void ThreadedAssignment::addPacketStatsAndSendStatsPacket(QJsonObject statsObjec
     ioStats["outbound_kbps"] = nodeList->getOutboundKbps();
     ioStats["outbound_pps"] = nodeList->getOutboundPPS();
 
+    auto timings = nodeList->getConnectionTimings();
+    ioStats["rtt"] = timingStats(timings.rtt);
+    ioStats["jitter"] = timingStats(timings.jitter);
+    ioStats["queueing_delay"] = timingStats(timings.queueingDelay);
+    ioStats["retransmit_latency"] = timingStats(timings.retransmitLatency);
+
     statsObject["io_stats"] = ioStats;
 
     QJsonObject assignmentStats;
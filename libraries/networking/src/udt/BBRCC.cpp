@@ -0,0 +1,279 @@
+//
+//  BBRCC.cpp
+//  libraries/networking/src/udt
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BBRCC.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtCore/QtGlobal>
+
+using namespace udt;
+using namespace std::chrono;
+
+static const double USECS_PER_SECOND = 1000000.0;
+
+// 2 / ln(2), the smallest gain that doubles the sending rate every round trip
+static const double HIGH_GAIN = 2.885;
+static const double PROBE_BANDWIDTH_CONGESTION_WINDOW_GAIN = 2.0;
+static const double PROBE_BANDWIDTH_PACING_GAINS[] = { 1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+static const int PROBE_BANDWIDTH_CYCLE_LENGTH = sizeof(PROBE_BANDWIDTH_PACING_GAINS) / sizeof(double);
+
+static const int BANDWIDTH_FILTER_ROUNDS = 10;
+static const double FULL_BANDWIDTH_GROWTH = 1.25;
+static const int FULL_BANDWIDTH_ROUNDS = 3;
+
+static const microseconds MIN_RTT_WINDOW = seconds(10);
+static const microseconds PROBE_RTT_DURATION = milliseconds(200);
+
+static const int MIN_CONGESTION_WINDOW_PACKETS = 4;
+static const int INITIAL_CONGESTION_WINDOW_PACKETS = 16;
+
+BBRCC::BBRCC() :
+    _pacingGain(HIGH_GAIN),
+    _congestionWindowGain(HIGH_GAIN)
+{
+    // until the first delivery rate sample the send queue is only limited by the congestion window
+    _packetSendPeriod = 0.0;
+    _congestionWindowSize = INITIAL_CONGESTION_WINDOW_PACKETS;
+}
+
+void BBRCC::onPacketSent(int wireSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint) {
+    if (_sentPacketDatas.empty()) {
+        // restarting from idle, don't let the idle time drag the next delivery rate samples down
+        _deliveredTime = timePoint;
+    }
+
+    _sentPacketDatas.emplace_back(seqNum, timePoint, _delivered, _deliveredTime);
+}
+
+void BBRCC::onPacketReSent(int wireSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint) {
+    auto it = std::find_if(_sentPacketDatas.begin(), _sentPacketDatas.end(), [seqNum](SentPacketData& sentPacketInfo) {
+        return sentPacketInfo.sequenceNumber == seqNum;
+    });
+
+    // a re-sent packet cannot be used for RTT samples since we can't tell which copy was ACKed
+    if (it != _sentPacketDatas.end()) {
+        it->wasResent = true;
+    }
+}
+
+bool BBRCC::onACK(SequenceNumber ack, p_high_resolution_clock::time_point receiveTime) {
+    auto previousAck = _lastACK;
+    _lastACK = ack;
+
+    bool wasDuplicateACK = (ack == previousAck);
+
+    // the ACK is cumulative - pop every packet it covers, keeping the most recently sent one for the samples
+    int newlyDelivered = 0;
+    auto lastACKed = _sentPacketDatas.empty() ? SentPacketData(ack, receiveTime, _delivered, _deliveredTime)
+                                              : _sentPacketDatas.front();
+
+    while (!_sentPacketDatas.empty() && _sentPacketDatas.front().sequenceNumber <= ack) {
+        lastACKed = _sentPacketDatas.front();
+        _sentPacketDatas.pop_front();
+        ++newlyDelivered;
+    }
+
+    if (newlyDelivered > 0) {
+        _delivered += newlyDelivered;
+        _deliveredTime = receiveTime;
+
+        if (lastACKed.sequenceNumber == ack && !lastACKed.wasResent) {
+            updateRTT(duration_cast<microseconds>(receiveTime - lastACKed.timePoint).count(), receiveTime);
+        }
+
+        // a new round trip starts once a packet sent after the previous round started is ACKed
+        bool roundStarted = false;
+        if (lastACKed.deliveredAtSend >= _nextRoundDelivered) {
+            _nextRoundDelivered = _delivered;
+            ++_round;
+            roundStarted = true;
+        }
+
+        // delivery rate over the interval this packet was in flight - samples shorter than the propagation
+        // delay come from ACK compression and over-estimate the bandwidth, so they are skipped
+        auto interval = duration_cast<microseconds>(receiveTime - lastACKed.deliveredTimeAtSend).count();
+        if (interval > 0 && (_minRTT == -1 || interval >= _minRTT)) {
+            updateBandwidth((_delivered - lastACKed.deliveredAtSend) * USECS_PER_SECOND / interval);
+        }
+
+        if (roundStarted && _mode == Mode::Startup) {
+            // Startup ends when the bandwidth estimate stops growing for a few rounds - the pipe is full
+            if (_bottleneckBandwidth >= _fullBandwidth * FULL_BANDWIDTH_GROWTH) {
+                _fullBandwidth = _bottleneckBandwidth;
+                _fullBandwidthRounds = 0;
+            } else if (++_fullBandwidthRounds >= FULL_BANDWIDTH_ROUNDS) {
+                _mode = Mode::Drain;
+                _pacingGain = 1.0 / HIGH_GAIN;
+                _congestionWindowGain = HIGH_GAIN;
+            }
+        }
+    }
+
+    updateMode(receiveTime);
+    updateControlParameters();
+
+    ++_numACKSinceFastRetransmit;
+
+    // perform the fast re-transmit check if this is a duplicate ACK or if this is the first or second ACK
+    // after a previous fast re-transmit
+    if (wasDuplicateACK || _numACKSinceFastRetransmit < 3) {
+        return needsFastRetransmit(ack, wasDuplicateACK);
+    } else {
+        _duplicateACKCount = 0;
+    }
+
+    return false;
+}
+
+void BBRCC::updateRTT(int rttSample, p_high_resolution_clock::time_point now) {
+    const int MAX_RTT_SAMPLE_MICROSECONDS = 10000000;
+    rttSample = std::max(1, std::min(rttSample, MAX_RTT_SAMPLE_MICROSECONDS));
+    _lastRTTSample = rttSample;
+
+    // Jacobson's smoothed RTT, only used for the retransmission timeout
+    if (_ewmaRTT == -1) {
+        _ewmaRTT = rttSample;
+        _rttVariance = rttSample / 2;
+    } else {
+        static const int RTT_ESTIMATION_ALPHA = 8;
+        static const int RTT_ESTIMATION_VARIANCE_ALPHA = 4;
+
+        _ewmaRTT = (_ewmaRTT * (RTT_ESTIMATION_ALPHA - 1) + rttSample) / RTT_ESTIMATION_ALPHA;
+        _rttVariance = (_rttVariance * (RTT_ESTIMATION_VARIANCE_ALPHA - 1)
+                        + abs(rttSample - _ewmaRTT)) / RTT_ESTIMATION_VARIANCE_ALPHA;
+    }
+
+    // the propagation delay is the min RTT over a window - an old minimum is replaced by whatever we see now
+    _minRTTExpired = _minRTT != -1 && (now - _minRTTTimestamp) > MIN_RTT_WINDOW;
+    if (_minRTT == -1 || rttSample <= _minRTT || _minRTTExpired) {
+        _minRTT = rttSample;
+        _minRTTTimestamp = now;
+    }
+}
+
+void BBRCC::updateBandwidth(double packetsPerSecond) {
+    // drop samples that fell out of the window, then samples that can never be the max again
+    while (!_bandwidthSamples.empty() && _bandwidthSamples.front().round <= _round - BANDWIDTH_FILTER_ROUNDS) {
+        _bandwidthSamples.pop_front();
+    }
+    while (!_bandwidthSamples.empty() && _bandwidthSamples.back().packetsPerSecond <= packetsPerSecond) {
+        _bandwidthSamples.pop_back();
+    }
+    _bandwidthSamples.push_back({ _round, packetsPerSecond });
+
+    _bottleneckBandwidth = _bandwidthSamples.front().packetsPerSecond;
+}
+
+void BBRCC::enterProbeBandwidth(p_high_resolution_clock::time_point now) {
+    _mode = Mode::ProbeBandwidth;
+    _congestionWindowGain = PROBE_BANDWIDTH_CONGESTION_WINDOW_GAIN;
+
+    // start on a random phase other than the draining one, so that connections sharing a link don't sync up
+    _probeBandwidthCycleIndex = (PROBE_BANDWIDTH_CYCLE_LENGTH - 1 - qrand() % (PROBE_BANDWIDTH_CYCLE_LENGTH - 1));
+    _pacingGain = PROBE_BANDWIDTH_PACING_GAINS[_probeBandwidthCycleIndex];
+    _cycleStart = now;
+}
+
+void BBRCC::updateMode(p_high_resolution_clock::time_point now) {
+    if (_mode == Mode::Drain && packetsInFlight() <= bandwidthDelayProduct()) {
+        // the queue built during Startup is gone
+        enterProbeBandwidth(now);
+    }
+
+    if (_mode == Mode::ProbeBandwidth && _minRTT != -1 && (now - _cycleStart) > microseconds(_minRTT)) {
+        // each gain in the cycle is held for one propagation delay
+        _probeBandwidthCycleIndex = (_probeBandwidthCycleIndex + 1) % PROBE_BANDWIDTH_CYCLE_LENGTH;
+        _pacingGain = PROBE_BANDWIDTH_PACING_GAINS[_probeBandwidthCycleIndex];
+        _cycleStart = now;
+    }
+
+    if (_minRTTExpired && _mode != Mode::ProbeRTT) {
+        // the min RTT hasn't been seen in a while, drain the queue so we can measure it again
+        _modeBeforeProbeRTT = _mode;
+        _mode = Mode::ProbeRTT;
+        _pacingGain = 1.0;
+        _probeRTTDoneTime = p_high_resolution_clock::time_point();
+        _minRTTExpired = false;
+    }
+
+    if (_mode == Mode::ProbeRTT) {
+        if (_probeRTTDoneTime == p_high_resolution_clock::time_point()) {
+            if (packetsInFlight() <= MIN_CONGESTION_WINDOW_PACKETS) {
+                _probeRTTDoneTime = now + PROBE_RTT_DURATION;
+            }
+        } else if (now >= _probeRTTDoneTime) {
+            _minRTTTimestamp = now;
+
+            if (_modeBeforeProbeRTT == Mode::Startup) {
+                _mode = Mode::Startup;
+                _pacingGain = HIGH_GAIN;
+                _congestionWindowGain = HIGH_GAIN;
+            } else {
+                enterProbeBandwidth(now);
+            }
+        }
+    }
+}
+
+int BBRCC::bandwidthDelayProduct() const {
+    if (_minRTT == -1 || _bottleneckBandwidth <= 0.0) {
+        return INITIAL_CONGESTION_WINDOW_PACKETS;
+    }
+
+    return (int)std::ceil(_bottleneckBandwidth * _minRTT / USECS_PER_SECOND);
+}
+
+void BBRCC::updateControlParameters() {
+    if (_bottleneckBandwidth > 0.0) {
+        // pace at the estimated bottleneck bandwidth, scaled by the gain of the current mode
+        setPacketSendPeriod(USECS_PER_SECOND / (_pacingGain * _bottleneckBandwidth));
+    }
+
+    if (_mode == Mode::ProbeRTT) {
+        _congestionWindowSize = MIN_CONGESTION_WINDOW_PACKETS;
+    } else {
+        _congestionWindowSize = (int)std::ceil(_congestionWindowGain * bandwidthDelayProduct());
+    }
+
+    _congestionWindowSize = std::max(MIN_CONGESTION_WINDOW_PACKETS,
+                                     std::min(_congestionWindowSize, udt::MAX_PACKETS_IN_FLIGHT));
+}
+
+bool BBRCC::needsFastRetransmit(SequenceNumber ack, bool wasDuplicateACK) {
+    // we may need to re-send ackNum + 1 if it has been more than our estimated timeout since it was sent
+    if (!_sentPacketDatas.empty() && _sentPacketDatas.front().sequenceNumber == ack + 1) {
+        auto sinceSend = duration_cast<microseconds>(p_high_resolution_clock::now() - _sentPacketDatas.front().timePoint).count();
+
+        if (sinceSend >= estimatedTimeout()) {
+            _numACKSinceFastRetransmit = 0;
+            return true;
+        }
+    }
+
+    // if this is the 3rd duplicate ACK, we fallback to Reno's fast re-transmit
+    static const int RENO_FAST_RETRANSMIT_DUPLICATE_COUNT = 3;
+
+    ++_duplicateACKCount;
+
+    if (wasDuplicateACK && _duplicateACKCount == RENO_FAST_RETRANSMIT_DUPLICATE_COUNT) {
+        // unlike Reno or Vegas we don't shrink the window on loss, the model only changes with delivery rate
+        _numACKSinceFastRetransmit = 0;
+        _duplicateACKCount = 0;
+        return true;
+    }
+
+    return false;
+}
+
+int BBRCC::estimatedTimeout() const {
+    return _ewmaRTT == -1 ? DEFAULT_SYN_INTERVAL : _ewmaRTT + _rttVariance * 4;
+}
@@ -0,0 +1,115 @@
+//
+//  BBRCC.h
+//  libraries/networking/src/udt
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_BBRCC_h
+#define hifi_BBRCC_h
+
+#include <algorithm>
+#include <deque>
+
+#include "CongestionControl.h"
+#include "Constants.h"
+
+namespace udt {
+
+// Model based congestion control in the style of BBR
+// https://queue.acm.org/detail.cfm?id=3022184
+//
+// Instead of reacting to delay (like TCPVegasCC) or loss, it keeps estimates of the bottleneck bandwidth
+// and of the round trip propagation delay. The send period paces packets at the bottleneck bandwidth
+// and the congestion window is sized to a small multiple of the bandwidth-delay product.
+class BBRCC : public CongestionControl {
+public:
+    BBRCC();
+
+    virtual bool onACK(SequenceNumber ackNum, p_high_resolution_clock::time_point receiveTime) override;
+
+    virtual void onPacketSent(int wireSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint) override;
+    virtual void onPacketReSent(int wireSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint) override;
+
+    virtual int estimatedTimeout() const override;
+    virtual int estimatedRTT() const override { return std::max(_ewmaRTT, 0); }
+
+protected:
+    virtual void setInitialSendSequenceNumber(SequenceNumber seqNum) override { _lastACK = seqNum - 1; }
+
+private:
+    enum class Mode { Startup, Drain, ProbeBandwidth, ProbeRTT };
+
+    struct SentPacketData {
+        SentPacketData(SequenceNumber seqNum, p_high_resolution_clock::time_point tPoint,
+                       int64_t delivered, p_high_resolution_clock::time_point deliveredTime) :
+            sequenceNumber(seqNum), timePoint(tPoint), deliveredAtSend(delivered), deliveredTimeAtSend(deliveredTime) {};
+
+        SequenceNumber sequenceNumber;
+        p_high_resolution_clock::time_point timePoint;
+        int64_t deliveredAtSend; // packets delivered when this one was sent, for delivery rate samples
+        p_high_resolution_clock::time_point deliveredTimeAtSend;
+        bool wasResent { false };
+    };
+
+    struct BandwidthSample {
+        int64_t round;
+        double packetsPerSecond;
+    };
+
+    void updateRTT(int rttSample, p_high_resolution_clock::time_point now);
+    void updateBandwidth(double packetsPerSecond);
+    void updateMode(p_high_resolution_clock::time_point now);
+    void updateControlParameters();
+
+    void enterProbeBandwidth(p_high_resolution_clock::time_point now);
+
+    bool needsFastRetransmit(SequenceNumber ack, bool wasDuplicateACK);
+
+    int bandwidthDelayProduct() const; // in packets
+    int packetsInFlight() const { return (int)_sentPacketDatas.size(); }
+
+    std::deque<SentPacketData> _sentPacketDatas; // sent but un-ACKed packets, oldest first
+
+    Mode _mode { Mode::Startup };
+    double _pacingGain;
+    double _congestionWindowGain;
+
+    // delivery rate samples, max filtered over the last few rounds - monotonically decreasing rates
+    std::deque<BandwidthSample> _bandwidthSamples;
+    double _bottleneckBandwidth { 0.0 }; // packets per second
+
+    int64_t _delivered { 0 }; // number of packets ACKed on this connection
+    p_high_resolution_clock::time_point _deliveredTime;
+
+    int64_t _round { 0 }; // number of round trips elapsed
+    int64_t _nextRoundDelivered { 0 }; // value of _delivered that ends the current round
+
+    double _fullBandwidth { 0.0 }; // bandwidth plateau detection for leaving Startup
+    int _fullBandwidthRounds { 0 };
+
+    int _probeBandwidthCycleIndex { 0 };
+    p_high_resolution_clock::time_point _cycleStart;
+
+    int _minRTT { -1 }; // round trip propagation delay estimate, in microseconds
+    p_high_resolution_clock::time_point _minRTTTimestamp;
+    bool _minRTTExpired { false };
+    p_high_resolution_clock::time_point _probeRTTDoneTime;
+    Mode _modeBeforeProbeRTT { Mode::ProbeBandwidth };
+
+    int _ewmaRTT { -1 }; // used for the retransmission timeout, as in TCPVegasCC
+    int _rttVariance { 0 };
+
+    SequenceNumber _lastACK; // Sequence number of last packet that was ACKed
+    int _numACKSinceFastRetransmit { 3 }; // Number of ACKs received since fast re-transmit, default avoids immediate re-transmit
+    int _duplicateACKCount { 0 };
+};
+
+}
+
+#endif // hifi_BBRCC_h
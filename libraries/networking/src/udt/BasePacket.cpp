@@ -86,6 +86,15 @@ BasePacket& BasePacket::operator=(const BasePacket& other) {
     _payloadCapacity = other._payloadCapacity;
     
     _payloadSize = other._payloadSize;
+
+    if (other.hasExternalPayload()) {
+        // a copy owns all of its data, so pull the external payload into the new buffer
+        memcpy(_payloadStart + _payloadSize, other.getExternalPayload(), other._externalPayloadSize);
+        _payloadSize += other._externalPayloadSize;
+    }
+    _externalPayload.clear();
+    _externalPayloadOffset = 0;
+    _externalPayloadSize = 0;
     
     _senderSockAddr = other._senderSockAddr;
     
@@ -110,6 +119,12 @@ BasePacket& BasePacket::operator=(BasePacket&& other) {
     _payloadCapacity = other._payloadCapacity;
     
     _payloadSize = other._payloadSize;
+
+    _externalPayload = std::move(other._externalPayload);
+    _externalPayloadOffset = other._externalPayloadOffset;
+    _externalPayloadSize = other._externalPayloadSize;
+    other._externalPayloadOffset = 0;
+    other._externalPayloadSize = 0;
     
     _senderSockAddr = std::move(other._senderSockAddr);
     
@@ -132,6 +147,17 @@ void BasePacket::setPayloadSize(qint64 payloadSize) {
     }
 }
 
+void BasePacket::setExternalPayload(const QByteArray& buffer, qint64 offset, qint64 size) {
+    Q_ASSERT(isWritable());
+    Q_ASSERT(offset >= 0 && offset + size <= buffer.size());
+    Q_ASSERT_X(size <= _payloadCapacity - _payloadSize, "BasePacket::setExternalPayload",
+               "external payload does not fit in the packet");
+
+    _externalPayload = buffer;
+    _externalPayloadOffset = offset;
+    _externalPayloadSize = size;
+}
+
 QByteArray BasePacket::read(qint64 maxSize) {
     qint64 sizeToRead = std::min(size() - pos(), maxSize);
     QByteArray data { getPayload() + pos(), (int) sizeToRead };
@@ -48,11 +48,11 @@ public:
     char* getData() { return _packet.get(); }
     const char* getData() const { return _packet.get(); }
     
-    // Returns the size of the packet, including the header
+    // Returns the size of the packet held in getData(), including the header (but not the external payload)
     qint64 getDataSize() const { return (_payloadStart - _packet.get()) + _payloadSize; }
     
-    // Returns the size of the packet, including the header AND the UDP/IP header
-    qint64 getWireSize() const { return getDataSize() + UDP_IPV4_HEADER_SIZE; }
+    // Returns the size of the packet, including the header, the external payload AND the UDP/IP header
+    qint64 getWireSize() const { return getDataSize() + _externalPayloadSize + UDP_IPV4_HEADER_SIZE; }
     
     // Returns the size of the payload only
     qint64 getPayloadSize() const { return _payloadSize; }
@@ -64,7 +64,14 @@ public:
     qint64 getPayloadCapacity() const  { return _payloadCapacity; }
     
     qint64 bytesLeftToRead() const { return _payloadSize - pos(); }
-    qint64 bytesAvailableForWrite() const { return _payloadCapacity - pos(); }
+    qint64 bytesAvailableForWrite() const { return hasExternalPayload() ? 0 : _payloadCapacity - pos(); }
+
+    // Sends size bytes of buffer, starting at offset, after the payload without copying them into the packet.
+    // The packet keeps a reference to buffer, and nothing else can be written to it once this is set.
+    void setExternalPayload(const QByteArray& buffer, qint64 offset, qint64 size);
+    bool hasExternalPayload() const { return _externalPayloadSize > 0; }
+    const char* getExternalPayload() const { return _externalPayload.constData() + _externalPayloadOffset; }
+    qint64 getExternalPayloadSize() const { return _externalPayloadSize; }
     
     HifiSockAddr& getSenderSockAddr() { return _senderSockAddr; }
     const HifiSockAddr& getSenderSockAddr() const { return _senderSockAddr; }
@@ -106,6 +113,10 @@ protected:
     qint64 _payloadCapacity = 0;          // Total capacity of the payload
     
     qint64 _payloadSize = 0;          // How much of the payload is actually used
+
+    QByteArray _externalPayload;   // Shared buffer the tail of the payload is sent from (only used on sending end)
+    qint64 _externalPayloadOffset = 0;
+    qint64 _externalPayloadSize = 0;
     
     HifiSockAddr _senderSockAddr;  // sender address for packet (only used on receiving end)
 
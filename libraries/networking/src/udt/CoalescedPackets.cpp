@@ -0,0 +1,93 @@
+//
+//  CoalescedPackets.cpp
+//  libraries/networking/src/udt
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "CoalescedPackets.h"
+
+#include <cstring>
+
+#include "../NLPacket.h"
+
+using namespace udt;
+
+// bigger packets don't gain much from sharing a datagram, and would leave little room for others
+static const int MAX_COALESCED_PACKET_SIZE = Packet::maxPayloadSize() / 4;
+
+static qint64 entrySize(const Packet& packet) {
+    return (qint64)sizeof(CoalescedPackets::EntrySize) + packet.getDataSize() - Packet::localHeaderSize();
+}
+
+std::unique_ptr<Packet> CoalescedPackets::createContainer() {
+    return NLPacket::create(PacketType::CoalescedPackets, -1, true);
+}
+
+bool CoalescedPackets::isCoalescable(const Packet& packet) {
+    return !packet.isPartOfMessage() && !packet.hasExternalPayload()
+        && packet.getDataSize() - Packet::localHeaderSize() <= MAX_COALESCED_PACKET_SIZE;
+}
+
+bool CoalescedPackets::canAppend(const Packet& container, const Packet& packet) {
+    return isCoalescable(packet) && entrySize(packet) <= container.bytesAvailableForWrite();
+}
+
+void CoalescedPackets::append(Packet& container, const Packet& packet) {
+    auto size = packet.getDataSize() - Packet::localHeaderSize();
+    container.writePrimitive((EntrySize)size);
+    container.write(packet.getData() + Packet::localHeaderSize(), size);
+}
+
+bool CoalescedPackets::unpack(const Packet& container, std::vector<std::unique_ptr<Packet>>& packets) {
+    const int containerHeaderSize = NLPacket::localHeaderSize(PacketType::CoalescedPackets);
+    if (container.getPayloadSize() < containerHeaderSize) {
+        return false;
+    }
+
+    const char* begin = container.getPayload() + containerHeaderSize;
+    const char* end = container.getPayload() + container.getPayloadSize();
+
+    // check every entry before unpacking any, so that a container is either handled whole or not at all
+    const char* entry = begin;
+    while (entry < end) {
+        EntrySize size;
+        if (end - entry < (qint64)sizeof(size)) {
+            return false;
+        }
+        memcpy(&size, entry, sizeof(size));
+        entry += sizeof(size);
+
+        if (size < sizeof(PacketType) || end - entry < size ||
+            size < NLPacket::localHeaderSize((PacketType)(quint8)entry[0])) {
+            return false;
+        }
+        entry += size;
+    }
+
+    Packet::SequenceNumberAndBitField header = (SequenceNumber::Type)container.getSequenceNumber();
+    if (container.isReliable()) {
+        header |= RELIABILITY_BIT_MASK;
+    }
+
+    packets.clear();
+    for (entry = begin; entry < end;) {
+        EntrySize size;
+        memcpy(&size, entry, sizeof(size));
+        entry += sizeof(size);
+
+        int packetSize = (int)sizeof(header) + size;
+        auto buffer = std::unique_ptr<char[]>(new char[packetSize]);
+        memcpy(buffer.get(), &header, sizeof(header));
+        memcpy(buffer.get() + sizeof(header), entry, size);
+        entry += size;
+
+        auto packet = Packet::fromReceivedPacket(std::move(buffer), packetSize, container.getSenderSockAddr());
+        packet->setReceiveTime(container.getReceiveTime());
+        packets.push_back(std::move(packet));
+    }
+    return true;
+}
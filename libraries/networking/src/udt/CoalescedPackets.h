@@ -0,0 +1,45 @@
+//
+//  CoalescedPackets.h
+//  libraries/networking/src/udt
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_CoalescedPackets_h
+#define hifi_CoalescedPackets_h
+
+#include <memory>
+#include <vector>
+
+#include "Packet.h"
+
+namespace udt {
+
+// The CoalescedPackets container a SendQueue packs small reliable packets into. The container is a packet of its
+// own, it is sequenced, ACKed and re-sent as a whole. Its payload is the list of the packets in it, each with its
+// size and without its udt header (the receiver gives them the one of the container).
+class CoalescedPackets {
+public:
+    using EntrySize = quint16;
+
+    static std::unique_ptr<Packet> createContainer();
+
+    // Small packets that aren't part of a message and own their payload.
+    static bool isCoalescable(const Packet& packet);
+
+    static bool canAppend(const Packet& container, const Packet& packet);
+    static void append(Packet& container, const Packet& packet);
+
+    // Gives each packet in a received container the udt header of the container. Fails, without unpacking any of
+    // them, if an entry is cut short or too small to hold a packet header.
+    static bool unpack(const Packet& container, std::vector<std::unique_ptr<Packet>>& packets);
+};
+
+}
+
+#endif // hifi_CoalescedPackets_h
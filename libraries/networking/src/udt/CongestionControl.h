@@ -48,6 +48,7 @@ public:
     virtual void onPacketReSent(int wireSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint) {}
 
     virtual int estimatedTimeout() const = 0;
+    virtual int estimatedRTT() const { return 0; } // smoothed RTT in microseconds, 0 if unknown
 
 protected:
     void setMSS(int mss) { _mss = mss; }
@@ -62,6 +63,7 @@ protected:
     
     int _mss { 0 }; // Maximum Packet Size, including all packet headers
     SequenceNumber _sendCurrSeqNum; // current maximum seq num sent out
+    int _lastRTTSample { -1 }; // raw RTT measured from the last ACK in microseconds, -1 once the connection took it
     
 private:
     CongestionControl(const CongestionControl& other) = delete;
@@ -11,6 +11,8 @@
 
 #include "Connection.h"
 
+#include <algorithm>
+#include <cstdlib>
 #include <random>
 
 #include <QtCore/QThread>
@@ -89,6 +91,14 @@ void Connection::setMaxBandwidth(int maxBandwidth) {
     _congestionControl->setMaxBandwidth(maxBandwidth);
 }
 
+void Connection::setCoalescingWindow(int coalescingWindow) {
+    _coalescingWindow = coalescingWindow;
+
+    if (_sendQueue) {
+        _sendQueue->setCoalescingWindow(_coalescingWindow);
+    }
+}
+
 SendQueue& Connection::getSendQueue() {
     if (!_sendQueue) {
         // we may have a sequence number from the previous inactive queue - re-use that so that the
@@ -121,6 +131,7 @@ SendQueue& Connection::getSendQueue() {
         _sendQueue->setPacketSendPeriod(_congestionControl->_packetSendPeriod);
         _sendQueue->setEstimatedTimeout(_congestionControl->estimatedTimeout());
         _sendQueue->setFlowWindowSize(_congestionControl->_congestionWindowSize);
+        _sendQueue->setCoalescingWindow(_coalescingWindow);
 
         // give the randomized sequence number to the congestion control object
         _congestionControl->setInitialSendSequenceNumber(_sendQueue->getCurrentSequenceNumber());
@@ -194,8 +205,10 @@ void Connection::recordSentPackets(int wireSize, int payloadSize,
 }
 
 void Connection::recordRetransmission(int wireSize, int payloadSize,
-                                      SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint) {
+                                      SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint,
+                                      p_high_resolution_clock::time_point firstSentTimePoint) {
     _stats.recordRetransmittedPackets(payloadSize, wireSize);
+    _stats.recordRetransmitLatency(duration_cast<microseconds>(timePoint - firstSentTimePoint).count());
 
     _congestionControl->onPacketReSent(wireSize, seqNum, timePoint);
 }
@@ -204,8 +217,10 @@ void Connection::recordSentUnreliablePackets(int wireSize, int payloadSize) {
     _stats.recordUnreliableSentPackets(payloadSize, wireSize);
 }
 
-void Connection::recordReceivedUnreliablePackets(int wireSize, int payloadSize) {
+void Connection::recordReceivedUnreliablePackets(int wireSize, int payloadSize,
+                                                 p_high_resolution_clock::time_point receiveTime) {
     _stats.recordUnreliableReceivedPackets(payloadSize, wireSize);
+    _stats.recordQueueingDelay(duration_cast<microseconds>(p_high_resolution_clock::now() - receiveTime).count());
 }
 
 void Connection::sendACK() {
@@ -240,7 +255,8 @@ void Connection::sendHandshakeRequest() {
     _didRequestHandshake = true;
 }
 
-bool Connection::processReceivedSequenceNumber(SequenceNumber sequenceNumber, int packetSize, int payloadSize) {
+bool Connection::processReceivedSequenceNumber(SequenceNumber sequenceNumber, int packetSize, int payloadSize,
+                                               p_high_resolution_clock::time_point receiveTime) {
     if (!_hasReceivedHandshake) {
         // Refuse to process any packets until we've received the handshake
         // Send handshake request to re-request a handshake
@@ -256,6 +272,9 @@ bool Connection::processReceivedSequenceNumber(SequenceNumber sequenceNumber, in
     
     // mark our last receive time as now (to push the potential expiry farther)
     _lastReceiveTime = p_high_resolution_clock::now();
+
+    _stats.recordQueueingDelay(duration_cast<microseconds>(_lastReceiveTime - receiveTime).count());
+    recordArrival(sequenceNumber, receiveTime);
     
     // If this is not the next sequence number, report loss
     if (sequenceNumber > _lastReceivedSequenceNumber + 1) {
@@ -288,6 +307,26 @@ bool Connection::processReceivedSequenceNumber(SequenceNumber sequenceNumber, in
     return !wasDuplicate;
 }
 
+void Connection::recordArrival(SequenceNumber sequenceNumber, p_high_resolution_clock::time_point receiveTime) {
+    // there are no send timestamps on the wire, so the one way jitter is measured as the change in the gap
+    // between consecutive packets (RFC 5481 IPDV) - a packet after a loss, or a re-ordered one, has nothing to compare with
+    if (sequenceNumber == _lastReceivedSequenceNumber + 1 && _lastArrivalTime != p_high_resolution_clock::time_point()) {
+        int gap = (int)duration_cast<microseconds>(receiveTime - _lastArrivalTime).count();
+
+        if (_lastArrivalGap >= 0) {
+            _stats.recordJitter(std::abs(gap - _lastArrivalGap));
+        }
+
+        _lastArrivalGap = std::max(gap, 0);
+    } else {
+        _lastArrivalGap = -1;
+    }
+
+    if (sequenceNumber > _lastReceivedSequenceNumber) {
+        _lastArrivalTime = receiveTime;
+    }
+}
+
 void Connection::processControl(ControlPacketPointer controlPacket) {
     
     // Simple dispatch to control packets processing methods based on their type.
@@ -354,6 +393,11 @@ void Connection::processACK(ControlPacketPointer controlPacket) {
             // the congestion control has told us it needs a fast re-transmit of ack + 1, add that now
             _sendQueue->fastRetransmit(ack + 1);
         }
+
+        if (_congestionControl->_lastRTTSample != -1) {
+            _stats.recordRTTSample(_congestionControl->_lastRTTSample);
+            _congestionControl->_lastRTTSample = -1;
+        }
     });
     
     _stats.record(ConnectionStats::Stats::ProcessedACK);
@@ -412,6 +456,8 @@ void Connection::resetReceiveState() {
     SequenceNumber defaultSequenceNumber;
     
     _lastReceivedSequenceNumber = defaultSequenceNumber;
+    _lastArrivalTime = p_high_resolution_clock::time_point();
+    _lastArrivalGap = -1;
     
     // clear the loss list
     _lossList.clear();
@@ -443,6 +489,7 @@ void Connection::updateCongestionControlAndSendQueue(std::function<void ()> cong
     // record connection stats
     _stats.recordPacketSendPeriod(_congestionControl->_packetSendPeriod);
     _stats.recordCongestionWindowSize(_congestionControl->_congestionWindowSize);
+    _stats.recordRTT(_congestionControl->estimatedRTT());
 }
 
 void PendingReceivedMessage::enqueuePacket(std::unique_ptr<Packet> packet) {
@@ -61,7 +61,8 @@ public:
     void sync(); // rate control method, fired by Socket for all connections on SYN interval
 
     // return indicates if this packet should be processed
-    bool processReceivedSequenceNumber(SequenceNumber sequenceNumber, int packetSize, int payloadSize);
+    bool processReceivedSequenceNumber(SequenceNumber sequenceNumber, int packetSize, int payloadSize,
+                                       p_high_resolution_clock::time_point receiveTime);
     void processControl(ControlPacketPointer controlPacket);
 
     void queueReceivedMessagePacket(std::unique_ptr<Packet> packet);
@@ -71,12 +72,13 @@ public:
     HifiSockAddr getDestination() const { return _destination; }
 
     void setMaxBandwidth(int maxBandwidth);
+    void setCoalescingWindow(int coalescingWindow);
 
     void sendHandshakeRequest();
     bool hasReceivedHandshake() const { return _hasReceivedHandshake; }
     
     void recordSentUnreliablePackets(int wireSize, int payloadSize);
-    void recordReceivedUnreliablePackets(int wireSize, int payloadSize);
+    void recordReceivedUnreliablePackets(int wireSize, int payloadSize, p_high_resolution_clock::time_point receiveTime);
     void setDestinationAddress(const HifiSockAddr& destination);
 
 signals:
@@ -86,7 +88,8 @@ signals:
 
 private slots:
     void recordSentPackets(int wireSize, int payloadSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint);
-    void recordRetransmission(int wireSize, int payloadSize, SequenceNumber sequenceNumber, p_high_resolution_clock::time_point timePoint);
+    void recordRetransmission(int wireSize, int payloadSize, SequenceNumber sequenceNumber, p_high_resolution_clock::time_point timePoint,
+                              p_high_resolution_clock::time_point firstSentTimePoint);
 
     void queueInactive();
     void queueTimeout();
@@ -99,6 +102,7 @@ private:
     void processHandshakeACK(ControlPacketPointer controlPacket);
     
     void resetReceiveState();
+    void recordArrival(SequenceNumber sequenceNumber, p_high_resolution_clock::time_point receiveTime);
     
     SendQueue& getSendQueue();
     SequenceNumber nextACK() const;
@@ -113,6 +117,8 @@ private:
    
     p_high_resolution_clock::time_point _connectionStart = p_high_resolution_clock::now(); // holds the time_point for creation of this connection
     p_high_resolution_clock::time_point _lastReceiveTime; // holds the last time we received anything from sender
+    p_high_resolution_clock::time_point _lastArrivalTime; // receive time of the packet with the largest sequence number
+    int _lastArrivalGap { -1 }; // usecs between the last two consecutive packets, -1 if they weren't consecutive
 
     SequenceNumber _initialSequenceNumber; // Randomized on Connection creation, identifies connection during re-connect requests
     SequenceNumber _initialReceiveSequenceNumber; // Randomized by peer Connection on creation, identifies connection during re-connect requests
@@ -129,6 +135,7 @@ private:
     std::unique_ptr<CongestionControl> _congestionControl;
    
     std::unique_ptr<SendQueue> _sendQueue;
+    int _coalescingWindow { 0 };
     
     std::map<MessageNumber, PendingReceivedMessage> _pendingReceivedMessages;
 
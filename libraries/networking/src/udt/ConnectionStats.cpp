@@ -11,6 +11,8 @@
 
 #include "ConnectionStats.h"
 
+#include <algorithm>
+
 #include <QtCore/QDebug>
 
 using namespace udt;
@@ -90,6 +92,26 @@ void ConnectionStats::recordPacketSendPeriod(int sample) {
     _currentSample.packetSendPeriod = sample;
 }
 
+void ConnectionStats::recordRTT(int sample) {
+    _currentSample.rtt = sample;
+}
+
+void ConnectionStats::recordRTTSample(int sample) {
+    _currentSample.rttSamples.record(std::max(sample, 0));
+}
+
+void ConnectionStats::recordJitter(int sample) {
+    _currentSample.jitter.record(std::max(sample, 0));
+}
+
+void ConnectionStats::recordQueueingDelay(int sample) {
+    _currentSample.queueingDelay.record(std::max(sample, 0));
+}
+
+void ConnectionStats::recordRetransmitLatency(int sample) {
+    _currentSample.retransmitLatency.record(std::max(sample, 0));
+}
+
 QDebug& operator<<(QDebug&& debug, const udt::ConnectionStats::Stats& stats) {
     debug << "Connection stats:\n";
 #define HIFI_LOG_EVENT(x) << "    " #x " events: " << stats.events[ConnectionStats::Stats::Event::x] << "\n"
@@ -106,6 +128,10 @@ QDebug& operator<<(QDebug&& debug, const udt::ConnectionStats::Stats& stats) {
     debug << "\n     Duplicate packets: " << stats.duplicatePackets;
     debug << "\n     Sent util bytes: " << stats.sentUtilBytes;
     debug << "\n     Sent bytes: " << stats.sentBytes;
-    debug << "\n     Received bytes: " << stats.receivedBytes << "\n";
+    debug << "\n     Received bytes: " << stats.receivedBytes;
+    debug << "\n     RTT p50/p99: " << stats.rttSamples.getValueAtPercentile(50.0)
+        << "/" << stats.rttSamples.getValueAtPercentile(99.0) << "us";
+    debug << "\n     Jitter p50/p99: " << stats.jitter.getValueAtPercentile(50.0)
+        << "/" << stats.jitter.getValueAtPercentile(99.0) << "us\n";
     return debug;
 }
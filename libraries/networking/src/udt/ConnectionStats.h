@@ -16,6 +16,8 @@
 #include <array>
 #include <stdint.h>
 
+#include <shared/HdrHistogram.h>
+
 namespace udt {
 
 class ConnectionStats {
@@ -68,6 +70,12 @@ public:
         int rtt { 0 };
         int congestionWindowSize { 0 };
         int packetSendPeriod { 0 };
+
+        // distributions of the timings sampled during the interval, in microseconds
+        HdrHistogram rttSamples; // every RTT measured from an ACK
+        HdrHistogram jitter; // change in the gap between consecutive packets on arrival
+        HdrHistogram queueingDelay; // from the kernel receiving a datagram to it being processed
+        HdrHistogram retransmitLatency; // from a packet first being sent to it being re-sent
         
         // TODO: Remove once Win build supports brace initialization: `Events events {{ 0 }};`
         Stats() { events.fill(0); }
@@ -93,6 +101,12 @@ public:
 
     void recordCongestionWindowSize(int sample);
     void recordPacketSendPeriod(int sample);
+    void recordRTT(int sample);
+
+    void recordRTTSample(int sample);
+    void recordJitter(int sample);
+    void recordQueueingDelay(int sample);
+    void recordRetransmitLatency(int sample);
     
 private:
     Stats _currentSample;
@@ -11,6 +11,8 @@
 
 #include "LossList.h"
 
+#include <algorithm>
+
 #include "ControlPacket.h"
 
 using namespace udt;
@@ -43,13 +45,17 @@ void LossList::append(SequenceNumber start, SequenceNumber end) {
     _length += seqlen(start, end);
 }
 
+LossList::Ranges::iterator LossList::firstRangeNotBefore(SequenceNumber seq) {
+    return lower_bound(_lossList.begin(), _lossList.end(), seq, [](const Range& range, const SequenceNumber& seq) {
+        return range.second < seq;
+    });
+}
+
 void LossList::insert(SequenceNumber start, SequenceNumber end) {
     Q_ASSERT_X(start <= end,
                "LossList::insert(SequenceNumber, SequenceNumber)", "Range start greater than range end");
     
-    auto it = find_if_not(_lossList.begin(), _lossList.end(), [&start](pair<SequenceNumber, SequenceNumber> pair){
-        return pair.second < start;
-    });
+    auto it = firstRangeNotBefore(start);
     
     if (it == _lossList.end() || end < it->first) {
         // No overlap, simply insert
@@ -68,29 +74,29 @@ void LossList::insert(SequenceNumber start, SequenceNumber end) {
             it->second = end;
         }
         
-        auto it2 = it;
-        ++it2;
+        auto mergeBegin = it + 1;
+        auto mergeEnd = mergeBegin;
         // For all ranges touching the current range
-        while (it2 != _lossList.end() && it->second >= it2->first - 1) {
+        while (mergeEnd != _lossList.end() && it->second >= mergeEnd->first - 1) {
             // extend current range if necessary
-            if (it->second < it2->second) {
-                _length += seqlen(it->second + 1, it2->second);
-                it->second = it2->second;
+            if (it->second < mergeEnd->second) {
+                _length += seqlen(it->second + 1, mergeEnd->second);
+                it->second = mergeEnd->second;
             }
             
-            // Remove overlapping range
-            _length -= seqlen(it2->first, it2->second);
-            it2 = _lossList.erase(it2);
+            _length -= seqlen(mergeEnd->first, mergeEnd->second);
+            ++mergeEnd;
         }
+        
+        // Remove overlapping ranges in one pass
+        _lossList.erase(mergeBegin, mergeEnd);
     }
 }
 
 bool LossList::remove(SequenceNumber seq) {
-    auto it = find_if(_lossList.begin(), _lossList.end(), [&seq](pair<SequenceNumber, SequenceNumber> pair) {
-        return pair.first <= seq && seq <= pair.second;
-    });
+    auto it = firstRangeNotBefore(seq);
     
-    if (it != end(_lossList)) {
+    if (it != _lossList.end() && it->first <= seq) {
         if (it->first == it->second) {
             _lossList.erase(it);
         } else if (seq == it->first) {
@@ -100,7 +106,7 @@ bool LossList::remove(SequenceNumber seq) {
         } else {
             auto temp = it->second;
             it->second = seq - 1;
-            _lossList.insert(++it, make_pair(seq + 1, temp));
+            _lossList.insert(it + 1, make_pair(seq + 1, temp));
         }
         _length -= 1;
         
@@ -116,44 +122,44 @@ void LossList::remove(SequenceNumber start, SequenceNumber end) {
     Q_ASSERT_X(start <= end,
                "LossList::remove(SequenceNumber, SequenceNumber)", "Range start greater than range end");
     // Find the first segment sharing sequence numbers
-    auto it = find_if(_lossList.begin(), _lossList.end(), [&start, &end](pair<SequenceNumber, SequenceNumber> pair) {
-        return (pair.first <= start && start <= pair.second) || (start <= pair.first && pair.first <= end);
-    });
+    auto it = firstRangeNotBefore(start);
     
-    // If we found one
-    if (it != _lossList.end()) {
-        
-        // While the end of the current segment is contained, either shorten it (first one only - sometimes)
-        // or remove it altogether since it is fully contained it the range
-        while (it != _lossList.end() && end >= it->second) {
-            if (start <= it->first) {
-                // Segment is contained, update new length and erase it.
-                _length -= seqlen(it->first, it->second);
-                it = _lossList.erase(it);
-            } else {
-                // Beginning of segment not contained, modify end of segment.
-                // Will only occur sometimes one the first loop
-                _length -= seqlen(start, it->second);
-                it->second = start - 1;
-                ++it;
-            }
+    if (it == _lossList.end() || end < it->first) {
+        // No segment overlaps the range
+        return;
+    }
+    
+    // Beginning of the first segment not contained
+    if (it->first < start) {
+        if (end < it->second) {
+            // Cut it in half if the range we are removing is contained within one segment
+            _length -= seqlen(start, end);
+            auto temp = it->second;
+            it->second = start - 1;
+            _lossList.insert(it + 1, make_pair(end + 1, temp));
+            return;
         }
         
-        // There might be more to remove
-        if (it != _lossList.end() && it->first <= end) {
-            if (start <= it->first) {
-                // Truncate beginning of segment
-                _length -= seqlen(it->first, end);
-                it->first = end + 1;
-            } else {
-                // Cut it in half if the range we are removing is contained within one segment
-                _length -= seqlen(start, end);
-                auto temp = it->second;
-                it->second = start - 1;
-                _lossList.insert(++it, make_pair(end + 1, temp));
-            }
-        }
+        // Otherwise modify end of segment
+        _length -= seqlen(start, it->second);
+        it->second = start - 1;
+        ++it;
     }
+    
+    // Every following segment ending within the range is fully contained
+    auto eraseEnd = it;
+    while (eraseEnd != _lossList.end() && eraseEnd->second <= end) {
+        _length -= seqlen(eraseEnd->first, eraseEnd->second);
+        ++eraseEnd;
+    }
+    
+    // There might be one more segment straddling the end of the range, truncate its beginning
+    if (eraseEnd != _lossList.end() && eraseEnd->first <= end) {
+        _length -= seqlen(eraseEnd->first, end);
+        eraseEnd->first = end + 1;
+    }
+    
+    _lossList.erase(it, eraseEnd);
 }
 
 SequenceNumber LossList::getFirstSequenceNumber() const {
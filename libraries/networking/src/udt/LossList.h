@@ -12,7 +12,7 @@
 #ifndef hifi_LossList_h
 #define hifi_LossList_h
 
-#include <list>
+#include <deque>
 
 #include "SequenceNumber.h"
 
@@ -30,7 +30,7 @@ public:
     void append(SequenceNumber seq);
     void append(SequenceNumber start, SequenceNumber end);
     
-    // inserts anywhere - MUCH slower
+    // inserts anywhere - slower, the ranges after the insertion point have to be shifted
     void insert(SequenceNumber start, SequenceNumber end);
     
     bool remove(SequenceNumber seq);
@@ -44,7 +44,13 @@ public:
     void write(ControlPacket& packet, int maxPairs = -1);
     
 private:
-    std::list<std::pair<SequenceNumber, SequenceNumber>> _lossList;
+    using Range = std::pair<SequenceNumber, SequenceNumber>;
+    using Ranges = std::deque<Range>;
+
+    // returns the first range that does not end before seq, or end() if there is none
+    Ranges::iterator firstRangeNotBefore(SequenceNumber seq);
+
+    Ranges _lossList; // sorted, non overlapping ranges - contiguous so lookups can binary search
     int _length { 0 };
 };
     
@@ -0,0 +1,316 @@
+//
+//  NetworkConditioner.cpp
+//  libraries/networking/src/udt
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "NetworkConditioner.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QtCore/QStringList>
+
+#include <NumericalConstants.h>
+
+#include "../NetworkLogging.h"
+
+using namespace udt;
+using namespace std::chrono;
+
+const QString NetworkConditioner::ENVIRONMENT_VARIABLE = "HIFI_UDT_NETWORK_CONDITIONS";
+
+bool NetworkConditioner::Profile::matches(Direction direction, const HifiSockAddr& peer) const {
+    if ((direction == Outbound && !outbound) || (direction == Inbound && !inbound)) {
+        return false;
+    }
+
+    if (peerAddress.isNull()) {
+        return true;
+    }
+
+    return peerAddress == peer.getAddress() && (peerPort == 0 || peerPort == peer.getPort());
+}
+
+QString NetworkConditioner::Profile::toString() const {
+    QString peerString = peerAddress.isNull() ? "all peers" : peerAddress.toString();
+    if (!peerAddress.isNull() && peerPort != 0) {
+        peerString += ":" + QString::number(peerPort);
+    }
+
+    QString directionString = (outbound && inbound) ? "both ways" : (outbound ? "outbound" : "inbound");
+
+    return QString("%1 %2 - loss %3% reorder %4% (%5 ms) delay %6 ms jitter %7 ms bandwidth %8 kbps (%9 ms queue)")
+        .arg(peerString).arg(directionString).arg(loss * 100.0).arg(reorder * 100.0).arg(reorderDelay)
+        .arg(delay).arg(jitter).arg(bandwidth).arg(queue);
+}
+
+NetworkConditioner::NetworkConditioner(ReleaseHandler releaseHandler) :
+    _releaseHandler(releaseHandler)
+{
+}
+
+NetworkConditioner::~NetworkConditioner() {
+    stop();
+}
+
+bool NetworkConditioner::parse(const QString& specification, std::vector<Profile>& profiles,
+                               quint32& seed, bool& hasSeed) {
+    profiles.clear();
+    hasSeed = false;
+
+    for (const QString& profileString : specification.split(';', QString::SkipEmptyParts)) {
+        Profile profile;
+        bool hasImpairment = false;
+
+        for (const QString& pairString : profileString.split(',', QString::SkipEmptyParts)) {
+            auto pair = pairString.split('=');
+            if (pair.size() != 2) {
+                qCWarning(networking) << "Invalid network condition" << pairString.trimmed();
+                return false;
+            }
+
+            QString key = pair[0].trimmed().toLower();
+            QString value = pair[1].trimmed();
+            bool ok = true;
+
+            if (key == "seed") {
+                seed = value.toUInt(&ok);
+                hasSeed = true;
+            } else if (key == "peer") {
+                int portSeparator = value.lastIndexOf(':');
+                if (portSeparator != -1) {
+                    profile.peerPort = value.mid(portSeparator + 1).toUShort(&ok);
+                    value = value.left(portSeparator);
+                }
+                ok = ok && profile.peerAddress.setAddress(value);
+            } else if (key == "direction") {
+                profile.outbound = (value == "out" || value == "both");
+                profile.inbound = (value == "in" || value == "both");
+                ok = profile.outbound || profile.inbound;
+            } else if (key == "loss") {
+                profile.loss = value.toDouble(&ok) / 100.0;
+                hasImpairment = true;
+            } else if (key == "reorder") {
+                profile.reorder = value.toDouble(&ok) / 100.0;
+                hasImpairment = true;
+            } else if (key == "reorder_delay") {
+                profile.reorderDelay = value.toInt(&ok);
+            } else if (key == "delay") {
+                profile.delay = value.toInt(&ok);
+                hasImpairment = true;
+            } else if (key == "jitter") {
+                profile.jitter = value.toInt(&ok);
+                hasImpairment = true;
+            } else if (key == "bandwidth") {
+                profile.bandwidth = value.toInt(&ok);
+                hasImpairment = true;
+            } else if (key == "queue") {
+                profile.queue = value.toInt(&ok);
+            } else {
+                ok = false;
+            }
+
+            if (!ok || profile.loss < 0.0 || profile.loss > 1.0 || profile.reorder < 0.0 || profile.reorder > 1.0
+                || profile.reorderDelay < 0 || profile.delay < 0 || profile.jitter < 0
+                || profile.bandwidth < 0 || profile.queue < 0) {
+                qCWarning(networking) << "Invalid network condition" << pairString.trimmed();
+                return false;
+            }
+        }
+
+        // a profile that only holds the seed doesn't condition anything
+        if (hasImpairment) {
+            profiles.push_back(profile);
+        }
+    }
+
+    // profiles for a specific peer take precedence over the default ones
+    std::stable_partition(profiles.begin(), profiles.end(), [](const Profile& profile) {
+        return !profile.peerAddress.isNull();
+    });
+
+    return true;
+}
+
+bool NetworkConditioner::configure(const QString& specification) {
+    std::vector<Profile> profiles;
+    quint32 seed = 0;
+    bool hasSeed = false;
+
+    if (!parse(specification, profiles, seed, hasSeed)) {
+        return false;
+    }
+
+    if (!hasSeed) {
+        seed = std::random_device()();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _profiles = profiles;
+        _seed = seed;
+        _peerStates[Outbound].clear();
+        _peerStates[Inbound].clear();
+
+        if (!_profiles.empty() && !_thread.joinable()) {
+            _isStopping = false;
+            _thread = std::thread(&NetworkConditioner::run, this);
+        }
+    }
+
+    _isActive = !profiles.empty();
+
+    if (_isActive) {
+        qCDebug(networking) << "Conditioning network traffic with seed" << seed;
+        for (const auto& profile : profiles) {
+            qCDebug(networking).noquote() << "    " << profile.toString();
+        }
+    }
+
+    return true;
+}
+
+bool NetworkConditioner::conditionOutbound(const char* data, qint64 size, const HifiSockAddr& peer) {
+    std::unique_ptr<char[]> ownedData;
+    return condition(Outbound, ownedData, data, size, peer);
+}
+
+bool NetworkConditioner::conditionInbound(std::unique_ptr<char[]>& data, qint64 size, const HifiSockAddr& peer) {
+    return condition(Inbound, data, nullptr, size, peer);
+}
+
+NetworkConditioner::Stats NetworkConditioner::getStats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+NetworkConditioner::PeerState& NetworkConditioner::peerState(Direction direction, const HifiSockAddr& peer) {
+    auto& peerStates = _peerStates[direction];
+    auto it = peerStates.find(peer);
+
+    if (it == peerStates.end()) {
+        // derive the generator from the peer so that its decisions are the same from run to run,
+        // however the traffic to other peers is interleaved with it
+        std::seed_seq seedSequence { _seed, peer.getAddress().toIPv4Address(), (quint32)peer.getPort(), (quint32)direction };
+        it = peerStates.emplace(peer, PeerState { std::mt19937(seedSequence), Clock::time_point() }).first;
+    }
+
+    return it->second;
+}
+
+bool NetworkConditioner::condition(Direction direction, std::unique_ptr<char[]>& data, const char* unownedData,
+                                   qint64 size, const HifiSockAddr& peer) {
+    if (!_isActive) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto profile = std::find_if(_profiles.begin(), _profiles.end(), [&](const Profile& profile) {
+        return profile.matches(direction, peer);
+    });
+
+    if (profile == _profiles.end()) {
+        return false;
+    }
+
+    auto& state = peerState(direction, peer);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    ++_stats.conditioned;
+
+    if (profile->loss > 0.0 && chance(state.generator) < profile->loss) {
+        ++_stats.lost;
+        return true;
+    }
+
+    auto now = Clock::now();
+    auto departure = now;
+
+    if (profile->bandwidth > 0) {
+        state.linkFreeAt = std::max(state.linkFreeAt, now);
+
+        if (state.linkFreeAt - now > milliseconds(profile->queue)) {
+            // the queue in front of the bottleneck is full
+            ++_stats.overflowed;
+            return true;
+        }
+
+        // kbps is also bits per ms
+        state.linkFreeAt += microseconds((size * BITS_IN_BYTE * USECS_PER_MSEC) / profile->bandwidth);
+        departure = state.linkFreeAt;
+    }
+
+    auto release = departure + milliseconds(profile->delay);
+
+    if (profile->jitter > 0) {
+        std::uniform_int_distribution<int> jitter(0, profile->jitter * (int)USECS_PER_MSEC);
+        release += microseconds(jitter(state.generator));
+    }
+
+    if (profile->reorder > 0.0 && chance(state.generator) < profile->reorder) {
+        ++_stats.reordered;
+        release += milliseconds(profile->reorderDelay);
+    }
+
+    Datagram datagram { direction, nullptr, size, peer };
+    if (data) {
+        datagram.data = std::move(data);
+    } else {
+        datagram.data.reset(new char[size]);
+        memcpy(datagram.data.get(), unownedData, size);
+    }
+
+    bool isEarliest = _pendingDatagrams.empty() || release < _pendingDatagrams.begin()->first;
+    _pendingDatagrams.emplace(release, std::move(datagram));
+
+    if (isEarliest) {
+        _condition.notify_one();
+    }
+
+    return true;
+}
+
+void NetworkConditioner::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (!_isStopping) {
+        if (_pendingDatagrams.empty()) {
+            _condition.wait(lock);
+            continue;
+        }
+
+        auto next = _pendingDatagrams.begin();
+        if (Clock::now() < next->first) {
+            _condition.wait_until(lock, next->first);
+            continue;
+        }
+
+        Datagram datagram = std::move(next->second);
+        _pendingDatagrams.erase(next);
+
+        lock.unlock();
+        _releaseHandler(std::move(datagram));
+        lock.lock();
+    }
+}
+
+void NetworkConditioner::stop() {
+    _isActive = false;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopping = true;
+        _pendingDatagrams.clear();
+    }
+    _condition.notify_one();
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
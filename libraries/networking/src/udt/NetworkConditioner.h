@@ -0,0 +1,143 @@
+//
+//  NetworkConditioner.h
+//  libraries/networking/src/udt
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_NetworkConditioner_h
+#define hifi_NetworkConditioner_h
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <QtCore/QString>
+
+#include "../HifiSockAddr.h"
+
+namespace udt {
+
+// Emulates an impaired network between a Socket and the kernel, so that loss, reordering, jitter and
+// bandwidth caps can be reproduced in-process and without root privileges (unlike netem).
+//
+// It is configured with a specification made of profiles separated by ';', each a list of key=value pairs
+// separated by ',':
+//
+//     seed=42;loss=1,delay=20,jitter=5;peer=127.0.0.1:40102,direction=out,bandwidth=2000,queue=100
+//
+//   peer        host[:port] the profile applies to. A profile without a peer applies to all other peers
+//   direction   out, in or both (the default)
+//   loss        percentage of datagrams dropped
+//   reorder     percentage of datagrams held back for reorder_delay so that the ones after them overtake them
+//   reorder_delay   ms, defaults to 10
+//   delay       ms of one way delay
+//   jitter      maximum ms of random delay added on top of the one way delay
+//   bandwidth   kbps the datagrams are paced at, 0 for no cap
+//   queue       ms of datagrams that can wait for the bandwidth cap before the next one is dropped, defaults to 250
+//   seed        seed for all random decisions, random if not given. Each peer and direction gets its own
+//               generator derived from it, so that the decisions for one peer don't depend on traffic to another
+class NetworkConditioner {
+public:
+    enum Direction { Outbound, Inbound };
+
+    struct Datagram {
+        Direction direction;
+        std::unique_ptr<char[]> data;
+        qint64 size;
+        HifiSockAddr peer;
+    };
+
+    struct Profile {
+        QHostAddress peerAddress; // null for the default profile
+        quint16 peerPort { 0 }; // 0 for any port
+        bool outbound { true };
+        bool inbound { true };
+
+        double loss { 0.0 };
+        double reorder { 0.0 };
+        int reorderDelay { 10 };
+        int delay { 0 };
+        int jitter { 0 };
+        int bandwidth { 0 };
+        int queue { 250 };
+
+        bool matches(Direction direction, const HifiSockAddr& peer) const;
+        QString toString() const;
+    };
+
+    struct Stats {
+        quint64 conditioned { 0 };
+        quint64 lost { 0 };
+        quint64 overflowed { 0 };
+        quint64 reordered { 0 };
+    };
+
+    using ReleaseHandler = std::function<void(Datagram datagram)>;
+
+    static const QString ENVIRONMENT_VARIABLE;
+
+    NetworkConditioner(ReleaseHandler releaseHandler);
+    ~NetworkConditioner();
+
+    // Replaces the current profiles. An empty specification turns the conditioner off.
+    // Returns false and leaves the current profiles in place if the specification can't be parsed.
+    bool configure(const QString& specification);
+    bool isActive() const { return _isActive; }
+
+    // These return false if no profile applies and the datagram should be sent or processed as usual.
+    // Otherwise the datagram was taken, and it is either dropped or given to the release handler later
+    // (on the conditioner's thread).
+    bool conditionOutbound(const char* data, qint64 size, const HifiSockAddr& peer);
+    bool conditionInbound(std::unique_ptr<char[]>& data, qint64 size, const HifiSockAddr& peer);
+
+    Stats getStats() const;
+
+    static bool parse(const QString& specification, std::vector<Profile>& profiles, quint32& seed, bool& hasSeed);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PeerState {
+        std::mt19937 generator;
+        Clock::time_point linkFreeAt;
+    };
+
+    bool condition(Direction direction, std::unique_ptr<char[]>& data, const char* unownedData, qint64 size,
+                   const HifiSockAddr& peer);
+    PeerState& peerState(Direction direction, const HifiSockAddr& peer);
+    void run();
+    void stop();
+
+    ReleaseHandler _releaseHandler;
+
+    std::atomic<bool> _isActive { false };
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    std::thread _thread;
+    bool _isStopping { false };
+
+    std::vector<Profile> _profiles;
+    quint32 _seed { 0 };
+    std::unordered_map<HifiSockAddr, PeerState> _peerStates[2];
+    std::multimap<Clock::time_point, Datagram> _pendingDatagrams;
+    Stats _stats;
+};
+
+}
+
+#endif // hifi_NetworkConditioner_h
@@ -152,6 +152,9 @@ void Packet::writeSequenceNumber(SequenceNumber sequenceNumber) const {
 }
 
 void Packet::obfuscate(ObfuscationLevel level) {
+    // the external payload is shared, it can't be obfuscated in place - obfuscate a copy of the packet instead
+    Q_ASSERT_X(!hasExternalPayload(), "Packet::obfuscate", "Cannot obfuscate a packet with an external payload");
+
     auto obfuscationKey = KEYS[getObfuscationLevel()] ^ KEYS[level]; // Undo old and apply new one.
     if (obfuscationKey != 0) {
         xorHelper(getData() + localHeaderSize(isPartOfMessage()),
@@ -27,7 +27,9 @@ PacketVersion versionForPacketType(PacketType packetType) {
         case PacketType::StunResponse:
             return 17;
         case PacketType::DomainList:
-            return static_cast<PacketVersion>(DomainListVersion::HasConnectReason);
+            return static_cast<PacketVersion>(DomainListVersion::HasNodeTableRevisions);
+        case PacketType::DomainListRequest:
+            return static_cast<PacketVersion>(DomainListRequestVersion::HasNodeTableRevision);
         case PacketType::EntityAdd:
         case PacketType::EntityClone:
         case PacketType::EntityEdit:
@@ -136,6 +136,7 @@ public:
         BulkAvatarTraitsAck,
         StopInjector,
         AvatarZonePresence,
+        CoalescedPackets,
         NUM_PACKET_TYPE
     };
 
@@ -187,7 +188,7 @@ public:
             << PacketTypeEnum::Value::ReplicatedMicrophoneAudioWithEcho << PacketTypeEnum::Value::ReplicatedInjectAudio
             << PacketTypeEnum::Value::ReplicatedSilentAudioFrame << PacketTypeEnum::Value::ReplicatedAvatarIdentity
             << PacketTypeEnum::Value::ReplicatedKillAvatar << PacketTypeEnum::Value::ReplicatedBulkAvatarData
-            << PacketTypeEnum::Value::AvatarZonePresence;
+            << PacketTypeEnum::Value::AvatarZonePresence << PacketTypeEnum::Value::CoalescedPackets;
         return NON_SOURCED_PACKETS;
     }
 
@@ -278,6 +279,7 @@ enum class EntityVersion : PacketVersion {
     TextEntityFonts,
     ScriptServerKinematicMotion,
     ScreenshareZone,
+    BulkInitialScene,
 
     // Add new versions above here
     NUM_PACKET_TYPE,
@@ -377,7 +379,14 @@ enum class DomainListVersion : PacketVersion {
     GetMachineFingerprintFromUUIDSupport,
     AuthenticationOptional,
     HasTimestamp,
-    HasConnectReason
+    HasConnectReason,
+    HasAuthenticationMethod,
+    HasNodeTableRevisions
+};
+
+enum class DomainListRequestVersion : PacketVersion {
+    PreNodeTableRevisions = 22,
+    HasNodeTableRevision
 };
 
 enum class AudioVersion : PacketVersion {
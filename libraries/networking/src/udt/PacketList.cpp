@@ -68,7 +68,7 @@ void PacketList::endSegment() {
 size_t PacketList::getDataSize() const {
     size_t totalBytes = 0;
     for (const auto& packet : _packets) {
-        totalBytes += packet->getDataSize();
+        totalBytes += packet->getDataSize() + packet->getExternalPayloadSize();
     }
 
     if (_currentPacket) {
@@ -81,7 +81,7 @@ size_t PacketList::getDataSize() const {
 size_t PacketList::getMessageSize() const {
     size_t totalBytes = 0;
     for (const auto& packet: _packets) {
-        totalBytes += packet->getPayloadSize();
+        totalBytes += packet->getPayloadSize() + packet->getExternalPayloadSize();
     }
     
     if (_currentPacket) {
@@ -128,7 +128,7 @@ QByteArray PacketList::getMessage() const {
     size_t sizeBytes = 0;
 
     for (const auto& packet : _packets) {
-        sizeBytes += packet->size();
+        sizeBytes += packet->size() + packet->getExternalPayloadSize();
     }
 
     QByteArray data;
@@ -136,6 +136,7 @@ QByteArray PacketList::getMessage() const {
 
     for (auto& packet : _packets) {
         data.append(packet->getPayload(), packet->getPayloadSize());
+        data.append(packet->getExternalPayload(), packet->getExternalPayloadSize());
     }
 
     return data;
@@ -167,6 +168,52 @@ qint64 PacketList::writeString(const QString& string) {
     return writeData(data.constData(), data.length());
 }
 
+qint64 PacketList::writeExternal(const QByteArray& buffer) {
+    Q_ASSERT_X(_segmentStartIndex == -1, "PacketList::writeExternal", "Cannot write an external buffer inside a segment");
+
+    qint64 offset = 0;
+
+    while (offset < buffer.size()) {
+        if (!_currentPacket) {
+            _currentPacket = createPacketWithExtendedHeader();
+        }
+
+        qint64 sizeRemaining = buffer.size() - offset;
+
+        if (!_isOrdered && sizeRemaining > _currentPacket->bytesAvailableForWrite()) {
+            // an unordered PacketList can't split the buffer, it has to fit in a single packet
+            if (_currentPacket->getPayloadSize() > _extendedHeader.size()) {
+                _packets.push_back(std::move(_currentPacket));
+                continue;
+            }
+
+            qCDebug(networking) << "Error in PacketList::writeExternal - attempted to write a buffer to an unordered packet"
+                << "that is larger than the payload size.";
+            Q_ASSERT(false);
+
+            return PACKET_LIST_WRITE_ERROR;
+        }
+
+        // fill whatever room is left in the current packet with the next slice of the buffer
+        qint64 sliceSize = std::min(sizeRemaining, _currentPacket->bytesAvailableForWrite());
+
+        if (sliceSize > 0) {
+            _currentPacket->setExternalPayload(buffer, offset, sliceSize);
+            offset += sliceSize;
+        } else if (_currentPacket->getPayloadSize() <= _extendedHeader.size()) {
+            qCDebug(networking) << "Error in PacketList::writeExternal - the extended header leaves no room for the buffer.";
+            Q_ASSERT(false);
+
+            return PACKET_LIST_WRITE_ERROR;
+        }
+
+        // nothing can be written after an external payload, so this packet is done
+        _packets.push_back(std::move(_currentPacket));
+    }
+
+    return offset;
+}
+
 qint64 PacketList::writeData(const char* data, qint64 maxSize) {
     auto sizeRemaining = maxSize;
 
@@ -60,6 +60,11 @@ public:
     
     qint64 writeString(const QString& string);
 
+    // Appends the contents of buffer to the list without copying it. The buffer is split by offset across
+    // packets, which keep a reference to it until they have been sent (and acknowledged, for reliable lists).
+    // The packet holding the end of buffer is closed, so later writes start a new packet.
+    qint64 writeExternal(const QByteArray& buffer);
+
     p_high_resolution_clock::time_point getFirstPacketReceiveTime() const;
     
     
@@ -11,13 +11,14 @@
 
 #include "PacketQueue.h"
 
+#include <iterator>
+
 #include "PacketList.h"
 
 using namespace udt;
 
 PacketQueue::PacketQueue(MessageNumber messageNumber) : _currentMessageNumber(messageNumber) {
-    _channels.emplace_front(new std::list<PacketPointer>());
-    _currentChannel = _channels.begin();
+    _channels.emplace_back(new RawChannel());
 }
 
 MessageNumber PacketQueue::getNextMessageNumber() {
@@ -33,6 +34,24 @@ bool PacketQueue::isEmpty() const {
     return _channels.size() == 1 && _channels.front()->empty();
 }
 
+bool PacketQueue::isMainChannelEmpty() const {
+    LockGuard locker(_packetsLock);
+    return _channels.front()->empty();
+}
+
+PacketQueue::PacketPointer PacketQueue::takeMainChannelPacketIf(const std::function<bool(const Packet&)>& predicate) {
+    LockGuard locker(_packetsLock);
+
+    auto& channel = _channels.front();
+    if (channel->empty() || !predicate(*channel->front())) {
+        return PacketPointer();
+    }
+
+    auto packet = std::move(channel->front());
+    channel->pop_front();
+    return packet;
+}
+
 PacketQueue::PacketPointer PacketQueue::takePacket() {
     LockGuard locker(_packetsLock);
 
@@ -41,14 +60,14 @@ PacketQueue::PacketPointer PacketQueue::takePacket() {
     }
 
     // handle the case where we are looking at the first channel and it is empty
-    if (_currentChannel == _channels.begin() && (*_currentChannel)->empty()) {
+    if (_currentChannel == 0 && _channels.front()->empty()) {
         ++_currentChannel;
     }
 
     // at this point the current channel should always not be at the end and should also not be empty
-    Q_ASSERT(_currentChannel != _channels.end());
+    Q_ASSERT(_currentChannel < _channels.size());
 
-    auto& channel = *_currentChannel;
+    auto& channel = _channels[_currentChannel];
 
     Q_ASSERT(!channel->empty());
 
@@ -57,9 +76,9 @@ PacketQueue::PacketPointer PacketQueue::takePacket() {
     channel->pop_front();
 
     // Remove now empty channel (Don't remove the main channel)
-    if (channel->empty() && _currentChannel != _channels.begin()) {
-        // erase the current channel and slide the iterator to the next channel
-        _currentChannel = _channels.erase(_currentChannel);
+    if (channel->empty() && _currentChannel != 0) {
+        // erase the current channel, the next channel slides into the current index
+        _channels.erase(_channels.begin() + _currentChannel);
     } else {
         ++_currentChannel;
     }
@@ -71,9 +90,9 @@ PacketQueue::PacketPointer PacketQueue::takePacket() {
     // to respect our capped number of channels considered concurrently
     static const int MAX_CHANNELS_SENT_CONCURRENTLY = 16;
 
-    if (_currentChannel == _channels.end() || _channelsVisitedCount >= MAX_CHANNELS_SENT_CONCURRENTLY) {
+    if (_currentChannel >= _channels.size() || _channelsVisitedCount >= MAX_CHANNELS_SENT_CONCURRENTLY) {
         _channelsVisitedCount = 0;
-        _currentChannel = _channels.begin();
+        _currentChannel = 0;
     }
 
     return packet;
@@ -89,7 +108,11 @@ void PacketQueue::queuePacketList(PacketListPointer packetList) {
         packetList->preparePackets(getNextMessageNumber());
     }
 
+    // build the channel before taking the lock, the send thread only needs it for the final push
+    Channel channel { new RawChannel(std::make_move_iterator(packetList->_packets.begin()),
+                                     std::make_move_iterator(packetList->_packets.end())) };
+    packetList->_packets.clear();
+
     LockGuard locker(_packetsLock);
-    _channels.emplace_back(new std::list<PacketPointer>());
-    _channels.back()->swap(packetList->_packets);
+    _channels.push_back(std::move(channel));
 }
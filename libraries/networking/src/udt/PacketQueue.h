@@ -12,7 +12,8 @@
 #ifndef hifi_PacketQueue_h
 #define hifi_PacketQueue_h
 
-#include <list>
+#include <deque>
+#include <functional>
 #include <vector>
 #include <memory>
 #include <mutex>
@@ -30,9 +31,9 @@ class PacketQueue {
     using LockGuard = std::lock_guard<Mutex>;
     using PacketPointer = std::unique_ptr<Packet>;
     using PacketListPointer = std::unique_ptr<PacketList>;
-    using RawChannel = std::list<PacketPointer>;
+    using RawChannel = std::deque<PacketPointer>;
     using Channel = std::unique_ptr<RawChannel>;
-    using Channels = std::list<Channel>;
+    using Channels = std::vector<Channel>;
     
 public:
     PacketQueue(MessageNumber messageNumber = 0);
@@ -41,6 +42,11 @@ public:
     
     bool isEmpty() const;
     PacketPointer takePacket();
+
+    // Takes the packet at the front of the main channel (the one individual packets are queued on)
+    // if it satisfies the predicate, used to coalesce it with the packet that was just taken
+    bool isMainChannelEmpty() const;
+    PacketPointer takeMainChannelPacketIf(const std::function<bool(const Packet&)>& predicate);
     
     Mutex& getLock() { return _packetsLock; }
 
@@ -54,7 +60,7 @@ private:
     mutable Mutex _packetsLock; // Protects the packets to be sent.
     Channels _channels; // One channel per packet list + Main channel
 
-    Channels::iterator _currentChannel;
+    Channels::size_type _currentChannel { 0 }; // Index, since growing _channels invalidates iterators
     unsigned int _channelsVisitedCount { 0 };
 };
 
@@ -24,6 +24,7 @@
 #include <SharedUtil.h>
 
 #include "../NetworkLogging.h"
+#include "CoalescedPackets.h"
 #include "ControlPacket.h"
 #include "Packet.h"
 #include "PacketList.h"
@@ -138,7 +139,7 @@ void SendQueue::stop() {
     
 int SendQueue::sendPacket(const Packet& packet) {
     _lastPacketSentAt = std::chrono::high_resolution_clock::now();
-    return _socket->writeDatagram(packet.getData(), packet.getDataSize(), _destination);
+    return _socket->writeDatagram(packet, _destination);
 }
     
 void SendQueue::ack(SequenceNumber ack) {
@@ -216,18 +217,20 @@ bool SendQueue::sendNewPacketAndAddToSentList(std::unique_ptr<Packet> newPacket,
 
     // Save packet/payload size before we move it
     auto packetSize = newPacket->getWireSize();
-    auto payloadSize = newPacket->getPayloadSize();
+    auto payloadSize = newPacket->getPayloadSize() + newPacket->getExternalPayloadSize();
     
     auto bytesWritten = sendPacket(*newPacket);
+    auto sentTimePoint = p_high_resolution_clock::now();
 
-    emit packetSent(packetSize, payloadSize, sequenceNumber, p_high_resolution_clock::now());
+    emit packetSent(packetSize, payloadSize, sequenceNumber, sentTimePoint);
 
     {
         // Insert the packet we have just sent in the sent list
         QWriteLocker locker(&_sentLock);
         auto& entry = _sentPackets[newPacket->getSequenceNumber()];
-        entry.first = 0; // No resend
-        entry.second.swap(newPacket);
+        entry.numResends = 0;
+        entry.firstSentTimePoint = sentTimePoint;
+        entry.packet.swap(newPacket);
     }
     Q_ASSERT_X(!newPacket, "SendQueue::sendNewPacketAndAddToSentList()", "Overriden packet in sent list");
 
@@ -366,6 +369,9 @@ int SendQueue::maybeSendNewPacket() {
             std::unique_ptr<Packet> packet = _packets.takePacket();
             Q_ASSERT(packet);
 
+            if (_coalescingWindow > 0 && CoalescedPackets::isCoalescable(*packet)) {
+                packet = coalescePackets(std::move(packet));
+            }
 
             // attempt to send the packet
             sendNewPacketAndAddToSentList(move(packet), nextNumber);
@@ -379,6 +385,43 @@ int SendQueue::maybeSendNewPacket() {
     return 0;
 }
 
+std::unique_ptr<Packet> SendQueue::coalescePackets(std::unique_ptr<Packet> firstPacket) {
+    auto container = CoalescedPackets::createContainer();
+
+    auto canAppend = [&](const Packet& packet) {
+        return CoalescedPackets::canAppend(*container, packet);
+    };
+
+    CoalescedPackets::append(*container, *firstPacket);
+    int numCoalesced = 1;
+
+    const auto windowEnd = steady_clock::now() + microseconds(_coalescingWindow);
+
+    while (_state == State::Running) {
+        if (auto packet = _packets.takeMainChannelPacketIf(canAppend)) {
+            CoalescedPackets::append(*container, *packet);
+            ++numCoalesced;
+            continue;
+        }
+
+        std::unique_lock<std::recursive_mutex> locker(_packets.getLock());
+
+        // stop at the first packet that doesn't fit, the packets stay in order
+        // otherwise wait for more until the window closes
+        if (!_packets.isMainChannelEmpty() || steady_clock::now() >= windowEnd) {
+            break;
+        }
+
+        _emptyCondition.wait_until(locker, windowEnd);
+    }
+
+    if (numCoalesced == 1) {
+        return firstPacket;
+    }
+
+    return container;
+}
+
 bool SendQueue::maybeResendPacket() {
     
     // the following while makes sure that we find a packet to re-send, if there is one
@@ -401,14 +444,15 @@ bool SendQueue::maybeResendPacket() {
 
                 auto& entry = it->second;
                 // we found the packet - grab it
-                auto& resendPacket = *(entry.second);
-                ++entry.first; // Add 1 resend
+                auto& resendPacket = *(entry.packet);
+                ++entry.numResends;
 
-                Packet::ObfuscationLevel level = (Packet::ObfuscationLevel)(entry.first < 2 ? 0 : (entry.first - 2) % 4);
+                Packet::ObfuscationLevel level = (Packet::ObfuscationLevel)(entry.numResends < 2 ? 0 : (entry.numResends - 2) % 4);
 
                 auto wireSize = resendPacket.getWireSize();
-                auto payloadSize = resendPacket.getPayloadSize();
+                auto payloadSize = resendPacket.getPayloadSize() + resendPacket.getExternalPayloadSize();
                 auto sequenceNumber = it->first;
+                auto firstSentTimePoint = entry.firstSentTimePoint;
 
                 if (level != Packet::NoObfuscation) {
 #ifdef UDT_CONNECTION_DEBUG
@@ -444,7 +488,7 @@ bool SendQueue::maybeResendPacket() {
                 }
                 
                 emit packetRetransmitted(wireSize, payloadSize, sequenceNumber,
-                                         p_high_resolution_clock::now());
+                                         p_high_resolution_clock::now(), firstSentTimePoint);
                 
                 // Signal that we did resend a packet
                 return true;
@@ -68,6 +68,11 @@ public:
     void setPacketSendPeriod(int newPeriod) { _packetSendPeriod = newPeriod; }
     
     void setEstimatedTimeout(int estimatedTimeout) { _estimatedTimeout = estimatedTimeout; }
+
+    // Small reliable packets that are not part of a message are sent together in one datagram, the first one
+    // waits up to coalescingWindow microseconds for others to join it. 0 turns coalescing off.
+    int getCoalescingWindow() const { return _coalescingWindow; }
+    void setCoalescingWindow(int coalescingWindow) { _coalescingWindow = coalescingWindow; }
     
 public slots:
     void stop();
@@ -79,7 +84,8 @@ public slots:
 
 signals:
     void packetSent(int wireSize, int payloadSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint);
-    void packetRetransmitted(int wireSize, int payloadSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint);
+    void packetRetransmitted(int wireSize, int payloadSize, SequenceNumber seqNum, p_high_resolution_clock::time_point timePoint,
+                             p_high_resolution_clock::time_point firstSentTimePoint);
     
     void queueInactive();
 
@@ -100,6 +106,7 @@ private:
     bool sendNewPacketAndAddToSentList(std::unique_ptr<Packet> newPacket, SequenceNumber sequenceNumber);
     
     int maybeSendNewPacket(); // Figures out what packet to send next
+    std::unique_ptr<Packet> coalescePackets(std::unique_ptr<Packet> firstPacket);
     bool maybeResendPacket(); // Determines whether to resend a packet and which one
     
     bool isInactive(bool attemptedToSendPacket);
@@ -126,13 +133,19 @@ private:
     std::atomic<int> _estimatedTimeout { 0 }; // Estimated timeout, set from CC
     
     std::atomic<int> _flowWindowSize { 0 }; // Flow control window size (number of packets that can be on wire) - set from CC
+
+    std::atomic<int> _coalescingWindow { 0 }; // Time small packets wait for others to be coalesced with, in microseconds
     
     mutable std::mutex _naksLock; // Protects the naks list.
     LossList _naks; // Sequence numbers of packets to resend
     
     mutable QReadWriteLock _sentLock; // Protects the sent packet list
-    using PacketResendPair = std::pair<uint8_t, std::unique_ptr<Packet>>; // Number of resend + packet ptr
-    std::unordered_map<SequenceNumber, PacketResendPair> _sentPackets; // Packets waiting for ACK.
+    struct SentPacket {
+        uint8_t numResends { 0 };
+        p_high_resolution_clock::time_point firstSentTimePoint;
+        std::unique_ptr<Packet> packet;
+    };
+    std::unordered_map<SequenceNumber, SentPacket> _sentPackets; // Packets waiting for ACK.
     
     std::mutex _handshakeMutex; // Protects the handshake ACK condition_variable
     std::atomic<bool> _hasReceivedHandshakeACK { false }; // flag for receipt of handshake ACK from client
@@ -15,12 +15,16 @@
 #include <sys/socket.h>
 #endif
 
+#include <algorithm>
+
+#include <QtCore/QProcessEnvironment>
 #include <QtCore/QThread>
 
 #include <shared/QtHelpers.h>
 #include <LogHandler.h>
 
 #include "../NetworkLogging.h"
+#include "CoalescedPackets.h"
 #include "Connection.h"
 #include "ControlPacket.h"
 #include "Packet.h"
@@ -36,6 +40,15 @@ using namespace udt;
 #include <WS2tcpip.h>
 #else
 #include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+#include <errno.h>
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#include <time.h>
 #endif
 
 
@@ -56,6 +69,19 @@ Socket::Socket(QObject* parent, bool shouldChangeSocketOptions) :
     const int READY_READ_BACKUP_CHECK_MSECS = 2 * 1000;
     connect(_readyReadBackupTimer, &QTimer::timeout, this, &Socket::checkForReadyReadBackup);
     _readyReadBackupTimer->start(READY_READ_BACKUP_CHECK_MSECS);
+
+    auto environment = QProcessEnvironment::systemEnvironment();
+    if (environment.contains(NetworkConditioner::ENVIRONMENT_VARIABLE)) {
+        _networkConditioner.configure(environment.value(NetworkConditioner::ENVIRONMENT_VARIABLE));
+    }
+
+    static const QString COALESCING_WINDOW_ENVIRONMENT_VARIABLE = "HIFI_UDT_COALESCING_WINDOW_USECS";
+    if (environment.contains(COALESCING_WINDOW_ENVIRONMENT_VARIABLE)) {
+        _coalescingWindow = std::max(0, environment.value(COALESCING_WINDOW_ENVIRONMENT_VARIABLE).toInt());
+    }
+
+    static const QString KERNEL_RECEIVE_TIMESTAMPS_ENVIRONMENT_VARIABLE = "HIFI_UDT_KERNEL_RECEIVE_TIMESTAMPS";
+    _useKernelTimestamps = environment.value(KERNEL_RECEIVE_TIMESTAMPS_ENVIRONMENT_VARIABLE).toInt() != 0;
 }
 
 void Socket::bind(const QHostAddress& address, quint16 port) {
@@ -77,6 +103,10 @@ void Socket::bind(const QHostAddress& address, quint16 port) {
             qCWarning(networking) << "Socket::bind Cannot setsockopt IP_DONTFRAGMENT" << wsaErr;
         }
 #endif
+
+        if (_useKernelTimestamps) {
+            enableKernelTimestamps();
+        }
     }
 }
 
@@ -89,6 +119,61 @@ void Socket::rebind(quint16 localPort) {
     bind(QHostAddress::AnyIPv4, localPort);
 }
 
+void Socket::setKernelReceiveTimestamps(bool useKernelTimestamps) {
+    _useKernelTimestamps = useKernelTimestamps;
+    if (!useKernelTimestamps) {
+        _hasKernelTimestamps = false;
+    } else if (_udpSocket.state() == QAbstractSocket::BoundState) {
+        enableKernelTimestamps();
+    }
+}
+
+void Socket::enableKernelTimestamps() {
+    _hasKernelTimestamps = false;
+
+#if defined(Q_OS_LINUX)
+    // have the kernel stamp datagrams as they come off the wire, so that their receive time doesn't include
+    // however long they waited in the socket buffer and for the event loop to get to them.
+    // QUdpSocket drops the control messages SO_TIMESTAMPNS would deliver the stamps in (and with it set the kernel
+    // stops keeping them on the socket), so the stamps are read back with SIOCGSTAMPNS instead - the first call
+    // turns stamping on, and fails with ENOENT since nothing was received yet
+    timespec stamp;
+    if (ioctl(_udpSocket.socketDescriptor(), SIOCGSTAMPNS, &stamp) == 0 || errno == ENOENT) {
+        _hasKernelTimestamps = true;
+    } else {
+        qCDebug(networking) << "Socket::bind Cannot ioctl SIOCGSTAMPNS" << errno;
+    }
+#endif
+}
+
+p_high_resolution_clock::time_point Socket::kernelReceiveTime(p_high_resolution_clock::time_point readTime) {
+#if defined(Q_OS_LINUX)
+    // the kernel keeps the stamp of the last datagram read from the socket
+    timespec stamp;
+    if (ioctl(_udpSocket.socketDescriptor(), SIOCGSTAMPNS, &stamp) != 0) {
+        if (errno != ENOENT) {
+            qCDebug(networking) << "Socket::kernelReceiveTime Cannot ioctl SIOCGSTAMPNS" << errno;
+            _hasKernelTimestamps = false;
+        }
+        return readTime;
+    }
+
+    // the stamp is on the realtime clock, only the time since it was taken carries over to ours
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    auto queueingTime = std::chrono::seconds(now.tv_sec - stamp.tv_sec) + std::chrono::nanoseconds(now.tv_nsec - stamp.tv_nsec);
+    if (queueingTime.count() < 0) {
+        // the realtime clock was stepped back
+        return readTime;
+    }
+
+    return readTime - std::chrono::duration_cast<p_high_resolution_clock::duration>(queueingTime);
+#else
+    return readTime;
+#endif
+}
+
 void Socket::setSystemBufferSizes() {
     for (int i = 0; i < 2; i++) {
         QAbstractSocket::SocketOption bufferOpt;
@@ -130,7 +215,7 @@ qint64 Socket::writeBasePacket(const udt::BasePacket& packet, const HifiSockAddr
     Q_ASSERT_X(!dynamic_cast<const Packet*>(&packet),
                "Socket::writeBasePacket", "Cannot send a Packet/NLPacket via writeBasePacket");
 
-    return writeDatagram(packet.getData(), packet.getDataSize(), sockAddr);
+    return writeDatagram(packet, sockAddr);
 }
 
 qint64 Socket::writePacket(const Packet& packet, const HifiSockAddr& sockAddr) {
@@ -145,13 +230,13 @@ qint64 Socket::writePacket(const Packet& packet, const HifiSockAddr& sockAddr) {
     auto connection = findOrCreateConnection(sockAddr, true);
     if (connection) {
         connection->recordSentUnreliablePackets(packet.getWireSize(),
-                                                packet.getPayloadSize());
+                                                packet.getPayloadSize() + packet.getExternalPayloadSize());
     }
 
     // write the correct sequence number to the Packet here
     packet.writeSequenceNumber(sequenceNumber);
 
-    return writeDatagram(packet.getData(), packet.getDataSize(), sockAddr);
+    return writeDatagram(packet, sockAddr);
 }
 
 qint64 Socket::writePacket(std::unique_ptr<Packet> packet, const HifiSockAddr& sockAddr) {
@@ -235,6 +320,15 @@ qint64 Socket::writeDatagram(const char* data, qint64 size, const HifiSockAddr&
 }
 
 qint64 Socket::writeDatagram(const QByteArray& datagram, const HifiSockAddr& sockAddr) {
+    if (_networkConditioner.conditionOutbound(datagram.constData(), datagram.size(), sockAddr)) {
+        // the conditioner either dropped it or will write it later, as far as the caller knows it was sent
+        return datagram.size();
+    }
+
+    return writeDatagramToSocket(datagram, sockAddr);
+}
+
+qint64 Socket::writeDatagramToSocket(const QByteArray& datagram, const HifiSockAddr& sockAddr) {
 
     // don't attempt to write the datagram if we're unbound.  Just drop it.
     // _udpSocket.writeDatagram will return an error anyway, but there are
@@ -270,6 +364,62 @@ qint64 Socket::writeDatagram(const QByteArray& datagram, const HifiSockAddr& soc
     return bytesWritten;
 }
 
+qint64 Socket::writeDatagram(const BasePacket& packet, const HifiSockAddr& sockAddr) {
+    if (!packet.hasExternalPayload()) {
+        return writeDatagram(packet.getData(), packet.getDataSize(), sockAddr);
+    }
+
+    if (!_networkConditioner.isActive() && _udpSocket.state() == QAbstractSocket::BoundState
+        && sockAddr.getAddress().protocol() == QAbstractSocket::IPv4Protocol) {
+        sockaddr_in destination;
+        memset(&destination, 0, sizeof(destination));
+        destination.sin_family = AF_INET;
+        destination.sin_port = htons(sockAddr.getPort());
+        destination.sin_addr.s_addr = htonl(sockAddr.getAddress().toIPv4Address());
+
+        // hand the header and the external payload to the kernel as two buffers of the same datagram
+#ifdef WIN32
+        WSABUF buffers[2];
+        buffers[0].buf = const_cast<char*>(packet.getData());
+        buffers[0].len = (ULONG)packet.getDataSize();
+        buffers[1].buf = const_cast<char*>(packet.getExternalPayload());
+        buffers[1].len = (ULONG)packet.getExternalPayloadSize();
+
+        DWORD bytesWritten = 0;
+        if (WSASendTo(_udpSocket.socketDescriptor(), buffers, 2, &bytesWritten, 0,
+                      reinterpret_cast<const sockaddr*>(&destination), sizeof(destination), nullptr, nullptr) == 0) {
+            return bytesWritten;
+        }
+#else
+        iovec buffers[2];
+        buffers[0].iov_base = const_cast<char*>(packet.getData());
+        buffers[0].iov_len = packet.getDataSize();
+        buffers[1].iov_base = const_cast<char*>(packet.getExternalPayload());
+        buffers[1].iov_len = packet.getExternalPayloadSize();
+
+        msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_name = &destination;
+        message.msg_namelen = sizeof(destination);
+        message.msg_iov = buffers;
+        message.msg_iovlen = 2;
+
+        auto bytesWritten = sendmsg(_udpSocket.socketDescriptor(), &message, 0);
+        if (bytesWritten >= 0) {
+            return bytesWritten;
+        }
+#endif
+    }
+
+    // we couldn't write it directly - join the two parts so that the datagram goes through QUdpSocket,
+    // which also takes care of reporting the error if it fails again (and of conditioning it)
+    QByteArray datagram;
+    datagram.reserve((int)(packet.getDataSize() + packet.getExternalPayloadSize()));
+    datagram.append(packet.getData(), (int)packet.getDataSize());
+    datagram.append(packet.getExternalPayload(), (int)packet.getExternalPayloadSize());
+    return writeDatagram(datagram, sockAddr);
+}
+
 Connection* Socket::findOrCreateConnection(const HifiSockAddr& sockAddr, bool filterCreate) {
     Lock connectionsLock(_connectionsHashMutex);
     auto it = _connectionsHash.find(sockAddr);
@@ -288,6 +438,7 @@ Connection* Socket::findOrCreateConnection(const HifiSockAddr& sockAddr, bool fi
             auto congestionControl = _ccFactory->create();
             congestionControl->setMaxBandwidth(_maxBandwidth);
             auto connection = std::unique_ptr<Connection>(new Connection(this, sockAddr, std::move(congestionControl)));
+            connection->setCoalescingWindow(_coalescingWindow);
             if (QThread::currentThread() != thread()) {
                 qCDebug(networking) << "Moving new Connection to NodeList thread";
                 connection->moveToThread(thread());
@@ -410,78 +561,136 @@ void Socket::readPendingDatagrams() {
             continue;
         }
 
-        auto it = _unfilteredHandlers.find(senderSockAddr);
-
-        if (it != _unfilteredHandlers.end()) {
-            // we have a registered unfiltered handler for this HifiSockAddr - call that and return
-            if (it->second) {
-                auto basePacket = BasePacket::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
-                basePacket->setReceiveTime(receiveTime);
-                it->second(std::move(basePacket));
-            }
+        if (_hasKernelTimestamps) {
+            receiveTime = kernelReceiveTime(p_high_resolution_clock::now());
+        }
 
+        if (_networkConditioner.conditionInbound(buffer, packetSizeWithHeader, senderSockAddr)) {
+            // the conditioner either dropped it or will hand it back to processConditionedDatagrams later
             continue;
         }
 
-        // check if this was a control packet or a data packet
-        bool isControlPacket = *reinterpret_cast<uint32_t*>(buffer.get()) & CONTROL_BIT_MASK;
+        processDatagram(std::move(buffer), packetSizeWithHeader, senderSockAddr, receiveTime);
+    }
+}
 
-        if (isControlPacket) {
-            // setup a control packet from the data we just read
-            auto controlPacket = ControlPacket::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
-            controlPacket->setReceiveTime(receiveTime);
+void Socket::processConditionedDatagrams() {
+    std::vector<NetworkConditioner::Datagram> datagrams;
+    {
+        Lock lock(_conditionedDatagramsMutex);
+        datagrams.swap(_conditionedDatagrams);
+    }
 
-            // move this control packet to the matching connection, if there is one
-            auto connection = findOrCreateConnection(senderSockAddr, true);
+    for (auto& datagram : datagrams) {
+        processDatagram(std::move(datagram.data), (int)datagram.size, datagram.peer, p_high_resolution_clock::now());
+    }
+}
 
-            if (connection) {
-                connection->processControl(move(controlPacket));
-            }
+void Socket::releaseConditionedDatagram(NetworkConditioner::Datagram datagram) {
+    if (datagram.direction == NetworkConditioner::Outbound) {
+        writeDatagramToSocket(QByteArray::fromRawData(datagram.data.get(), (int)datagram.size), datagram.peer);
+    } else {
+        // received datagrams have to be processed on the socket's thread
+        {
+            Lock lock(_conditionedDatagramsMutex);
+            _conditionedDatagrams.push_back(std::move(datagram));
+        }
+        QMetaObject::invokeMethod(this, "processConditionedDatagrams", Qt::QueuedConnection);
+    }
+}
 
-        } else {
-            // setup a Packet from the data we just read
-            auto packet = Packet::fromReceivedPacket(std::move(buffer), packetSizeWithHeader, senderSockAddr);
-            packet->setReceiveTime(receiveTime);
+void Socket::processDatagram(std::unique_ptr<char[]> buffer, int size, const HifiSockAddr& senderSockAddr,
+                             p_high_resolution_clock::time_point receiveTime) {
+    auto it = _unfilteredHandlers.find(senderSockAddr);
+
+    if (it != _unfilteredHandlers.end()) {
+        // we have a registered unfiltered handler for this HifiSockAddr - call that and return
+        if (it->second) {
+            auto basePacket = BasePacket::fromReceivedPacket(std::move(buffer), size, senderSockAddr);
+            basePacket->setReceiveTime(receiveTime);
+            it->second(std::move(basePacket));
+        }
+
+        return;
+    }
 
-            // save the sequence number in case this is the packet that sticks readyRead
-            _lastReceivedSequenceNumber = packet->getSequenceNumber();
+    // check if this was a control packet or a data packet
+    bool isControlPacket = *reinterpret_cast<uint32_t*>(buffer.get()) & CONTROL_BIT_MASK;
 
-            // call our verification operator to see if this packet is verified
-            if (!_packetFilterOperator || _packetFilterOperator(*packet)) {
-                auto connection = findOrCreateConnection(senderSockAddr, true);
+    if (isControlPacket) {
+        // setup a control packet from the data we just read
+        auto controlPacket = ControlPacket::fromReceivedPacket(std::move(buffer), size, senderSockAddr);
+        controlPacket->setReceiveTime(receiveTime);
 
-                if (packet->isReliable()) {
-                    // if this was a reliable packet then signal the matching connection with the sequence number
+        // move this control packet to the matching connection, if there is one
+        auto connection = findOrCreateConnection(senderSockAddr, true);
 
-                    if (!connection || !connection->processReceivedSequenceNumber(packet->getSequenceNumber(),
-                                                                                  packet->getDataSize(),
-                                                                                  packet->getPayloadSize())) {
-                        // the connection could not be created or indicated that we should not continue processing this packet
+        if (connection) {
+            connection->processControl(move(controlPacket));
+        }
+
+    } else {
+        // setup a Packet from the data we just read
+        auto packet = Packet::fromReceivedPacket(std::move(buffer), size, senderSockAddr);
+        packet->setReceiveTime(receiveTime);
+
+        // save the sequence number in case this is the packet that sticks readyRead
+        _lastReceivedSequenceNumber = packet->getSequenceNumber();
+
+        // call our verification operator to see if this packet is verified
+        if (!_packetFilterOperator || _packetFilterOperator(*packet)) {
+            auto connection = findOrCreateConnection(senderSockAddr, true);
+
+            if (packet->isReliable()) {
+                // if this was a reliable packet then signal the matching connection with the sequence number
+
+                if (!connection || !connection->processReceivedSequenceNumber(packet->getSequenceNumber(),
+                                                                              packet->getDataSize(),
+                                                                              packet->getPayloadSize(),
+                                                                              receiveTime)) {
+                    // the connection could not be created or indicated that we should not continue processing this packet
 #ifdef UDT_CONNECTION_DEBUG
-                        qCDebug(networking) << "Can't process packet: version" << (unsigned int)NLPacket::versionInHeader(*packet)
-                            << ", type" << NLPacket::typeInHeader(*packet);
+                    qCDebug(networking) << "Can't process packet: version" << (unsigned int)NLPacket::versionInHeader(*packet)
+                        << ", type" << NLPacket::typeInHeader(*packet);
 #endif
-                        continue;
-                    }
-                } else if (connection) {
-                    connection->recordReceivedUnreliablePackets(packet->getWireSize(),
-                                                                packet->getPayloadSize());
+                    return;
                 }
+            } else if (connection) {
+                connection->recordReceivedUnreliablePackets(packet->getWireSize(),
+                                                            packet->getPayloadSize(),
+                                                            receiveTime);
+            }
 
-                if (packet->isPartOfMessage()) {
-                    auto connection = findOrCreateConnection(senderSockAddr, true);
-                    if (connection) {
-                        connection->queueReceivedMessagePacket(std::move(packet));
-                    }
-                } else if (_packetHandler) {
-                    // call the verified packet callback to let it handle this packet
-                    _packetHandler(std::move(packet));
+            if (packet->isPartOfMessage()) {
+                auto connection = findOrCreateConnection(senderSockAddr, true);
+                if (connection) {
+                    connection->queueReceivedMessagePacket(std::move(packet));
                 }
+            } else if (NLPacket::typeInHeader(*packet) == PacketType::CoalescedPackets) {
+                processCoalescedPackets(std::move(packet));
+            } else if (_packetHandler) {
+                // call the verified packet callback to let it handle this packet
+                _packetHandler(std::move(packet));
             }
         }
     }
 }
 
+void Socket::processCoalescedPackets(std::unique_ptr<Packet> container) {
+    // the container was sequenced as a whole, but the packets in it still have to be verified one by one
+    std::vector<std::unique_ptr<Packet>> packets;
+    if (!CoalescedPackets::unpack(*container, packets)) {
+        qCDebug(networking) << "Dropping malformed coalesced packets from" << container->getSenderSockAddr();
+        return;
+    }
+
+    for (auto& packet : packets) {
+        if (_packetHandler && (!_packetFilterOperator || _packetFilterOperator(*packet))) {
+            _packetHandler(std::move(packet));
+        }
+    }
+}
+
 void Socket::connectToSendSignal(const HifiSockAddr& destinationAddr, QObject* receiver, const char* slot) {
     Lock connectionsLock(_connectionsHashMutex);
     auto it = _connectionsHash.find(destinationAddr);
@@ -507,6 +716,17 @@ void Socket::setConnectionMaxBandwidth(int maxBandwidth) {
     }
 }
 
+void Socket::setConnectionCoalescingWindow(int coalescingWindow) {
+    qInfo() << "Setting socket's coalescing window to" << coalescingWindow << "usecs. ("
+            << _connectionsHash.size() << "live connections)";
+    _coalescingWindow = coalescingWindow;
+    Lock connectionsLock(_connectionsHashMutex);
+    for (auto& pair : _connectionsHash) {
+        auto& connection = pair.second;
+        connection->setCoalescingWindow(_coalescingWindow);
+    }
+}
+
 ConnectionStats::Stats Socket::sampleStatsForConnection(const HifiSockAddr& destination) {
     auto it = _connectionsHash.find(destination);
     if (it != _connectionsHash.end()) {
@@ -26,6 +26,7 @@
 #include "../HifiSockAddr.h"
 #include "TCPVegasCC.h"
 #include "Connection.h"
+#include "NetworkConditioner.h"
 
 //#define UDT_CONNECTION_DEBUG
 
@@ -66,6 +67,8 @@ public:
     qint64 writePacketList(std::unique_ptr<PacketList> packetList, const HifiSockAddr& sockAddr);
     qint64 writeDatagram(const char* data, qint64 size, const HifiSockAddr& sockAddr);
     qint64 writeDatagram(const QByteArray& datagram, const HifiSockAddr& sockAddr);
+    // Writes the packet and its external payload, if it has one, as a single datagram without joining them
+    qint64 writeDatagram(const BasePacket& packet, const HifiSockAddr& sockAddr);
     
     void bind(const QHostAddress& address, quint16 port = 0);
     void rebind(quint16 port);
@@ -84,6 +87,19 @@ public:
     void setCongestionControlFactory(std::unique_ptr<CongestionControlVirtualFactory> ccFactory);
     void setConnectionMaxBandwidth(int maxBandwidth);
 
+    // see SendQueue::setCoalescingWindow, applies to all current and future connections
+    void setConnectionCoalescingWindow(int coalescingWindow);
+
+    // Stamps received datagrams with the time the kernel received them, rather than the time they were read, so that
+    // the queueing delay includes the time they waited in the socket buffer. It costs a system call per datagram, so
+    // it is off unless set here or through the HIFI_UDT_KERNEL_RECEIVE_TIMESTAMPS environment variable.
+    void setKernelReceiveTimestamps(bool useKernelTimestamps);
+
+    // Emulates loss, reordering, jitter and bandwidth caps on this socket, see NetworkConditioner for the format.
+    // Sockets start with the conditions in the HIFI_UDT_NETWORK_CONDITIONS environment variable.
+    bool setNetworkConditions(const QString& specification) { return _networkConditioner.configure(specification); }
+    NetworkConditioner::Stats getNetworkConditionerStats() const { return _networkConditioner.getStats(); }
+
     void messageReceived(std::unique_ptr<Packet> packet);
     void messageFailed(Connection* connection, Packet::MessageNumber messageNumber);
     
@@ -103,6 +119,7 @@ public slots:
 
 private slots:
     void readPendingDatagrams();
+    void processConditionedDatagrams();
     void checkForReadyReadBackup();
 
     void handleSocketError(QAbstractSocket::SocketError socketError);
@@ -110,6 +127,13 @@ private slots:
 
 private:
     void setSystemBufferSizes();
+    void enableKernelTimestamps();
+    p_high_resolution_clock::time_point kernelReceiveTime(p_high_resolution_clock::time_point readTime);
+    qint64 writeDatagramToSocket(const QByteArray& datagram, const HifiSockAddr& sockAddr);
+    void processDatagram(std::unique_ptr<char[]> buffer, int size, const HifiSockAddr& senderSockAddr,
+                         p_high_resolution_clock::time_point receiveTime);
+    void processCoalescedPackets(std::unique_ptr<Packet> container);
+    void releaseConditionedDatagram(NetworkConditioner::Datagram datagram);
     Connection* findOrCreateConnection(const HifiSockAddr& sockAddr, bool filterCreation = false);
    
     // privatized methods used by UDTTest - they are private since they must be called on the Socket thread
@@ -138,6 +162,9 @@ private:
     QTimer* _readyReadBackupTimer { nullptr };
 
     int _maxBandwidth { -1 };
+    int _coalescingWindow { 0 };
+    bool _useKernelTimestamps { false };
+    bool _hasKernelTimestamps { false };
 
     std::unique_ptr<CongestionControlVirtualFactory> _ccFactory { new CongestionControlFactory<TCPVegasCC>() };
 
@@ -146,6 +173,14 @@ private:
     int _lastPacketSizeRead { 0 };
     SequenceNumber _lastReceivedSequenceNumber;
     HifiSockAddr _lastPacketSockAddr;
+
+    Mutex _conditionedDatagramsMutex;
+    std::vector<NetworkConditioner::Datagram> _conditionedDatagrams;
+
+    // last, so that its thread stops releasing datagrams before the rest of the socket goes away
+    NetworkConditioner _networkConditioner { [this](NetworkConditioner::Datagram datagram) {
+        releaseConditionedDatagram(std::move(datagram));
+    } };
     
     friend UDTTest;
 };
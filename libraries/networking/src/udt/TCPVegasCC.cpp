@@ -44,6 +44,8 @@ bool TCPVegasCC::calculateRTT(p_high_resolution_clock::time_point sendTime, p_hi
         lastRTT = MAX_RTT_SAMPLE_MICROSECONDS;
     }
 
+    _lastRTTSample = lastRTT;
+
     if (_ewmaRTT == -1) {
         // first RTT sample - set _ewmaRTT to the value and set the variance to half the value
         _ewmaRTT = lastRTT;
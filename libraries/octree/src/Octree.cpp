@@ -52,7 +52,7 @@
 #include "OctreeUtils.h"
 #include "OctreeEntitiesFileParser.h"
 
-QVector<QString> PERSIST_EXTENSIONS = {"json", "json.gz"};
+QVector<QString> PERSIST_EXTENSIONS = {"json", "json.gz", "bin"};
 
 Octree::Octree(bool shouldReaverage) :
     _rootElement(NULL),
@@ -676,6 +676,10 @@ bool Octree::readFromFile(const char* fileName) {
         return readJSONFromGzippedFile(qFileName);
     }
 
+    if (qFileName.endsWith(".bin")) {
+        return readFromBinaryFile(qFileName);
+    }
+
     QFile file(qFileName);
 
     if (!file.open(QIODevice::ReadOnly)) {
@@ -865,6 +869,8 @@ bool Octree::writeToFile(const char* fileName, const OctreeElementPointer& eleme
         success = writeToJSONFile(cFileName, element);
     } else if (persistAsFileType == "json.gz") {
         success = writeToJSONFile(cFileName, element, true);
+    } else if (persistAsFileType == "bin") {
+        success = writeToBinaryFile(qFileName, element);
     } else {
         qCDebug(octree) << "unable to write octree to file of type" << persistAsFileType;
     }
@@ -54,6 +54,15 @@ using RecurseOctreeSortingOperation = std::function<float(const OctreeElementPoi
 using SortedChild = std::pair<float, OctreeElementPointer>;
 typedef QHash<uint, AACube> CubeList;
 
+// An edit decoded ahead of being applied, see Octree::decodeEditPacketData().
+class OctreeDecodedEdit {
+public:
+    virtual ~OctreeDecodedEdit() {}
+
+    int processedBytes { 0 };
+};
+using OctreeDecodedEditPointer = std::unique_ptr<OctreeDecodedEdit>;
+
 const bool NO_EXISTS_BITS         = false;
 const bool WANT_EXISTS_BITS       = true;
 
@@ -138,6 +147,22 @@ public:
     virtual bool handlesEditPacketType(PacketType packetType) const { return false; }
     virtual int processEditPacketData(ReceivedMessage& message, const unsigned char* editData, int maxLength,
                                       const SharedNodePointer& sourceNode) { return 0; }
+
+    // Decodes and validates an edit without the lock of the tree, so that the edits of a batch can be decoded on
+    // several threads at once. Returns nullptr if the tree doesn't decode edits of that type ahead, those are processed
+    // by processEditPacketData() instead.
+    virtual OctreeDecodedEditPointer decodeEditPacketData(ReceivedMessage& message, const unsigned char* editData,
+                                                          int maxLength, const SharedNodePointer& sourceNode) { return nullptr; }
+    // Applies a decoded edit, in the order the edits came in. The InPlace version applies it if it doesn't change the
+    // structure of the tree, with only the read lock of the tree held so that it doesn't wait for the traversals, nor
+    // they for it: the elements and items it changes are locked on their own. It returns false, having changed nothing
+    // in the tree, if the same edit has to be passed to processDecodedEdit() with the write lock held instead.
+    virtual bool processDecodedEditInPlace(OctreeDecodedEdit& edit, const SharedNodePointer& sourceNode) { return false; }
+    virtual void processDecodedEdit(OctreeDecodedEdit& edit, const SharedNodePointer& sourceNode) { }
+    // The edits processed with the write lock held between these may leave the restructuring of the tree they cause to
+    // endEditBatch(), which does it in one pass. The write lock has to be held for the whole batch.
+    virtual void beginEditBatch() { }
+    virtual void endEditBatch() { }
     virtual void processChallengeOwnershipRequestPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
     virtual void processChallengeOwnershipReplyPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
     virtual void processChallengeOwnershipPacket(ReceivedMessage& message, const SharedNodePointer& sourceNode) { return; }
@@ -214,6 +239,14 @@ public:
                             bool skipThoseWithBadParents) = 0;
     virtual bool writeToJSON(QString& jsonString, const OctreeElementPointer& element) = 0;
 
+    // binary snapshots, which the trees that can be persisted in them implement
+    virtual bool writeToBinaryFile(const QString& fileName, const OctreeElementPointer& element) { return false; }
+    virtual bool readFromBinaryFile(const QString& fileName) { return false; }
+    virtual bool readBinaryFileInfo(const QString& fileName, QUuid& id, int64_t& dataVersion) const { return false; }
+    // appends the changes made since the last binary snapshot was read or written to its journal, false if they have to
+    // be persisted by writing a new snapshot
+    virtual bool writeToBinaryJournal(qint64& journalSize) { return false; }
+
     // Octree importers
     bool readFromFile(const char* filename);
     bool readFromURL(const QString& url, const bool isObservable = true, const qint64 callerId = -1); // will support file urls as well...
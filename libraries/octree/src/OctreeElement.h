@@ -224,8 +224,9 @@ protected:
       unsigned char* pointer;
     } _octalCode;
 
-    quint64 _lastChanged; /// Client and server, timestamp this node was last changed, 8 bytes
-    uint64_t _lastChangedContent { 0 };
+    // edits that don't change the structure of the tree mark elements changed while they are traversed
+    std::atomic<quint64> _lastChanged; /// Client and server, timestamp this node was last changed, 8 bytes
+    std::atomic<uint64_t> _lastChangedContent { 0 };
 
     /// Client and server, pointers to child nodes, various encodings
 #ifdef SIMPLE_CHILD_ARRAY
@@ -626,6 +626,12 @@ void OctreePacketData::loadFinalizedContent(const unsigned char* data, int lengt
     if (data && length > 0) {
 
         if (_enableCompression) {
+            // the sections of a message sent reliably can be larger than a packet
+            if (length > _compressedByteArray.size()) {
+                _compressedByteArray.resize(length);
+                _compressed = (unsigned char*)_compressedByteArray.data();
+            }
+
             _compressedBytes = length;
             memcpy(_compressed, data, _compressedBytes);
 
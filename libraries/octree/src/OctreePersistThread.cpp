@@ -23,6 +23,7 @@
 #include <QDir>
 #include <QDirIterator>
 #include <QFile>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -39,6 +40,7 @@
 
 constexpr std::chrono::seconds OctreePersistThread::DEFAULT_PERSIST_INTERVAL { 30 };
 constexpr std::chrono::milliseconds TIME_BETWEEN_PROCESSING { 10 };
+constexpr std::chrono::seconds TIME_BETWEEN_JOURNAL_WRITES { 1 };
 
 constexpr int MAX_OCTREE_REPLACEMENT_BACKUP_FILES_COUNT { 20 };
 constexpr int64_t MAX_OCTREE_REPLACEMENT_BACKUP_FILES_SIZE_BYTES { 50 * 1000 * 1000 };
@@ -49,6 +51,7 @@ OctreePersistThread::OctreePersistThread(OctreePointer tree, const QString& file
     _filename(filename),
     _persistInterval(persistInterval),
     _lastPersistCheck(std::chrono::steady_clock::now()),
+    _lastJournalWrite(_lastPersistCheck),
     _initialLoadComplete(false),
     _loadTimeUSecs(0),
     _debugTimestampNow(debugTimestampNow),
@@ -74,7 +77,19 @@ void OctreePersistThread::start() {
     OctreeUtils::RawOctreeData data;
     qCDebug(octree) << "Reading octree data from" << _filename;
     QFile file(_filename);
-    if (file.open(QIODevice::ReadOnly)) {
+    if (_persistAsFileType == "bin") {
+        // only the header of a binary snapshot is read here, the entities are read from the file itself once loading
+        if (_tree->readBinaryFileInfo(_filename, data.id, data.dataVersion)) {
+            qCDebug(octree) << "Current octree data: ID(" << data.id << ") DataVersion(" << data.dataVersion << ")";
+            packet->writePrimitive(true);
+            auto id = data.id.toRfc4122();
+            packet->write(id);
+            packet->writePrimitive(data.dataVersion);
+        } else {
+            qCWarning(octree) << "No octree data found";
+            packet->writePrimitive(false);
+        }
+    } else if (file.open(QIODevice::ReadOnly)) {
         QByteArray jsonData(file.readAll());
         file.close();
         if (!gunzip(jsonData, _cachedJSONData)) {
@@ -115,8 +130,17 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
     if (includesNewData) {
         _cachedJSONData.clear();
         replacementData = message->readAll();
-        replaceData(replacementData);
-        hasValidOctreeData = data.readOctreeDataInfoFromFile(_filename);
+        if (_persistAsFileType == "bin") {
+            // the replacement is JSON, it is loaded from memory and persisted as a binary snapshot afterwards
+            backupCurrentFile();
+            if (!gunzip(replacementData, _cachedJSONData)) {
+                _cachedJSONData = replacementData;
+            }
+            hasValidOctreeData = data.readOctreeDataInfoFromData(_cachedJSONData);
+        } else {
+            replaceData(replacementData);
+            hasValidOctreeData = data.readOctreeDataInfoFromFile(_filename);
+        }
         qDebug() << "Got OctreeDataFileReply, new data sent";
     } else {
         qDebug() << "Got OctreeDataFileReply, current entity data is sufficient";
@@ -167,6 +191,9 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
     _loadTimeUSecs = loadDone - loadStarted;
 
     _tree->clearDirtyBit(); // the tree is clean since we just loaded it
+    if (_persistAsFileType == "bin" && !replacementData.isNull()) {
+        _tree->setDirtyBit(); // but the replacement data is only on disk in the backups of the domain server
+    }
 
     unsigned long nodeCount = OctreeElement::getNodeCount();
     unsigned long internalNodeCount = OctreeElement::getInternalNodeCount();
@@ -204,7 +231,7 @@ void OctreePersistThread::handleOctreeDataFileReply(QSharedPointer<ReceivedMessa
 QString OctreePersistThread::getPersistFileMimeType() const {
     if (_persistAsFileType == "json") {
         return "application/json";
-    } if (_persistAsFileType == "json.gz") {
+    } if (_persistAsFileType == "json.gz" || _persistAsFileType == "bin") {
         return "application/zip";
     }
     return "";
@@ -253,17 +280,33 @@ void OctreePersistThread::process() {
         persist();
     }
 
+    // the changes to the binary snapshot are journaled between the persists, so that few of them are lost on a crash
+    if (_persistAsFileType == "bin" && now - _lastJournalWrite > TIME_BETWEEN_JOURNAL_WRITES) {
+        _lastJournalWrite = now;
+        qint64 journalSize;
+        _tree->writeToBinaryJournal(journalSize);
+    }
+
     QTimer::singleShot(TIME_BETWEEN_PROCESSING.count(), this, &OctreePersistThread::process);
 }
 
 void OctreePersistThread::aboutToFinish() {
     qCDebug(octree) << "Persist thread about to finish...";
     persist();
+    if (_isDataSentToDSStale) {
+        sendLatestEntityDataToDS();
+    }
     qCDebug(octree) << "Persist thread done with about to finish...";
 }
 
 QByteArray OctreePersistThread::getPersistFileContents() const {
     QByteArray fileContents;
+    if (_persistAsFileType == "bin") {
+        // the binary snapshot is only for this server to load, it is downloaded as gzipped JSON
+        _tree->toJSON(&fileContents, nullptr, true);
+        return fileContents;
+    }
+
     QFile file(_filename);
     if (file.open(QIODevice::ReadOnly)) {
         fileContents = file.readAll();
@@ -312,15 +355,28 @@ void OctreePersistThread::persist() {
 
         _tree->incrementPersistDataVersion();
 
-        qCDebug(octree) << "Saving Octree data to:" << _filename;
-        if (_tree->writeToFile(_filename.toLocal8Bit().constData(), nullptr, _persistAsFileType)) {
-            _tree->clearDirtyBit(); // tree is clean after saving
-            qCDebug(octree) << "DONE persisting Octree data to" << _filename;
+        // the binary snapshot is only written again once its journal has grown larger than it, which compacts the
+        // journal, or if the tree has no journal
+        qint64 journalSize;
+        if (_persistAsFileType == "bin" && _tree->writeToBinaryJournal(journalSize) &&
+            journalSize < QFileInfo(_filename).size()) {
+            _tree->clearDirtyBit(); // tree is clean after journaling
+            qCDebug(octree) << "DONE journaling Octree data to" << _filename;
+
+            // the copy of the DS catches up with the journal when it is compacted, serializing the whole tree to
+            // JSON for it every few seconds would cost more than the journal saves
+            _isDataSentToDSStale = true;
         } else {
-            qCWarning(octree) << "Failed to persist Octree data to" << _filename;
-        }
+            qCDebug(octree) << "Saving Octree data to:" << _filename;
+            if (_tree->writeToFile(_filename.toLocal8Bit().constData(), nullptr, _persistAsFileType)) {
+                _tree->clearDirtyBit(); // tree is clean after saving
+                qCDebug(octree) << "DONE persisting Octree data to" << _filename;
+            } else {
+                qCWarning(octree) << "Failed to persist Octree data to" << _filename;
+            }
 
-        sendLatestEntityDataToDS();
+            sendLatestEntityDataToDS();
+        }
     }
 }
 
@@ -331,6 +387,7 @@ void OctreePersistThread::sendLatestEntityDataToDS() {
 
     QByteArray data;
     if (_tree->toJSON(&data, nullptr, true)) {
+        _isDataSentToDSStale = false;
         auto message = NLPacketList::create(PacketType::OctreeDataPersist, QByteArray(), true, true);
         message->write(data);
         nodeList->sendPacketList(std::move(message), domainHandler.getSockAddr());
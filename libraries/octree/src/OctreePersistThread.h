@@ -70,6 +70,7 @@ private:
     QString _filename;
     std::chrono::milliseconds _persistInterval;
     std::chrono::steady_clock::time_point _lastPersistCheck;
+    std::chrono::steady_clock::time_point _lastJournalWrite;
     bool _initialLoadComplete;
 
     quint64 _loadTimeUSecs;
@@ -79,6 +80,7 @@ private:
 
     QString _persistAsFileType;
     QByteArray _cachedJSONData;
+    bool _isDataSentToDSStale { false }; // true while the DS hasn't been sent what was only journaled
 };
 
 #endif // hifi_OctreePersistThread_h
@@ -83,6 +83,7 @@ int OctreeQuery::getBroadcastData(unsigned char* destinationBuffer) {
 
     OctreeQueryFlags queryFlags { NoFlags };
     queryFlags |= (_reportInitialCompletion ? OctreeQuery::WantInitialCompletion : 0);
+    queryFlags |= (_sendsNacks ? OctreeQuery::SendsNacks : 0);
     memcpy(destinationBuffer, &queryFlags, sizeof(queryFlags));
     destinationBuffer += sizeof(queryFlags);
 
@@ -165,6 +166,7 @@ int OctreeQuery::parseData(ReceivedMessage& message) {
     sourceBuffer += sizeof(queryFlags);
 
     _reportInitialCompletion = bool(queryFlags & OctreeQueryFlags::WantInitialCompletion);
+    _sendsNacks = bool(queryFlags & OctreeQueryFlags::SendsNacks);
 
     return sourceBuffer - startPosition;
 }
@@ -56,6 +56,10 @@ public:
     bool wantReportInitialCompletion() const { return _reportInitialCompletion; }
     void setReportInitialCompletion(bool reportInitialCompletion) { _reportInitialCompletion = reportInitialCompletion; }
 
+    // The viewer NACKs the octree packets it misses, so it can be sent changes against what it was sent before.
+    bool getSendsNacks() const { return _sendsNacks; }
+    void setSendsNacks(bool sendsNacks) { _sendsNacks = sendsNacks; }
+
 signals:
     void incomingConnectionIDChanged();
 
@@ -78,11 +82,12 @@ protected:
     QJsonObject _jsonParameters;
     QReadWriteLock _jsonParametersLock;
     
-    enum OctreeQueryFlags : uint16_t { NoFlags = 0x0, WantInitialCompletion = 0x1 };
+    enum OctreeQueryFlags : uint16_t { NoFlags = 0x0, WantInitialCompletion = 0x1, SendsNacks = 0x2 };
     friend OctreeQuery::OctreeQueryFlags operator|=(OctreeQuery::OctreeQueryFlags& lhs, const int rhs);
 
     bool _hasReceivedFirstQuery { false };
     bool _reportInitialCompletion { false };
+    bool _sendsNacks { false };
 };
 
 #endif // hifi_OctreeQuery_h
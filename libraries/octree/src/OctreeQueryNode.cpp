@@ -209,6 +209,11 @@ void OctreeQueryNode::packetSent(const NLPacket& packet) {
     _sequenceNumber++;
 }
 
+void OctreeQueryNode::untrackedPacketSent() {
+    _sentPacketHistory.untrackedPacketSent(_sequenceNumber);
+    _sequenceNumber++;
+}
+
 bool OctreeQueryNode::hasNextNackedPacket() const {
     return !_nackedSequenceNumbers.isEmpty();
 }
@@ -73,6 +73,7 @@ public:
 
     void octreePacketSent() { packetSent(*_octreePacket); }
     void packetSent(const NLPacket& packet);
+    void untrackedPacketSent(); // for a message sent reliably, which is never resent
 
     OCTREE_PACKET_SEQUENCE getSequenceNumber() const { return _sequenceNumber; }
 
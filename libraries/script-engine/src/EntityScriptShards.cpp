@@ -0,0 +1,109 @@
+//
+//  EntityScriptShards.cpp
+//  libraries/script-engine/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptShards.h"
+
+#include <algorithm>
+
+void EntityScriptShards::setEngines(const std::vector<ScriptEnginePointer>& engines) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _engines = engines;
+    _movedEntities.clear();
+}
+
+std::vector<ScriptEnginePointer> EntityScriptShards::getEngines() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return _engines;
+}
+
+int EntityScriptShards::getNumShards() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return (int)_engines.size();
+}
+
+int EntityScriptShards::getShardUnlocked(const EntityItemID& entityID) const {
+    if (_engines.empty()) {
+        return -1;
+    }
+    auto it = _movedEntities.constFind(entityID);
+    if (it != _movedEntities.constEnd()) {
+        return it.value();
+    }
+    return (int)(qHash(entityID) % (uint)_engines.size());
+}
+
+int EntityScriptShards::getShard(const EntityItemID& entityID) const {
+    std::lock_guard<std::mutex> lock(_lock);
+    return getShardUnlocked(entityID);
+}
+
+ScriptEnginePointer EntityScriptShards::getEngine(const EntityItemID& entityID) const {
+    std::lock_guard<std::mutex> lock(_lock);
+    int shard = getShardUnlocked(entityID);
+    return shard < 0 ? ScriptEnginePointer() : _engines[shard];
+}
+
+void EntityScriptShards::moveEntity(const EntityItemID& entityID, int shard) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (shard >= 0 && shard < (int)_engines.size()) {
+        _movedEntities[entityID] = shard;
+    }
+}
+
+void EntityScriptShards::forgetEntity(const EntityItemID& entityID) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _movedEntities.remove(entityID);
+}
+
+bool EntityScriptShards::pickEntityToMove(const std::vector<QHash<EntityItemID, quint64>>& runTimes,
+                                          quint64 minRunTimeToBalance, EntityItemID& entityID, int& toShard) {
+    if (runTimes.size() < 2) {
+        return false;
+    }
+
+    std::vector<quint64> shardRunTimes(runTimes.size(), 0);
+    std::vector<std::pair<EntityItemID, quint64>> hottestEntities(runTimes.size());
+    for (size_t i = 0; i < runTimes.size(); ++i) {
+        for (auto it = runTimes[i].cbegin(); it != runTimes[i].cend(); ++it) {
+            shardRunTimes[i] += it.value();
+            if (it.value() > hottestEntities[i].second) {
+                hottestEntities[i] = { it.key(), it.value() };
+            }
+        }
+    }
+
+    auto busiest = std::max_element(shardRunTimes.begin(), shardRunTimes.end()) - shardRunTimes.begin();
+    auto lightest = std::min_element(shardRunTimes.begin(), shardRunTimes.end()) - shardRunTimes.begin();
+    const auto& hottestEntity = hottestEntities[busiest];
+    if (busiest == lightest || shardRunTimes[busiest] <= minRunTimeToBalance ||
+        shardRunTimes[lightest] + hottestEntity.second >= shardRunTimes[busiest]) {
+        return false;
+    }
+
+    entityID = hottestEntity.first;
+    toShard = (int)lightest;
+    return true;
+}
+
+void EntityScriptShards::callEntityScriptMethod(const EntityItemID& entityID, const QString& methodName,
+                                                const QStringList& params, const QUuid& remoteCallerID) {
+    auto engine = getEngine(entityID);
+    if (engine) {
+        engine->callEntityScriptMethod(entityID, methodName, params, remoteCallerID);
+    }
+}
+
+QFuture<QVariant> EntityScriptShards::getLocalEntityScriptDetails(const EntityItemID& entityID) {
+    auto engine = getEngine(entityID);
+    if (!engine) {
+        return QFuture<QVariant>();
+    }
+    return engine->getLocalEntityScriptDetails(entityID);
+}
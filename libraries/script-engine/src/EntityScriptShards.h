@@ -0,0 +1,64 @@
+//
+//  EntityScriptShards.h
+//  libraries/script-engine/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptShards_h
+#define hifi_EntityScriptShards_h
+
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QHash>
+
+#include <EntitiesScriptEngineProvider.h>
+
+#include "ScriptEngine.h"
+
+// The script engines the entity script server runs its entity scripts in, each on its own thread, so that a slow
+// script only holds up the scripts that share its engine. All the scripts of an entity run in the same engine, the one
+// picked by the hash of the entity id, unless the entity was moved to another engine to even out their load.
+//
+// The entity scripts calling each other through the Entities API go through here to reach the engine of the entity
+// they call. A call within an engine runs before it returns, as it does with a single engine, while a call to another
+// engine is queued on its thread and runs once that engine gets to it: waiting for it would hold the caller up for as
+// long as the callee's engine is busy, and two engines calling each other would deadlock.
+class EntityScriptShards : public EntitiesScriptEngineProvider {
+public:
+    void setEngines(const std::vector<ScriptEnginePointer>& engines);
+    std::vector<ScriptEnginePointer> getEngines() const;
+    int getNumShards() const;
+
+    int getShard(const EntityItemID& entityID) const;
+    ScriptEnginePointer getEngine(const EntityItemID& entityID) const;
+
+    // Runs the scripts of an entity in another engine from now on, the caller moves the scripts that are running.
+    void moveEntity(const EntityItemID& entityID, int shard);
+    void forgetEntity(const EntityItemID& entityID);
+
+    // Picks the entity to move to even out the load of the shards, given the time each entity of each shard spent
+    // running scripts. The hottest entity of the busiest shard moves to the lightest shard if the busiest spent more
+    // than minRunTimeToBalance running scripts and the move leaves both less busy than the busiest was, which a shard
+    // running a single hot entity can't be. Returns false if no entity is worth moving.
+    static bool pickEntityToMove(const std::vector<QHash<EntityItemID, quint64>>& runTimes, quint64 minRunTimeToBalance,
+                                 EntityItemID& entityID, int& toShard);
+
+    virtual void callEntityScriptMethod(const EntityItemID& entityID, const QString& methodName,
+                                        const QStringList& params = QStringList(),
+                                        const QUuid& remoteCallerID = QUuid()) override;
+    virtual QFuture<QVariant> getLocalEntityScriptDetails(const EntityItemID& entityID) override;
+
+private:
+    int getShardUnlocked(const EntityItemID& entityID) const;
+
+    mutable std::mutex _lock;
+    std::vector<ScriptEnginePointer> _engines;
+    QHash<EntityItemID, int> _movedEntities;
+};
+
+#endif // hifi_EntityScriptShards_h
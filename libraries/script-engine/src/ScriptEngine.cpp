@@ -17,6 +17,7 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QEventLoop>
 #include <QtCore/QFileInfo>
+#include <QtCore/QPointer>
 #include <QtCore/QTimer>
 #include <QtCore/QThread>
 #include <QtCore/QRegularExpression>
@@ -1413,9 +1414,43 @@ void ScriptEngine::timerFired() {
     QTimer* callingTimer = reinterpret_cast<QTimer*>(sender());
     CallbackData timerData = _timerFunctionMap.value(callingTimer);
 
+    // timers only fire from the event loop, so one that fires during an entity script call comes from the events
+    // processed during the call: it waits for the call to be done rather than run inside it
+    if (!_timedCalls.empty() && timerData.function.isValid()) {
+        {
+            std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+            ++_numDeferredTimerCalls;
+            auto it = _entityScriptStats.find(timerData.definingEntityIdentifier);
+            if (it != _entityScriptStats.end()) {
+                ++it->numDeferredTimerCalls;
+            }
+        }
+        // an interval timer just skips this timeout
+        if (!callingTimer->isActive()) {
+            QPointer<QTimer> timer { callingTimer };
+            _reentrantCalls.push_back([this, timer] {
+                if (timer && _timerFunctionMap.contains(timer)) {
+                    timer->start(0);
+                }
+            });
+        }
+        return;
+    }
+
+    // an entity script that spent its soft budget gets its timers back in the next second, a timeout fires then
+    int deferral = getEntityScriptTimerDeferral(timerData.definingEntityIdentifier);
+    if (deferral > 0 && timerData.function.isValid()) {
+        if (!callingTimer->isActive()) {
+            callingTimer->start(deferral);
+        }
+        return;
+    }
+
     if (!callingTimer->isActive()) {
         // this timer is done, we can kill it
-        _timerFunctionMap.remove(callingTimer);
+        if (_timerFunctionMap.remove(callingTimer) > 0) {
+            countTimer(timerData.definingEntityIdentifier, -1);
+        }
         delete callingTimer;
     }
 
@@ -1425,8 +1460,18 @@ void ScriptEngine::timerFired() {
         auto preTimer = p_high_resolution_clock::now();
         callWithEnvironment(timerData.definingEntityIdentifier, timerData.definingSandboxURL, timerData.function, timerData.function, QScriptValueList());
         auto postTimer = p_high_resolution_clock::now();
-        auto elapsed = (postTimer - preTimer);
-        _totalTimerExecution += std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(postTimer - preTimer);
+        _totalTimerExecution += elapsed;
+
+        std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+        _totalTimerRunTime += (quint64)elapsed.count();
+        ++_numTimerCalls;
+        if (!timerData.definingEntityIdentifier.isNull()) {
+            auto it = _entityScriptStats.find(timerData.definingEntityIdentifier);
+            if (it != _entityScriptStats.end()) {
+                ++it->numTimerCalls;
+            }
+        }
     } else {
         qCWarning(scriptengine) << "timerFired -- invalid function" << timerData.function.toVariant().toString();
     }
@@ -1451,6 +1496,7 @@ QObject* ScriptEngine::setupTimerWithInterval(const QScriptValue& function, int
 
     CallbackData timerData = { function, currentEntityIdentifier, currentSandboxURL };
     _timerFunctionMap.insert(newTimer, timerData);
+    countTimer(currentEntityIdentifier, 1);
 
     newTimer->start(intervalMS);
     return newTimer;
@@ -1479,7 +1525,7 @@ QObject* ScriptEngine::setTimeout(const QScriptValue& function, int timeoutMS) {
 void ScriptEngine::stopTimer(QTimer *timer) {
     if (_timerFunctionMap.contains(timer)) {
         timer->stop();
-        _timerFunctionMap.remove(timer);
+        countTimer(_timerFunctionMap.take(timer).definingEntityIdentifier, -1);
         delete timer;
     } else {
         qCDebug(scriptengine) << "stopTimer -- not in _timerFunctionMap" << timer;
@@ -2042,6 +2088,9 @@ void ScriptEngine::forwardHandlerCall(const EntityItemID& entityID, const QStrin
         assert(false);
         return ;
     }
+    if (deferReentrantCall([=] { forwardHandlerCall(entityID, eventName, eventHandlerArgs); })) {
+        return;
+    }
     if (!_registeredHandlers.contains(entityID)) {
         return;
     }
@@ -2160,6 +2209,9 @@ void ScriptEngine::loadEntityScript(const EntityItemID& entityID, const QString&
         );
         return;
     }
+    if (deferReentrantCall([=] { loadEntityScript(entityID, entityScript, forceRedownload); })) {
+        return;
+    }
     PROFILE_RANGE(script, __FUNCTION__);
 
     QSharedPointer<ScriptEngines> scriptEngines(_scriptEngines);
@@ -2449,6 +2501,9 @@ void ScriptEngine::unloadEntityScript(const EntityItemID& entityID, bool shouldR
                                   Q_ARG(bool, shouldRemoveFromMap));
         return;
     }
+    if (deferReentrantCall([=] { unloadEntityScript(entityID, shouldRemoveFromMap); })) {
+        return;
+    }
 #ifdef THREAD_DEBUGGING
     qCDebug(scriptengine) << "ScriptEngine::unloadEntityScript() called on correct thread [" << thread() << "]  "
         "entityID:" << entityID;
@@ -2472,6 +2527,11 @@ void ScriptEngine::unloadEntityScript(const EntityItemID& entityID, bool shouldR
                 QWriteLocker locker { &_entityScriptsLock };
                 _entityScripts.remove(entityID);
             }
+            {
+                std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+                _entityScriptRunTimes.remove(entityID);
+                _entityScriptStats.remove(entityID);
+            }
             emit entityScriptDetailsUpdated();
         } else if (oldDetails.status != EntityScriptStatus::UNLOADED) {
             EntityScriptDetails newDetails;
@@ -2566,6 +2626,14 @@ void ScriptEngine::doWithEnvironment(const EntityItemID& entityID, const QUrl& s
     currentEntityIdentifier = entityID;
     currentSandboxURL = sandboxURL;
 
+    // the calls an entity script makes into other entity scripts are timed on their own
+    bool isTimed = !entityID.isNull();
+    if (isTimed) {
+        _timedCalls.push_back({ entityID, usecTimestampNow(), 0 });
+    }
+    bool wasHandlingQueuedCall = _isHandlingQueuedCall;
+    _isHandlingQueuedCall = false;
+
 #if DEBUG_CURRENT_ENTITY
     QScriptValue oldData = this->globalObject().property("debugEntityID");
     this->globalObject().setProperty("debugEntityID", entityID.toScriptValue(this)); // Make the entityID available to javascript as a global.
@@ -2577,6 +2645,222 @@ void ScriptEngine::doWithEnvironment(const EntityItemID& entityID, const QUrl& s
     maybeEmitUncaughtException(!entityID.isNull() ? entityID.toString() : __FUNCTION__);
     currentEntityIdentifier = oldIdentifier;
     currentSandboxURL = oldSandboxURL;
+
+    _isHandlingQueuedCall = wasHandlingQueuedCall;
+    if (isTimed) {
+        TimedCall call = _timedCalls.back();
+        _timedCalls.pop_back();
+        quint64 runTime = usecTimestampNow() - call.startTime;
+        recordEntityScriptCall(entityID, call.startTime, runTime - std::min(call.nestedRunTime, runTime));
+        if (!_timedCalls.empty()) {
+            _timedCalls.back().nestedRunTime += runTime;
+        }
+
+        if (_abortedTimedCall >= 0) {
+            QString timedOut = QString("Timed out (entity script calls are limited to %1ms)")
+                .arg(_entityScriptHardBudgetMsecs.load());
+            if (_abortedTimedCall == (int)_timedCalls.size()) {
+                _abortedTimedCall = -1;
+                suspendEntityScript(entityID, timedOut);
+            } else if (isEvaluating()) {
+                // the call being aborted is further out, keep unwinding to it
+                abortEvaluation(makeError(timedOut));
+            }
+        }
+
+        if (_timedCalls.empty() && !_reentrantCalls.empty()) {
+            QMetaObject::invokeMethod(this, [this] { runReentrantCalls(); }, Qt::QueuedConnection);
+        }
+    }
+}
+
+bool ScriptEngine::event(QEvent* event) {
+    // the queued calls into the engine all come through here, from the event loop
+    bool wasHandlingQueuedCall = _isHandlingQueuedCall;
+    _isHandlingQueuedCall = event->type() == QEvent::MetaCall;
+    bool result = BaseScriptEngine::event(event);
+    _isHandlingQueuedCall = wasHandlingQueuedCall;
+    return result;
+}
+
+// A queued call that arrives while an entity script call runs comes from the events the engine processes during the
+// call. Run there, its time would be charged to the running call, and a hard budget would abort the wrong script.
+bool ScriptEngine::deferReentrantCall(std::function<void()> call) {
+    if (!_isHandlingQueuedCall || _timedCalls.empty()) {
+        return false;
+    }
+    _reentrantCalls.push_back(call);
+    return true;
+}
+
+void ScriptEngine::runReentrantCalls() {
+    std::vector<std::function<void()>> calls;
+    calls.swap(_reentrantCalls);
+    for (const auto& call : calls) {
+        call();
+    }
+}
+
+void ScriptEngine::recordEntityScriptCall(const EntityItemID& entityID, quint64 startTime, quint64 runTime) {
+    std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+    _entityScriptRunTimes[entityID] += runTime;
+    _totalEntityScriptRunTime += runTime;
+    ++_numEntityScriptCalls;
+
+    EntityScriptStats& stats = _entityScriptStats[entityID];
+    stats.runTime += runTime;
+    stats.maxCallTime = std::max(stats.maxCallTime, runTime);
+    ++stats.numCalls;
+    if (startTime - stats.budgetWindowStart >= USECS_PER_SECOND) {
+        stats.budgetWindowStart = startTime;
+        stats.budgetWindowRunTime = 0;
+    }
+    stats.budgetWindowRunTime += runTime;
+}
+
+int ScriptEngine::getEntityScriptTimerDeferral(const EntityItemID& entityID) {
+    int softBudgetMsecs = _entityScriptSoftBudgetMsecs;
+    if (softBudgetMsecs <= 0 || entityID.isNull()) {
+        return 0;
+    }
+
+    quint64 now = usecTimestampNow();
+    std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+    auto it = _entityScriptStats.find(entityID);
+    if (it == _entityScriptStats.end() || now - it->budgetWindowStart >= USECS_PER_SECOND ||
+        it->budgetWindowRunTime < (quint64)softBudgetMsecs * USECS_PER_MSEC) {
+        return 0;
+    }
+    ++it->numDeferredTimerCalls;
+    ++_numDeferredTimerCalls;
+    quint64 windowEnd = it->budgetWindowStart + USECS_PER_SECOND;
+    return std::max(1, (int)((windowEnd - now) / USECS_PER_MSEC));
+}
+
+void ScriptEngine::countTimer(const EntityItemID& entityID, int delta) {
+    std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+    _numTimers += delta;
+    if (!entityID.isNull()) {
+        auto it = _entityScriptStats.find(entityID);
+        if (it != _entityScriptStats.end()) {
+            it->numTimers += delta;
+        } else if (delta > 0) {
+            _entityScriptStats[entityID].numTimers = delta;
+        }
+    }
+}
+
+void ScriptEngine::checkEntityScriptHardBudget() {
+    int hardBudgetMsecs = _entityScriptHardBudgetMsecs;
+    if (hardBudgetMsecs <= 0 || _timedCalls.empty() || _abortedTimedCall >= 0 || !isEvaluating()) {
+        return;
+    }
+
+    // the innermost call that ran for longer than the budget, not counting the calls nested in it, is the one whose
+    // script gets suspended. This runs from the events processed during a long evaluation, and the abort unwinds the
+    // calls it is nested in too.
+    quint64 now = usecTimestampNow();
+    quint64 hardBudget = (quint64)hardBudgetMsecs * USECS_PER_MSEC;
+    for (int i = (int)_timedCalls.size() - 1; i >= 0; --i) {
+        const TimedCall& call = _timedCalls[i];
+        quint64 end = i + 1 < (int)_timedCalls.size() ? _timedCalls[i + 1].startTime : now;
+        quint64 runTime = end - call.startTime - std::min(call.nestedRunTime, end - call.startTime);
+        if (runTime > hardBudget) {
+            qCDebug(scriptengine) << "Aborting a call into the entity script of" << call.entityID << "after"
+                << hardBudgetMsecs << "ms";
+            _abortedTimedCall = i;
+            abortEvaluation(makeError(QString("Timed out (entity script calls are limited to %1ms)").arg(hardBudgetMsecs)));
+            return;
+        }
+    }
+}
+
+void ScriptEngine::suspendEntityScript(const EntityItemID& entityID, const QString& reason) {
+    scriptErrorMessage("Suspending the entity script of " + entityID.toString() + ": " + reason);
+    stopAllTimersForEntityScript(entityID);
+
+    // the event handlers the script added, on any entity, are dropped with its timers
+    for (auto& handlersOnEntity : _registeredHandlers) {
+        for (auto& handlersForEvent : handlersOnEntity) {
+            for (int i = handlersForEvent.count() - 1; i >= 0; --i) {
+                if (handlersForEvent[i].definingEntityIdentifier == entityID) {
+                    handlersForEvent.removeAt(i);
+                }
+            }
+        }
+    }
+    updateEntityScriptStatus(entityID, EntityScriptStatus::ERROR_RUNNING_SCRIPT, reason);
+
+    std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+    ++_numSuspendedEntityScripts;
+}
+
+void ScriptEngine::setEntityScriptBudgets(int softBudgetMsecsPerSecond, int hardBudgetMsecs) {
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, softBudgetMsecsPerSecond, hardBudgetMsecs] {
+            setEntityScriptBudgets(softBudgetMsecsPerSecond, hardBudgetMsecs);
+        });
+        return;
+    }
+
+    _entityScriptSoftBudgetMsecs = std::max(softBudgetMsecsPerSecond, 0);
+    _entityScriptHardBudgetMsecs = std::max(hardBudgetMsecs, 0);
+
+    // the watchdog only gets to run while a script is evaluated if the engine processes events often enough
+    if (_entityScriptHardBudgetMsecs > 0) {
+        static const int MIN_WATCHDOG_INTERVAL_MSECS = 10;
+        int interval = std::max(std::min(hardBudgetMsecs / 2, (int)MSECS_PER_SECOND), MIN_WATCHDOG_INTERVAL_MSECS);
+        if (!_entityScriptWatchdog) {
+            _entityScriptWatchdog = new QTimer(this);
+            connect(_entityScriptWatchdog, &QTimer::timeout, this, &ScriptEngine::checkEntityScriptHardBudget);
+        }
+        _entityScriptWatchdog->start(interval);
+        setProcessEventsInterval(interval);
+    } else {
+        if (_entityScriptWatchdog) {
+            _entityScriptWatchdog->stop();
+        }
+        setProcessEventsInterval(MSECS_PER_SECOND);
+    }
+}
+
+QHash<EntityItemID, quint64> ScriptEngine::takeEntityScriptRunTimes() {
+    QHash<EntityItemID, quint64> runTimes;
+    std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+    runTimes.swap(_entityScriptRunTimes);
+    return runTimes;
+}
+
+QVariantMap ScriptEngine::getScriptStats() {
+    const double MSECS_PER_USEC = 1.0 / USECS_PER_MSEC;
+    int numRunningEntityScripts = getNumRunningEntityScripts();
+
+    QVariantMap stats;
+    QVariantMap entityScripts;
+    {
+        std::lock_guard<std::mutex> lock(_entityScriptRunTimesLock);
+        stats["entityScriptRunTime"] = _totalEntityScriptRunTime * MSECS_PER_USEC;
+        stats["entityScriptCalls"] = _numEntityScriptCalls;
+        stats["timerRunTime"] = _totalTimerRunTime * MSECS_PER_USEC;
+        stats["timerCalls"] = _numTimerCalls;
+        stats["deferredTimerCalls"] = _numDeferredTimerCalls;
+        stats["suspendedEntityScripts"] = _numSuspendedEntityScripts;
+        stats["timers"] = _numTimers;
+
+        for (auto it = _entityScriptStats.constBegin(); it != _entityScriptStats.constEnd(); ++it) {
+            QVariantMap entityStats;
+            entityStats["runTime"] = it->runTime * MSECS_PER_USEC;
+            entityStats["maxCallTime"] = it->maxCallTime * MSECS_PER_USEC;
+            entityStats["calls"] = it->numCalls;
+            entityStats["timerCalls"] = it->numTimerCalls;
+            entityStats["deferredTimerCalls"] = it->numDeferredTimerCalls;
+            entityStats["timers"] = it->numTimers;
+            entityScripts[it.key().toString()] = entityStats;
+        }
+    }
+    stats["runningEntityScripts"] = numRunningEntityScripts;
+    stats["entityScripts"] = entityScripts;
+    return stats;
 }
 
 void ScriptEngine::callWithEnvironment(const EntityItemID& entityID, const QUrl& sandboxURL, QScriptValue function, QScriptValue thisObject, QScriptValueList args) {
@@ -2605,6 +2889,9 @@ void ScriptEngine::callEntityScriptMethod(const EntityItemID& entityID, const QS
         "entityID:" << entityID << "methodName:" << methodName;
 #endif
 
+    if (deferReentrantCall([=] { callEntityScriptMethod(entityID, methodName, params, remoteCallerID); })) {
+        return;
+    }
     if (HIFI_AUTOREFRESH_FILE_SCRIPTS && methodName != "unload") {
         refreshFileScript(entityID);
     }
@@ -2671,6 +2958,9 @@ void ScriptEngine::callEntityScriptMethod(const EntityItemID& entityID, const QS
         "entityID:" << entityID << "methodName:" << methodName << "event: pointerEvent";
 #endif
 
+    if (deferReentrantCall([=] { callEntityScriptMethod(entityID, methodName, event); })) {
+        return;
+    }
     if (HIFI_AUTOREFRESH_FILE_SCRIPTS) {
         refreshFileScript(entityID);
     }
@@ -2709,6 +2999,9 @@ void ScriptEngine::callEntityScriptMethod(const EntityItemID& entityID, const QS
         "entityID:" << entityID << "methodName:" << methodName << "otherID:" << otherID << "collision: collision";
 #endif
 
+    if (deferReentrantCall([=] { callEntityScriptMethod(entityID, methodName, otherID, collision); })) {
+        return;
+    }
     if (HIFI_AUTOREFRESH_FILE_SCRIPTS) {
         refreshFileScript(entityID);
     }
@@ -12,6 +12,7 @@
 #ifndef hifi_ScriptEngine_h
 #define hifi_ScriptEngine_h
 
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -563,6 +564,36 @@ public:
         auto it = _entityScripts.constFind(entityID);
         return it != _entityScripts.constEnd() && it->status == EntityScriptStatus::RUNNING;
     }
+
+    /**jsdoc
+     * Gets the time spent running the scripts of this script engine and the number of calls made into them.
+     * @function Script.getScriptStats
+     * @returns {Script.ScriptStats} The run time and call counts of the script engine and of each of its entity scripts.
+     */
+    /**jsdoc
+     * @typedef {object} Script.ScriptStats
+     * @property {number} entityScriptRunTime - The time spent running entity scripts, in ms.
+     * @property {number} entityScriptCalls - The number of calls made into entity scripts, including timer callbacks.
+     * @property {number} timerRunTime - The time spent running timer callbacks, in ms.
+     * @property {number} timerCalls - The number of timer callbacks called.
+     * @property {number} deferredTimerCalls - The number of entity script timer callbacks deferred because their entity
+     *     script had spent its soft budget, or because another entity script call was running.
+     * @property {number} suspendedEntityScripts - The number of entity scripts suspended because a call ran for longer
+     *     than the hard budget.
+     * @property {number} timers - The number of timers waiting to fire.
+     * @property {number} runningEntityScripts - The number of entity scripts running.
+     * @property {Object.<Uuid, Script.EntityScriptStats>} entityScripts - The stats of each entity script.
+     */
+    /**jsdoc
+     * @typedef {object} Script.EntityScriptStats
+     * @property {number} runTime - The time spent running the entity script, in ms.
+     * @property {number} maxCallTime - The longest time a call into the entity script ran for, in ms.
+     * @property {number} calls - The number of calls made into the entity script, including timer callbacks.
+     * @property {number} timerCalls - The number of timer callbacks of the entity script called.
+     * @property {number} deferredTimerCalls - The number of timer callbacks of the entity script deferred.
+     * @property {number} timers - The number of timers of the entity script waiting to fire.
+     */
+    Q_INVOKABLE QVariantMap getScriptStats();
     QVariant cloneEntityScriptDetails(const EntityItemID& entityID);
     QFuture<QVariant> getLocalEntityScriptDetails(const EntityItemID& entityID) override;
 
@@ -674,6 +705,15 @@ public:
     bool getEntityScriptDetails(const EntityItemID& entityID, EntityScriptDetails &details) const;
     bool hasEntityScriptDetails(const EntityItemID& entityID) const;
 
+    // the time spent running the scripts of each entity, in usecs, since this was last called
+    QHash<EntityItemID, quint64> takeEntityScriptRunTimes();
+
+    // The run time budgets of the entity scripts, 0 for none. The timer callbacks of an entity script that ran for longer
+    // than its soft budget in the last second are deferred until the next second. A call into an entity script that runs
+    // for longer than the hard budget is aborted, and the entity script is suspended until it is reloaded. Only the owner
+    // of the engine sets them, entity scripts can't.
+    void setEntityScriptBudgets(int softBudgetMsecsPerSecond, int hardBudgetMsecs);
+
     void setScriptEngines(QSharedPointer<ScriptEngines>& scriptEngines) { _scriptEngines = scriptEngines; }
 
 public slots:
@@ -877,6 +917,8 @@ signals:
 protected:
     void init();
 
+    bool event(QEvent* event) override;
+
     /**jsdoc
      * @function Script.executeOnScriptThread
      * @param {function} function - Function.
@@ -898,6 +940,13 @@ protected:
 
     QString logException(const QScriptValue& exception);
     void timerFired();
+    void checkEntityScriptHardBudget();
+    bool deferReentrantCall(std::function<void()> call);
+    void runReentrantCalls();
+    int getEntityScriptTimerDeferral(const EntityItemID& entityID);
+    void recordEntityScriptCall(const EntityItemID& entityID, quint64 startTime, quint64 runTime);
+    void countTimer(const EntityItemID& entityID, int delta);
+    void suspendEntityScript(const EntityItemID& entityID, const QString& reason);
     void stopAllTimers();
     void stopAllTimersForEntityScript(const EntityItemID& entityID);
     void refreshFileScript(const EntityItemID& entityID);
@@ -942,6 +991,49 @@ protected:
     QHash<EntityItemID, EntityScriptDetails> _entityScripts;
     EntityScriptContentAvailableMap _contentAvailableQueue;
 
+    struct EntityScriptStats {
+        quint64 runTime { 0 };
+        quint64 maxCallTime { 0 };
+        quint64 numCalls { 0 };
+        quint64 numTimerCalls { 0 };
+        quint64 numDeferredTimerCalls { 0 };
+        int numTimers { 0 };
+
+        // the run time in the current second, spent against the soft budget
+        quint64 budgetWindowStart { 0 };
+        quint64 budgetWindowRunTime { 0 };
+    };
+
+    // the entity script calls running, innermost last, each timed on its own: the run time of the calls nested in a call
+    // is taken out of its own
+    struct TimedCall {
+        EntityItemID entityID;
+        quint64 startTime { 0 };
+        quint64 nestedRunTime { 0 };
+    };
+
+    std::vector<TimedCall> _timedCalls;
+    int _abortedTimedCall { -1 }; // the index of the call the hard budget is aborting, if any
+
+    // the calls that arrived from the events processed during an entity script call, run once it is done
+    bool _isHandlingQueuedCall { false };
+    std::vector<std::function<void()>> _reentrantCalls;
+    std::atomic<int> _entityScriptSoftBudgetMsecs { 0 };
+    std::atomic<int> _entityScriptHardBudgetMsecs { 0 };
+    QTimer* _entityScriptWatchdog { nullptr };
+
+    // guards the run times and stats below, which are read from other threads
+    std::mutex _entityScriptRunTimesLock;
+    QHash<EntityItemID, quint64> _entityScriptRunTimes;
+    QHash<EntityItemID, EntityScriptStats> _entityScriptStats;
+    quint64 _totalEntityScriptRunTime { 0 };
+    quint64 _numEntityScriptCalls { 0 };
+    quint64 _totalTimerRunTime { 0 };
+    quint64 _numTimerCalls { 0 };
+    quint64 _numDeferredTimerCalls { 0 };
+    quint64 _numSuspendedEntityScripts { 0 };
+    int _numTimers { 0 };
+
     bool _isThreaded { false };
     QScriptEngineDebugger* _debugger { nullptr };
     bool _debuggable { false };
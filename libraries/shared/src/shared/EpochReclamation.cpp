@@ -0,0 +1,115 @@
+//
+//  EpochReclamation.cpp
+//  libraries/shared/src/shared
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EpochReclamation.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+static std::atomic<uint64_t> nextEpochReclamationID { 0 };
+
+EpochReclamation::ReadGuard::ReadGuard(const EpochReclamation& epochs) :
+    _record(epochs.threadRecord())
+{
+    if (_record->depth++ == 0) {
+        // any data retired from here on was swapped out before we load it, so it can't be what we load
+        _record->epoch.store(epochs._epoch.load());
+    }
+}
+
+EpochReclamation::ReadGuard::~ReadGuard() {
+    if (--_record->depth == 0) {
+        _record->epoch.store(0, std::memory_order_release);
+    }
+}
+
+EpochReclamation::EpochReclamation() :
+    _id(nextEpochReclamationID++)
+{
+}
+
+EpochReclamation::~EpochReclamation() {
+    for (auto& retired : _retired) {
+        retired.second();
+    }
+
+    auto record = _records.load();
+    while (record) {
+        auto next = record->next;
+        delete record;
+        record = next;
+    }
+}
+
+EpochReclamation::ThreadRecord* EpochReclamation::threadRecord() const {
+    // records are keyed on an ID rather than the address, which could be re-used by a later instance
+    thread_local std::vector<std::pair<uint64_t, ThreadRecord*>> threadRecords;
+
+    auto it = std::find_if(threadRecords.begin(), threadRecords.end(), [this](const std::pair<uint64_t, ThreadRecord*>& pair) {
+        return pair.first == _id;
+    });
+
+    if (it != threadRecords.end()) {
+        return it->second;
+    }
+
+    auto record = new ThreadRecord();
+    record->next = _records.load();
+    while (!_records.compare_exchange_weak(record->next, record)) {}
+
+    threadRecords.emplace_back(_id, record);
+    return record;
+}
+
+void EpochReclamation::retire(std::function<void()> deleter) {
+    std::lock_guard<std::mutex> lock(_retiredMutex);
+
+    // guards that start after this see the new epoch, and whatever replaced the retired data
+    _retired.emplace_back(_epoch.fetch_add(1), std::move(deleter));
+}
+
+size_t EpochReclamation::reclaim() {
+    uint64_t oldestEpoch = std::numeric_limits<uint64_t>::max();
+
+    for (auto record = _records.load(); record; record = record->next) {
+        auto epoch = record->epoch.load();
+        if (epoch != 0) {
+            oldestEpoch = std::min(oldestEpoch, epoch);
+        }
+    }
+
+    std::vector<std::function<void()>> deleters;
+    size_t numRetired;
+
+    {
+        std::lock_guard<std::mutex> lock(_retiredMutex);
+
+        // a guard that started in an epoch after the one something was retired in can't have seen it
+        while (!_retired.empty() && _retired.front().first < oldestEpoch) {
+            deleters.push_back(std::move(_retired.front().second));
+            _retired.pop_front();
+        }
+
+        numRetired = _retired.size();
+    }
+
+    // the deleters run outside of the lock, in case they retire something themselves
+    for (auto& deleter : deleters) {
+        deleter();
+    }
+
+    return numRetired;
+}
+
+size_t EpochReclamation::getNumRetired() const {
+    std::lock_guard<std::mutex> lock(_retiredMutex);
+    return _retired.size();
+}
@@ -0,0 +1,73 @@
+//
+//  EpochReclamation.h
+//  libraries/shared/src/shared
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+#ifndef hifi_EpochReclamation_h
+#define hifi_EpochReclamation_h
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <utility>
+
+// Epoch based reclamation, for data that is read much more often than it is replaced.
+//
+// Readers hold a ReadGuard for as long as they use what they loaded from an atomic pointer - entering and leaving
+// a guard costs a couple of atomic stores on a per-thread record, without locks or reference counting.
+// A writer swaps in the new data, and retires the old data with a deleter that only runs once every guard that
+// could have loaded it has been released.
+//
+// Guards nest, and retire/reclaim never wait on readers, so both can be called while holding a guard.
+class EpochReclamation {
+    struct ThreadRecord;
+
+public:
+    class ReadGuard {
+    public:
+        ReadGuard(const EpochReclamation& epochs);
+        ~ReadGuard();
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+    private:
+        ThreadRecord* _record;
+    };
+
+    EpochReclamation();
+    ~EpochReclamation(); // runs the remaining deleters, there must not be any guard left
+
+    // Defers the deleter until no guard can still see what it deletes. Call it after the retired data was swapped out.
+    void retire(std::function<void()> deleter);
+
+    // Runs the deleters that are safe to run and returns how many are still waiting on guards.
+    size_t reclaim();
+
+    size_t getNumRetired() const;
+
+private:
+    struct ThreadRecord {
+        std::atomic<uint64_t> epoch { 0 }; // epoch the thread's outermost guard started in, 0 when it holds none
+        int depth { 0 };
+        ThreadRecord* next { nullptr };
+    };
+
+    ThreadRecord* threadRecord() const;
+
+    const uint64_t _id;
+    std::atomic<uint64_t> _epoch { 1 };
+    mutable std::atomic<ThreadRecord*> _records { nullptr };
+
+    mutable std::mutex _retiredMutex;
+    std::deque<std::pair<uint64_t, std::function<void()>>> _retired;
+};
+
+#endif // hifi_EpochReclamation_h
@@ -0,0 +1,135 @@
+//
+//  HdrHistogram.cpp
+//  libraries/shared/src/shared
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "HdrHistogram.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int mostSignificantBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+HdrHistogram::HdrHistogram(int subBucketBits, uint64_t highestTrackableValue) :
+    _subBucketBits(std::max(2, std::min(subBucketBits, 16))),
+    _highestTrackableValue(std::max(highestTrackableValue, (uint64_t)1 << _subBucketBits))
+{
+    _numBuckets = bucketIndex(_highestTrackableValue) + 1;
+}
+
+void HdrHistogram::record(uint64_t value, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    if (_counts.empty()) {
+        _counts.resize(_numBuckets, 0);
+    }
+
+    _counts[bucketIndex(std::min(value, _highestTrackableValue))] += count;
+
+    _totalCount += count;
+    _min = std::min(_min, value);
+    _max = std::max(_max, value);
+    _sum += (double)value * count;
+}
+
+void HdrHistogram::merge(const HdrHistogram& other) {
+    assert(_subBucketBits == other._subBucketBits && _numBuckets == other._numBuckets);
+
+    if (other.isEmpty()) {
+        return;
+    }
+
+    if (_counts.empty()) {
+        _counts = other._counts;
+    } else {
+        for (int i = 0; i < _numBuckets; ++i) {
+            _counts[i] += other._counts[i];
+        }
+    }
+
+    _totalCount += other._totalCount;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+    _sum += other._sum;
+}
+
+void HdrHistogram::reset() {
+    std::fill(_counts.begin(), _counts.end(), 0);
+    _totalCount = 0;
+    _min = UINT64_MAX;
+    _max = 0;
+    _sum = 0.0;
+}
+
+double HdrHistogram::getMean() const {
+    return isEmpty() ? 0.0 : _sum / _totalCount;
+}
+
+uint64_t HdrHistogram::getValueAtPercentile(double percentile) const {
+    if (isEmpty()) {
+        return 0;
+    }
+
+    percentile = std::max(0.0, std::min(percentile, 100.0));
+    uint64_t targetCount = std::max((uint64_t)1, (uint64_t)std::ceil(percentile / 100.0 * _totalCount));
+
+    uint64_t runningCount = 0;
+    for (int i = 0; i < _numBuckets; ++i) {
+        runningCount += _counts[i];
+
+        if (runningCount >= targetCount) {
+            return std::max(_min, std::min(highestValueInBucket(i), _max));
+        }
+    }
+
+    return _max;
+}
+
+int HdrHistogram::bucketIndex(uint64_t value) const {
+    const uint64_t subBucketCount = (uint64_t)1 << _subBucketBits;
+
+    if (value < subBucketCount) {
+        // the first power of two ranges are counted exactly
+        return (int)value;
+    }
+
+    // above that, the range [2^n, 2^(n+1)) is split in half as many sub-buckets, each 2^shift wide
+    int shift = mostSignificantBit(value) - (_subBucketBits - 1);
+    return (int)(shift * (subBucketCount / 2) + (value >> shift));
+}
+
+uint64_t HdrHistogram::lowestValueInBucket(int index) const {
+    const int subBucketCount = 1 << _subBucketBits;
+    const int halfSubBucketCount = subBucketCount / 2;
+
+    if (index < subBucketCount) {
+        return (uint64_t)index;
+    }
+
+    int shift = index / halfSubBucketCount - 1;
+    return (uint64_t)(index - shift * halfSubBucketCount) << shift;
+}
+
+uint64_t HdrHistogram::highestValueInBucket(int index) const {
+    return lowestValueInBucket(index + 1) - 1;
+}
@@ -0,0 +1,65 @@
+//
+//  HdrHistogram.h
+//  libraries/shared/src/shared
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+#ifndef hifi_HdrHistogram_h
+#define hifi_HdrHistogram_h
+
+#include <stdint.h>
+#include <vector>
+
+// High dynamic range histogram of non-negative integer values (typically microseconds).
+//
+// Values are counted in log-linear buckets: every power of two range is split into the same number of sub-buckets,
+// so a value is known to within 1 / 2^(subBucketBits - 1) of itself whatever its magnitude, in constant memory.
+// Values above the highest trackable value are counted in the last bucket.
+//
+// The buckets are only allocated on the first record, so an empty histogram is cheap to copy around.
+class HdrHistogram {
+public:
+    static const int DEFAULT_SUB_BUCKET_BITS = 6; // values within ~3%
+    static const uint64_t DEFAULT_HIGHEST_TRACKABLE_VALUE = (1ULL << 27) - 1; // a bit over two minutes in usecs
+
+    HdrHistogram(int subBucketBits = DEFAULT_SUB_BUCKET_BITS,
+                 uint64_t highestTrackableValue = DEFAULT_HIGHEST_TRACKABLE_VALUE);
+
+    void record(uint64_t value, uint64_t count = 1);
+
+    // Adds the counts of another histogram, it must have been created with the same parameters.
+    void merge(const HdrHistogram& other);
+
+    void reset();
+
+    bool isEmpty() const { return _totalCount == 0; }
+    uint64_t getTotalCount() const { return _totalCount; }
+    uint64_t getMin() const { return isEmpty() ? 0 : _min; }
+    uint64_t getMax() const { return _max; }
+    double getMean() const;
+
+    // Returns the highest value equivalent to the bucket the given percentile (0 to 100) falls in, 0 if empty.
+    uint64_t getValueAtPercentile(double percentile) const;
+
+private:
+    int bucketIndex(uint64_t value) const;
+    uint64_t lowestValueInBucket(int index) const;
+    uint64_t highestValueInBucket(int index) const;
+
+    int _subBucketBits;
+    uint64_t _highestTrackableValue;
+    int _numBuckets;
+
+    std::vector<uint64_t> _counts;
+    uint64_t _totalCount { 0 };
+    uint64_t _min { UINT64_MAX };
+    uint64_t _max { 0 };
+    double _sum { 0.0 };
+};
+
+#endif // hifi_HdrHistogram_h
@@ -0,0 +1,146 @@
+//
+//  CoalescedPacketsTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "CoalescedPacketsTests.h"
+
+#include <set>
+
+#include <NLPacket.h>
+#include <udt/CoalescedPackets.h>
+
+QTEST_MAIN(CoalescedPacketsTests)
+
+using namespace udt;
+
+namespace {
+
+const SequenceNumber CONTAINER_SEQUENCE_NUMBER { 1234 };
+
+// what the receiving socket gets for the first size bytes of a packet, in a buffer of exactly that size
+std::unique_ptr<Packet> receive(const Packet& packet, qint64 size) {
+    auto data = std::unique_ptr<char[]>(new char[size]);
+    memcpy(data.get(), packet.getData(), size);
+    return Packet::fromReceivedPacket(std::move(data), size, HifiSockAddr());
+}
+
+std::unique_ptr<Packet> createContainer(const std::vector<std::unique_ptr<NLPacket>>& packets) {
+    auto container = CoalescedPackets::createContainer();
+    for (const auto& packet : packets) {
+        CoalescedPackets::append(*container, *packet);
+    }
+    container->writeSequenceNumber(CONTAINER_SEQUENCE_NUMBER);
+    return container;
+}
+
+std::vector<std::unique_ptr<NLPacket>> createPackets() {
+    std::vector<std::unique_ptr<NLPacket>> packets;
+
+    auto sourcedPacket = NLPacket::create(PacketType::Ping);
+    sourcedPacket->writeSourceID(42);
+    sourcedPacket->write("sourced");
+    packets.push_back(std::move(sourcedPacket));
+
+    auto nonSourcedPacket = NLPacket::create(PacketType::ICEPing);
+    nonSourcedPacket->write("non-sourced");
+    packets.push_back(std::move(nonSourcedPacket));
+
+    // no payload at all, only the header
+    packets.push_back(NLPacket::create(PacketType::PingReply));
+
+    return packets;
+}
+
+}
+
+void CoalescedPacketsTests::roundTripTest() {
+    auto sentPackets = createPackets();
+    for (const auto& packet : sentPackets) {
+        QVERIFY(CoalescedPackets::isCoalescable(*packet));
+    }
+    auto container = createContainer(sentPackets);
+
+    auto receivedContainer = receive(*container, container->getDataSize());
+    QCOMPARE(NLPacket::typeInHeader(*receivedContainer), PacketType::CoalescedPackets);
+
+    std::vector<std::unique_ptr<Packet>> packets;
+    QVERIFY(CoalescedPackets::unpack(*receivedContainer, packets));
+    QCOMPARE(packets.size(), sentPackets.size());
+
+    for (size_t i = 0; i < packets.size(); ++i) {
+        QCOMPARE(packets[i]->getSequenceNumber(), CONTAINER_SEQUENCE_NUMBER);
+        QVERIFY(packets[i]->isReliable());
+        QVERIFY(!packets[i]->isPartOfMessage());
+
+        auto packet = NLPacket::fromBase(std::move(packets[i]));
+        const auto& sentPacket = sentPackets[i];
+        QCOMPARE(packet->getType(), sentPacket->getType());
+        QCOMPARE(packet->getVersion(), sentPacket->getVersion());
+        QCOMPARE(packet->getSourceID(), sentPacket->getSourceID());
+        QCOMPARE(QByteArray(packet->getPayload(), packet->getPayloadSize()),
+                 QByteArray(sentPacket->getPayload(), sentPacket->getPayloadSize()));
+    }
+}
+
+void CoalescedPacketsTests::truncatedContainerTest() {
+    auto sentPackets = createPackets();
+    auto container = createContainer(sentPackets);
+
+    // the sizes the container can be cut at and still be whole
+    std::set<qint64> entryEnds;
+    qint64 end = NLPacket::totalHeaderSize(PacketType::CoalescedPackets);
+    entryEnds.insert(end);
+    for (const auto& packet : sentPackets) {
+        end += sizeof(CoalescedPackets::EntrySize) + packet->getDataSize() - Packet::localHeaderSize();
+        entryEnds.insert(end);
+    }
+    QCOMPARE(end, container->getDataSize());
+
+    for (qint64 size = NLPacket::totalHeaderSize(PacketType::CoalescedPackets); size < end; ++size) {
+        std::vector<std::unique_ptr<Packet>> packets;
+        bool isUnpacked = CoalescedPackets::unpack(*receive(*container, size), packets);
+        QCOMPARE(isUnpacked, entryEnds.count(size) > 0);
+        if (!isUnpacked) {
+            QVERIFY(packets.empty());
+        }
+    }
+}
+
+void CoalescedPacketsTests::malformedEntryTest() {
+    auto validPacket = NLPacket::create(PacketType::ICEPing);
+    validPacket->write("valid");
+
+    auto unpack = [&](const QByteArray& entry) {
+        auto container = CoalescedPackets::createContainer();
+        CoalescedPackets::append(*container, *validPacket);
+        container->write(entry);
+        std::vector<std::unique_ptr<Packet>> packets;
+        bool isUnpacked = CoalescedPackets::unpack(*receive(*container, container->getDataSize()), packets);
+        return isUnpacked || !packets.empty();
+    };
+
+    auto entry = [](CoalescedPackets::EntrySize size, const QByteArray& data) {
+        return QByteArray((const char*)&size, sizeof(size)) + data;
+    };
+
+    // the type of a packet without its version
+    QByteArray typeOnly(1, (char)PacketType::ICEPing);
+    QByteArray typeAndVersion = typeOnly + QByteArray(1, (char)versionForPacketType(PacketType::ICEPing));
+
+    QVERIFY(unpack(entry(typeAndVersion.size(), typeAndVersion)));
+    QVERIFY(!unpack(entry(0, QByteArray())));
+    QVERIFY(!unpack(entry(typeOnly.size(), typeOnly)));
+    QVERIFY(!unpack(entry(typeAndVersion.size() + 1, typeAndVersion)));
+    QVERIFY(!unpack(entry(CoalescedPackets::EntrySize(-1), typeAndVersion)));
+
+    // a sourced packet has to hold its source id and verification hash
+    QByteArray sourcedHeader(2, 0);
+    sourcedHeader[0] = (char)PacketType::Ping;
+    QVERIFY(!unpack(entry(sourcedHeader.size(), sourcedHeader)));
+}
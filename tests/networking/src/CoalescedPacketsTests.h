@@ -0,0 +1,27 @@
+//
+//  CoalescedPacketsTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_CoalescedPacketsTests_h
+#define hifi_CoalescedPacketsTests_h
+
+#include <QtTest/QtTest>
+
+class CoalescedPacketsTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test packets come out of a container sent over the wire as they went in, with the udt header of the container
+    void roundTripTest();
+    // Test a container cut anywhere but between two entries is rejected whole
+    void truncatedContainerTest();
+    // Test entries that are empty, too small for a packet header or bigger than what is left are rejected
+    void malformedEntryTest();
+};
+
+#endif // hifi_CoalescedPacketsTests_h
@@ -0,0 +1,195 @@
+//
+//  HMACAuthTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "HMACAuthTests.h"
+
+#include <atomic>
+#include <thread>
+
+#include <HMACAuth.h>
+#include <NLPacket.h>
+
+QTEST_MAIN(HMACAuthTests)
+
+namespace {
+
+// reference key 00 01 02 ... 0f from the SipHash paper
+QByteArray referenceKey() {
+    QByteArray key;
+    for (char i = 0; i < 16; ++i) {
+        key.append(i);
+    }
+    return key;
+}
+
+QByteArray referenceMessage(int length) {
+    QByteArray message;
+    for (int i = 0; i < length; ++i) {
+        message.append((char)i);
+    }
+    return message;
+}
+
+QByteArray toByteArray(const HMACAuth::HMACHash& hash) {
+    return QByteArray((const char*)hash.data(), (int)hash.size());
+}
+
+}
+
+void HMACAuthTests::sipHashKnownAnswer() {
+    HMACAuth auth(HMACAuth::SIPHASH);
+    QByteArray key = referenceKey();
+    QVERIFY(auth.setKey(key.constData(), key.size()));
+
+    // 128-bit output vectors from the SipHash reference implementation
+    const std::vector<std::pair<int, QByteArray>> VECTORS {
+        { 0, "a3817f04ba25a8e66df67214c7550293" },
+        { 1, "da87c1d86b99af44347659119b22fc45" },
+        { 15, "5493e99933b0a8117e08ec0f97cfc3d9" },
+        { 63, "5150d1772f50834a503e069a973fbd7c" }
+    };
+
+    for (const auto& vector : VECTORS) {
+        QByteArray message = referenceMessage(vector.first);
+        HMACAuth::HMACHash hash;
+        QVERIFY(auth.calculateHash(hash, message.constData(), message.size()));
+        QCOMPARE(toByteArray(hash).toHex(), vector.second);
+    }
+}
+
+void HMACAuthTests::sipHashIncremental() {
+    HMACAuth auth(HMACAuth::SIPHASH);
+    QVERIFY(auth.setKey(QUuid::createUuid()));
+
+    QByteArray message = referenceMessage(100);
+    HMACAuth::HMACHash oneShot;
+    QVERIFY(auth.calculateHash(oneShot, message.constData(), message.size()));
+
+    QVERIFY(auth.addData(message.constData(), 37));
+    QVERIFY(auth.addData(message.constData() + 37, message.size() - 37));
+    QCOMPARE(toByteArray(auth.result()), toByteArray(oneShot));
+}
+
+void HMACAuthTests::splitHash() {
+    QByteArray message = referenceMessage(100);
+
+    for (auto method : { HMACAuth::MD5, HMACAuth::SIPHASH }) {
+        HMACAuth auth(method);
+        QVERIFY(auth.setKey(QUuid::createUuid()));
+
+        HMACAuth::HMACHash oneShot;
+        QVERIFY(auth.calculateHash(oneShot, message.constData(), message.size()));
+
+        // a packet header and its external payload hash the same as the joined datagram, wherever the split is
+        for (int split = 0; split <= message.size(); ++split) {
+            HMACAuth::HMACHash splitHash;
+            QVERIFY(auth.calculateHash(splitHash, message.constData(), split,
+                                       message.constData() + split, message.size() - split));
+            QCOMPARE(toByteArray(splitHash), toByteArray(oneShot));
+        }
+    }
+}
+
+void HMACAuthTests::methodSwitch() {
+    const QUuid secret = QUuid::createUuid();
+    QByteArray message = referenceMessage(64);
+
+    HMACAuth md5Auth(HMACAuth::MD5);
+    md5Auth.setKey(secret);
+    HMACAuth sipHashAuth(HMACAuth::SIPHASH);
+    sipHashAuth.setKey(secret);
+
+    HMACAuth::HMACHash md5Hash, sipHash;
+    QVERIFY(md5Auth.calculateHash(md5Hash, message.constData(), message.size()));
+    QVERIFY(sipHashAuth.calculateHash(sipHash, message.constData(), message.size()));
+
+    // both methods must fill the same 16 byte field in the NLPacket header
+    QCOMPARE((int)md5Hash.size(), NUM_BYTES_MD5_HASH);
+    QCOMPARE((int)sipHash.size(), NUM_BYTES_MD5_HASH);
+    QVERIFY(md5Hash != sipHash);
+
+    HMACAuth switchingAuth(HMACAuth::MD5);
+    switchingAuth.setKey(secret);
+    switchingAuth.setAuthMethod(HMACAuth::SIPHASH);
+    switchingAuth.setKey(secret);
+
+    HMACAuth::HMACHash switchedHash;
+    QVERIFY(switchingAuth.calculateHash(switchedHash, message.constData(), message.size()));
+    QCOMPARE(toByteArray(switchedHash), toByteArray(sipHash));
+}
+
+void HMACAuthTests::rekeyWhileHashing() {
+    QByteArray message = referenceMessage(64);
+    const QUuid secrets[] { QUuid::createUuid(), QUuid::createUuid() };
+
+    // the hashes of the message under each key
+    QByteArray expectedHashes[2];
+    for (int i = 0; i < 2; ++i) {
+        HMACAuth auth(HMACAuth::SIPHASH);
+        auth.setKey(secrets[i]);
+        HMACAuth::HMACHash hash;
+        QVERIFY(auth.calculateHash(hash, message.constData(), message.size()));
+        expectedHashes[i] = toByteArray(hash);
+    }
+
+    HMACAuth sharedAuth(HMACAuth::SIPHASH);
+    sharedAuth.setKey(secrets[0]);
+
+    // a node being re-keyed while its packets are verified on other threads
+    std::atomic<bool> isDone { false };
+    std::thread rekeyThread([&] {
+        for (int i = 0; !isDone; ++i) {
+            sharedAuth.setKey(secrets[i % 2]);
+        }
+    });
+
+    int numMixedHashes = 0;
+    const int NUM_HASHES = 200000;
+    for (int i = 0; i < NUM_HASHES; ++i) {
+        HMACAuth::HMACHash hash;
+        sharedAuth.calculateHash(hash, message.constData(), message.size());
+        QByteArray hashBytes = toByteArray(hash);
+        if (hashBytes != expectedHashes[0] && hashBytes != expectedHashes[1]) {
+            ++numMixedHashes;
+        }
+    }
+    isDone = true;
+    rekeyThread.join();
+
+    QCOMPARE(numMixedHashes, 0);
+}
+
+void HMACAuthTests::verifyThroughput_data() {
+    QTest::addColumn<int>("authMethod");
+    QTest::addColumn<int>("payloadSize");
+
+    // a small avatar/audio sized payload and a full MTU payload for each method
+    QTest::newRow("HMAC-MD5 small") << (int)HMACAuth::MD5 << 64;
+    QTest::newRow("SipHash small") << (int)HMACAuth::SIPHASH << 64;
+    QTest::newRow("HMAC-MD5 MTU") << (int)HMACAuth::MD5 << NLPacket::maxPayloadSize(PacketType::BulkAvatarData);
+    QTest::newRow("SipHash MTU") << (int)HMACAuth::SIPHASH << NLPacket::maxPayloadSize(PacketType::BulkAvatarData);
+}
+
+void HMACAuthTests::verifyThroughput() {
+    QFETCH(int, authMethod);
+    QFETCH(int, payloadSize);
+
+    HMACAuth auth((HMACAuth::AuthMethod)authMethod);
+    auth.setKey(QUuid::createUuid());
+
+    auto packet = NLPacket::create(PacketType::BulkAvatarData, payloadSize);
+    packet->write(referenceMessage(payloadSize));
+    packet->writeVerificationHash(auth);
+
+    QByteArray headerHash = NLPacket::verificationHashInHeader(*packet);
+    QBENCHMARK {
+        QCOMPARE(NLPacket::hashForPacketAndHMAC(*packet, auth), headerHash);
+    }
+}
@@ -0,0 +1,28 @@
+//
+//  HMACAuthTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_HMACAuthTests_h
+#define hifi_HMACAuthTests_h
+
+#include <QtTest/QtTest>
+
+class HMACAuthTests : public QObject {
+    Q_OBJECT
+private slots:
+    void sipHashKnownAnswer();
+    void sipHashIncremental();
+    void splitHash();
+    void methodSwitch();
+    void rekeyWhileHashing();
+    void verifyThroughput_data();
+    void verifyThroughput();
+};
+
+#endif // hifi_HMACAuthTests_h
@@ -0,0 +1,105 @@
+//
+//  LocalIDTableTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "LocalIDTableTests.h"
+
+#include <vector>
+
+#include <LocalIDTable.h>
+
+QTEST_MAIN(LocalIDTableTests)
+
+using IntTable = LocalIDTable<const int>;
+
+void LocalIDTableTests::storeAndLoad() {
+    IntTable table;
+    int values[] = { 1, 2, 3 };
+
+    QCOMPARE(table.load(0), (const int*)nullptr);
+    QCOMPARE(table.load(65535), (const int*)nullptr);
+
+    table.store(1, &values[0]);
+    table.store(2, &values[1]);
+    table.store(65535, &values[2]);
+
+    QCOMPARE(table.load(1), &values[0]);
+    QCOMPARE(table.load(2), &values[1]);
+    QCOMPARE(table.load(65535), &values[2]);
+    QCOMPARE(table.load(3), (const int*)nullptr);
+
+    // storing over an entry replaces it
+    table.store(1, &values[2]);
+    QCOMPARE(table.load(1), &values[2]);
+}
+
+void LocalIDTableTests::pagesAllocatedOnDemand() {
+    IntTable table;
+    int value = 0;
+
+    QCOMPARE(table.getNumAllocatedPages(), (size_t)0);
+
+    // local IDs in the same page share it
+    table.store(1, &value);
+    table.store(IntTable::PAGE_SIZE - 1, &value);
+    QCOMPARE(table.getNumAllocatedPages(), (size_t)1);
+
+    table.store(IntTable::PAGE_SIZE, &value);
+    table.store(40000, &value);
+    QCOMPARE(table.getNumAllocatedPages(), (size_t)3);
+}
+
+void LocalIDTableTests::clearOnlyExpected() {
+    IntTable table;
+    int oldValue = 0;
+    int newValue = 1;
+    auto noRetire = [](std::atomic<const int*>*) { QFAIL("page should not be retired"); };
+
+    table.store(7, &oldValue);
+    table.store(8, &oldValue);
+
+    // the entry was replaced since, so a clear for the old value leaves it alone
+    table.store(7, &newValue);
+    QVERIFY(!table.clear(7, &oldValue, noRetire));
+    QCOMPARE(table.load(7), &newValue);
+
+    // clearing an entry in a page that was never allocated
+    QVERIFY(!table.clear(30000, &oldValue, noRetire));
+
+    QVERIFY(table.clear(7, &newValue, noRetire));
+    QCOMPARE(table.load(7), (const int*)nullptr);
+    QCOMPARE(table.load(8), &oldValue);
+}
+
+void LocalIDTableTests::emptyPageRetired() {
+    IntTable table;
+    int value = 0;
+    std::vector<std::atomic<const int*>*> retiredPages;
+    auto retire = [&](std::atomic<const int*>* page) { retiredPages.push_back(page); };
+
+    table.store(10, &value);
+    table.store(11, &value);
+    QCOMPARE(table.getNumAllocatedPages(), (size_t)1);
+
+    QVERIFY(table.clear(10, &value, retire));
+    QCOMPARE(retiredPages.size(), (size_t)0);
+
+    QVERIFY(table.clear(11, &value, retire));
+    QCOMPARE(retiredPages.size(), (size_t)1);
+    QCOMPARE(table.getNumAllocatedPages(), (size_t)0);
+    QCOMPARE(table.load(11), (const int*)nullptr);
+
+    // the retired page is no longer reachable from the table, so it is ours to delete
+    delete[] retiredPages[0];
+
+    // and a new page is allocated when the range is used again
+    table.store(12, &value);
+    QCOMPARE(table.load(12), &value);
+    QCOMPARE(table.getNumAllocatedPages(), (size_t)1);
+}
@@ -0,0 +1,25 @@
+//
+//  LocalIDTableTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_LocalIDTableTests_h
+#define hifi_LocalIDTableTests_h
+
+#include <QtTest/QtTest>
+
+class LocalIDTableTests : public QObject {
+    Q_OBJECT
+private slots:
+    void storeAndLoad();
+    void pagesAllocatedOnDemand();
+    void clearOnlyExpected();
+    void emptyPageRetired();
+};
+
+#endif // hifi_LocalIDTableTests_h
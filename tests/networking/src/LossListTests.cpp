@@ -0,0 +1,176 @@
+//
+//  LossListTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "LossListTests.h"
+
+#include <algorithm>
+#include <random>
+#include <set>
+
+#include <udt/LossList.h>
+
+QTEST_MAIN(LossListTests)
+
+using namespace udt;
+
+namespace {
+
+const int NUM_PACKETS = 10000;
+const int NUM_OPERATIONS = 5000;
+
+// returns the offsets (from the first packet) of the packets lost on a link with the given loss rate
+std::vector<int> simulateLoss(float lossRate, unsigned int seed) {
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution isLost(lossRate);
+
+    std::vector<int> lost;
+    for (int i = 0; i < NUM_PACKETS; ++i) {
+        if (isLost(generator)) {
+            lost.push_back(i);
+        }
+    }
+    return lost;
+}
+
+void addLossRates() {
+    QTest::addColumn<float>("lossRate");
+
+    QTest::newRow("5% loss") << 0.05f;
+    QTest::newRow("20% loss") << 0.20f;
+}
+
+}
+
+void LossListTests::matchesReferenceModel_data() {
+    QTest::addColumn<int>("base");
+
+    QTest::newRow("start of range") << 0;
+    QTest::newRow("wraps around") << (SequenceNumber::MAX - NUM_OPERATIONS);
+}
+
+void LossListTests::matchesReferenceModel() {
+    QFETCH(int, base);
+
+    std::mt19937 generator(base);
+    auto randomInt = [&generator](int max) { return std::uniform_int_distribution<int>(0, max)(generator); };
+
+    LossList lossList;
+    std::set<int> model; // offsets from base, which do not wrap around
+    int last = -1;
+
+    auto toSeq = [base](int offset) { return SequenceNumber(base) + offset; };
+
+    for (int i = 0; i < NUM_OPERATIONS; ++i) {
+        switch (randomInt(4)) {
+            case 0: {
+                int start = last + 1 + randomInt(3);
+                int end = start + randomInt(3);
+                lossList.append(toSeq(start), toSeq(end));
+                for (int j = start; j <= end; ++j) {
+                    model.insert(j);
+                }
+                last = end;
+                break;
+            }
+            case 1: {
+                if (last < 0) {
+                    break;
+                }
+                int start = randomInt(last);
+                int end = std::min(last, start + randomInt(8));
+                lossList.insert(toSeq(start), toSeq(end));
+                for (int j = start; j <= end; ++j) {
+                    model.insert(j);
+                }
+                break;
+            }
+            case 2: {
+                int seq = randomInt(last + 1);
+                bool wasLost = model.erase(seq) > 0;
+                QCOMPARE(lossList.remove(toSeq(seq)), wasLost);
+                break;
+            }
+            case 3: {
+                int start = randomInt(last + 1);
+                int end = start + randomInt(16);
+                lossList.remove(toSeq(start), toSeq(end));
+                model.erase(model.lower_bound(start), model.upper_bound(end));
+                break;
+            }
+            default: {
+                if (!model.empty()) {
+                    QCOMPARE(lossList.popFirstSequenceNumber(), toSeq(*model.begin()));
+                    model.erase(model.begin());
+                }
+                break;
+            }
+        }
+
+        QCOMPARE(lossList.getLength(), (int)model.size());
+        QCOMPARE(lossList.isEmpty(), model.empty());
+        if (!model.empty()) {
+            QCOMPARE(lossList.getFirstSequenceNumber(), toSeq(*model.begin()));
+        }
+    }
+
+    // drain what is left in order
+    for (int offset : model) {
+        QCOMPARE(lossList.popFirstSequenceNumber(), toSeq(offset));
+    }
+    QVERIFY(lossList.isEmpty());
+}
+
+void LossListTests::receiverBenchmark_data() {
+    addLossRates();
+}
+
+void LossListTests::receiverBenchmark() {
+    QFETCH(float, lossRate);
+
+    auto lost = simulateLoss(lossRate, NUM_PACKETS);
+    auto retransmitted = lost;
+    std::shuffle(retransmitted.begin(), retransmitted.end(), std::mt19937(NUM_PACKETS));
+
+    QBENCHMARK {
+        LossList lossList;
+        for (int offset : lost) {
+            lossList.append(SequenceNumber(offset));
+        }
+        for (int offset : retransmitted) {
+            lossList.remove(SequenceNumber(offset));
+        }
+        QVERIFY(lossList.isEmpty());
+    }
+}
+
+void LossListTests::senderBenchmark_data() {
+    addLossRates();
+}
+
+void LossListTests::senderBenchmark() {
+    QFETCH(float, lossRate);
+
+    auto lost = simulateLoss(lossRate, NUM_PACKETS);
+
+    QBENCHMARK {
+        LossList naks;
+        // NAKs report each loss twice, the second report arriving after the retransmission started
+        for (int offset : lost) {
+            naks.insert(SequenceNumber(offset), SequenceNumber(offset));
+        }
+        for (int offset : lost) {
+            naks.insert(SequenceNumber(offset), SequenceNumber(offset));
+            naks.popFirstSequenceNumber();
+        }
+        while (!naks.isEmpty()) {
+            naks.popFirstSequenceNumber();
+        }
+    }
+}
@@ -0,0 +1,32 @@
+//
+//  LossListTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_LossListTests_h
+#define hifi_LossListTests_h
+
+#include <QtTest/QtTest>
+
+class LossListTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Random appends, inserts and removes must match a std::set of the lost sequence numbers
+    void matchesReferenceModel_data();
+    void matchesReferenceModel();
+
+    // Receiver side - gaps are appended, retransmissions are removed out of order
+    void receiverBenchmark_data();
+    void receiverBenchmark();
+
+    // Sender side - NAK ranges are inserted, retransmissions pop the front
+    void senderBenchmark_data();
+    void senderBenchmark();
+};
+
+#endif // hifi_LossListTests_h
@@ -0,0 +1,179 @@
+//
+//  MessagesFanOutTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MessagesFanOutTests.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <MessagesFanOut.h>
+
+QTEST_MAIN(MessagesFanOutTests)
+
+Q_DECLARE_METATYPE(MessagesFanOut::DropPolicy)
+
+namespace {
+
+// records what each subscriber was sent, in the order it was sent in
+class SentPayloads {
+public:
+    MessagesFanOut::SendFunction sendFunction() {
+        return [this](const Node& node, const QByteArray& payload) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _payloads[node.getLocalID()].push_back(payload);
+        };
+    }
+
+    std::vector<QByteArray> payloadsFor(const SharedNodePointer& node) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _payloads[node->getLocalID()];
+    }
+
+    size_t count() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t count = 0;
+        for (auto& payloads : _payloads) {
+            count += payloads.second.size();
+        }
+        return count;
+    }
+
+private:
+    std::mutex _mutex;
+    std::unordered_map<Node::LocalID, std::vector<QByteArray>> _payloads;
+};
+
+std::vector<SharedNodePointer> createSubscribers(int numSubscribers) {
+    std::vector<SharedNodePointer> subscribers;
+    for (int i = 0; i < numSubscribers; ++i) {
+        HifiSockAddr socket(QHostAddress::LocalHost, (quint16)(40000 + i));
+        SharedNodePointer node(new Node(QUuid::createUuid(), NodeType::Agent, socket, socket));
+        node->setLocalID((Node::LocalID)(i + 1));
+        node->activatePublicSocket();
+        subscribers.push_back(node);
+    }
+    return subscribers;
+}
+
+std::vector<QByteArray> numberedPayloads(int first, int last) {
+    std::vector<QByteArray> payloads;
+    for (int i = first; i <= last; ++i) {
+        payloads.push_back(QByteArray::number(i));
+    }
+    return payloads;
+}
+
+}
+
+void MessagesFanOutTests::fanOutInOrder() {
+    const int NUM_SUBSCRIBERS = 37;
+    const int NUM_MESSAGES = 200;
+
+    SentPayloads sent;
+    MessagesFanOut fanOut(4, sent.sendFunction());
+    auto subscribers = createSubscribers(NUM_SUBSCRIBERS);
+
+    for (int i = 1; i <= NUM_MESSAGES; ++i) {
+        fanOut.publish(QByteArray::number(i), subscribers);
+    }
+
+    QTRY_COMPARE(sent.count(), (size_t)(NUM_SUBSCRIBERS * NUM_MESSAGES));
+
+    // every subscriber gets every message, in the order they were published in
+    for (auto& subscriber : subscribers) {
+        QVERIFY(sent.payloadsFor(subscriber) == numberedPayloads(1, NUM_MESSAGES));
+    }
+
+    auto stats = fanOut.getStats();
+    QCOMPARE(stats.numSent, (quint64)(NUM_SUBSCRIBERS * NUM_MESSAGES));
+    QCOMPARE(stats.numDelayed, (quint64)0);
+    QCOMPARE(stats.numDropped, (quint64)0);
+}
+
+void MessagesFanOutTests::limiterHoldsBackAndDrops_data() {
+    QTest::addColumn<MessagesFanOut::DropPolicy>("dropPolicy");
+    QTest::addColumn<int>("firstQueued");
+
+    // 10 messages, 2 sent right away as the burst, 3 held back and 5 dropped
+    QTest::newRow("drop oldest") << MessagesFanOut::DropPolicy::DropOldest << 8;
+    QTest::newRow("drop newest") << MessagesFanOut::DropPolicy::DropNewest << 3;
+}
+
+void MessagesFanOutTests::limiterHoldsBackAndDrops() {
+    QFETCH(MessagesFanOut::DropPolicy, dropPolicy);
+    QFETCH(int, firstQueued);
+
+    SentPayloads sent;
+    MessagesFanOut fanOut(1, sent.sendFunction());
+
+    MessagesFanOut::Settings settings;
+    settings.maxMessagesPerSecond = 20.0f;
+    settings.maxBurst = 2;
+    settings.maxQueuedMessages = 3;
+    settings.dropPolicy = dropPolicy;
+    fanOut.setSettings(settings);
+
+    auto subscribers = createSubscribers(1);
+    for (int i = 1; i <= 10; ++i) {
+        fanOut.publish(QByteArray::number(i), subscribers);
+    }
+
+    // the held back messages go out as the subscriber earns room for them, one every 50ms
+    QTRY_COMPARE(sent.count(), (size_t)5);
+
+    auto expected = numberedPayloads(1, 2);
+    auto queued = numberedPayloads(firstQueued, firstQueued + 2);
+    expected.insert(expected.end(), queued.begin(), queued.end());
+    QVERIFY(sent.payloadsFor(subscribers[0]) == expected);
+
+    auto stats = fanOut.getStats();
+    QCOMPARE(stats.numSent, (quint64)5);
+    QCOMPARE(stats.numDelayed, (quint64)(dropPolicy == MessagesFanOut::DropPolicy::DropOldest ? 8 : 3));
+    QCOMPARE(stats.numDropped, (quint64)5);
+    QCOMPARE(stats.numQueued, (quint64)0);
+}
+
+void MessagesFanOutTests::resizeKeepsQueuedMessages() {
+    const int NUM_SUBSCRIBERS = 9;
+    const int NUM_MESSAGES = 20;
+
+    SentPayloads sent;
+    MessagesFanOut fanOut(1, sent.sendFunction());
+
+    // slow enough that most of the messages are still held back when the pool is resized
+    MessagesFanOut::Settings settings;
+    settings.maxMessagesPerSecond = 100.0f;
+    settings.maxBurst = 1;
+    settings.maxQueuedMessages = NUM_MESSAGES;
+    fanOut.setSettings(settings);
+
+    auto subscribers = createSubscribers(NUM_SUBSCRIBERS);
+    for (int i = 1; i <= NUM_MESSAGES / 2; ++i) {
+        fanOut.publish(QByteArray::number(i), subscribers);
+    }
+
+    // the pool is clamped to the number of cores, resize to whatever else it can be
+    fanOut.setNumThreads(fanOut.numThreads() == 1 ? 2 : 1);
+
+    for (int i = NUM_MESSAGES / 2 + 1; i <= NUM_MESSAGES; ++i) {
+        fanOut.publish(QByteArray::number(i), subscribers);
+    }
+
+    QTRY_COMPARE(sent.count(), (size_t)(NUM_SUBSCRIBERS * NUM_MESSAGES));
+
+    for (auto& subscriber : subscribers) {
+        QVERIFY(sent.payloadsFor(subscriber) == numberedPayloads(1, NUM_MESSAGES));
+    }
+
+    auto stats = fanOut.getStats();
+    QCOMPARE(stats.numDropped, (quint64)0);
+    QCOMPARE(stats.numQueued, (quint64)0);
+}
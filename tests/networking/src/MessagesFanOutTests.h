@@ -0,0 +1,25 @@
+//
+//  MessagesFanOutTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MessagesFanOutTests_h
+#define hifi_MessagesFanOutTests_h
+
+#include <QtTest/QtTest>
+
+class MessagesFanOutTests : public QObject {
+    Q_OBJECT
+private slots:
+    void fanOutInOrder();
+    void limiterHoldsBackAndDrops_data();
+    void limiterHoldsBackAndDrops();
+    void resizeKeepsQueuedMessages();
+};
+
+#endif // hifi_MessagesFanOutTests_h
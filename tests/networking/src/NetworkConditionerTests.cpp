@@ -0,0 +1,140 @@
+//
+//  NetworkConditionerTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "NetworkConditionerTests.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include <udt/NetworkConditioner.h>
+
+QTEST_MAIN(NetworkConditionerTests)
+
+using namespace udt;
+
+namespace {
+
+const HifiSockAddr FIRST_PEER { QHostAddress("127.0.0.1"), 40102 };
+const HifiSockAddr SECOND_PEER { QHostAddress("127.0.0.1"), 40103 };
+
+// sends numDatagrams numbered datagrams to peer and fills released with the numbers of the ones that made it through
+void sendNumberedDatagrams(const QString& conditions, const HifiSockAddr& peer, int numDatagrams,
+                           std::vector<int>& released) {
+    std::mutex mutex;
+
+    NetworkConditioner conditioner([&](NetworkConditioner::Datagram datagram) {
+        std::lock_guard<std::mutex> lock(mutex);
+        released.push_back(*reinterpret_cast<int*>(datagram.data.get()));
+    });
+    QVERIFY(conditioner.configure(conditions));
+
+    for (int i = 0; i < numDatagrams; ++i) {
+        if (!conditioner.conditionOutbound(reinterpret_cast<const char*>(&i), sizeof(i), peer)) {
+            std::lock_guard<std::mutex> lock(mutex);
+            released.push_back(i);
+        }
+    }
+
+    auto stats = conditioner.getStats();
+    auto expected = numDatagrams - stats.lost - stats.overflowed;
+    QTRY_VERIFY([&] { std::lock_guard<std::mutex> lock(mutex); return released.size() == expected; }());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::sort(released.begin(), released.end());
+}
+
+}
+
+void NetworkConditionerTests::parseTest() {
+    std::vector<NetworkConditioner::Profile> profiles;
+    quint32 seed = 0;
+    bool hasSeed = false;
+
+    QVERIFY(NetworkConditioner::parse("seed=42;loss=1.5,delay=20,jitter=5;peer=10.0.0.1:40102,direction=out,bandwidth=2000",
+                                      profiles, seed, hasSeed));
+    QVERIFY(hasSeed);
+    QCOMPARE(seed, (quint32)42);
+    QCOMPARE((int)profiles.size(), 2);
+
+    // the profile for a specific peer is matched before the default one
+    QCOMPARE(profiles[0].peerAddress, QHostAddress("10.0.0.1"));
+    QCOMPARE(profiles[0].peerPort, (quint16)40102);
+    QVERIFY(profiles[0].outbound && !profiles[0].inbound);
+    QCOMPARE(profiles[0].bandwidth, 2000);
+    QVERIFY(profiles[1].peerAddress.isNull());
+    QCOMPARE(profiles[1].loss, 0.015);
+    QCOMPARE(profiles[1].delay, 20);
+    QCOMPARE(profiles[1].jitter, 5);
+
+    QVERIFY(profiles[0].matches(NetworkConditioner::Outbound, HifiSockAddr(QHostAddress("10.0.0.1"), 40102)));
+    QVERIFY(!profiles[0].matches(NetworkConditioner::Inbound, HifiSockAddr(QHostAddress("10.0.0.1"), 40102)));
+    QVERIFY(!profiles[0].matches(NetworkConditioner::Outbound, HifiSockAddr(QHostAddress("10.0.0.1"), 40103)));
+
+    QVERIFY(NetworkConditioner::parse("", profiles, seed, hasSeed));
+    QVERIFY(profiles.empty());
+
+    QVERIFY(!NetworkConditioner::parse("loss=150", profiles, seed, hasSeed));
+    QVERIFY(!NetworkConditioner::parse("delay", profiles, seed, hasSeed));
+    QVERIFY(!NetworkConditioner::parse("latency=10", profiles, seed, hasSeed));
+    QVERIFY(!NetworkConditioner::parse("peer=nowhere,loss=1", profiles, seed, hasSeed));
+}
+
+void NetworkConditionerTests::seededLossTest() {
+    const int NUM_DATAGRAMS = 2000;
+    const QString CONDITIONS = "seed=7;peer=127.0.0.1:40102,loss=10";
+
+    std::vector<int> firstRun, secondRun, otherSeed, otherPeer;
+
+    sendNumberedDatagrams(CONDITIONS, FIRST_PEER, NUM_DATAGRAMS, firstRun);
+    sendNumberedDatagrams(CONDITIONS, FIRST_PEER, NUM_DATAGRAMS, secondRun);
+    QVERIFY(firstRun == secondRun);
+
+    // 10% loss, give or take
+    QVERIFY(firstRun.size() > NUM_DATAGRAMS * 0.85 && firstRun.size() < NUM_DATAGRAMS * 0.95);
+
+    sendNumberedDatagrams("seed=8;peer=127.0.0.1:40102,loss=10", FIRST_PEER, NUM_DATAGRAMS, otherSeed);
+    QVERIFY(firstRun != otherSeed);
+
+    // the profile doesn't apply to another port
+    sendNumberedDatagrams(CONDITIONS, SECOND_PEER, NUM_DATAGRAMS, otherPeer);
+    QCOMPARE((int)otherPeer.size(), NUM_DATAGRAMS);
+}
+
+void NetworkConditionerTests::bandwidthTest() {
+    const int DATAGRAM_SIZE = 1000;
+    const int NUM_DATAGRAMS = 100;
+
+    std::mutex mutex;
+    std::vector<std::chrono::steady_clock::time_point> releaseTimes;
+
+    NetworkConditioner conditioner([&](NetworkConditioner::Datagram) {
+        std::lock_guard<std::mutex> lock(mutex);
+        releaseTimes.push_back(std::chrono::steady_clock::now());
+    });
+
+    // 8000 kbps sends a 1000 byte datagram every ms, and 50 ms of queue holds 50 of them
+    QVERIFY(conditioner.configure("bandwidth=8000,queue=50"));
+
+    QByteArray datagram(DATAGRAM_SIZE, 0);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NUM_DATAGRAMS; ++i) {
+        QVERIFY(conditioner.conditionOutbound(datagram.constData(), datagram.size(), FIRST_PEER));
+    }
+
+    auto stats = conditioner.getStats();
+    QVERIFY(stats.overflowed >= 45 && stats.overflowed <= 50);
+
+    auto expected = NUM_DATAGRAMS - stats.overflowed;
+    QTRY_VERIFY([&] { std::lock_guard<std::mutex> lock(mutex); return releaseTimes.size() == expected; }());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(releaseTimes.back() - start).count();
+    QVERIFY(elapsed >= (qint64)expected - 2);
+}
@@ -0,0 +1,26 @@
+//
+//  NetworkConditionerTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_NetworkConditionerTests_h
+#define hifi_NetworkConditionerTests_h
+
+#include <QtTest/QtTest>
+
+class NetworkConditionerTests : public QObject {
+    Q_OBJECT
+private slots:
+    void parseTest();
+    // Test the same seed drops the same datagrams, and only from the peers a profile applies to
+    void seededLossTest();
+    // Test datagrams are paced at the bandwidth cap and dropped once the queue is full
+    void bandwidthTest();
+};
+
+#endif // hifi_NetworkConditionerTests_h
@@ -0,0 +1,100 @@
+//
+//  PacketListTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketListTests.h"
+
+#include <udt/Packet.h>
+#include <udt/PacketList.h>
+
+QTEST_MAIN(PacketListTests)
+
+using namespace udt;
+
+namespace {
+
+const int BENCHMARK_BUFFER_SIZE = 4 * 1024 * 1024;
+
+QByteArray createBuffer(int size) {
+    QByteArray buffer(size, 0);
+    for (int i = 0; i < size; ++i) {
+        buffer[i] = (char)(i % 251);
+    }
+    return buffer;
+}
+
+}
+
+void PacketListTests::writeExternalTest() {
+    auto packetList = PacketList::create(PacketType::Unknown, QByteArray(), true, true);
+    QByteArray buffer = createBuffer(10 * packetList->getMaxSegmentSize() + 17);
+
+    QByteArray prefix("prefix");
+    QByteArray suffix("suffix");
+
+    packetList->write(prefix);
+    QCOMPARE(packetList->writeExternal(buffer), (qint64)buffer.size());
+    packetList->write(suffix);
+    packetList->closeCurrentPacket();
+
+    // the prefix shares its packet with the start of the buffer, and the suffix goes in a packet of its own
+    QCOMPARE(packetList->getNumPackets(), (size_t)12);
+    QCOMPARE(packetList->getMessageSize(), (size_t)(prefix.size() + buffer.size() + suffix.size()));
+    QCOMPARE(packetList->getMessage(), prefix + buffer + suffix);
+}
+
+void PacketListTests::writeExternalUnorderedTest() {
+    auto packetList = PacketList::create(PacketType::Unknown);
+    QByteArray buffer = createBuffer(packetList->getMaxSegmentSize() / 2 + 1);
+
+    QCOMPARE(packetList->writeExternal(buffer), (qint64)buffer.size());
+    QCOMPARE(packetList->writeExternal(buffer), (qint64)buffer.size());
+    packetList->closeCurrentPacket();
+
+    QCOMPARE(packetList->getNumPackets(), (size_t)2);
+    QCOMPARE(packetList->getMessage(), buffer + buffer);
+}
+
+void PacketListTests::copyExternalPayloadTest() {
+    QByteArray buffer = createBuffer(100);
+
+    auto packet = Packet::create();
+    packet->write("abc", 3);
+    packet->setExternalPayload(buffer, 10, 50);
+
+    QVERIFY(packet->hasExternalPayload());
+    QCOMPARE(packet->getPayloadSize(), (qint64)3);
+    QCOMPARE(packet->bytesAvailableForWrite(), (qint64)0);
+
+    auto copy = Packet::createCopy(*packet);
+
+    QVERIFY(!copy->hasExternalPayload());
+    QCOMPARE(copy->getWireSize(), packet->getWireSize());
+    QCOMPARE(QByteArray(copy->getPayload(), (int)copy->getPayloadSize()), QByteArray("abc") + buffer.mid(10, 50));
+}
+
+void PacketListTests::writeBenchmark() {
+    QByteArray buffer = createBuffer(BENCHMARK_BUFFER_SIZE);
+
+    QBENCHMARK {
+        auto packetList = PacketList::create(PacketType::Unknown, QByteArray(), true, true);
+        packetList->write(buffer);
+        packetList->closeCurrentPacket();
+    }
+}
+
+void PacketListTests::writeExternalBenchmark() {
+    QByteArray buffer = createBuffer(BENCHMARK_BUFFER_SIZE);
+
+    QBENCHMARK {
+        auto packetList = PacketList::create(PacketType::Unknown, QByteArray(), true, true);
+        packetList->writeExternal(buffer);
+        packetList->closeCurrentPacket();
+    }
+}
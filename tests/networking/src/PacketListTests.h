@@ -0,0 +1,31 @@
+//
+//  PacketListTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketListTests_h
+#define hifi_PacketListTests_h
+
+#include <QtTest/QtTest>
+
+class PacketListTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test an external buffer is split across packets and reassembles into the same message
+    void writeExternalTest();
+    // Test an unordered list never splits an external buffer
+    void writeExternalUnorderedTest();
+    // Test copying a packet pulls its external payload into the copy
+    void copyExternalPayloadTest();
+
+    // Benchmark filling a list with a large buffer, by copy and by reference
+    void writeBenchmark();
+    void writeExternalBenchmark();
+};
+
+#endif // hifi_PacketListTests_h
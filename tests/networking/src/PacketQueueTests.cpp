@@ -0,0 +1,116 @@
+//
+//  PacketQueueTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "PacketQueueTests.h"
+
+#include <udt/PacketList.h>
+#include <udt/PacketQueue.h>
+
+QTEST_MAIN(PacketQueueTests)
+
+using namespace udt;
+
+namespace {
+
+// every packet of the list carries `marker` as the first byte of its payload
+std::unique_ptr<PacketList> createPacketList(char marker, int numPackets) {
+    auto packetList = PacketList::create(PacketType::Unknown);
+    QByteArray payload(packetList->getMaxSegmentSize(), marker);
+    for (int i = 0; i < numPackets; ++i) {
+        packetList->startSegment();
+        packetList->write(payload);
+        packetList->endSegment();
+    }
+    packetList->closeCurrentPacket();
+    return packetList;
+}
+
+char markerOf(const Packet& packet) {
+    return packet.getPayload()[0];
+}
+
+}
+
+void PacketQueueTests::roundRobinTest() {
+    PacketQueue queue;
+    QVERIFY(queue.isEmpty());
+
+    const int NUM_LIST_PACKETS = 4;
+    queue.queuePacketList(createPacketList('a', NUM_LIST_PACKETS));
+    queue.queuePacketList(createPacketList('b', NUM_LIST_PACKETS));
+
+    auto mainPacket = Packet::create();
+    mainPacket->write("m", 1);
+    queue.queuePacket(std::move(mainPacket));
+
+    QString order;
+    while (!queue.isEmpty()) {
+        auto packet = queue.takePacket();
+        QVERIFY(packet);
+        order.append(markerOf(*packet));
+    }
+
+    // the main channel goes first, then the lists alternate until drained
+    QCOMPARE(order, QString("mabababab"));
+    QVERIFY(!queue.takePacket());
+}
+
+void PacketQueueTests::takeMainChannelPacketIfTest() {
+    PacketQueue queue;
+    QVERIFY(queue.isMainChannelEmpty());
+
+    auto isSmall = [](const Packet& packet) {
+        return packet.getPayloadSize() <= 1;
+    };
+
+    queue.queuePacketList(createPacketList('a', 1));
+    QVERIFY(queue.isMainChannelEmpty());
+    QVERIFY(!queue.takeMainChannelPacketIf(isSmall));
+
+    auto smallPacket = Packet::create();
+    smallPacket->write("s", 1);
+    queue.queuePacket(std::move(smallPacket));
+
+    auto bigPacket = Packet::create();
+    bigPacket->write("bb", 2);
+    queue.queuePacket(std::move(bigPacket));
+
+    auto packet = queue.takeMainChannelPacketIf(isSmall);
+    QVERIFY(packet);
+    QCOMPARE(markerOf(*packet), 's');
+
+    // the big packet is now at the front and holds back the rest of the main channel
+    QVERIFY(!queue.isMainChannelEmpty());
+    QVERIFY(!queue.takeMainChannelPacketIf(isSmall));
+
+    QString order;
+    while (!queue.isEmpty()) {
+        order.append(markerOf(*queue.takePacket()));
+    }
+    QCOMPARE(order, QString("ba"));
+}
+
+void PacketQueueTests::packetListBenchmark() {
+    const int NUM_LISTS = 8;
+    const int NUM_LIST_PACKETS = 256;
+
+    QBENCHMARK {
+        PacketQueue queue;
+        for (int i = 0; i < NUM_LISTS; ++i) {
+            queue.queuePacketList(createPacketList('a' + i, NUM_LIST_PACKETS));
+        }
+
+        int taken = 0;
+        while (queue.takePacket()) {
+            ++taken;
+        }
+        QCOMPARE(taken, NUM_LISTS * NUM_LIST_PACKETS);
+    }
+}
@@ -0,0 +1,29 @@
+//
+//  PacketQueueTests.h
+//  tests/networking/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_PacketQueueTests_h
+#define hifi_PacketQueueTests_h
+
+#include <QtTest/QtTest>
+
+class PacketQueueTests : public QObject {
+    Q_OBJECT
+private slots:
+    // Test packets are handed out round robin between the main channel and packet lists
+    void roundRobinTest();
+
+    // Test only the packet at the front of the main channel is taken for coalescing, and only if it matches
+    void takeMainChannelPacketIfTest();
+
+    // Benchmark queueing and draining large packet lists, as done for asset transfers
+    void packetListBenchmark();
+};
+
+#endif // hifi_PacketQueueTests_h
@@ -0,0 +1,160 @@
+//
+//  EntityDeltaBaselineTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityDeltaBaselineTests.h"
+
+#include <EntityDeltaBaseline.h>
+#include <NumericalConstants.h>
+
+#include "EntityTestUtils.h"
+
+QTEST_MAIN(EntityDeltaBaselineTests)
+
+namespace {
+
+const QString USER_DATA = "{ \"public\": true }";
+const uint64_t START_TIME = 1000 * USECS_PER_SECOND;
+
+// An entity-server sending an entity to one viewer with unreliable packets, as its traversals do, and what the viewer
+// ends up with: each packet it receives overwrites the properties the packet carries.
+class Viewer {
+public:
+    Viewer(const EntityItemPointer& entity, bool sendsNacks) : _entity(entity), _sendsNacks(sendsNacks) {}
+
+    // returns whether all of the properties were sent
+    bool send(uint64_t now, bool isDropped = false) {
+        bool isNewBaseline = false;
+        quint64 deltaVersion = _baseline.getDeltaVersion(*_entity, now, _sendsNacks, isNewBaseline);
+
+        QByteArray data = encodeEntity(_entity, false, deltaVersion);
+        if (isNewBaseline) {
+            _baseline.baselineSent(_entity->getPropertiesVersion(), now, false);
+        }
+
+        if (!isDropped) {
+            EntityItemProperties received;
+            received.constructFromBuffer((const unsigned char*)data.constData(), data.size());
+            _properties.merge(received);
+        }
+
+        return deltaVersion == 0;
+    }
+
+    void rename(const QString& name) {
+        EntityItemProperties properties;
+        properties.setName(name);
+        _entity->setProperties(properties);
+    }
+
+    EntityDeltaBaseline& getBaseline() { return _baseline; }
+    const EntityItemProperties& getProperties() const { return _properties; }
+
+private:
+    EntityItemPointer _entity;
+    bool _sendsNacks;
+    EntityDeltaBaseline _baseline;
+    EntityItemProperties _properties;
+};
+
+EntityItemPointer createEntity() {
+    EntityItemProperties properties;
+    properties.setName("box");
+    properties.setUserData(USER_DATA);
+    properties.setPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+    return createBox(properties);
+}
+
+}
+
+void EntityDeltaBaselineTests::initTestCase() {
+    setUpEntityServerDependencies();
+}
+
+void EntityDeltaBaselineTests::noDeltasToViewerThatDoesntNack() {
+    Viewer viewer(createEntity(), false);
+    uint64_t now = START_TIME;
+
+    // the first packet is lost, and there is no NACK to have it resent
+    QVERIFY(viewer.send(now, true));
+
+    // so every later update carries all of the properties, and the first one that gets through has everything
+    for (int i = 1; i <= 10; ++i) {
+        now += EntityDeltaBaseline::SETTLE_PERIOD;
+        viewer.rename(QString("box %1").arg(i));
+        QVERIFY(viewer.send(now));
+
+        QCOMPARE(viewer.getProperties().getName(), QString("box %1").arg(i));
+        QCOMPARE(viewer.getProperties().getUserData(), USER_DATA);
+        QVERIFY(viewer.getProperties().getPosition() == glm::vec3(1.0f, 2.0f, 3.0f));
+    }
+}
+
+void EntityDeltaBaselineTests::lostBaselineIsRefreshed() {
+    auto entity = createEntity();
+    Viewer viewer(entity, true);
+    uint64_t baselineTime = START_TIME;
+
+    // the baseline is lost, and so is the NACK that would have had it resent
+    QVERIFY(viewer.send(baselineTime, true));
+
+    // the updates sent while the baseline settles are whole
+    uint64_t now = baselineTime + EntityDeltaBaseline::SETTLE_PERIOD / 2;
+    viewer.rename("settling");
+    QVERIFY(viewer.send(now, true));
+
+    // the viewer is left with the defaults of what the deltas don't carry until the baseline is refreshed
+    now = baselineTime + EntityDeltaBaseline::SETTLE_PERIOD + 1;
+    viewer.rename("delta");
+    QVERIFY(!viewer.send(now));
+    QCOMPARE(viewer.getProperties().getName(), QString("delta"));
+    QVERIFY(viewer.getProperties().getUserData() != USER_DATA);
+
+    // then the entity is sent whole again, which is the new baseline
+    now = baselineTime + EntityDeltaBaseline::REFRESH_PERIOD + 1;
+    viewer.rename("refreshed");
+    QVERIFY(viewer.send(now));
+    QCOMPARE(viewer.getBaseline().getVersion(), entity->getPropertiesVersion());
+    QCOMPARE(viewer.getProperties().getName(), QString("refreshed"));
+    QCOMPARE(viewer.getProperties().getUserData(), USER_DATA);
+    QVERIFY(viewer.getProperties().getPosition() == glm::vec3(1.0f, 2.0f, 3.0f));
+
+    // and the deltas resume once it settled
+    now += EntityDeltaBaseline::SETTLE_PERIOD + 1;
+    viewer.rename("delta again");
+    QVERIFY(!viewer.send(now));
+    QCOMPARE(viewer.getProperties().getName(), QString("delta again"));
+    QCOMPARE(viewer.getProperties().getUserData(), USER_DATA);
+}
+
+void EntityDeltaBaselineTests::reliableBaselineIsKept() {
+    auto entity = createEntity();
+    Viewer viewer(entity, false);
+
+    // as the initial scene is sent, reliably
+    viewer.getBaseline().baselineSent(entity->getPropertiesVersion(), START_TIME, true);
+
+    uint64_t now = START_TIME + EntityDeltaBaseline::SETTLE_PERIOD / 2;
+    viewer.rename("settling");
+    QVERIFY(viewer.send(now));
+
+    // the viewer doesn't NACK, but the baseline can't have been lost
+    now = START_TIME + EntityDeltaBaseline::SETTLE_PERIOD + 1;
+    viewer.rename("delta");
+    QVERIFY(!viewer.send(now));
+
+    now = START_TIME + 10 * EntityDeltaBaseline::REFRESH_PERIOD;
+    viewer.rename("much later");
+    QVERIFY(!viewer.send(now));
+    QCOMPARE(viewer.getProperties().getName(), QString("much later"));
+
+    // unless the entity is changed entirely
+    entity->markAsChangedOnServer();
+    QVERIFY(viewer.send(now + 1));
+}
@@ -0,0 +1,26 @@
+//
+//  EntityDeltaBaselineTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityDeltaBaselineTests_h
+#define hifi_EntityDeltaBaselineTests_h
+
+#include <QtTest/QtTest>
+
+class EntityDeltaBaselineTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void noDeltasToViewerThatDoesntNack();
+    void lostBaselineIsRefreshed();
+    void reliableBaselineIsKept();
+};
+
+#endif // hifi_EntityDeltaBaselineTests_h
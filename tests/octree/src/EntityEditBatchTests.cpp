@@ -0,0 +1,160 @@
+//
+//  EntityEditBatchTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityEditBatchTests.h"
+
+#include <Node.h>
+#include <ReceivedMessage.h>
+
+#include "EntityTestUtils.h"
+
+QTEST_MAIN(EntityEditBatchTests)
+
+static const glm::vec3 NEAR_POSITION { 1.0f, 1.0f, 1.0f };
+static const glm::vec3 FAR_POSITION { 1000.0f, 1000.0f, 1000.0f };
+
+// counts the edits that go through the edit filter, which lets them all through unchanged
+class FilterCountingTree : public EntityTree {
+public:
+    mutable int numFiltered { 0 };
+
+protected:
+    bool filterProperties(const EntityItemPointer& existingEntity, EntityItemProperties& propertiesIn,
+                          EntityItemProperties& propertiesOut, bool& wasChanged, FilterType filterType) const override {
+        ++numFiltered;
+        return true;
+    }
+};
+
+static EntityItemPointer addBox(const EntityTreePointer& tree, const glm::vec3& position) {
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setPosition(position);
+    properties.setDimensions(glm::vec3(1.0f));
+
+    EntityItemPointer entity;
+    tree->withWriteLock([&] {
+        entity = tree->addEntity(EntityItemID(QUuid::createUuid()), properties);
+    });
+    return entity;
+}
+
+// what an interface sends along with a new position
+static void moveBox(const EntityTreePointer& tree, const EntityItemPointer& entity, const glm::vec3& position) {
+    EntityItemProperties properties;
+    properties.setPosition(position);
+    properties.setQueryAACube(AACube(position - glm::vec3(1.0f), 2.0f));
+    tree->updateEntity(entity->getEntityItemID(), properties);
+}
+
+static bool isInItsElement(const EntityItemPointer& entity) {
+    auto element = entity->getElement();
+    return element && element->getAACube().contains(entity->getQueryAACube()) &&
+        element->getEntityWithEntityItemID(entity->getEntityItemID()) == entity;
+}
+
+static bool isInAnyElement(const EntityTreePointer& tree, const EntityItemID& id) {
+    bool found = false;
+    tree->withReadLock([&] {
+        tree->recurseTreeWithOperation([&](const OctreeElementPointer& element, void*) {
+            auto entityTreeElement = std::static_pointer_cast<EntityTreeElement>(element);
+            found = found || entityTreeElement->getEntityWithEntityItemID(id);
+            return !found;
+        });
+    });
+    return found;
+}
+
+void EntityEditBatchTests::initTestCase() {
+    setUpEntityServerDependencies();
+}
+
+void EntityEditBatchTests::movesWaitForEndOfBatch() {
+    auto tree = createServerTree();
+    auto entity = addBox(tree, NEAR_POSITION);
+    QVERIFY(entity);
+    QVERIFY(isInItsElement(entity));
+
+    bool movedDuringBatch = true;
+    tree->withWriteLock([&] {
+        tree->beginEditBatch();
+        moveBox(tree, entity, FAR_POSITION);
+        movedDuringBatch = isInItsElement(entity);
+        tree->endEditBatch();
+    });
+
+    QVERIFY(!movedDuringBatch);
+    QVERIFY(isInItsElement(entity));
+}
+
+void EntityEditBatchTests::eraseAmongEdits() {
+    auto tree = createServerTree();
+    auto moved = addBox(tree, NEAR_POSITION);
+    auto erased = addBox(tree, NEAR_POSITION);
+    auto movedAfterErase = addBox(tree, NEAR_POSITION);
+    QVERIFY(moved && erased && movedAfterErase);
+
+    // the order the inbound packet processor applies them in: the edits of a batch, an erase, then more edits
+    tree->withWriteLock([&] {
+        tree->beginEditBatch();
+        moveBox(tree, moved, FAR_POSITION);
+        moveBox(tree, erased, FAR_POSITION);
+        tree->deleteEntity(erased->getEntityItemID(), true);
+        moveBox(tree, movedAfterErase, -FAR_POSITION);
+        tree->endEditBatch();
+    });
+
+    QVERIFY(!tree->findEntityByEntityItemID(erased->getEntityItemID()));
+    QVERIFY(!erased->getElement());
+    QVERIFY(!isInAnyElement(tree, erased->getEntityItemID()));
+
+    QVERIFY(isInItsElement(moved));
+    QVERIFY(isInItsElement(movedAfterErase));
+}
+
+void EntityEditBatchTests::moveIsFilteredOnce() {
+    auto tree = std::make_shared<FilterCountingTree>();
+    tree->createRootElement();
+    tree->setIsServer(true);
+    auto entity = addBox(tree, NEAR_POSITION);
+    QVERIFY(entity);
+
+    // an edit from an interface that isn't allowed to bypass the filter
+    SharedNodePointer sender { new Node(QUuid::createUuid(), NodeType::Agent, HifiSockAddr(), HifiSockAddr()) };
+    QVERIFY(!sender->isAllowedEditor());
+
+    EntityItemProperties properties;
+    properties.setPosition(FAR_POSITION);
+    properties.setQueryAACube(AACube(FAR_POSITION - glm::vec3(1.0f), 2.0f));
+    properties.setLastEdited(usecTimestampNow());
+    QByteArray buffer(NLPacket::maxPayloadSize(PacketType::EntityEdit), 0);
+    EntityPropertyFlags didntFitProperties;
+    QCOMPARE(EntityItemProperties::encodeEntityEditPacket(PacketType::EntityEdit, entity->getEntityItemID(), properties,
+                                                          buffer, properties.getChangedProperties(), didntFitProperties),
+             OctreeElement::COMPLETED);
+    ReceivedMessage message(buffer, PacketType::EntityEdit, versionForPacketType(PacketType::EntityEdit), HifiSockAddr());
+
+    // what the inbound packet processor does with it: the move crosses elements, so it can't be applied in place
+    auto edit = tree->decodeEditPacketData(message, reinterpret_cast<const unsigned char*>(buffer.constData()),
+                                           buffer.size(), sender);
+    QVERIFY(edit);
+    bool appliedInPlace = true;
+    tree->withReadLock([&] {
+        appliedInPlace = tree->processDecodedEditInPlace(*edit, sender);
+    });
+    QVERIFY(!appliedInPlace);
+    tree->withWriteLock([&] {
+        tree->processDecodedEdit(*edit, sender);
+    });
+
+    QCOMPARE(tree->numFiltered, 1);
+    QCOMPARE(entity->getWorldPosition(), FAR_POSITION);
+    QVERIFY(isInItsElement(entity));
+}
@@ -0,0 +1,26 @@
+//
+//  EntityEditBatchTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityEditBatchTests_h
+#define hifi_EntityEditBatchTests_h
+
+#include <QtTest/QtTest>
+
+class EntityEditBatchTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void movesWaitForEndOfBatch();
+    void eraseAmongEdits();
+    void moveIsFilteredOnce();
+};
+
+#endif // hifi_EntityEditBatchTests_h
@@ -0,0 +1,70 @@
+//
+//  EntityEncodeCacheTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityEncodeCacheTests.h"
+
+#include "EntityTestUtils.h"
+
+QTEST_MAIN(EntityEncodeCacheTests)
+
+static EntityItemPointer createBoxWithUserData() {
+    EntityItemProperties properties;
+    properties.setName("box");
+    properties.setUserData("{ \"public\": true }");
+    properties.setPrivateUserData("{ \"private\": true }");
+    return createBox(properties);
+}
+
+void EntityEncodeCacheTests::initTestCase() {
+    EntityItem::setEncodeCacheEnabled(true);
+}
+
+void EntityEncodeCacheTests::copiesSameEncoding() {
+    auto entity = createBoxWithUserData();
+
+    QByteArray first = encodeEntity(entity);
+    QVERIFY(!first.isEmpty());
+
+    quint64 hits = EntityItem::getEncodeCacheHits();
+    QByteArray second = encodeEntity(entity);
+
+    QCOMPARE(EntityItem::getEncodeCacheHits(), hits + 1);
+    QCOMPARE(second, first);
+}
+
+void EntityEncodeCacheTests::encodesAgainAfterEdit() {
+    auto entity = createBoxWithUserData();
+    QByteArray before = encodeEntity(entity);
+
+    EntityItemProperties properties;
+    properties.setName("renamed box");
+    entity->setProperties(properties);
+
+    quint64 hits = EntityItem::getEncodeCacheHits();
+    QByteArray after = encodeEntity(entity);
+
+    QCOMPARE(EntityItem::getEncodeCacheHits(), hits);
+    QVERIFY(after != before);
+    QVERIFY(after.contains("renamed box"));
+}
+
+void EntityEncodeCacheTests::keepsPrivateUserDataApart() {
+    auto entity = createBoxWithUserData();
+
+    QByteArray withPrivateUserData = encodeEntity(entity, true);
+    QByteArray withoutPrivateUserData = encodeEntity(entity, false);
+
+    QVERIFY(withPrivateUserData.contains("\"private\""));
+    QVERIFY(!withoutPrivateUserData.contains("\"private\""));
+
+    // and both are copied from then on
+    QCOMPARE(encodeEntity(entity, true), withPrivateUserData);
+    QCOMPARE(encodeEntity(entity, false), withoutPrivateUserData);
+}
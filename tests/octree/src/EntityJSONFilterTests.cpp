@@ -0,0 +1,69 @@
+//
+//  EntityJSONFilterTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityJSONFilterTests.h"
+
+#include <EntityJSONFilter.h>
+#include <ZoneEntityItem.h>
+
+#include "EntityTestUtils.h"
+
+QTEST_MAIN(EntityJSONFilterTests)
+
+static EntityItemPointer createZone() {
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Zone);
+    return ZoneEntityItem::factory(EntityItemID(QUuid::createUuid()), properties);
+}
+
+void EntityJSONFilterTests::emptyFilterMatchesEverything() {
+    EntityJSONFilter filter;
+    QVERIFY(filter.isEmpty());
+    QVERIFY(createBox()->matchesJSONFilters(filter));
+
+    // a filter with nothing that is understood still isn't empty, but matches everything
+    EntityJSONFilter flagsOnly(QJsonObject { { "flags", QJsonObject { { "includeAncestors", true } } } });
+    QVERIFY(!flagsOnly.isEmpty());
+    QCOMPARE(flagsOnly.getTest(), EntityJSONFilter::Test::None);
+    QVERIFY(createBox()->matchesJSONFilters(flagsOnly));
+}
+
+void EntityJSONFilterTests::serverScriptsFilter() {
+    EntityJSONFilter filter(QJsonObject { { "serverScripts", "+" } });
+    QCOMPARE(filter.getTest(), EntityJSONFilter::Test::NonDefaultServerScripts);
+
+    auto entity = createBox();
+    QVERIFY(!entity->matchesJSONFilters(filter));
+
+    entity->setServerScripts("http://example.com/script.js");
+    QVERIFY(entity->matchesJSONFilters(filter));
+}
+
+void EntityJSONFilterTests::typeFilter() {
+    EntityJSONFilter boxes(QJsonObject { { "type", "Box" } });
+    QCOMPARE(boxes.getTest(), EntityJSONFilter::Test::Type);
+    QVERIFY(createBox()->matchesJSONFilters(boxes));
+    QVERIFY(!createZone()->matchesJSONFilters(boxes));
+
+    EntityJSONFilter unknownType(QJsonObject { { "type", "NotAType" } });
+    QCOMPARE(unknownType.getTest(), EntityJSONFilter::Test::Nothing);
+    QVERIFY(!createBox()->matchesJSONFilters(unknownType));
+}
+
+void EntityJSONFilterTests::avatarPriorityZones() {
+    EntityJSONFilter filter(QJsonObject { { "avatarPriority", true }, { "type", "Box" } });
+    QVERIFY(filter.wantsAvatarPriorityZones());
+
+    auto zone = std::static_pointer_cast<ZoneEntityItem>(createZone());
+    QVERIFY(!zone->matchesJSONFilters(filter));
+
+    zone->setAvatarPriority(COMPONENT_MODE_ENABLED);
+    QVERIFY(zone->matchesJSONFilters(filter));
+}
@@ -0,0 +1,26 @@
+//
+//  EntityJSONFilterTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityJSONFilterTests_h
+#define hifi_EntityJSONFilterTests_h
+
+#include <QtTest/QtTest>
+
+class EntityJSONFilterTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void emptyFilterMatchesEverything();
+    void serverScriptsFilter();
+    void typeFilter();
+    void avatarPriorityZones();
+};
+
+#endif // hifi_EntityJSONFilterTests_h
@@ -0,0 +1,217 @@
+//
+//  EntityJournalTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityJournalTests.h"
+
+#include <QtCore/QTemporaryDir>
+
+#include <EntityJournal.h>
+#include <SimpleEntitySimulation.h>
+
+#include "EntityTestUtils.h"
+
+QTEST_MAIN(EntityJournalTests)
+
+static EntityItemID addBox(const EntityTreePointer& tree, const QString& name) {
+    EntityItemID id(QUuid::createUuid());
+    tree->withWriteLock([&] {
+        EntityItemProperties properties;
+        properties.setType(EntityTypes::Box);
+        properties.setName(name);
+        tree->addEntity(id, properties);
+    });
+    return id;
+}
+
+static void renameBox(const EntityTreePointer& tree, const EntityItemID& id, const QString& name) {
+    tree->withWriteLock([&] {
+        EntityItemProperties properties;
+        properties.setName(name);
+        tree->updateEntity(id, properties);
+    });
+}
+
+static EntityTreePointer loadTree(const QString& fileName) {
+    auto tree = createServerTree();
+    tree->withWriteLock([&] {
+        tree->readFromBinaryFile(fileName);
+    });
+    return tree;
+}
+
+void EntityJournalTests::initTestCase() {
+    setUpEntityServerDependencies();
+}
+
+void EntityJournalTests::changesAreReplayed() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+
+    auto tree = createServerTree();
+    auto editedID = addBox(tree, "edited");
+    auto deletedID = addBox(tree, "deleted");
+    tree->setOctreeVersionInfo(QUuid::createUuid(), 1);
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+
+    renameBox(tree, editedID, "renamed");
+    tree->deleteEntity(deletedID, true);
+    auto addedID = addBox(tree, "added");
+    tree->incrementPersistDataVersion();
+
+    qint64 journalSize;
+    QVERIFY(tree->writeToBinaryJournal(journalSize));
+    QCOMPARE(journalSize, QFileInfo(EntityJournalWriter::fileNameForSnapshot(fileName)).size());
+
+    auto loadedTree = loadTree(fileName);
+    auto edited = loadedTree->findEntityByID(editedID);
+    QVERIFY(edited);
+    QCOMPARE(edited->getName(), QString("renamed"));
+    QVERIFY(!loadedTree->findEntityByID(deletedID));
+    auto added = loadedTree->findEntityByID(addedID);
+    QVERIFY(added);
+    QCOMPARE(added->getName(), QString("added"));
+
+    QUuid id;
+    int64_t dataVersion;
+    QVERIFY(loadedTree->readBinaryFileInfo(fileName, id, dataVersion));
+    QCOMPARE(dataVersion, (int64_t)2);
+
+    // the loaded tree goes on with the same journal
+    renameBox(loadedTree, addedID, "renamed again");
+    QVERIFY(loadedTree->writeToBinaryJournal(journalSize));
+    auto reloadedTree = loadTree(fileName);
+    QCOMPARE(reloadedTree->findEntityByID(addedID)->getName(), QString("renamed again"));
+    QCOMPARE(reloadedTree->findEntityByID(editedID)->getName(), QString("renamed"));
+}
+
+void EntityJournalTests::incompleteRecordIsIgnored() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+
+    auto tree = createServerTree();
+    auto firstID = addBox(tree, "first");
+    auto secondID = addBox(tree, "second");
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+
+    qint64 journalSize;
+    renameBox(tree, firstID, "renamed first");
+    QVERIFY(tree->writeToBinaryJournal(journalSize));
+    renameBox(tree, secondID, "renamed second");
+    QVERIFY(tree->writeToBinaryJournal(journalSize));
+
+    // as if the server stopped while the last record was written
+    QFile journal(EntityJournalWriter::fileNameForSnapshot(fileName));
+    QVERIFY(journal.resize(journal.size() - 1));
+
+    auto loadedTree = loadTree(fileName);
+    QCOMPARE(loadedTree->findEntityByID(firstID)->getName(), QString("renamed first"));
+    QCOMPARE(loadedTree->findEntityByID(secondID)->getName(), QString("second"));
+}
+
+void EntityJournalTests::staleJournalIsIgnored() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+    QString journalFileName = EntityJournalWriter::fileNameForSnapshot(fileName);
+    QString oldJournalFileName = dir.filePath("old.journal");
+
+    auto tree = createServerTree();
+    auto boxID = addBox(tree, "box");
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+
+    qint64 journalSize;
+    renameBox(tree, boxID, "renamed");
+    QVERIFY(tree->writeToBinaryJournal(journalSize));
+    QVERIFY(QFile::copy(journalFileName, oldJournalFileName));
+
+    // a journal that follows an older snapshot isn't replayed over a newer one
+    renameBox(tree, boxID, "renamed again");
+    tree->incrementPersistDataVersion();
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+    QVERIFY(QFile::remove(journalFileName));
+    QVERIFY(QFile::rename(oldJournalFileName, journalFileName));
+
+    auto loadedTree = loadTree(fileName);
+    QCOMPARE(loadedTree->findEntityByID(boxID)->getName(), QString("renamed again"));
+}
+
+void EntityJournalTests::simulationChangesAreReplayed() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+
+    auto tree = createServerTree();
+    SimpleEntitySimulationPointer simulation { new SimpleEntitySimulation() };
+    simulation->setEntityTree(tree);
+    tree->setSimulation(simulation);
+
+    auto boxID = addBox(tree, "box");
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+
+    tree->withWriteLock([&] {
+        EntityItemProperties properties;
+        properties.setVelocity(glm::vec3(1.0f, 0.0f, 0.0f));
+        tree->updateEntity(boxID, properties);
+    });
+    qint64 journalSize;
+    QVERIFY(tree->writeToBinaryJournal(journalSize));
+
+    // the box moves on its own, as simple kinematics
+    tree->preUpdate();
+    QTest::qWait(100);
+    tree->update(true);
+    auto box = tree->findEntityByID(boxID);
+    glm::vec3 position = box->getWorldPosition();
+    QVERIFY(position.x > 0.0f);
+
+    QVERIFY(tree->writeToBinaryJournal(journalSize));
+    auto loadedBox = loadTree(fileName)->findEntityByID(boxID);
+    QVERIFY(loadedBox);
+    QVERIFY(loadedBox->getWorldPosition() == position);
+
+    // and it is stopped by the server, as an orphaned entity is
+    box->setVelocity(glm::vec3(0.0f));
+    box->markAsChangedOnServer(PROP_VELOCITY);
+
+    QVERIFY(tree->writeToBinaryJournal(journalSize));
+    loadedBox = loadTree(fileName)->findEntityByID(boxID);
+    QVERIFY(loadedBox);
+    QVERIFY(loadedBox->getWorldVelocity() == glm::vec3(0.0f));
+
+    tree->setSimulation(nullptr);
+}
+
+void EntityJournalTests::dataVersionIsInHeader() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+
+    auto tree = createServerTree();
+    auto boxID = addBox(tree, "box");
+    tree->setOctreeVersionInfo(QUuid::createUuid(), 1);
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+
+    renameBox(tree, boxID, "renamed");
+    tree->incrementPersistDataVersion();
+    qint64 journalSize;
+    QVERIFY(tree->writeToBinaryJournal(journalSize));
+
+    // the data version is read without going through the records, even when they can't be replayed
+    QFile journal(EntityJournalWriter::fileNameForSnapshot(fileName));
+    QVERIFY(journal.resize(journal.size() - 1));
+
+    QUuid id;
+    int64_t dataVersion;
+    QVERIFY(tree->readBinaryFileInfo(fileName, id, dataVersion));
+    QCOMPARE(dataVersion, (int64_t)2);
+
+    // a new snapshot starts a journal of its own, the data version is then the one of the snapshot
+    tree->incrementPersistDataVersion();
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+    QVERIFY(tree->readBinaryFileInfo(fileName, id, dataVersion));
+    QCOMPARE(dataVersion, (int64_t)3);
+}
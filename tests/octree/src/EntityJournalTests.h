@@ -0,0 +1,29 @@
+//
+//  EntityJournalTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityJournalTests_h
+#define hifi_EntityJournalTests_h
+
+#include <QtTest/QtTest>
+
+class EntityJournalTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void changesAreReplayed();
+    void incompleteRecordIsIgnored();
+    void staleJournalIsIgnored();
+    void simulationChangesAreReplayed();
+    void dataVersionIsInHeader();
+};
+
+#endif // hifi_EntityJournalTests_h
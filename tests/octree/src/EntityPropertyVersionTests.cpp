@@ -0,0 +1,137 @@
+//
+//  EntityPropertyVersionTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityPropertyVersionTests.h"
+
+#include "EntityTestUtils.h"
+
+QTEST_MAIN(EntityPropertyVersionTests)
+
+static EntityItemPointer createMovedBox() {
+    EntityItemProperties properties;
+    properties.setName("box");
+    properties.setUserData("{ \"public\": true }");
+    properties.setPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+    return createBox(properties);
+}
+
+static bool decode(const QByteArray& encodedEntity, EntityItemProperties& properties) {
+    return !encodedEntity.isEmpty() &&
+        properties.constructFromBuffer((const unsigned char*)encodedEntity.constData(), encodedEntity.size());
+}
+
+void EntityPropertyVersionTests::initTestCase() {
+    setUpEntityServerDependencies();
+}
+
+void EntityPropertyVersionTests::setPropertiesBumpsChangedProperties() {
+    auto entity = createBox();
+    quint64 version = entity->getPropertiesVersion();
+
+    EntityItemProperties properties;
+    properties.setName("renamed");
+    entity->setProperties(properties);
+
+    QVERIFY(entity->getPropertiesVersion() > version);
+
+    EntityPropertyFlags changedProperties;
+    QVERIFY(entity->getPropertiesChangedSince(version, changedProperties));
+    QVERIFY(changedProperties.getHasProperty(PROP_NAME));
+    QVERIFY(!changedProperties.getHasProperty(PROP_POSITION));
+
+    // nothing changed since the current version
+    changedProperties = EntityPropertyFlags();
+    QVERIFY(entity->getPropertiesChangedSince(entity->getPropertiesVersion(), changedProperties));
+    QVERIFY(changedProperties.isEmpty());
+}
+
+void EntityPropertyVersionTests::changesAccumulateSinceVersion() {
+    auto entity = createBox();
+    quint64 baseline = entity->getPropertiesVersion();
+
+    entity->markAsChangedOnServer(PROP_SIMULATION_OWNER);
+    quint64 afterOwnerChange = entity->getPropertiesVersion();
+    entity->markAsChangedOnServer(EntityPropertyFlags(PROP_VELOCITY) + PROP_ACCELERATION);
+
+    EntityPropertyFlags sinceBaseline;
+    QVERIFY(entity->getPropertiesChangedSince(baseline, sinceBaseline));
+    QVERIFY(sinceBaseline.getHasProperty(PROP_SIMULATION_OWNER));
+    QVERIFY(sinceBaseline.getHasProperty(PROP_VELOCITY));
+    QVERIFY(sinceBaseline.getHasProperty(PROP_ACCELERATION));
+
+    EntityPropertyFlags sinceOwnerChange;
+    QVERIFY(entity->getPropertiesChangedSince(afterOwnerChange, sinceOwnerChange));
+    QVERIFY(!sinceOwnerChange.getHasProperty(PROP_SIMULATION_OWNER));
+    QVERIFY(sinceOwnerChange.getHasProperty(PROP_VELOCITY));
+}
+
+void EntityPropertyVersionTests::markAllChangedInvalidatesOlderVersions() {
+    auto entity = createBox();
+    quint64 baseline = entity->getPropertiesVersion();
+
+    entity->markAsChangedOnServer();
+
+    EntityPropertyFlags changedProperties;
+    QVERIFY(!entity->getPropertiesChangedSince(baseline, changedProperties));
+
+    // a baseline taken afterwards is usable again
+    baseline = entity->getPropertiesVersion();
+    entity->markAsChangedOnServer(PROP_NAME);
+    QVERIFY(entity->getPropertiesChangedSince(baseline, changedProperties));
+    QVERIFY(changedProperties.getHasProperty(PROP_NAME));
+}
+
+void EntityPropertyVersionTests::deltaHasOnlyChangedProperties() {
+    auto entity = createMovedBox();
+    quint64 baseline = entity->getPropertiesVersion();
+
+    EntityItemProperties properties;
+    properties.setName("renamed box");
+    entity->setProperties(properties);
+
+    QByteArray full = encodeEntity(entity);
+    QByteArray delta = encodeEntity(entity, false, baseline);
+    QVERIFY(!delta.isEmpty());
+    QVERIFY(delta.size() < full.size());
+
+    // a viewer that has nothing gets everything
+    EntityItemProperties fromFull;
+    QVERIFY(decode(full, fromFull));
+    QCOMPARE(fromFull.getName(), QString("renamed box"));
+    QCOMPARE(fromFull.getUserData(), QString("{ \"public\": true }"));
+    QVERIFY(fromFull.getPosition() == glm::vec3(1.0f, 2.0f, 3.0f));
+
+    // a viewer that has the baseline only gets the new name, what it already has decodes to the defaults
+    EntityItemProperties defaults = createBox()->getProperties();
+    EntityItemProperties fromDelta;
+    QVERIFY(decode(delta, fromDelta));
+    QCOMPARE(fromDelta.getName(), QString("renamed box"));
+    QCOMPARE(fromDelta.getUserData(), defaults.getUserData());
+    QVERIFY(fromDelta.getPosition() == defaults.getPosition());
+}
+
+void EntityPropertyVersionTests::deltaKeepsMotionTogether() {
+    auto entity = createMovedBox();
+    quint64 baseline = entity->getPropertiesVersion();
+
+    EntityItemProperties properties;
+    properties.setVelocity(glm::vec3(0.0f, 1.0f, 0.0f));
+    entity->setProperties(properties);
+
+    EntityItemProperties defaults = createBox()->getProperties();
+    EntityItemProperties fromDelta;
+    QVERIFY(decode(encodeEntity(entity, false, baseline), fromDelta));
+
+    // the unchanged position comes along with the new velocity, so that the viewer extrapolates from where it is
+    QVERIFY(fromDelta.getVelocity() == glm::vec3(0.0f, 1.0f, 0.0f));
+    QVERIFY(fromDelta.getPosition() == glm::vec3(1.0f, 2.0f, 3.0f));
+    QCOMPARE(fromDelta.getName(), defaults.getName());
+    QCOMPARE(fromDelta.getUserData(), defaults.getUserData());
+}
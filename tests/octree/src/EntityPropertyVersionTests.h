@@ -0,0 +1,28 @@
+//
+//  EntityPropertyVersionTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityPropertyVersionTests_h
+#define hifi_EntityPropertyVersionTests_h
+
+#include <QtTest/QtTest>
+
+class EntityPropertyVersionTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void setPropertiesBumpsChangedProperties();
+    void changesAccumulateSinceVersion();
+    void markAllChangedInvalidatesOlderVersions();
+    void deltaHasOnlyChangedProperties();
+    void deltaKeepsMotionTogether();
+};
+
+#endif // hifi_EntityPropertyVersionTests_h
@@ -0,0 +1,110 @@
+//
+//  EntitySceneSnapshotTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySceneSnapshotTests.h"
+
+#include <atomic>
+#include <thread>
+
+#include <EntitySceneSnapshotCache.h>
+
+#include "EntityTestUtils.h"
+
+QTEST_MAIN(EntitySceneSnapshotTests)
+
+static const int NUM_BENCHMARK_ENTITIES = 10000;
+
+static void addBoxes(const EntityTreePointer& tree, int count) {
+    tree->withWriteLock([&] {
+        for (int i = 0; i < count; ++i) {
+            EntityItemProperties properties;
+            properties.setType(EntityTypes::Box);
+            properties.setName(QString("box %1").arg(i));
+            properties.setPosition(glm::vec3(i % 100, (i / 100) % 100, i / 10000));
+            properties.setDimensions(glm::vec3(0.5f));
+            tree->addEntity(EntityItemID(QUuid::createUuid()), properties);
+        }
+    });
+}
+
+void EntitySceneSnapshotTests::initTestCase() {
+    setUpEntityServerDependencies();
+}
+
+void EntitySceneSnapshotTests::captureEncodesEveryEntity() {
+    auto tree = createServerTree();
+    addBoxes(tree, 10);
+
+    quint64 before = usecTimestampNow();
+    auto snapshot = EntitySceneSnapshot::capture(tree);
+    QVERIFY(snapshot->getCaptureTime() >= before);
+    QCOMPARE((int)snapshot->getEntries().size(), 10);
+
+    for (auto& entry : snapshot->getEntries()) {
+        auto entity = entry.entity.lock();
+        QVERIFY(entity);
+        QCOMPARE(entry.propertiesVersion, entity->getPropertiesVersion());
+        QVERIFY(!entry.data.isEmpty());
+        QVERIFY(entry.dataWithPrivateUserData.isEmpty());
+
+        EntityItemProperties properties;
+        QVERIFY(properties.constructFromBuffer((const unsigned char*)entry.data.constData(), entry.data.size()));
+        QCOMPARE(properties.getName(), entity->getName());
+    }
+}
+
+void EntitySceneSnapshotTests::cacheNeverWaitsForTheTree() {
+    auto tree = createServerTree();
+    addBoxes(tree, 10);
+    EntitySceneSnapshotCache cache(tree);
+
+    // an edit holding the tree for longer than anybody should wait for it
+    std::atomic<bool> isLocked { false };
+    std::atomic<bool> release { false };
+    std::thread editThread([&] {
+        tree->withWriteLock([&] {
+            isLocked = true;
+            while (!release) {
+                std::this_thread::yield();
+            }
+        });
+    });
+    while (!isLocked) {
+        std::this_thread::yield();
+    }
+
+    // there is no snapshot yet, and the capture started for the next viewers waits for the tree on its own thread
+    QVERIFY(!cache.get());
+    QVERIFY(cache.isCapturing());
+
+    release = true;
+    editThread.join();
+
+    QTRY_VERIFY(!cache.isCapturing());
+    auto snapshot = cache.get();
+    QVERIFY(snapshot);
+    QCOMPARE((int)snapshot->getEntries().size(), 10);
+
+    // a recent snapshot is used as it is
+    QVERIFY(cache.get() == snapshot);
+    QVERIFY(!cache.isCapturing());
+}
+
+void EntitySceneSnapshotTests::captureBenchmark() {
+    auto tree = createServerTree();
+    addBoxes(tree, NUM_BENCHMARK_ENTITIES);
+
+    // the time it takes before the first new viewer can be sent the scene in bulk
+    EntitySceneSnapshotPointer snapshot;
+    QBENCHMARK {
+        snapshot = EntitySceneSnapshot::capture(tree);
+    }
+    qDebug() << "Captured" << snapshot->getEntries().size() << "entities," << snapshot->getDataSize() << "bytes";
+}
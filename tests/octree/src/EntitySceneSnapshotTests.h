@@ -0,0 +1,26 @@
+//
+//  EntitySceneSnapshotTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySceneSnapshotTests_h
+#define hifi_EntitySceneSnapshotTests_h
+
+#include <QtTest/QtTest>
+
+class EntitySceneSnapshotTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void captureEncodesEveryEntity();
+    void cacheNeverWaitsForTheTree();
+    void captureBenchmark();
+};
+
+#endif // hifi_EntitySceneSnapshotTests_h
@@ -0,0 +1,270 @@
+//
+//  EntitySnapshotFileTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntitySnapshotFileTests.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QTemporaryDir>
+
+#include <NumericalConstants.h>
+
+#include "EntityTestUtils.h"
+
+QTEST_MAIN(EntitySnapshotFileTests)
+
+static const int NUM_BENCHMARK_ENTITIES = 10000;
+
+static QVector<EntityItemID> addBoxes(const EntityTreePointer& tree, int count) {
+    QVector<EntityItemID> ids;
+    tree->withWriteLock([&] {
+        for (int i = 0; i < count; ++i) {
+            EntityItemProperties properties;
+            properties.setType(EntityTypes::Box);
+            properties.setName(QString("box %1").arg(i));
+            properties.setPosition(glm::vec3(i % 100, (i / 100) % 100, i / 10000));
+            properties.setDimensions(glm::vec3(0.5f));
+            properties.setUserData("{\"grabbableKey\":{\"grabbable\":true}}");
+
+            EntityItemID id(QUuid::createUuid());
+            if (tree->addEntity(id, properties)) {
+                ids.push_back(id);
+            }
+        }
+    });
+    return ids;
+}
+
+void EntitySnapshotFileTests::initTestCase() {
+    setUpEntityServerDependencies();
+}
+
+void EntitySnapshotFileTests::roundTrip() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+
+    auto tree = createServerTree();
+    auto ids = addBoxes(tree, 10);
+    QCOMPARE(ids.size(), 10);
+
+    EntityItemID childID(QUuid::createUuid());
+    tree->withWriteLock([&] {
+        EntityItemProperties properties;
+        properties.setType(EntityTypes::Model);
+        properties.setModelURL("http://example.com/model.fbx");
+        properties.setParentID(ids.front());
+        properties.setPrivateUserData("{\"secret\":true}");
+        QVERIFY(tree->addEntity(childID, properties));
+    });
+    QUuid persistID = QUuid::createUuid();
+    tree->setOctreeVersionInfo(persistID, 42);
+
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+
+    QUuid id;
+    int64_t dataVersion;
+    QVERIFY(tree->readBinaryFileInfo(fileName, id, dataVersion));
+    QCOMPARE(id, persistID);
+    QCOMPARE(dataVersion, (int64_t)42);
+
+    auto loadedTree = createServerTree();
+    loadedTree->withWriteLock([&] {
+        QVERIFY(loadedTree->readFromBinaryFile(fileName));
+    });
+
+    // the loaded tree keeps the id and data version of the content
+    QString reloadedFileName = dir.filePath("reloaded.bin");
+    QVERIFY(loadedTree->writeToBinaryFile(reloadedFileName, nullptr));
+    QVERIFY(loadedTree->readBinaryFileInfo(reloadedFileName, id, dataVersion));
+    QCOMPARE(id, persistID);
+    QCOMPARE(dataVersion, (int64_t)42);
+
+    for (const auto& entityID : ids) {
+        auto original = tree->findEntityByID(entityID);
+        auto loaded = loadedTree->findEntityByID(entityID);
+        QVERIFY(loaded);
+        QCOMPARE(loaded->getType(), EntityTypes::Box);
+        QCOMPARE(loaded->getName(), original->getName());
+        QCOMPARE(loaded->getUserData(), original->getUserData());
+        QCOMPARE(loaded->getCreated(), original->getCreated());
+        QVERIFY(glm::distance(loaded->getWorldPosition(), original->getWorldPosition()) < 0.001f);
+    }
+
+    auto child = loadedTree->findEntityByID(childID);
+    QVERIFY(child);
+    QCOMPARE(child->getType(), EntityTypes::Model);
+    QCOMPARE(child->getParentID(), QUuid(ids.front()));
+    QCOMPARE(child->getPrivateUserData(), QString("{\"secret\":true}"));
+}
+
+void EntitySnapshotFileTests::largeEntityIsWritten() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+
+    // the user data alone doesn't fit in the buffer the entities are encoded to first
+    QString userData = QString("{\"data\":\"%1\"}").arg(QString(100000, 'x'));
+
+    auto tree = createServerTree();
+    EntityItemID id(QUuid::createUuid());
+    tree->withWriteLock([&] {
+        EntityItemProperties properties;
+        properties.setType(EntityTypes::Box);
+        properties.setUserData(userData);
+        QVERIFY(tree->addEntity(id, properties));
+    });
+
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+
+    auto loadedTree = createServerTree();
+    loadedTree->withWriteLock([&] {
+        QVERIFY(loadedTree->readFromBinaryFile(fileName));
+    });
+    auto loaded = loadedTree->findEntityByID(id);
+    QVERIFY(loaded);
+    QCOMPARE(loaded->getUserData(), userData);
+}
+
+void EntitySnapshotFileTests::truncatedFileIsRejected() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+
+    auto tree = createServerTree();
+    addBoxes(tree, 10);
+    QVERIFY(tree->writeToBinaryFile(fileName, nullptr));
+
+    QFile file(fileName);
+    QVERIFY(file.resize(file.size() - 1));
+
+    auto loadedTree = createServerTree();
+    loadedTree->withWriteLock([&] {
+        QVERIFY(!loadedTree->readFromBinaryFile(fileName));
+    });
+}
+
+// The longest an edit waits for the tree lock while the entities are persisted. The times depend on the machine, they
+// are reported rather than checked: the longest wait is the result, to be compared with the persist time, which the
+// edits used to wait for in full.
+static void benchmarkEditsDuring(const EntityTreePointer& tree, const QVector<EntityItemID>& ids,
+                                 std::function<void()> persist) {
+    std::atomic<bool> isPersisting { true };
+    qint64 persistTime = 0;
+    std::thread persistThread([&] {
+        QElapsedTimer timer;
+        timer.start();
+        persist();
+        persistTime = timer.nsecsElapsed();
+        isPersisting = false;
+    });
+
+    qint64 maxLockWait = 0;
+    int numEdits = 0;
+    while (isPersisting) {
+        QElapsedTimer timer;
+        timer.start();
+        tree->withWriteLock([&] {
+            maxLockWait = std::max(maxLockWait, timer.nsecsElapsed());
+
+            EntityItemProperties properties;
+            properties.setName(QString("edited %1").arg(numEdits));
+            tree->updateEntity(ids[numEdits % ids.size()], properties);
+        });
+        ++numEdits;
+    }
+    persistThread.join();
+
+    qDebug() << "persist took" << persistTime / (qint64)NSECS_PER_MSEC << "ms, the longest wait for the tree lock of the"
+        << numEdits << "edits made meanwhile was" << maxLockWait / (qint64)NSECS_PER_MSEC << "ms";
+    QTest::setBenchmarkResult((qreal)maxLockWait / NSECS_PER_MSEC, QTest::WalltimeMilliseconds);
+}
+
+void EntitySnapshotFileTests::benchmarkEditsDuringPersist() {
+    auto tree = createServerTree();
+    auto ids = addBoxes(tree, NUM_BENCHMARK_ENTITIES);
+
+    // the JSON export used to hold the tree lock for all of its serialization, now it only holds it to copy the
+    // properties of the entities
+    benchmarkEditsDuring(tree, ids, [&] {
+        QByteArray data;
+        tree->toJSON(&data, nullptr, true);
+    });
+}
+
+void EntitySnapshotFileTests::benchmarkEditsDuringBinaryPersist() {
+    QTemporaryDir dir;
+    QString fileName = dir.filePath("models.bin");
+
+    auto tree = createServerTree();
+    auto ids = addBoxes(tree, NUM_BENCHMARK_ENTITIES);
+
+    // the binary snapshot only holds it to list the entities
+    benchmarkEditsDuring(tree, ids, [&] {
+        tree->writeToBinaryFile(fileName, nullptr);
+    });
+}
+
+void EntitySnapshotFileTests::benchmarkPersistJSON() {
+    QTemporaryDir dir;
+    QByteArray fileName = dir.filePath("models.json.gz").toLocal8Bit();
+
+    auto tree = createServerTree();
+    addBoxes(tree, NUM_BENCHMARK_ENTITIES);
+
+    QBENCHMARK {
+        QVERIFY(tree->writeToFile(fileName.constData(), nullptr, "json.gz"));
+    }
+}
+
+void EntitySnapshotFileTests::benchmarkPersistBinary() {
+    QTemporaryDir dir;
+    QByteArray fileName = dir.filePath("models.bin").toLocal8Bit();
+
+    auto tree = createServerTree();
+    addBoxes(tree, NUM_BENCHMARK_ENTITIES);
+
+    QBENCHMARK {
+        QVERIFY(tree->writeToFile(fileName.constData(), nullptr, "bin"));
+    }
+}
+
+void EntitySnapshotFileTests::benchmarkLoadJSON() {
+    QTemporaryDir dir;
+    QByteArray fileName = dir.filePath("models.json.gz").toLocal8Bit();
+
+    auto tree = createServerTree();
+    addBoxes(tree, NUM_BENCHMARK_ENTITIES);
+    QVERIFY(tree->writeToFile(fileName.constData(), nullptr, "json.gz"));
+
+    QBENCHMARK {
+        auto loadedTree = createServerTree();
+        loadedTree->withWriteLock([&] {
+            QVERIFY(loadedTree->readFromFile(fileName.constData()));
+        });
+    }
+}
+
+void EntitySnapshotFileTests::benchmarkLoadBinary() {
+    QTemporaryDir dir;
+    QByteArray fileName = dir.filePath("models.bin").toLocal8Bit();
+
+    auto tree = createServerTree();
+    addBoxes(tree, NUM_BENCHMARK_ENTITIES);
+    QVERIFY(tree->writeToFile(fileName.constData(), nullptr, "bin"));
+
+    QBENCHMARK {
+        auto loadedTree = createServerTree();
+        loadedTree->withWriteLock([&] {
+            QVERIFY(loadedTree->readFromFile(fileName.constData()));
+        });
+    }
+}
@@ -0,0 +1,37 @@
+//
+//  EntitySnapshotFileTests.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntitySnapshotFileTests_h
+#define hifi_EntitySnapshotFileTests_h
+
+#include <QtTest/QtTest>
+
+class EntitySnapshotFileTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void roundTrip();
+    void largeEntityIsWritten();
+    void truncatedFileIsRejected();
+
+    // the longest the edits wait for the tree lock while the entities are persisted
+    void benchmarkEditsDuringPersist();
+    void benchmarkEditsDuringBinaryPersist();
+
+    // load and persist times of the binary snapshot against the JSON the entity server used to persist to
+    void benchmarkPersistJSON();
+    void benchmarkPersistBinary();
+    void benchmarkLoadJSON();
+    void benchmarkLoadBinary();
+};
+
+#endif // hifi_EntitySnapshotFileTests_h
@@ -0,0 +1,62 @@
+//
+//  EntityTestUtils.h
+//  tests/octree/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityTestUtils_h
+#define hifi_EntityTestUtils_h
+
+// Only the *Tests.cpp files of a testcase are compiled, so the helpers shared by the entity tests live here, inline.
+
+#include <QtCore/QByteArray>
+
+#include <AccountManager.h>
+#include <AddressManager.h>
+#include <DependencyManager.h>
+#include <EntityItemProperties.h>
+#include <EntityTree.h>
+#include <EntityTreeElement.h>
+#include <NodeList.h>
+#include <ShapeEntityItem.h>
+
+// What entities expect to find when they are decoded, or added to a tree, on an entity-server.
+inline void setUpEntityServerDependencies() {
+    DependencyManager::registerInheritance<LimitedNodeList, NodeList>();
+    DependencyManager::set<AccountManager>();
+    DependencyManager::set<AddressManager>();
+    DependencyManager::set<NodeList>(NodeType::EntityServer, INVALID_PORT);
+}
+
+inline EntityTreePointer createServerTree() {
+    auto tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    tree->setIsServer(true);
+    return tree;
+}
+
+inline EntityItemPointer createBox(EntityItemProperties properties = EntityItemProperties()) {
+    properties.setType(EntityTypes::Box);
+    return ShapeEntityItem::boxFactory(EntityItemID(QUuid::createUuid()), properties);
+}
+
+// The entity as an entity-server sends it, empty if it doesn't fit in a packet.
+inline QByteArray encodeEntity(const EntityItemPointer& entity, bool withPrivateUserData = false,
+                               quint64 knownPropertiesVersion = 0) {
+    OctreePacketData packetData;
+    EncodeBitstreamParams params;
+    EntityTreeElementExtraEncodeDataPointer extraEncodeData { new EntityTreeElementExtraEncodeData() };
+
+    auto appendState = entity->appendEntityData(&packetData, params, extraEncodeData, withPrivateUserData,
+                                                knownPropertiesVersion);
+    if (appendState != OctreeElement::COMPLETED) {
+        return QByteArray();
+    }
+    return QByteArray((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+}
+
+#endif // hifi_EntityTestUtils_h
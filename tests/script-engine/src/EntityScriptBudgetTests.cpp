@@ -0,0 +1,147 @@
+//
+//  EntityScriptBudgetTests.cpp
+//  tests/script-engine/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptBudgetTests.h"
+
+#include <ScriptEngine.h>
+#include <ScriptEngines.h>
+#include <SharedUtil.h>
+
+QTEST_MAIN(EntityScriptBudgetTests)
+
+// runs entity script calls directly, without loading entity scripts
+class TestScriptEngine : public ScriptEngine {
+public:
+    TestScriptEngine() : ScriptEngine(ENTITY_SERVER_SCRIPT, QString(), "budget test") {
+        _scriptEnginesOwner = QSharedPointer<ScriptEngines>::create(ENTITY_SERVER_SCRIPT);
+        setScriptEngines(_scriptEnginesOwner);
+    }
+
+    using ScriptEngine::doWithEnvironment;
+
+    // an entity script made of the given object
+    void addEntityScript(const EntityItemID& entityID, const QString& scriptObject) {
+        EntityScriptDetails details;
+        details.status = EntityScriptStatus::RUNNING;
+        details.scriptObject = evaluate("(" + scriptObject + ")");
+        setEntityScriptDetails(entityID, details);
+    }
+
+    EntityScriptStatus getStatus(const EntityItemID& entityID) {
+        EntityScriptDetails details;
+        getEntityScriptDetails(entityID, details);
+        return details.status;
+    }
+
+private:
+    QSharedPointer<ScriptEngines> _scriptEnginesOwner;
+};
+
+static const QUrl SANDBOX_URL { "about:EntityScript" };
+
+static void runFor(quint64 usecs) {
+    quint64 end = usecTimestampNow() + usecs;
+    while (usecTimestampNow() < end) {
+    }
+}
+
+// what the engine does while a script runs
+static void processEventsFor(quint64 usecs) {
+    quint64 end = usecTimestampNow() + usecs;
+    while (usecTimestampNow() < end) {
+        QCoreApplication::processEvents();
+    }
+}
+
+void EntityScriptBudgetTests::nestedCallsAreTimedSeparately() {
+    TestScriptEngine engine;
+    EntityItemID outerID(QUuid::createUuid());
+    EntityItemID innerID(QUuid::createUuid());
+
+    quint64 startTime = usecTimestampNow();
+    engine.doWithEnvironment(outerID, SANDBOX_URL, [&] {
+        runFor(20 * USECS_PER_MSEC);
+        engine.doWithEnvironment(innerID, SANDBOX_URL, [&] {
+            runFor(40 * USECS_PER_MSEC);
+        });
+        runFor(10 * USECS_PER_MSEC);
+    });
+    quint64 runTime = usecTimestampNow() - startTime;
+
+    auto runTimes = engine.takeEntityScriptRunTimes();
+    QVERIFY(runTimes[innerID] >= 40 * USECS_PER_MSEC);
+    QVERIFY(runTimes[outerID] >= 30 * USECS_PER_MSEC);
+    QVERIFY(runTimes[outerID] + runTimes[innerID] <= runTime);
+
+    auto entityScripts = engine.getScriptStats()["entityScripts"].toMap();
+    QCOMPARE(entityScripts[outerID.toString()].toMap()["calls"].toInt(), 1);
+    QCOMPARE(entityScripts[innerID.toString()].toMap()["calls"].toInt(), 1);
+}
+
+void EntityScriptBudgetTests::timerWaitsForRunningCall() {
+    TestScriptEngine engine;
+    EntityItemID entityID(QUuid::createUuid());
+    engine.addEntityScript(entityID, "{}");
+
+    engine.doWithEnvironment(entityID, SANDBOX_URL, [&] {
+        engine.setTimeout(engine.evaluate("(function () { fired = true; })"), 0);
+        processEventsFor(50 * USECS_PER_MSEC);
+        QVERIFY(!engine.globalObject().property("fired").toBool());
+    });
+
+    QTRY_VERIFY(engine.globalObject().property("fired").toBool());
+    QVERIFY(engine.getScriptStats()["deferredTimerCalls"].toInt() >= 1);
+}
+
+void EntityScriptBudgetTests::queuedCallWaitsForRunningCall() {
+    TestScriptEngine engine;
+    EntityItemID runningID(QUuid::createUuid());
+    EntityItemID calledID(QUuid::createUuid());
+    engine.addEntityScript(calledID, "{ ping: function () { pinged = true; } }");
+
+    engine.doWithEnvironment(runningID, SANDBOX_URL, [&] {
+        // what another thread calling into the engine amounts to
+        QMetaObject::invokeMethod(&engine, [&] { engine.callEntityScriptMethod(calledID, "ping"); }, Qt::QueuedConnection);
+        processEventsFor(50 * USECS_PER_MSEC);
+        QVERIFY(!engine.globalObject().property("pinged").toBool());
+
+        // a call the running script makes itself isn't held
+        engine.callEntityScriptMethod(calledID, "ping");
+        QVERIFY(engine.globalObject().property("pinged").toBool());
+        engine.globalObject().setProperty("pinged", false);
+    });
+
+    QTRY_VERIFY(engine.globalObject().property("pinged").toBool());
+
+    // the call waited, it isn't part of the run time of the script that was running
+    auto runTimes = engine.takeEntityScriptRunTimes();
+    QVERIFY(runTimes[runningID] >= 50 * USECS_PER_MSEC);
+    QVERIFY(runTimes.contains(calledID));
+}
+
+void EntityScriptBudgetTests::hardBudgetSuspendsInnermostScript() {
+    TestScriptEngine engine;
+    EntityItemID callerID(QUuid::createUuid());
+    EntityItemID slowID(QUuid::createUuid());
+    engine.addEntityScript(callerID, "{}");
+    engine.addEntityScript(slowID, "{ spin: function () { while (true) {} } }");
+    engine.setEntityScriptBudgets(0, 50);
+
+    quint64 startTime = usecTimestampNow();
+    engine.doWithEnvironment(callerID, SANDBOX_URL, [&] {
+        engine.callEntityScriptMethod(slowID, "spin");
+    });
+    engine.clearExceptions();
+
+    QVERIFY(usecTimestampNow() - startTime < 5 * USECS_PER_SECOND);
+    QCOMPARE(engine.getStatus(slowID), EntityScriptStatus::ERROR_RUNNING_SCRIPT);
+    QCOMPARE(engine.getStatus(callerID), EntityScriptStatus::RUNNING);
+    QCOMPARE(engine.getScriptStats()["suspendedEntityScripts"].toInt(), 1);
+}
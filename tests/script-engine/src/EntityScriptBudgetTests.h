@@ -0,0 +1,26 @@
+//
+//  EntityScriptBudgetTests.h
+//  tests/script-engine/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptBudgetTests_h
+#define hifi_EntityScriptBudgetTests_h
+
+#include <QtTest/QtTest>
+
+class EntityScriptBudgetTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void nestedCallsAreTimedSeparately();
+    void timerWaitsForRunningCall();
+    void queuedCallWaitsForRunningCall();
+    void hardBudgetSuspendsInnermostScript();
+};
+
+#endif // hifi_EntityScriptBudgetTests_h
@@ -0,0 +1,148 @@
+//
+//  EntityScriptShardsTests.cpp
+//  tests/script-engine/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptShardsTests.h"
+
+#include <EntityScriptShards.h>
+
+QTEST_MAIN(EntityScriptShardsTests)
+
+static const quint64 MIN_RUN_TIME_TO_BALANCE = 1000;
+
+// engines that are never run, the shards only hand them out
+static std::vector<ScriptEnginePointer> createEngines(int numEngines) {
+    std::vector<ScriptEnginePointer> engines;
+    for (int i = 0; i < numEngines; ++i) {
+        engines.push_back(ScriptEnginePointer(new ScriptEngine(ScriptEngine::ENTITY_SERVER_SCRIPT, QString(),
+                                                               QString("shard %1").arg(i))));
+    }
+    return engines;
+}
+
+static EntityItemID createEntityID() {
+    return EntityItemID(QUuid::createUuid());
+}
+
+void EntityScriptShardsTests::assignsEveryEntityToOneShard() {
+    EntityScriptShards shards;
+    auto engines = createEngines(4);
+    shards.setEngines(engines);
+    QCOMPARE(shards.getNumShards(), 4);
+
+    for (int i = 0; i < 100; ++i) {
+        auto entityID = createEntityID();
+        int shard = shards.getShard(entityID);
+        QVERIFY(shard >= 0 && shard < 4);
+        QCOMPARE(shards.getShard(entityID), shard);
+        QCOMPARE(shards.getEngine(entityID), engines[shard]);
+    }
+}
+
+void EntityScriptShardsTests::spreadsEntitiesOverShards() {
+    EntityScriptShards shards;
+    shards.setEngines(createEngines(4));
+
+    std::vector<int> numEntities(4, 0);
+    for (int i = 0; i < 400; ++i) {
+        ++numEntities[shards.getShard(createEntityID())];
+    }
+    for (int count : numEntities) {
+        QVERIFY(count > 0);
+    }
+}
+
+void EntityScriptShardsTests::movedEntityStaysMoved() {
+    EntityScriptShards shards;
+    auto engines = createEngines(4);
+    shards.setEngines(engines);
+
+    auto entityID = createEntityID();
+    int shard = (shards.getShard(entityID) + 1) % 4;
+    shards.moveEntity(entityID, shard);
+    QCOMPARE(shards.getShard(entityID), shard);
+    QCOMPARE(shards.getEngine(entityID), engines[shard]);
+
+    // there's no such shard
+    shards.moveEntity(entityID, 4);
+    QCOMPARE(shards.getShard(entityID), shard);
+
+    // new engines, the entities are where their hash puts them again
+    shards.setEngines(createEngines(1));
+    QCOMPARE(shards.getShard(entityID), 0);
+}
+
+void EntityScriptShardsTests::forgottenEntityGoesBack() {
+    EntityScriptShards shards;
+    shards.setEngines(createEngines(4));
+
+    auto entityID = createEntityID();
+    int hashedShard = shards.getShard(entityID);
+    shards.moveEntity(entityID, (hashedShard + 1) % 4);
+    shards.forgetEntity(entityID);
+    QCOMPARE(shards.getShard(entityID), hashedShard);
+}
+
+void EntityScriptShardsTests::noEnginesNoShard() {
+    EntityScriptShards shards;
+    auto entityID = createEntityID();
+    QCOMPARE(shards.getNumShards(), 0);
+    QCOMPARE(shards.getShard(entityID), -1);
+    QVERIFY(!shards.getEngine(entityID));
+}
+
+void EntityScriptShardsTests::balanceMovesHottestEntity() {
+    auto hotEntityID = createEntityID();
+    std::vector<QHash<EntityItemID, quint64>> runTimes(3);
+    runTimes[0][createEntityID()] = 2000;
+    runTimes[0][hotEntityID] = 4000;
+    runTimes[1][createEntityID()] = 3000;
+    runTimes[2][createEntityID()] = 500;
+
+    EntityItemID entityID;
+    int shard = -1;
+    QVERIFY(EntityScriptShards::pickEntityToMove(runTimes, MIN_RUN_TIME_TO_BALANCE, entityID, shard));
+    QCOMPARE(entityID, hotEntityID);
+    QCOMPARE(shard, 2);
+}
+
+void EntityScriptShardsTests::balanceLeavesLightLoad() {
+    std::vector<QHash<EntityItemID, quint64>> runTimes(2);
+    runTimes[0][createEntityID()] = 400;
+    runTimes[0][createEntityID()] = 500;
+
+    EntityItemID entityID;
+    int shard = -1;
+    QVERIFY(!EntityScriptShards::pickEntityToMove(runTimes, MIN_RUN_TIME_TO_BALANCE, entityID, shard));
+}
+
+void EntityScriptShardsTests::balanceLeavesSingleHotEntity() {
+    // moving the only script of the busiest shard would only make the lightest one as busy
+    std::vector<QHash<EntityItemID, quint64>> runTimes(2);
+    runTimes[0][createEntityID()] = 6000;
+    runTimes[1][createEntityID()] = 500;
+
+    EntityItemID entityID;
+    int shard = -1;
+    QVERIFY(!EntityScriptShards::pickEntityToMove(runTimes, MIN_RUN_TIME_TO_BALANCE, entityID, shard));
+
+    // nor would moving a script that is most of the load of its shard
+    runTimes[0][createEntityID()] = 400;
+    QVERIFY(!EntityScriptShards::pickEntityToMove(runTimes, MIN_RUN_TIME_TO_BALANCE, entityID, shard));
+}
+
+void EntityScriptShardsTests::balanceNeedsTwoShards() {
+    std::vector<QHash<EntityItemID, quint64>> runTimes(1);
+    runTimes[0][createEntityID()] = 6000;
+    runTimes[0][createEntityID()] = 6000;
+
+    EntityItemID entityID;
+    int shard = -1;
+    QVERIFY(!EntityScriptShards::pickEntityToMove(runTimes, MIN_RUN_TIME_TO_BALANCE, entityID, shard));
+}
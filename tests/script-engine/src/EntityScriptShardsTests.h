@@ -0,0 +1,31 @@
+//
+//  EntityScriptShardsTests.h
+//  tests/script-engine/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptShardsTests_h
+#define hifi_EntityScriptShardsTests_h
+
+#include <QtTest/QtTest>
+
+class EntityScriptShardsTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void assignsEveryEntityToOneShard();
+    void spreadsEntitiesOverShards();
+    void movedEntityStaysMoved();
+    void forgottenEntityGoesBack();
+    void noEnginesNoShard();
+    void balanceMovesHottestEntity();
+    void balanceLeavesLightLoad();
+    void balanceLeavesSingleHotEntity();
+    void balanceNeedsTwoShards();
+};
+
+#endif // hifi_EntityScriptShardsTests_h
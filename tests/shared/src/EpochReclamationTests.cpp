@@ -0,0 +1,141 @@
+//
+//  EpochReclamationTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EpochReclamationTests.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <shared/EpochReclamation.h>
+
+QTEST_MAIN(EpochReclamationTests)
+
+void EpochReclamationTests::reclaimWithoutGuardsTest() {
+    EpochReclamation epochs;
+    int numDeleted = 0;
+
+    epochs.retire([&] { ++numDeleted; });
+    epochs.retire([&] { ++numDeleted; });
+    QCOMPARE(epochs.getNumRetired(), (size_t)2);
+
+    QCOMPARE(epochs.reclaim(), (size_t)0);
+    QCOMPARE(numDeleted, 2);
+}
+
+void EpochReclamationTests::reclaimWaitsForGuardTest() {
+    EpochReclamation epochs;
+    bool isDeleted = false;
+
+    std::atomic<bool> hasGuard { false };
+    std::atomic<bool> shouldRelease { false };
+
+    std::thread reader([&] {
+        EpochReclamation::ReadGuard guard(epochs);
+        hasGuard = true;
+        while (!shouldRelease) {
+            std::this_thread::yield();
+        }
+    });
+
+    while (!hasGuard) {
+        std::this_thread::yield();
+    }
+
+    epochs.retire([&] { isDeleted = true; });
+    QCOMPARE(epochs.reclaim(), (size_t)1);
+    QVERIFY(!isDeleted);
+
+    shouldRelease = true;
+    reader.join();
+
+    QCOMPARE(epochs.reclaim(), (size_t)0);
+    QVERIFY(isDeleted);
+}
+
+void EpochReclamationTests::nestedGuardTest() {
+    EpochReclamation epochs;
+    bool isDeleted = false;
+
+    {
+        EpochReclamation::ReadGuard outerGuard(epochs);
+        {
+            EpochReclamation::ReadGuard innerGuard(epochs);
+            epochs.retire([&] { isDeleted = true; });
+        }
+
+        // the outer guard could still be using what was retired
+        epochs.reclaim();
+        QVERIFY(!isDeleted);
+    }
+
+    epochs.reclaim();
+    QVERIFY(isDeleted);
+}
+
+void EpochReclamationTests::guardAfterRetireTest() {
+    EpochReclamation epochs;
+    bool isDeleted = false;
+
+    epochs.retire([&] { isDeleted = true; });
+
+    // a guard that starts after the retire can't see what was retired, so it doesn't hold it back
+    EpochReclamation::ReadGuard guard(epochs);
+    epochs.reclaim();
+    QVERIFY(isDeleted);
+}
+
+void EpochReclamationTests::concurrentReadersTest() {
+    struct Data {
+        std::atomic<bool> isAlive { true };
+    };
+
+    const int NUM_READERS = 4;
+    const int NUM_UPDATES = 20000;
+
+    EpochReclamation epochs;
+    std::atomic<Data*> current { new Data() };
+    std::atomic<bool> isDone { false };
+    std::atomic<int> numDeadReads { 0 };
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < NUM_READERS; ++i) {
+        readers.emplace_back([&] {
+            while (!isDone) {
+                EpochReclamation::ReadGuard guard(epochs);
+                Data* data = current.load();
+                for (int j = 0; j < 10; ++j) {
+                    if (!data->isAlive) {
+                        ++numDeadReads;
+                    }
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < NUM_UPDATES; ++i) {
+        Data* oldData = current.exchange(new Data());
+        epochs.retire([oldData] {
+            oldData->isAlive = false;
+            delete oldData;
+        });
+        epochs.reclaim();
+    }
+
+    isDone = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    QCOMPARE(numDeadReads.load(), 0);
+    QCOMPARE(epochs.reclaim(), (size_t)0);
+
+    delete current.load();
+}
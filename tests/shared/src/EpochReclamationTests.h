@@ -0,0 +1,27 @@
+//
+//  EpochReclamationTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EpochReclamationTests_h
+#define hifi_EpochReclamationTests_h
+
+#include <QtTest/QtTest>
+
+class EpochReclamationTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void reclaimWithoutGuardsTest();
+    void reclaimWaitsForGuardTest();
+    void nestedGuardTest();
+    void guardAfterRetireTest();
+    void concurrentReadersTest();
+};
+
+#endif // hifi_EpochReclamationTests_h
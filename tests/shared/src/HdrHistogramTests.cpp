@@ -0,0 +1,114 @@
+//
+//  HdrHistogramTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "HdrHistogramTests.h"
+
+#include <shared/HdrHistogram.h>
+
+QTEST_MAIN(HdrHistogramTests)
+
+void HdrHistogramTests::emptyTest() {
+    HdrHistogram histogram;
+
+    QVERIFY(histogram.isEmpty());
+    QCOMPARE(histogram.getTotalCount(), (uint64_t)0);
+    QCOMPARE(histogram.getMin(), (uint64_t)0);
+    QCOMPARE(histogram.getMax(), (uint64_t)0);
+    QCOMPARE(histogram.getMean(), 0.0);
+    QCOMPARE(histogram.getValueAtPercentile(50.0), (uint64_t)0);
+}
+
+void HdrHistogramTests::exactSmallValuesTest() {
+    HdrHistogram histogram;
+
+    // values below 2^subBucketBits each get their own bucket
+    for (uint64_t value = 0; value < 10; ++value) {
+        histogram.record(value);
+    }
+
+    QCOMPARE(histogram.getTotalCount(), (uint64_t)10);
+    QCOMPARE(histogram.getMin(), (uint64_t)0);
+    QCOMPARE(histogram.getMax(), (uint64_t)9);
+    QCOMPARE(histogram.getMean(), 4.5);
+    QCOMPARE(histogram.getValueAtPercentile(0.0), (uint64_t)0);
+    QCOMPARE(histogram.getValueAtPercentile(50.0), (uint64_t)4);
+    QCOMPARE(histogram.getValueAtPercentile(90.0), (uint64_t)8);
+    QCOMPARE(histogram.getValueAtPercentile(100.0), (uint64_t)9);
+}
+
+void HdrHistogramTests::percentilePrecisionTest() {
+    HdrHistogram histogram;
+
+    const uint64_t NUM_VALUES = 1000000;
+    for (uint64_t value = 1; value <= NUM_VALUES; ++value) {
+        histogram.record(value);
+    }
+
+    const double MAX_RELATIVE_ERROR = 1.0 / (1 << (HdrHistogram::DEFAULT_SUB_BUCKET_BITS - 1));
+
+    for (double percentile : { 10.0, 50.0, 90.0, 99.0, 99.9 }) {
+        double expected = percentile / 100.0 * NUM_VALUES;
+        double actual = (double)histogram.getValueAtPercentile(percentile);
+
+        QVERIFY(actual >= expected);
+        QVERIFY((actual - expected) / expected <= MAX_RELATIVE_ERROR);
+    }
+
+    QCOMPARE(histogram.getValueAtPercentile(100.0), NUM_VALUES);
+}
+
+void HdrHistogramTests::highestTrackableValueTest() {
+    HdrHistogram histogram(HdrHistogram::DEFAULT_SUB_BUCKET_BITS, 1000);
+
+    histogram.record(10);
+    histogram.record(1000000);
+
+    // the outlier is counted in the last bucket, but the maximum is still exact
+    QCOMPARE(histogram.getTotalCount(), (uint64_t)2);
+    QCOMPARE(histogram.getMax(), (uint64_t)1000000);
+    QCOMPARE(histogram.getValueAtPercentile(50.0), (uint64_t)10);
+    QVERIFY(histogram.getValueAtPercentile(100.0) >= 1000);
+}
+
+void HdrHistogramTests::mergeTest() {
+    HdrHistogram first;
+    HdrHistogram second;
+    HdrHistogram empty;
+
+    first.record(5, 3);
+    second.record(20);
+    second.record(2);
+
+    first.merge(second);
+    first.merge(empty);
+
+    QCOMPARE(first.getTotalCount(), (uint64_t)5);
+    QCOMPARE(first.getMin(), (uint64_t)2);
+    QCOMPARE(first.getMax(), (uint64_t)20);
+    QCOMPARE(first.getValueAtPercentile(50.0), (uint64_t)5);
+
+    empty.merge(second);
+    QCOMPARE(empty.getTotalCount(), (uint64_t)2);
+    QCOMPARE(empty.getValueAtPercentile(100.0), (uint64_t)20);
+}
+
+void HdrHistogramTests::resetTest() {
+    HdrHistogram histogram;
+
+    histogram.record(100);
+    histogram.reset();
+
+    QVERIFY(histogram.isEmpty());
+    QCOMPARE(histogram.getValueAtPercentile(99.0), (uint64_t)0);
+
+    histogram.record(3);
+    QCOMPARE(histogram.getMin(), (uint64_t)3);
+    QCOMPARE(histogram.getMax(), (uint64_t)3);
+}
@@ -0,0 +1,28 @@
+//
+//  HdrHistogramTests.h
+//  tests/shared/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_HdrHistogramTests_h
+#define hifi_HdrHistogramTests_h
+
+#include <QtTest/QtTest>
+
+class HdrHistogramTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void emptyTest();
+    void exactSmallValuesTest();
+    void percentilePrecisionTest();
+    void highestTrackableValueTest();
+    void mergeTest();
+    void resetTest();
+};
+
+#endif // hifi_HdrHistogramTests_h
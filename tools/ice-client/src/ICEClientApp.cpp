@@ -14,11 +14,16 @@
 #include <QDataStream>
 #include <QLoggingCategory>
 #include <QCommandLineParser>
+#include <QThread>
+
+#include <algorithm>
 
 #include <PathUtils.h>
 #include <LimitedNodeList.h>
 #include <NetworkLogging.h>
 
+#include "ICELoadGenerator.h"
+
 ICEClientApp::ICEClientApp(int argc, char* argv[]) :
     QCoreApplication(argc, argv)
 {
@@ -44,6 +49,24 @@ ICEClientApp::ICEClientApp(int argc, char* argv[]) :
     const QCommandLineOption cacheSTUNOption("s", "cache stun-server response");
     parser.addOption(cacheSTUNOption);
 
+    const QCommandLineOption loadOption("load", "heartbeat the ice-server as this many domains and report its throughput",
+                                        "domains");
+    parser.addOption(loadOption);
+
+    const QCommandLineOption loadRateOption("load-rate", "heartbeats per second sent with --load", "heartbeats", "1000");
+    parser.addOption(loadRateOption);
+
+    const QCommandLineOption loadDurationOption("load-duration", "seconds to run --load for, 0 for no end", "seconds", "10");
+    parser.addOption(loadDurationOption);
+
+    const QCommandLineOption loadKeysOption("load-keys", "keypairs of the --load domains, created if missing",
+                                            "path", "ice-load-keys.json");
+    parser.addOption(loadKeysOption);
+
+    const QCommandLineOption serverCoresOption("server-cores", "cores of the ice-server machine, to report --load per core",
+                                               "cores");
+    parser.addOption(serverCoresOption);
+
     if (!parser.parse(QCoreApplication::arguments())) {
         qCritical() << parser.errorText() << endl;
         parser.showHelp();
@@ -104,6 +127,25 @@ ICEClientApp::ICEClientApp(int argc, char* argv[]) :
         qDebug() << "ICE-server address is" << _iceServerAddr;
     }
 
+    if (parser.isSet(loadOption)) {
+        ICELoadGenerator::Settings settings;
+        settings.iceServerAddr = _iceServerAddr;
+        settings.numDomains = std::max(1, parser.value(loadOption).toInt());
+        settings.heartbeatsPerSecond = std::max(1, parser.value(loadRateOption).toInt());
+        settings.durationSeconds = parser.value(loadDurationOption).toInt();
+        settings.keysPath = parser.value(loadKeysOption);
+        settings.serverCores = std::max(1, parser.isSet(serverCoresOption) ? parser.value(serverCoresOption).toInt()
+                                                                          : QThread::idealThreadCount());
+
+        _loadGenerator = new ICELoadGenerator(settings, this);
+        connect(_loadGenerator, &ICELoadGenerator::finished, this, &QCoreApplication::quit);
+
+        if (!_loadGenerator->start()) {
+            QMetaObject::invokeMethod(this, "quit", Qt::QueuedConnection);
+        }
+        return;
+    }
+
     setState(lookUpStunServer);
 
     QTimer* doTimer = new QTimer(this);
@@ -19,6 +19,8 @@
 #include <ReceivedMessage.h>
 #include <NetworkPeer.h>
 
+class ICELoadGenerator;
+
 
 class ICEClientApp : public QCoreApplication {
     Q_OBJECT
@@ -89,6 +91,8 @@ private:
     QTimer _stunResponseTimer;
     QTimer _iceResponseTimer;
     int _domainPingCount { 0 };
+
+    ICELoadGenerator* _loadGenerator { nullptr };
 };
 
 
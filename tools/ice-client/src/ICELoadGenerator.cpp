@@ -0,0 +1,240 @@
+//
+//  ICELoadGenerator.cpp
+//  tools/ice-client/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ICELoadGenerator.h"
+
+#include <openssl/err.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+
+#include <NumericalConstants.h>
+#include <UUID.h>
+
+#ifdef __clang__
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
+static const QString PUBLIC_KEY_KEY = "public_key";
+static const QString PRIVATE_KEY_KEY = "private_key";
+
+static QJsonObject generateKeypair() {
+    RSA* keyPair = RSA_new();
+    BIGNUM* exponent = BN_new();
+
+    const unsigned long RSA_KEY_EXPONENT = 65537;
+    BN_set_word(exponent, RSA_KEY_EXPONENT);
+
+    const int RSA_KEY_BITS = 2048;
+    bool generated = RSA_generate_key_ex(keyPair, RSA_KEY_BITS, exponent, NULL);
+    BN_free(exponent);
+
+    QJsonObject keys;
+
+    if (generated) {
+        // the ice-server reads public keys the way the metaverse API hands them out, as SubjectPublicKeyInfo
+        unsigned char* publicKeyDER = NULL;
+        int publicKeyLength = i2d_RSA_PUBKEY(keyPair, &publicKeyDER);
+
+        unsigned char* privateKeyDER = NULL;
+        int privateKeyLength = i2d_RSAPrivateKey(keyPair, &privateKeyDER);
+
+        if (publicKeyLength > 0 && privateKeyLength > 0) {
+            keys[PUBLIC_KEY_KEY] = QString(QByteArray(reinterpret_cast<char*>(publicKeyDER), publicKeyLength).toBase64());
+            keys[PRIVATE_KEY_KEY] = QString(QByteArray(reinterpret_cast<char*>(privateKeyDER), privateKeyLength).toBase64());
+        }
+
+        if (publicKeyLength > 0) {
+            OPENSSL_free(publicKeyDER);
+        }
+        if (privateKeyLength > 0) {
+            OPENSSL_free(privateKeyDER);
+        }
+    } else {
+        qWarning() << "Error generating RSA keypair -" << ERR_get_error();
+    }
+
+    RSA_free(keyPair);
+    return keys;
+}
+
+static QByteArray signPlaintext(const QByteArray& plaintext, const QByteArray& privateKey) {
+    const unsigned char* privateKeyData = reinterpret_cast<const unsigned char*>(privateKey.constData());
+    RSA* rsaPrivateKey = d2i_RSAPrivateKey(NULL, &privateKeyData, privateKey.size());
+
+    if (!rsaPrivateKey) {
+        return QByteArray();
+    }
+
+    QByteArray signature(RSA_size(rsaPrivateKey), 0);
+    unsigned int signatureBytes = 0;
+
+    QByteArray hashedPlaintext = QCryptographicHash::hash(plaintext, QCryptographicHash::Sha256);
+
+    int signReturn = RSA_sign(NID_sha256,
+                              reinterpret_cast<const unsigned char*>(hashedPlaintext.constData()),
+                              hashedPlaintext.size(),
+                              reinterpret_cast<unsigned char*>(signature.data()),
+                              &signatureBytes,
+                              rsaPrivateKey);
+
+    RSA_free(rsaPrivateKey);
+
+    return signReturn == 1 ? signature : QByteArray();
+}
+
+ICELoadGenerator::ICELoadGenerator(const Settings& settings, QObject* parent) :
+    QObject(parent),
+    _settings(settings),
+    _socket(this)
+{
+    _socket.bind(QHostAddress::AnyIPv4, 0);
+    _socket.setPacketHandler([this](std::unique_ptr<udt::Packet> packet) { processPacket(std::move(packet)); });
+
+    connect(&_sendTimer, &QTimer::timeout, this, &ICELoadGenerator::sendHeartbeats);
+    connect(&_reportTimer, &QTimer::timeout, this, &ICELoadGenerator::report);
+}
+
+bool ICELoadGenerator::start() {
+    if (!loadOrCreateKeys()) {
+        return false;
+    }
+
+    qDebug() << "Sending" << _settings.heartbeatsPerSecond << "heartbeats per second for" << _domains.size()
+        << "domains to" << _settings.iceServerAddr;
+    qDebug() << "The ice-server has to be started with --public-keys" << _settings.keysPath;
+
+    _elapsed.start();
+
+    const int SEND_INTERVAL_MSECS = 5;
+    _sendTimer.setTimerType(Qt::PreciseTimer);
+    _sendTimer.start(SEND_INTERVAL_MSECS);
+    _reportTimer.start((int)MSECS_PER_SECOND);
+
+    return true;
+}
+
+bool ICELoadGenerator::loadOrCreateKeys() {
+    QJsonObject keysObject;
+
+    QFile keysFile(_settings.keysPath);
+    if (keysFile.open(QIODevice::ReadOnly)) {
+        keysObject = QJsonDocument::fromJson(keysFile.readAll()).object();
+        keysFile.close();
+    }
+
+    if (keysObject.size() < _settings.numDomains) {
+        qDebug() << "Generating" << (_settings.numDomains - keysObject.size()) << "keypairs, this takes a while";
+
+        while (keysObject.size() < _settings.numDomains) {
+            auto keys = generateKeypair();
+            if (keys.isEmpty()) {
+                return false;
+            }
+            keysObject[uuidStringWithoutCurlyBraces(QUuid::createUuid())] = keys;
+        }
+
+        if (!keysFile.open(QIODevice::WriteOnly)) {
+            qWarning() << "Could not write the keys to" << _settings.keysPath;
+            return false;
+        }
+        keysFile.write(QJsonDocument(keysObject).toJson());
+        keysFile.close();
+    }
+
+    HifiSockAddr localSocket(QHostAddress::LocalHost, _socket.localPort());
+
+    for (auto it = keysObject.begin(); it != keysObject.end() && (int)_domains.size() < _settings.numDomains; ++it) {
+        Domain domain;
+        domain.id = QUuid(it.key());
+
+        auto privateKey = QByteArray::fromBase64(it.value().toObject()[PRIVATE_KEY_KEY].toString().toUtf8());
+
+        // build the heartbeat the same way a domain-server does
+        domain.heartbeatPacket = NLPacket::create(PacketType::ICEServerHeartbeat);
+
+        QDataStream heartbeatDataStream(domain.heartbeatPacket.get());
+        heartbeatDataStream << domain.id << localSocket << localSocket;
+
+        auto plaintext = QByteArray::fromRawData(domain.heartbeatPacket->getPayload(),
+                                                 domain.heartbeatPacket->getPayloadSize());
+        auto signature = signPlaintext(plaintext, privateKey);
+        if (signature.isEmpty()) {
+            qWarning() << "Could not sign a heartbeat for" << it.key() << "with the keys from" << _settings.keysPath;
+            return false;
+        }
+
+        heartbeatDataStream << signature;
+
+        _domains.push_back(std::move(domain));
+    }
+
+    return !_domains.empty();
+}
+
+void ICELoadGenerator::sendHeartbeats() {
+    if (_settings.durationSeconds > 0 && (quint64)_elapsed.elapsed() >= _settings.durationSeconds * MSECS_PER_SECOND) {
+        _sendTimer.stop();
+        _reportTimer.stop();
+
+        // the totals count the heartbeats still in flight as unanswered
+        double seconds = (double)_elapsed.elapsed() / MSECS_PER_SECOND;
+        double acknowledgedPerSecond = _numAcknowledged / seconds;
+        qDebug().noquote() << QString("Total: sent %1/s, acknowledged %2/s, denied %3/s - %4/s per ice-server core")
+            .arg(_numSent / seconds, 0, 'f', 0).arg(acknowledgedPerSecond, 0, 'f', 0).arg(_numDenied / seconds, 0, 'f', 0)
+            .arg(acknowledgedPerSecond / _settings.serverCores, 0, 'f', 0);
+
+        emit finished();
+        return;
+    }
+
+    // catch up with the rate, whatever the timer's precision
+    quint64 due = (quint64)(_elapsed.elapsed() * (qint64)_settings.heartbeatsPerSecond / MSECS_PER_SECOND);
+
+    while (_numSent < due) {
+        auto& domain = _domains[_nextDomain];
+        _nextDomain = (_nextDomain + 1) % _domains.size();
+
+        _socket.writePacket(*domain.heartbeatPacket, _settings.iceServerAddr);
+        ++_numSent;
+    }
+}
+
+void ICELoadGenerator::report() {
+    qint64 now = _elapsed.elapsed();
+    double seconds = (double)(now - _lastReportTime) / MSECS_PER_SECOND;
+
+    double acknowledgedPerSecond = (_numAcknowledged - _lastNumAcknowledged) / seconds;
+
+    qDebug().noquote() << QString("Sent %1/s, acknowledged %2/s, denied %3/s - %4/s per ice-server core")
+        .arg((_numSent - _lastNumSent) / seconds, 0, 'f', 0).arg(acknowledgedPerSecond, 0, 'f', 0)
+        .arg((_numDenied - _lastNumDenied) / seconds, 0, 'f', 0)
+        .arg(acknowledgedPerSecond / _settings.serverCores, 0, 'f', 0);
+
+    _lastNumSent = _numSent;
+    _lastNumAcknowledged = _numAcknowledged;
+    _lastNumDenied = _numDenied;
+    _lastReportTime = now;
+}
+
+void ICELoadGenerator::processPacket(std::unique_ptr<udt::Packet> packet) {
+    auto type = NLPacket::typeInHeader(*packet);
+
+    if (type == PacketType::ICEServerHeartbeatACK) {
+        ++_numAcknowledged;
+    } else if (type == PacketType::ICEServerHeartbeatDenied) {
+        ++_numDenied;
+    }
+}
@@ -0,0 +1,83 @@
+//
+//  ICELoadGenerator.h
+//  tools/ice-client/src
+//
+//  Copyright 2019 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ICELoadGenerator_h
+#define hifi_ICELoadGenerator_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+#include <NLPacket.h>
+#include <udt/Socket.h>
+
+// Simulates many domains heartbeating an ice-server, and reports how many heartbeats it verifies and answers.
+//
+// The domains' keypairs are kept in a JSON file (domain ID to base64 "public_key" and "private_key"), created on
+// the first run. The ice-server has to be started with that file as --public-keys to trust the simulated domains,
+// otherwise every heartbeat is denied.
+class ICELoadGenerator : public QObject {
+    Q_OBJECT
+public:
+    struct Settings {
+        HifiSockAddr iceServerAddr;
+        int numDomains { 100 };
+        int heartbeatsPerSecond { 1000 };
+        int durationSeconds { 10 }; // 0 to run until killed
+        QString keysPath;
+        int serverCores { 1 }; // to report the rate per core of the machine the ice-server runs on
+    };
+
+    ICELoadGenerator(const Settings& settings, QObject* parent = nullptr);
+
+    // Returns false if the keys couldn't be loaded or created.
+    bool start();
+
+signals:
+    void finished();
+
+private slots:
+    void sendHeartbeats();
+    void report();
+
+private:
+    struct Domain {
+        QUuid id;
+        std::unique_ptr<NLPacket> heartbeatPacket; // signed once, domains re-send the same heartbeat
+    };
+
+    bool loadOrCreateKeys();
+    void processPacket(std::unique_ptr<udt::Packet> packet);
+
+    Settings _settings;
+
+    udt::Socket _socket;
+    std::vector<Domain> _domains;
+    size_t _nextDomain { 0 };
+
+    QTimer _sendTimer;
+    QTimer _reportTimer;
+    QElapsedTimer _elapsed;
+
+    quint64 _numSent { 0 };
+    quint64 _numAcknowledged { 0 };
+    quint64 _numDenied { 0 };
+
+    // totals at the last report
+    quint64 _lastNumSent { 0 };
+    quint64 _lastNumAcknowledged { 0 };
+    quint64 _lastNumDenied { 0 };
+    qint64 _lastReportTime { 0 };
+};
+
+#endif // hifi_ICELoadGenerator_h
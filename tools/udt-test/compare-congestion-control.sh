@@ -0,0 +1,54 @@
+#!/bin/bash
+#
+#  compare-congestion-control.sh
+#  tools/udt-test
+#
+#  Compares the throughput and RTT inflation of the Vegas and BBR congestion controls
+#  between two udt-test instances on loopback, with the sender's socket emulating the network.
+#
+#  Usage: ./compare-congestion-control.sh [path to udt-test] [seconds per run]
+#  Conditions are read from DELAY (round trip ms, default 50), LOSS (percent, default 0),
+#  RATE (kbps, default 100000) and SEED (default 1).
+#
+#  Copyright 2019 High Fidelity, Inc.
+#
+#  Distributed under the Apache License, Version 2.0.
+#  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+#
+
+UDT_TEST=${1:-./udt-test}
+DURATION=${2:-30}
+DELAY=${DELAY:-50}
+LOSS=${LOSS:-0}
+RATE=${RATE:-100000}
+SEED=${SEED:-1}
+PORT=${PORT:-40102}
+
+# the sender conditions both directions, so use half the delay each way
+CONDITIONS="seed=$SEED;direction=out,delay=$(( DELAY / 2 )),loss=$LOSS,bandwidth=$RATE;direction=in,delay=$(( DELAY / 2 ))"
+trap "kill 0" EXIT
+
+"$UDT_TEST" -p $PORT > /dev/null 2>&1 &
+sleep 1
+
+for CC in vegas bbr; do
+    # columns are: Send (Mb/s) | Est. Max | RTT (ms) | RTT Inflation | ...
+    timeout $DURATION "$UDT_TEST" --target 127.0.0.1:$PORT --congestion-control $CC \
+        --network-conditions "$CONDITIONS" 2>&1 \
+        | awk -v cc=$CC '
+            {
+                # drop the log handler prefix before splitting the stats row
+                line = $0
+                sub(/^.*\] */, "", line)
+                split(line, columns, "|")
+                if (columns[1] ~ /^ *[0-9.]+ *$/) {
+                    send += columns[1]; rtt += columns[3]; inflation += columns[4]; samples++
+                }
+            }
+            END {
+                if (samples > 0) {
+                    printf "%-6s  avg send %8.2f Mb/s  avg RTT %8.2f ms  avg RTT inflation %5.2f\n",
+                        cc, send / samples, rtt / samples, inflation / samples
+                }
+            }'
+done
@@ -13,9 +13,11 @@
 
 #include <QtCore/QDebug>
 
+#include <udt/BBRCC.h>
 #include <udt/Constants.h>
 #include <udt/Packet.h>
 #include <udt/PacketList.h>
+#include <udt/TCPVegasCC.h>
 
 #include <LogHandler.h>
 
@@ -55,9 +57,16 @@ const QCommandLineOption MESSAGE_SEED {
 const QCommandLineOption STATS_INTERVAL {
     "stats-interval", "stats output interval (default is 100ms)", "milliseconds"
 };
+const QCommandLineOption CONGESTION_CONTROL {
+    "congestion-control", "congestion control used by the sender, vegas or bbr (default is vegas)", "name", "vegas"
+};
+const QCommandLineOption NETWORK_CONDITIONS {
+    "network-conditions", "emulated loss, reordering, jitter and bandwidth caps for this socket "
+    "(e.g. seed=1;loss=1,delay=25,bandwidth=20000), see udt::NetworkConditioner", "conditions"
+};
 
 const QStringList CLIENT_STATS_TABLE_HEADERS {
-    "Send (Mb/s)", "Est. Max (Mb/s)", "RTT (ms)", "CW (P)", "Period (us)",
+    "Send (Mb/s)", "Est. Max (Mb/s)", "RTT (ms)", "RTT Inflation", "CW (P)", "Period (us)",
     "Recv ACK", "Procd ACK", "Sent Packets", "Re-sent Packets"
 };
 
@@ -74,6 +83,25 @@ UDTTest::UDTTest(int& argc, char** argv) :
     // randomize the seed for packet size randomization
     srand(time(NULL));
 
+    QString congestionControl = _argumentParser.value(CONGESTION_CONTROL);
+    if (congestionControl == "bbr") {
+        _socket.setCongestionControlFactory(std::unique_ptr<udt::CongestionControlVirtualFactory>(
+            new udt::CongestionControlFactory<udt::BBRCC>()));
+    } else if (congestionControl == "vegas") {
+        _socket.setCongestionControlFactory(std::unique_ptr<udt::CongestionControlVirtualFactory>(
+            new udt::CongestionControlFactory<udt::TCPVegasCC>()));
+    } else {
+        qCritical() << "Unknown congestion control" << congestionControl << "- expected vegas or bbr.";
+        QMetaObject::invokeMethod(this, "quit", Qt::QueuedConnection);
+    }
+    qDebug() << "Using" << congestionControl << "congestion control";
+
+    if (_argumentParser.isSet(NETWORK_CONDITIONS)
+        && !_socket.setNetworkConditions(_argumentParser.value(NETWORK_CONDITIONS))) {
+        qCritical() << "Invalid network conditions" << _argumentParser.value(NETWORK_CONDITIONS);
+        QMetaObject::invokeMethod(this, "quit", Qt::QueuedConnection);
+    }
+
     _socket.bind(QHostAddress::AnyIPv4, _argumentParser.value(PORT_OPTION).toUInt());
     qDebug() << "Test socket is listening on" << _socket.localPort();
     
@@ -224,7 +252,7 @@ void UDTTest::parseArguments() {
     _argumentParser.addOptions({
         PORT_OPTION, TARGET_OPTION, PACKET_SIZE, MIN_PACKET_SIZE, MAX_PACKET_SIZE,
         MAX_SEND_BYTES, MAX_SEND_PACKETS, UNRELIABLE_PACKETS, ORDERED_PACKETS,
-        MESSAGE_SIZE, MESSAGE_SEED, STATS_INTERVAL
+        MESSAGE_SIZE, MESSAGE_SEED, STATS_INTERVAL, CONGESTION_CONTROL, NETWORK_CONDITIONS
     });
     
     if (!_argumentParser.parse(arguments())) {
@@ -373,6 +401,12 @@ void UDTTest::sampleStats() {
         }
         
         udt::ConnectionStats::Stats stats = _socket.sampleStatsForConnection(_target);
+
+        // how much queueing the congestion control adds, relative to the lowest RTT seen on this connection
+        if (stats.rtt > 0 && (_minRTT <= 0 || stats.rtt < _minRTT)) {
+            _minRTT = stats.rtt;
+        }
+        double rttInflation = _minRTT > 0 ? (double)stats.rtt / _minRTT : 0.0;
         
         int headerIndex = -1;
         
@@ -381,6 +415,7 @@ void UDTTest::sampleStats() {
             QString::number(stats.sendRate * PPS_TO_MBPS).rightJustified(CLIENT_STATS_TABLE_HEADERS[++headerIndex].size()),
             QString::number(stats.estimatedBandwith * PPS_TO_MBPS).rightJustified(CLIENT_STATS_TABLE_HEADERS[++headerIndex].size()),
             QString::number(stats.rtt / USECS_PER_MSEC, 'f', 2).rightJustified(CLIENT_STATS_TABLE_HEADERS[++headerIndex].size()),
+            QString::number(rttInflation, 'f', 2).rightJustified(CLIENT_STATS_TABLE_HEADERS[++headerIndex].size()),
             QString::number(stats.congestionWindowSize).rightJustified(CLIENT_STATS_TABLE_HEADERS[++headerIndex].size()),
             QString::number(stats.packetSendPeriod).rightJustified(CLIENT_STATS_TABLE_HEADERS[++headerIndex].size()),
             QString::number(stats.events[udt::ConnectionStats::Stats::ReceivedACK]).rightJustified(CLIENT_STATS_TABLE_HEADERS[++headerIndex].size()),
@@ -71,6 +71,7 @@ private:
     int _totalQueuedBytes { 0 }; // keeps track of the number of bytes we have already queued
     
     int _statsInterval { 100 }; // recording interval for stats in milliseconds
+    int _minRTT { -1 }; // lowest RTT sampled on the target connection, in microseconds
 };
 
 #endif // hifi_UDTTest_h